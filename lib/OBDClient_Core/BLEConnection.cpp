@@ -0,0 +1,114 @@
+#include "BLEConnection.h"
+
+const char* connectResultText(ConnectResult result) {
+  switch (result) {
+    case CONNECT_OK:         return "Connected";
+    case CONNECT_NO_DEVICE:  return "No target device found";
+    case CONNECT_FAILED:     return "Connection failed";
+    case CONNECT_NO_SERVICE: return "Failed to find service UUID";
+    case CONNECT_NO_TX:      return "Failed to find TX characteristic";
+    case CONNECT_NO_RX:      return "Failed to find RX characteristic";
+    case CONNECT_NO_NOTIFY:  return "Characteristic doesn't support notifications";
+  }
+  return "Unknown";
+}
+
+void BLEConnection::setDevice(const BLEAdvertisedDevice& found) {
+  device = found;
+  deviceSet = true;
+}
+
+ConnectResult BLEConnection::open(notify_callback onNotify) {
+  if (!deviceSet) return fail(CONNECT_NO_DEVICE);
+  uint32_t start = millis();
+
+  // One client for the lifetime of the connection
+  if (!client) {
+    client = BLEDevice::createClient();
+    client->setClientCallbacks(&callbacks);
+    clientsCreated++;
+  }
+
+  tx = nullptr;
+  rx = nullptr;
+  if (!client->connect(&device)) return fail(CONNECT_FAILED);
+
+  BLERemoteService* service = client->getService(BLEUUID(SERVICE_UUID));
+  if (!service) return fail(CONNECT_NO_SERVICE);
+
+  BLERemoteCharacteristic* txChar = service->getCharacteristic(BLEUUID(TX_CHAR_UUID));
+  if (!txChar) return fail(CONNECT_NO_TX);
+
+  BLERemoteCharacteristic* rxChar = service->getCharacteristic(BLEUUID(RX_CHAR_UUID));
+  if (!rxChar) return fail(CONNECT_NO_RX);
+  if (!rxChar->canNotify()) return fail(CONNECT_NO_NOTIFY);
+
+  rx = rxChar;                    // Set before notifications can arrive
+  rxChar->registerForNotify(onNotify);
+  tx = txChar;
+
+  uint32_t elapsed = millis() - start;
+  timing.connects++;
+  timing.lastConnect = elapsed;
+  average(timing.avgConnect, timing.maxConnect, elapsed, timing.connects);
+
+  if (dropTime) {
+    uint32_t reconnect = millis() - dropTime;
+    timing.lastReconnect = reconnect;
+    timing.reconnects++;
+    average(timing.avgReconnect, timing.maxReconnect, reconnect, timing.reconnects);
+    dropTime = 0;
+  }
+  return CONNECT_OK;
+}
+
+ConnectResult BLEConnection::fail(ConnectResult result) {
+  timing.failures++;
+  if (client && client->isConnected()) {
+    tx = nullptr;                 // A deliberate close, not a drop
+    client->disconnect();
+  }
+  rx = nullptr;
+  return result;
+}
+
+void BLEConnection::close(bool reconnecting) {
+  bool wasOpen = isOpen();
+  tx = nullptr;
+  if (wasOpen && client) client->disconnect();
+  rx = nullptr;
+  if (wasOpen && reconnecting) {
+    dropTime = millis();
+    if (dropTime == 0) dropTime = 1;
+  }
+}
+
+void BLEConnection::dropped() {
+  if (!isOpen()) return;          // close() or a failed open()
+  tx = nullptr;
+  rx = nullptr;
+  timing.drops++;
+  dropTime = millis();
+  if (dropTime == 0) dropTime = 1;
+}
+
+bool BLEConnection::write(const uint8_t* data, size_t length) {
+  BLERemoteCharacteristic* characteristic = tx;   // Read once: close() clears it
+  if (!characteristic) return false;
+  characteristic->writeValue((uint8_t*)data, length, true);
+  return true;
+}
+
+int BLEConnection::getRssi() {
+  return isOpen() ? client->getRssi() : 0;
+}
+
+// Running mean over count samples plus the maximum
+void BLEConnection::average(uint32_t& avg, uint32_t& max, uint32_t sample, uint32_t count) {
+  if (count <= 1) {
+    avg = sample;
+  } else {
+    avg = (uint32_t)(avg + ((int64_t)sample - avg) / (int64_t)count);
+  }
+  if (sample > max) max = sample;
+}
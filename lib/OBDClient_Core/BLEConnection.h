@@ -0,0 +1,89 @@
+#ifndef BLE_CONNECTION_H
+#define BLE_CONNECTION_H
+
+#include <Arduino.h>
+#include <BLEDevice.h>
+#include <BLEClient.h>
+#include <BLEAdvertisedDevice.h>
+
+// BLE UUIDs (Nordic UART Service compatible)
+#define SERVICE_UUID    "6E400001-B5A3-F393-E0A9-E50E24DCCA9E"
+#define TX_CHAR_UUID    "6E400002-B5A3-F393-E0A9-E50E24DCCA9E"  // Write to this
+#define RX_CHAR_UUID    "6E400003-B5A3-F393-E0A9-E50E24DCCA9E"  // Notifications from this
+
+// BLE Client callbacks - using unique class names
+class OBDClientCallbacks : public BLEClientCallbacks {
+public:
+  void onConnect(BLEClient* pClient) override;
+  void onDisconnect(BLEClient* pClient) override;
+};
+
+enum ConnectResult {
+  CONNECT_OK,
+  CONNECT_NO_DEVICE,       // Nothing found by the scan yet
+  CONNECT_FAILED,          // Link not established
+  CONNECT_NO_SERVICE,      // Nordic UART service missing
+  CONNECT_NO_TX,
+  CONNECT_NO_RX,
+  CONNECT_NO_NOTIFY        // RX characteristic cannot notify
+};
+
+const char* connectResultText(ConnectResult result);
+
+// Connect and reconnect timing (ms)
+struct ConnectionTiming {
+  uint32_t connects = 0;          // Successful opens
+  uint32_t failures = 0;          // Failed opens
+  uint32_t drops = 0;             // Links lost without close()
+  uint32_t lastConnect = 0;       // open() duration: connect, discovery, subscribe
+  uint32_t avgConnect = 0;
+  uint32_t maxConnect = 0;
+  uint32_t reconnects = 0;        // Successful opens after a drop
+  uint32_t lastReconnect = 0;     // Drop to the next successful open()
+  uint32_t avgReconnect = 0;
+  uint32_t maxReconnect = 0;
+};
+
+// Link to one adapter. The BLEClient, its callbacks and the found device
+// are created once and reused on every reconnect, so repeated dropouts
+// neither leak nor re-create BLE objects. close() and a lost link only
+// forget the characteristics; the next open() rediscovers them.
+class BLEConnection {
+public:
+  void setDevice(const BLEAdvertisedDevice& found);
+  bool hasDevice() const { return deviceSet; }
+  BLEAdvertisedDevice& getDevice() { return device; }
+  bool isDevice(BLEAdvertisedDevice& other) const {
+    return deviceSet && device.getAddress().equals(other.getAddress());
+  }
+
+  ConnectResult open(notify_callback onNotify);
+  void close(bool reconnecting = false); // reconnecting: time the next open() as a reconnect
+  void dropped();                       // From onDisconnect
+  bool isOpen() const { return tx != nullptr; }
+  bool isLinkUp() const { return client && client->isConnected(); }
+
+  bool write(const uint8_t* data, size_t length);
+  int getRssi();                        // dBm, 0 when closed or unknown
+
+  bool owns(const BLEClient* other) const { return client && client == other; }
+  bool owns(const BLERemoteCharacteristic* other) const { return rx && rx == other; }
+  const ConnectionTiming& getTiming() const { return timing; }
+  uint32_t getClientsCreated() const { return clientsCreated; }
+
+private:
+  ConnectResult fail(ConnectResult result);
+  static void average(uint32_t& avg, uint32_t& max, uint32_t sample, uint32_t count);
+
+  BLEClient* client = nullptr;
+  BLERemoteCharacteristic* tx = nullptr;
+  BLERemoteCharacteristic* rx = nullptr;
+  OBDClientCallbacks callbacks;
+  mutable BLEAdvertisedDevice device;   // ESP32 BLE getters are non-const
+  bool deviceSet = false;
+  uint32_t dropTime = 0;          // 0 = no drop waiting for a reconnect
+  uint32_t clientsCreated = 0;
+  ConnectionTiming timing;
+};
+
+#endif // BLE_CONNECTION_H
@@ -1,11 +1,64 @@
 #include "BLEOBDClient.h"
 
-// Global instance pointer
-BLEOBDClient* g_bleClient = nullptr;
+// Instance registry for callback dispatch
+BLEOBDClient* BLEOBDClient::instances[OBD_MAX_CLIENTS] = {};
+uint8_t BLEOBDClient::instanceCount = 0;
+
+// Shared scan callbacks (BLEScan is a singleton)
+static OBDScanCallbacks scanCallbacks;
+static bool bleInitialized = false;
 
 // Constructor
 BLEOBDClient::BLEOBDClient() {
-  g_bleClient = this;
+  memset(canSignalBindings, SIGNAL_COUNT, sizeof(canSignalBindings));
+  addStandardDerivedSignals(derived, trip);
+  displayConsumer = freshness.addConsumer("display");
+  telemetryConsumer = freshness.addConsumer("telemetry");
+  if (instanceCount < OBD_MAX_CLIENTS) {
+    instances[instanceCount++] = this;
+  }
+}
+
+BLEOBDClient::~BLEOBDClient() {
+  stopPollerTask();
+  for (uint8_t i = 0; i < instanceCount; i++) {
+    if (instances[i] == this) {
+      instances[i] = instances[--instanceCount];
+      instances[instanceCount] = nullptr;
+      break;
+    }
+  }
+}
+
+BLEOBDClient* BLEOBDClient::fromBLEClient(BLEClient* client) {
+  for (uint8_t i = 0; i < instanceCount; i++) {
+    if (instances[i]->connection.owns(client)) return instances[i];
+  }
+  return nullptr;
+}
+
+BLEOBDClient* BLEOBDClient::fromCharacteristic(BLERemoteCharacteristic* characteristic) {
+  for (uint8_t i = 0; i < instanceCount; i++) {
+    if (instances[i]->connection.owns(characteristic)) return instances[i];
+  }
+  return nullptr;
+}
+
+// Still looking for an adapter and this advertisement matches
+bool BLEOBDClient::wantsDevice(BLEAdvertisedDevice& device, bool byName) {
+  if (connectionState != SCANNING || doConnect || deviceConnected) return false;
+  if (byName) return device.getName() == deviceName;
+  return device.haveServiceUUID() && device.isAdvertisingService(BLEUUID(SERVICE_UUID));
+}
+
+// AT / ST commands talk to the adapter itself, everything else goes to the bus
+static bool isAdapterCommand(const char* command) {
+  return command[0] == 'A' || command[0] == 'S';
+}
+
+// Device already taken by this instance (connected or about to connect)
+bool BLEOBDClient::ownsAddress(BLEAdvertisedDevice& device) const {
+  return (deviceConnected || doConnect) && connection.isDevice(device);
 }
 
 // Main initialization
@@ -21,15 +74,24 @@ void BLEOBDClient::begin(String targetDeviceName) {
   
   printSystemInfo();
   
-  Serial.println("🔵 Initializing BLE...");
-  BLEDevice::init("ESP32S3_OBD_Client");
+  // Framing can briefly hold a capped chunk on top of a capped buffer
+  incomingData.reserve(staticMemory ? OBD_MAX_RESPONSE_TEXT * 2 : 256);
+  rxPending.reserve(staticMemory ? OBD_MAX_RESPONSE_TEXT : 256);
+  rxDraining.reserve(staticMemory ? OBD_MAX_RESPONSE_TEXT : 256);
   
-  // Setup BLE scan
+  Serial.println("🔵 Initializing BLE...");
+  if (!bleInitialized) {
+    BLEDevice::init("ESP32S3_OBD_Client");
+    
+    // Setup BLE scan (shared by all instances)
+    BLEScan* scan = BLEDevice::getScan();
+    scan->setAdvertisedDeviceCallbacks(&scanCallbacks);
+    scan->setInterval(1349);
+    scan->setWindow(449);
+    scan->setActiveScan(true);
+    bleInitialized = true;
+  }
   pBLEScan = BLEDevice::getScan();
-  pBLEScan->setAdvertisedDeviceCallbacks(new OBDScanCallbacks());
-  pBLEScan->setInterval(1349);
-  pBLEScan->setWindow(449);
-  pBLEScan->setActiveScan(true);
   
   Serial.println("✅ BLE Client initialized!");
   Serial.println("🔍 Target device: " + deviceName);
@@ -37,6 +99,9 @@ void BLEOBDClient::begin(String targetDeviceName) {
   // Start scanning
   updateConnectionState(SCANNING);
   startScan();
+  
+  heapAtBegin = ESP.getFreeHeap();
+  allocationsAtBegin = obdAllocationCount();
 }
 
 void BLEOBDClient::startScan() {
@@ -51,8 +116,53 @@ void BLEOBDClient::startScan() {
 }
 
 void BLEOBDClient::loop() {
-  // Handle connection state machine
-  if (doConnect && deviceFound) {
+  if (!pollerThread.isRunning()) {
+    service();
+  }
+  displayStatus();
+  
+  delay(50); // Small delay for stability
+}
+
+bool BLEOBDClient::startPollerTask(int8_t core, uint8_t priority, uint32_t stackSize) {
+  pollerStop = false;
+  if (!pollerThread.start(pollerEntry, this, "obd_poller", stackSize, priority, core)) {
+    Serial.println("❌ Failed to start poller task");
+    return false;
+  }
+  Serial.println("🧵 Poller task running on core " + String(core) + ", priority " + String(priority));
+  return true;
+}
+
+void BLEOBDClient::stopPollerTask() {
+  if (!pollerThread.isRunning()) return;
+  pollerStop = true;
+  pollerWake.notify();
+  pollerThread.join();
+}
+
+void BLEOBDClient::pollerEntry(void* self) {
+  BLEOBDClient* client = static_cast<BLEOBDClient*>(self);
+  while (!client->pollerStop) {
+    client->pollerWake.wait(OBD_POLLER_IDLE_MS);
+    client->service();
+  }
+}
+
+void BLEOBDClient::service() {
+  if (linkLost.exchange(false)) {
+    OBDLockGuard guard(stateLock);
+    handleLinkLost();
+  }
+  
+  // Handle connection state machine (the scan callback sets the device and
+  // flags on the BLE task, under the lock)
+  bool connectNow;
+  {
+    OBDLockGuard guard(stateLock);
+    connectNow = doConnect && deviceFound;
+  }
+  if (connectNow) {
     updateConnectionState(CONNECTING);
     if (connectToDevice()) {
       Serial.println("🎉 Successfully connected to OBD2 device!");
@@ -81,110 +191,189 @@ void BLEOBDClient::loop() {
     startScan();
   }
   
+  OBDLockGuard guard(stateLock);
+  drainIncoming();
+  releaseHeldReply();
+  
+  // Link quality check (may restart a poor link before polling)
+  if (deviceConnected && connectionState == CONNECTED) {
+    checkLink();
+  }
+  
   // Process OBD commands if connected
   if (deviceConnected && connectionState == CONNECTED) {
+    if (monitorState != MONITOR_OFF) {
+      processMonitorFrames();
+    }
     processCommandQueue();
+    updateDerivedSignals();
   }
+  if (telemetryOut) flushTelemetry();
+  profiler.markPublished();
+  subscriptions.poll(millis());
   
   // Handle command timeouts
-  if (waitingForResponse && (millis() - lastCommandTime > defaultTimeout)) {
+  if (waitingForResponse && (millis() - lastCommandTime > activeTimeout)) {
     handleTimeout();
   }
+}
+
+void BLEOBDClient::displayStatus() {
+  // Copy what is due under the lock and print without it: Serial can block
+  // as long as the USB host takes, and the poller must not wait for that
+  StatusSnapshot status;
+  bool showData, showStats;
+  {
+    OBDLockGuard guard(stateLock);
+    if (telemetryOut) return; // Text would corrupt the binary stream
+    
+    unsigned long now = millis();
+    showData = now - lastDataDisplay > 2000;
+    showStats = now - lastStatsDisplay > 10000;
+    if (!showData && !showStats) return;
+    if (showData) lastDataDisplay = now;
+    if (showStats) lastStatsDisplay = now;
+    snapshotStatus(status, showData);
+  }
   
   // Display data periodically
-  if (millis() - lastDataDisplay > 2000) {
-    if (deviceConnected) {
-      displayOBDData();
+  if (showData) {
+    if (status.connected) {
+      printOBDData(status);
     } else {
-      printConnectionInfo();
+      printConnectionState(status);
     }
-    lastDataDisplay = millis();
   }
   
   // Display statistics periodically
-  if (millis() - lastStatsDisplay > 10000) {
-    displayStatistics();
-    lastStatsDisplay = millis();
+  if (showStats) {
+    printStatistics(status);
   }
+}
+
+// Caller holds stateLock. consumeData: the values are about to be shown,
+// record them as read by the display consumer.
+void BLEOBDClient::snapshotStatus(StatusSnapshot& out, bool consumeData) {
+  unsigned long now = millis();
+  out.state = connectionState;
+  out.connected = deviceConnected;
+  strncpy(out.deviceName, deviceName.c_str(), sizeof(out.deviceName) - 1);
+  out.deviceName[sizeof(out.deviceName) - 1] = '\0';
+  out.scanDuration = now - scanStartTime;
+  out.data = obdData;
+  out.dataAge = now - obdData.lastUpdate;
   
-  delay(50); // Small delay for stability
+  // Age of each value since its request was sent, not since the last reply
+  out.oldestAge = 0;
+  out.oldestSignal = SIGNAL_RPM;
+  for (uint8_t i = 0; i < SIGNAL_COUNT; i++) {
+    uint32_t age = freshness.getAge((OBDSignal)i, now);
+    if (age > out.oldestAge) {
+      out.oldestAge = age;
+      out.oldestSignal = (OBDSignal)i;
+    }
+  }
+  if (consumeData && deviceConnected) {
+    freshness.consumed(displayConsumer, FRESHNESS_ALL_SIGNALS, now);
+  }
+  
+  out.stats = stats;
+  out.successRate = getSuccessRate();
+  out.uptime = getUptime();
+  out.timing = connection.getTiming();
+  out.pollBackoff = pollBackoff;
+  out.link = linkMonitor.getQuality();
+  out.staticMemory = staticMemory;
+  if (staticMemory) out.memory = getMemoryReport();
 }
 
 bool BLEOBDClient::connectToDevice() {
-  if (!targetDevice) {
+  if (!connection.hasDevice()) {
     Serial.println("❌ No target device found!");
     return false;
   }
   
-  Serial.println("🔗 Connecting to: " + String(targetDevice->getAddress().toString().c_str()));
-  
-  // Create client
-  pClient = BLEDevice::createClient();
-  pClient->setClientCallbacks(new OBDClientCallbacks());
+  Serial.println("🔗 Connecting to: " + String(connection.getDevice().getAddress().toString().c_str()));
   
-  // Connect to device
-  if (!pClient->connect(targetDevice)) {
-    Serial.println("❌ Connection failed!");
+  ConnectResult result = connection.open(bleNotifyCallback);
+  if (result != CONNECT_OK) {
+    Serial.print("❌ ");
+    Serial.println(connectResultText(result));
     return false;
   }
   
-  Serial.println("✅ Connected! Discovering services...");
-  
-  // Get service
-  BLERemoteService* pRemoteService = pClient->getService(BLEUUID(SERVICE_UUID));
-  if (pRemoteService == nullptr) {
-    Serial.println("❌ Failed to find service UUID");
-    pClient->disconnect();
-    return false;
-  }
+  const ConnectionTiming& timing = connection.getTiming();
+  Serial.println("✅ Connected and registered for notifications in " + String(timing.lastConnect) + "ms");
   
-  Serial.println("✅ Service found!");
+  deviceConnected = true;
+  stats.lastConnectionTime = millis();
+  linkMonitor.reset(millis());
+  lastRssiSample = 0;
+  return true;
+}
+
+// Link loss reported by onDisconnect(). close() raises it too; only a drop
+// of an open link is handled here
+void BLEOBDClient::handleLinkLost() {
+  // Already reconnected, or closed on purpose: the event is stale
+  if (connection.isLinkUp() || !connection.isOpen()) return;
   
-  // Get TX characteristic (for writing)
-  pTxCharacteristic = pRemoteService->getCharacteristic(BLEUUID(TX_CHAR_UUID));
-  if (pTxCharacteristic == nullptr) {
-    Serial.println("❌ Failed to find TX characteristic");
-    pClient->disconnect();
-    return false;
-  }
+  unsigned long uptime = getUptime();
+  stats.connectionUptime += uptime;
+  connection.dropped();
+  deviceConnected = false;
+  updateConnectionState(DISCONNECTED);
   
-  // Get RX characteristic (for notifications)
-  pRxCharacteristic = pRemoteService->getCharacteristic(BLEUUID(RX_CHAR_UUID));
-  if (pRxCharacteristic == nullptr) {
-    Serial.println("❌ Failed to find RX characteristic");
-    pClient->disconnect();
-    return false;
-  }
+  Serial.println("💔 BLE Disconnected (" + deviceName + ")! Uptime was: " + String(uptime) + "ms");
   
-  // Register for notifications
-  if (pRxCharacteristic->canNotify()) {
-    pRxCharacteristic->registerForNotify(bleNotifyCallback);
-    Serial.println("✅ Registered for notifications!");
-  } else {
-    Serial.println("❌ Characteristic doesn't support notifications!");
-    pClient->disconnect();
-    return false;
+  if (autoReconnect) {
+    Serial.println("🔄 Will attempt reconnection...");
+    doScan = true;
   }
-  
-  deviceConnected = true;
-  stats.lastConnectionTime = millis();
-  return true;
 }
 
 void BLEOBDClient::disconnect() {
-  if (pClient && deviceConnected) {
-    pClient->disconnect();
+  if (deviceConnected) {
+    connection.close();
     deviceConnected = false;
     updateConnectionState(DISCONNECTED);
   }
 }
 
+// Sample RSSI and reconnect a link that has stayed poor, instead of
+// waiting for the supervision timeout to drop it
+void BLEOBDClient::checkLink() {
+  unsigned long now = millis();
+  if (rssiInterval > 0 && (lastRssiSample == 0 || now - lastRssiSample >= rssiInterval)) {
+    linkMonitor.rssiSample(connection.getRssi());
+    lastRssiSample = now;
+  }
+  
+  if (!autoReconnect || !linkMonitor.shouldReconnect(now)) return;
+  
+  Serial.print("📉 Link quality ");
+  Serial.print(linkMonitor.getScore());
+  Serial.println("/100, reconnecting before the link drops");
+  stats.connectionUptime += getUptime();
+  connection.close(true);
+  deviceConnected = false;
+  waitingForResponse = false;
+  updateConnectionState(DISCONNECTED);
+  
+  // Same adapter: connect straight back to the cached device, no scan
+  deviceFound = true;
+  doConnect = true;
+}
+
 void BLEOBDClient::initializeOBD() {
   Serial.println("🔧 Initializing OBD2 connection...");
   updateConnectionState(INITIALIZING);
   
   // Clear any existing commands
-  resetCommandQueue();
+  {
+    OBDLockGuard guard(stateLock);
+    resetCommandQueue();
+  }
   
   // Send initialization commands with delays
   delay(500);
@@ -196,122 +385,386 @@ void BLEOBDClient::initializeOBD() {
   delay(200);
   sendCommand("ATS0");     // Spaces off
   delay(200);
+  sendCommand("ATH1");     // Headers on (identify responding ECUs)
+  delay(200);
   sendCommand("ATSP0");    // Auto protocol
   delay(500);
   
+  OBDLockGuard guard(stateLock);
+  
+  // Restore single-ECU filter and adapter timing
+  queueECUFilter();
+  queueTimingSetup();
+  
+  // Identify the adapter chip (ELM327 vs STN) once polling starts
+  adapterType = ADAPTER_UNKNOWN;
+  adapterIsSTN = false;
+  submitRequest("ATI", onIdentifyResponse, this);
+  
+  // Pick the voltage source: PID 0142 if listed in the 41-60 support mask
+  voltageSource = VOLTAGE_UNKNOWN;
+  voltageInFlight = false;
+  voltageFailures = 0;
+  submitRequest("0140", onVoltageSupport, this);
+  
+  // Replies to the init commands above were never waited for
+  rxLock.lock();
+  rxPending = "";
+  rxLock.unlock();
+  
   Serial.println("✅ OBD2 initialization complete!");
   updateConnectionState(CONNECTED);
 }
 
 void BLEOBDClient::setupOBDCommands() {
+  OBDLockGuard guard(stateLock);
   Serial.println("📋 Setting up OBD command queue...");
   
   // Add commands to queue (non-blocking like ELMduino)
-  addCommand("010C", &obdData.rpm, parseRPM);           // Engine RPM
-  addCommand("010D", &obdData.speed, parseSpeed);       // Vehicle Speed
-  addCommand("0105", &obdData.coolantTemp, parseTemperature); // Coolant Temp
-  addCommand("015C", &obdData.oilTemp, parseTemperature);     // Oil Temp
-  addCommand("012F", &obdData.fuelLevel, parsePercentage);    // Fuel Level
-  addCommand("0111", &obdData.throttlePos, parsePercentage);  // Throttle Position
-  addCommand("0104", &obdData.engineLoad, parsePercentage);   // Engine Load
-  addCommand("0110", &obdData.airflowRate, parseAirflow);     // Airflow Rate
-  
-  Serial.println("✅ Command queue ready with " + String(commandQueue.size()) + " commands");
-}
-
-void BLEOBDClient::addCommand(String cmd, float* target, bool (*parser)(String, float*)) {
-  OBDCommand newCmd;
-  newCmd.command = cmd;
-  newCmd.targetVariable = target;
-  newCmd.parseFunction = parser;
+  addPID(standardPID(0x0C, 2, 0.25f), &obdData.rpm);                  // Engine RPM
+  addPID(standardPID(0x0D, 1, 1.0f), &obdData.speed);                 // Vehicle Speed
+  addPID(standardPID(0x05, 1, 1.0f, -40.0f), &obdData.coolantTemp);   // Coolant Temp
+  addPID(standardPID(0x5C, 1, 1.0f, -40.0f), &obdData.oilTemp);       // Oil Temp
+  addPID(standardPID(0x2F, 1, 100.0f / 255.0f), &obdData.fuelLevel);  // Fuel Level
+  addPID(standardPID(0x11, 1, 100.0f / 255.0f), &obdData.throttlePos);// Throttle Position
+  addPID(standardPID(0x04, 1, 100.0f / 255.0f), &obdData.engineLoad); // Engine Load
+  addPID(standardPID(0x10, 2, 0.01f), &obdData.airflowRate);          // Airflow Rate
+  addPID(standardPID(0x0B, 1, 1.0f), &obdData.manifoldPressure);      // Intake MAP
+  addPID(standardPID(0x33, 1, 1.0f), &obdData.baroPressure, 30000);   // Barometric pressure
+  
+  // Extended (manufacturer) PIDs
+  for (uint8_t i = 0; i < extendedCount; i++) {
+    addPID(extendedPIDs[i], extendedTargets[i]);
+  }
+  
+  Serial.println("✅ Command queue ready with " + String(commandCount) + " commands");
+  
+  heapAtConnect = ESP.getFreeHeap();
+  allocationsAtConnect = obdAllocationCount();
+}
+
+bool BLEOBDClient::addCommand(String cmd, float* target, OBDParseFunction parser, uint32_t ecuId) {
+  OBDLockGuard guard(stateLock);
+  if (commandCount >= OBD_MAX_COMMANDS || cmd.length() == 0 || cmd.length() >= OBD_MAX_REQUEST) {
+    Serial.println("❌ Cannot add command: " + cmd);
+    return false;
+  }
+  
+  uint8_t slot = commandCount++;
+  OBDCommand& newCmd = commandQueue[slot];
+  memset(&newCmd, 0, sizeof(newCmd));
+  memcpy(newCmd.request, cmd.c_str(), cmd.length() + 1);
+  newCmd.requestLength = cmd.length();
   newCmd.timeout = defaultTimeout;
-  newCmd.completed = false;
-  newCmd.sentTime = 0;
-  commandQueue.push_back(newCmd);
+  newCmd.ecuId = ecuId;
+  newCmd.signal = signalForTarget(target);
+  
+  // Expected reply header, e.g. "010C" -> 0x41 0x0C
+  uint32_t mode = 0, pid = 0;
+  newCmd.responseMode = parseHexValue(cmd.c_str(), 2, &mode) ? (uint8_t)(mode + 0x40) : 0;
+  newCmd.pid = (cmd.length() >= 4 && parseHexValue(cmd.c_str() + 2, 2, &pid)) ? (int16_t)pid : -1;
+  
+  OBDCommandBinding& binding = commandBindings[slot];
+  binding.target = target;
+  binding.parser = parser;
+  return true;
 }
 
-void BLEOBDClient::processCommandQueue() {
-  static unsigned long lastCommandCheck = 0;
+void BLEOBDClient::addPID(const PIDDescriptor& desc, float* target, unsigned long intervalMs) {
+  OBDLockGuard guard(stateLock);
+  if (!pidDescriptorValid(desc)) {
+    Serial.println("❌ PID descriptor field outside the response frame");
+    return;
+  }
+  char request[8];
+  formatPIDRequest(desc, request);
+  if (!addCommand(request, target, nullptr, desc.ecuId)) return;
+  
+  OBDCommand& cmd = commandQueue[commandCount - 1];
+  cmd.interval = intervalMs;
+  cmd.flags |= OBD_CMD_DESCRIPTOR;
+  if (pidEchoLength(desc.mode) == 2) cmd.pid = desc.pid >> 8; // First DID byte
+  commandBindings[commandCount - 1].descriptor = desc;
+}
+
+int BLEOBDClient::addExtendedPID(const PIDDescriptor& desc, float* target) {
+  OBDLockGuard guard(stateLock);
+  if (extendedCount >= OBD_MAX_EXTENDED_PIDS || !pidDescriptorValid(desc)) return -1;
+  
+  uint8_t index = extendedCount++;
+  extendedPIDs[index] = desc;
+  extendedValues[index] = 0.0f;
+  extendedTargets[index] = target ? target : &extendedValues[index];
+  
+  // Already polling: join the running queue
+  if (connectionState == CONNECTED) addPID(desc, extendedTargets[index]);
+  return index;
+}
+
+int BLEOBDClient::loadExtendedPIDs(const uint8_t* blob, size_t length) {
+  OBDLockGuard guard(stateLock);
+  PIDDescriptor loaded[OBD_MAX_EXTENDED_PIDS];
+  int count = parsePIDBlob(blob, length, loaded, OBD_MAX_EXTENDED_PIDS - extendedCount);
+  if (count < 0) {
+    Serial.println("❌ Invalid extended PID blob");
+    return -1;
+  }
+  
+  for (int i = 0; i < count; i++) {
+    addExtendedPID(loaded[i]);
+  }
   
+  if (debugMode) {
+    Serial.println("📋 Loaded " + String(count) + " extended PIDs");
+  }
+  return count;
+}
+
+void BLEOBDClient::processCommandQueue() {
+  OBDLockGuard guard(stateLock);
   if (millis() - lastCommandCheck < 100) return; // Throttle command processing
   lastCommandCheck = millis();
   
-  if (commandQueue.empty()) return;
+  // Monitor mode owns the adapter once filters are set up
+  if (monitorState == MONITOR_STARTING && !waitingForResponse && setupCount == 0) {
+    monitorParser.reset();
+    monitorPromptSeen = false;
+    monitorState = MONITOR_ACTIVE;
+    sendCommand(adapterIsSTN ? "STMA" : "ATMA");
+    return;
+  }
+  if (monitorState == MONITOR_ACTIVE || monitorState == MONITOR_STOPPING) return;
   
   // Process current command if completed
-  if (currentCommandIndex < commandQueue.size() && commandQueue[currentCommandIndex].completed) {
+  if (currentCommandIndex < commandCount && (commandQueue[currentCommandIndex].flags & OBD_CMD_COMPLETED)) {
     OBDCommand& cmd = commandQueue[currentCommandIndex];
+    const OBDCommandBinding& binding = commandBindings[currentCommandIndex];
+    bool answered = cmd.responseLength > 0;
+    bool retry = false;
     
-    if (cmd.rawResponse.length() > 0 && !cmd.rawResponse.startsWith("NO DATA")) {
-      if (cmd.parseFunction && cmd.targetVariable) {
-        if (cmd.parseFunction(cmd.rawResponse, cmd.targetVariable)) {
+    if (answered && replyClass.status == STATUS_DATA) {
+      if (((cmd.flags & OBD_CMD_DESCRIPTOR) || binding.parser) && binding.target) {
+        profiler.markDecodeStart();
+        OBDResponse response;
+        const OBDMessage* msg = routeResponse(cmd, response);
+        learnResponseCount(cmd);
+        if (decodeCommand(currentCommandIndex, msg)) {
+          profiler.markDecoded();
           stats.successfulCommands++;
           obdData.lastUpdate = millis();
-          
-          // Update response time statistics
-          unsigned long responseTime = millis() - cmd.sentTime;
-          if (stats.averageResponseTime == 0) {
-            stats.averageResponseTime = responseTime;
-          } else {
-            stats.averageResponseTime = (stats.averageResponseTime + responseTime) / 2;
+          if (cmd.signal >= 0) {
+            publishSignal((OBDSignal)cmd.signal, *binding.target, cmd.sentTime);
           }
           
+          updateResponseStats(millis() - cmd.sentTime);
+          
           if (verboseLogging) {
-            Serial.println("✅ Parsed " + cmd.command + ": " + String(*cmd.targetVariable));
+            Serial.print("✅ Parsed ");
+            Serial.print(cmd.request);
+            Serial.print(": ");
+            Serial.println(*binding.target);
           }
         } else {
+          profiler.cancel();
           stats.failedCommands++;
           if (debugMode) {
-            Serial.println("❌ Parse failed for: " + cmd.command);
+            Serial.print("❌ Parse failed for: ");
+            Serial.println(cmd.request);
           }
         }
       }
+    } else if (answered && (replyClass.recovery & RECOVER_RETRY) && !pollRetried) {
+      // Transient adapter error: same command again, once
+      profiler.cancel();
+      retry = true;
+      pollRetried = true;
+      stats.retriedCommands++;
+      cmd.lastPolled = 0;
+      if (debugMode) {
+        Serial.print("🔁 ");
+        Serial.print(adapterStatusName(replyClass.status));
+        Serial.print(", retrying: ");
+        Serial.println(cmd.request);
+      }
     } else {
+      profiler.cancel();
       stats.failedCommands++;
       if (debugMode) {
-        Serial.println("❌ No data for: " + cmd.command);
+        if (answered && replyClass.status != STATUS_NO_DATA) {
+          Serial.print("❌ ");
+          Serial.print(adapterStatusName(replyClass.status));
+          Serial.print(" for: ");
+        } else {
+          Serial.print("❌ No data for: ");
+        }
+        Serial.println(cmd.request);
       }
     }
     
     // Move to next command
-    currentCommandIndex++;
-    if (currentCommandIndex >= commandQueue.size()) {
-      currentCommandIndex = 0; // Loop back to start
+    if (!retry) {
+      pollRetried = false;
+      currentCommandIndex++;
+      if (currentCommandIndex >= commandCount) {
+        currentCommandIndex = 0; // Loop back to start
+      }
     }
     
     // Reset command for next cycle
-    cmd.completed = false;
-    cmd.rawResponse = "";
+    cmd.flags &= ~OBD_CMD_COMPLETED;
+    cmd.responseLength = 0;
     cmd.sentTime = 0;
   }
   
+  // A degraded link gets fewer requests, so the adapter's buffer is not overrun
+  // and adapter overrun errors add their own back-off
+  uint32_t spacing = max(linkMonitor.getPollSpacing(), pollBackoff);
+  bool periodicDue = !waitingForResponse && millis() - lastCommandTime >= spacing && selectDueCommand();
+  
+  // Deliver a completed one-shot request
+  if (oneShotReady) {
+    oneShotReady = false;
+    completeOneShot(oneShotTimedOut);
+  }
+  
+  // Periodic DTC read
+  if (dtcInterval > 0 && dtcStep < 0 &&
+      (lastDTCRead == 0 || millis() - lastDTCRead > dtcInterval)) {
+    readDTCs();
+  }
+  
+  // Low-rate voltage read
+  if (voltageInterval > 0 && voltageSource != VOLTAGE_UNKNOWN && !voltageInFlight &&
+      (lastVoltageRead == 0 || millis() - lastVoltageRead > voltageInterval)) {
+    readVoltage();
+  }
+  
+  // Switch the request header when the next request needs a different one
+  // (STN adapters carry the header inside each STPX request instead)
+  bool oneShotNext = oneShotCount > 0 && (periodicSinceOneShot || !periodicDue);
+  if (!waitingForResponse && setupCount == 0 && !adapterIsSTN && (oneShotNext || periodicDue)) {
+    uint32_t wantedHeader = 0;
+    if (!oneShotNext && periodicDue && (commandQueue[currentCommandIndex].flags & OBD_CMD_DESCRIPTOR)) {
+      wantedHeader = commandBindings[currentCommandIndex].descriptor.header;
+    }
+    if (wantedHeader != activeHeader) {
+      if (wantedHeader) {
+        queueHeader(wantedHeader);
+      } else if (targetRequestHeader) {
+        queueHeader(targetRequestHeader);
+      } else {
+        queueHeader(functionalHeader());
+      }
+      activeHeader = wantedHeader;
+    }
+  }
+  
+  // Adapter setup commands take priority over polling
+  if (!waitingForResponse && setupCount > 0) {
+    const char* setupCmd = setupQueue[setupHead];
+    setupHead = (setupHead + 1) % OBD_MAX_SETUP_COMMANDS;
+    setupCount--;
+    profiler.cancel();
+    sendRequest(setupCmd, strlen(setupCmd));
+    setupInFlight = true;
+    waitingForResponse = true;
+    lastCommandTime = millis();
+    activeTimeout = defaultTimeout;
+    return;
+  }
+  
+  // One-shots go out whenever no periodic poll is due, and at most one
+  // between two polls while one is; the timeout is capped so a one-shot
+  // delays the periodic signals by no more than oneShotMaxDelay
+  if (!waitingForResponse && oneShotNext) {
+    OneShotRequest& req = oneShotQueue[oneShotHead];
+    oneShotLength = 0;
+    oneShotTimedOut = false;
+    profiler.cancel();
+    sendRequest(req.command, strlen(req.command));
+    oneShotInFlight = true;
+    waitingForResponse = true;
+    periodicSinceOneShot = false;
+    lastCommandTime = millis();
+    activeTimeout = min(req.timeout, oneShotMaxDelay);
+    return;
+  }
+  
+  if (commandCount == 0) return;
+  
   // Send next command if not waiting
-  if (!waitingForResponse && currentCommandIndex < commandQueue.size()) {
+  if (!waitingForResponse && periodicDue) {
     OBDCommand& cmd = commandQueue[currentCommandIndex];
-    sendCommand(cmd.command);
+    cmd.lastPolled = millis();
+    char request[64];
+    size_t length = buildPollRequest(currentCommandIndex, request, sizeof(request));
+    profiler.markSend();
+    sendRequest(request, length);
     waitingForResponse = true;
+    periodicSinceOneShot = true;
     lastCommandTime = millis();
+    activeTimeout = cmd.timeout;
     cmd.sentTime = millis();
     stats.totalCommands++;
     
     if (verboseLogging) {
-      Serial.println("📤 Sent: " + cmd.command);
+      Serial.print("📤 Sent: ");
+      Serial.println(cmd.request);
     }
   }
 }
 
 void BLEOBDClient::sendCommand(String command) {
-  if (deviceConnected && pTxCharacteristic) {
-    command += "\r"; // Add carriage return
-    pTxCharacteristic->writeValue(command.c_str(), command.length());
+  sendRequest(command.c_str(), command.length());
+}
+
+// Write the request plus carriage return from a stack buffer
+void BLEOBDClient::sendRequest(const char* request, size_t length) {
+  if (deviceConnected && connection.isOpen()) {
+    char line[72];
+    if (length > sizeof(line) - 1) length = sizeof(line) - 1;
+    memcpy(line, request, length);
+    line[length] = '\r';
+    connection.write((const uint8_t*)line, length + 1);
+    linkMonitor.requestSent(millis());
+    droppedWhileWaiting = false;
     
     if (debugMode) {
-      Serial.println("📤 Sent: " + command.substring(0, command.length()-1));
+      Serial.print("📤 Sent: ");
+      Serial.write((const uint8_t*)request, length);
+      Serial.println();
     }
   }
 }
 
-void BLEOBDClient::processIncomingData(String data) {
+// Hand bytes received by the BLE callback to the response framing below
+// (rxPending is swapped with rxDraining under rxLock and framed after it is
+// released, so the callback never waits on logging; both buffers keep their
+// capacity so steady-state polling does not reallocate)
+void BLEOBDClient::drainIncoming() {
+  rxLock.lock();
+  if (rxFirstByteStamped) profiler.markFirstByte(rxFirstByteCycles);
+  if (rxPromptStamped) profiler.markPrompt(rxPromptCycles);
+  rxFirstByteStamped = false;
+  rxPromptStamped = false;
+  bool received = rxPending.length() > 0;
+  if (received) {
+    linkMonitor.notified(rxFirstNotify);
+    linkMonitor.notified(rxLastNotify);
+    String spare = std::move(rxDraining);
+    rxDraining = std::move(rxPending);
+    rxPending = std::move(spare);
+  }
+  rxLock.unlock();
+  
+  if (received) {
+    processIncomingData(rxDraining);
+    rxDraining = "";
+  }
+}
+
+void BLEOBDClient::processIncomingData(const String& data) {
+  unsigned int scanFrom = incomingData.length();
   incomingData += data;
   
   if (verboseLogging) {
@@ -319,203 +772,1417 @@ void BLEOBDClient::processIncomingData(String data) {
     Serial.println("📋 Buffer: '" + incomingData + "'");
   }
   
-  // Check if we have a complete response (ends with >)
-  if (incomingData.indexOf('>') != -1) {
-    // Extract the response (everything before the >)
-    int promptPos = incomingData.indexOf('>');
-    String completeResponse = incomingData.substring(0, promptPos);
-    completeResponse.trim();
-    
-    if (debugMode && completeResponse.length() > 0) {
-      Serial.println("✅ Complete response: '" + completeResponse + "'");
-    }
+  // Only the new bytes can hold the prompt
+  int promptPos = incomingData.indexOf('>', scanFrom);
+  
+  // A stream without a prompt (line noise, wrong baud on the adapter side)
+  // must not grow the buffer forever
+  if (incomingData.length() > OBD_MAX_RESPONSE_TEXT && promptPos == -1) {
+    if (debugMode) Serial.println("⚠️ Discarding " + String(incomingData.length()) + " bytes without prompt");
+    incomingData = "";
+    return;
+  }
+  
+  // Each '>' ends one reply; a late reply and the current one can arrive
+  // in the same chunk
+  while (promptPos != -1) {
+    // The response is everything before the >, trimmed in place
+    const char* text = incomingData.c_str();
+    unsigned int start = 0, end = promptPos;
+    while (start < end && isspace((unsigned char)text[start])) start++;
+    while (end > start && isspace((unsigned char)text[end - 1])) end--;
     
-    // Process the response
-    if (waitingForResponse && currentCommandIndex < commandQueue.size()) {
-      OBDCommand& cmd = commandQueue[currentCommandIndex];
-      cmd.rawResponse = completeResponse;
-      cmd.completed = true;
-      waitingForResponse = false;
-      
-      unsigned long responseTime = millis() - lastCommandTime;
-      
-      if (debugMode) {
-        Serial.println("🎯 Command completed in " + String(responseTime) + "ms");
-      }
-    }
+    dispatchReply(text + start, end - start);
     
-    // Clear the buffer
-    incomingData = "";
+    // Drop the reply (in place) and let the scheduler act on it right away
+    incomingData.remove(0, promptPos + 1);
+    promptPos = incomingData.indexOf('>');
+    lastCommandCheck = 0;
   }
 }
 
-void BLEOBDClient::handleTimeout() {
-  if (currentCommandIndex < commandQueue.size()) {
-    OBDCommand& cmd = commandQueue[currentCommandIndex];
-    Serial.println("⏰ Command timeout: " + cmd.command);
-    stats.failedCommands++;
-    waitingForResponse = false;
-    cmd.completed = true;
-    cmd.rawResponse = "TIMEOUT";
+// Hand one complete reply to the request in flight, or drop it when it
+// answers an earlier (timed-out) request
+void BLEOBDClient::dispatchReply(const char* text, unsigned int length) {
+  if (debugMode && length > 0) {
+    Serial.print("✅ Complete response: '");
+    Serial.write((const uint8_t*)text, length);
+    Serial.println("'");
   }
-}
-
-void BLEOBDClient::resetCommandQueue() {
-  commandQueue.clear();
-  currentCommandIndex = 0;
-  waitingForResponse = false;
-  incomingData = "";
-}
-
-void BLEOBDClient::updateConnectionState(ConnectionState newState) {
-  if (newState != connectionState) {
-    connectionState = newState;
-    lastStateChange = millis();
+  
+  if (lateReplies > 0 && (long)(millis() - lateDeadline) >= 0) lateReplies = 0;
+  
+  // A second reply for the same request: the held one was the late answer
+  if (heldLength > 0) {
+    heldLength = 0;
+    if (lateReplies > 0) lateReplies--;
+    droppedWhileWaiting = true;
+    stats.staleReplies++;
+  }
+  
+  // Adapter commands answer with text (the ATI banner, ...) and get no recovery
+  bool adapterCommand = setupInFlight ||
+                        (oneShotInFlight && isAdapterCommand(oneShotQueue[oneShotHead].command));
+  ResponseClass reply = classifyResponse(text, length, !adapterCommand);
+  if (!waitingForResponse || isStaleReply(reply, text, length)) {
+    if (!waitingForResponse && length == 0) return;
     
-    String stateNames[] = {"DISCONNECTED", "SCANNING", "CONNECTING", "INITIALIZING", "CONNECTED", "ERROR"};
+    // Status text has no echo: it is either the late answer or this
+    // request's own, which only the next reply (or its absence) tells
+    if (waitingForResponse && reply.status != STATUS_DATA && length <= sizeof(heldReply)) {
+      holdReply(text, length);
+      return;
+    }
+    
+    if (lateReplies > 0) lateReplies--;
+    if (waitingForResponse) droppedWhileWaiting = true;
+    stats.staleReplies++;
     if (debugMode) {
-      Serial.println("🔄 State: " + stateNames[newState]);
+      Serial.print("🗑️ Dropped stale reply: '");
+      Serial.write((const uint8_t*)text, length);
+      Serial.println("'");
     }
+    return;
   }
-}
-
-void BLEOBDClient::displayOBDData() {
-  if (!deviceConnected) return;
   
-  Serial.println("━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━");
-  Serial.println("🚗 OBD2 DATA UPDATE");
-  Serial.println("━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━");
-  Serial.println("🔄 RPM: " + String(obdData.rpm, 0) + " rpm");
-  Serial.println("🏃 Speed: " + String(obdData.speed, 0) + " km/h");
-  Serial.println("🌡️  Coolant: " + String(obdData.coolantTemp, 1) + "°C");
-  Serial.println("🛢️  Oil: " + String(obdData.oilTemp, 1) + "°C");
-  Serial.println("⛽ Fuel: " + String(obdData.fuelLevel, 1) + "%");
-  Serial.println("💨 Throttle: " + String(obdData.throttlePos, 1) + "%");
-  Serial.println("🔧 Load: " + String(obdData.engineLoad, 1) + "%");
-  Serial.println("🌬️  Airflow: " + String(obdData.airflowRate, 2) + " g/s");
-  
-  unsigned long dataAge = millis() - obdData.lastUpdate;
-  Serial.println("⏰ Data age: " + String(dataAge) + "ms");
-  Serial.println("━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━");
+  // Answered with its echo: the adapter works one request at a time, so
+  // nothing older can follow
+  if (reply.status == STATUS_DATA) lateReplies = 0;
+  
+  acceptReply(reply, adapterCommand, text, length);
 }
 
-void BLEOBDClient::displayStatistics() {
-  float successRate = getSuccessRate();
-  
-  Serial.println("📊 STATISTICS:");
-  Serial.println("   📨 Total Commands: " + String(stats.totalCommands));
-  Serial.println("   ✅ Successful: " + String(stats.successfulCommands));
-  Serial.println("   ❌ Failed: " + String(stats.failedCommands));
-  Serial.println("   📈 Success Rate: " + String(successRate, 1) + "%");
-  Serial.println("   ⚡ Avg Response: " + String(stats.averageResponseTime) + "ms");
+// The reply answers the request in flight: record its status and hand it on
+void BLEOBDClient::acceptReply(const ResponseClass& reply, bool adapterCommand, const char* text,
+                               unsigned int length) {
+  linkMonitor.replyComplete();
   
-  if (deviceConnected) {
-    unsigned long currentUptime = getUptime();
-    Serial.println("   ⏰ Current Uptime: " + String(currentUptime / 1000) + "s");
+  // Classified once; recovery is for OBD requests, not adapter commands
+  replyClass = reply;
+  statusCounts[replyClass.status]++;
+  if (!adapterCommand) {
+    applyRecovery(replyClass);
   }
   
-  Serial.println("   🔄 Reconnect Attempts: " + String(stats.reconnectAttempts));
-}
-
-void BLEOBDClient::printConnectionInfo() {
-  String stateNames[] = {"DISCONNECTED", "SCANNING", "CONNECTING", "INITIALIZING", "CONNECTED", "ERROR"};
-  Serial.println("📱 Connection Status: " + stateNames[connectionState]);
+  if (length > OBD_MAX_RESPONSE_TEXT) length = OBD_MAX_RESPONSE_TEXT;
   
-  if (connectionState == SCANNING) {
-    unsigned long scanDuration = millis() - scanStartTime;
-    Serial.println("🔍 Scanning for: " + deviceName + " (" + String(scanDuration/1000) + "s)");
+  // Process the response
+  if (setupInFlight) {
+    setupInFlight = false;
+    waitingForResponse = false;
+  } else if (oneShotInFlight) {
+    memcpy(responseText, text, length);
+    responseText[length] = '\0';
+    oneShotLength = length;
+    oneShotInFlight = false;
+    oneShotReady = true;
+    waitingForResponse = false;
+  } else if (currentCommandIndex < commandCount) {
+    OBDCommand& cmd = commandQueue[currentCommandIndex];
+    memcpy(responseText, text, length);
+    responseText[length] = '\0';
+    cmd.responseLength = length;
+    cmd.flags |= OBD_CMD_COMPLETED;
+    waitingForResponse = false;
+    
+    if (debugMode) {
+      Serial.print("🎯 Command completed in ");
+      Serial.print(millis() - lastCommandTime);
+      Serial.println("ms");
+    }
   }
 }
 
-void BLEOBDClient::printSystemInfo() {
-  Serial.println("🔧 System Information:");
-  Serial.println("   📋 ESP32 Chip: " + String(ESP.getChipModel()));
-  Serial.println("   🔢 Revision: " + String(ESP.getChipRevision()));
-  Serial.println("   💾 Free Heap: " + String(ESP.getFreeHeap()) + " bytes");
-  Serial.println("   ⏰ CPU Frequency: " + String(ESP.getCpuFreqMHz()) + " MHz");
-  Serial.println();
-}
-
-float BLEOBDClient::getSuccessRate() const {
-  if (stats.totalCommands == 0) return 0.0;
-  return (stats.successfulCommands * 100.0) / stats.totalCommands;
-}
-
-unsigned long BLEOBDClient::getUptime() const {
-  if (!deviceConnected) return 0;
-  return millis() - stats.lastConnectionTime;
-}
-
-// Static parsing functions
-bool BLEOBDClient::parseRPM(String response, float* value) {
-  if (response.length() < 8) return false;
-  
-  response.replace(" ", "");
-  if (!response.startsWith("410C")) return false;
+// Data must echo the mode/PID of the request in flight (or be its negative
+// response). Status text carries no echo: while a timed-out request may still
+// answer, it counts as stale here and dispatchReply() holds it.
+bool BLEOBDClient::isStaleReply(const ResponseClass& reply, const char* text, unsigned int length) {
+  bool lateExpected = lateReplies > 0;
+  uint32_t value = 0;
+  uint8_t mode = 0;
+  int pid = -1;
   
-  String hex_a = response.substring(4, 6);
-  String hex_b = response.substring(6, 8);
+  if (setupInFlight) {
+    return lateExpected && reply.status == STATUS_DATA;
+  } else if (oneShotInFlight) {
+    const char* command = oneShotQueue[oneShotHead].command;
+    if (isAdapterCommand(command)) return lateExpected && reply.status == STATUS_DATA;
+    if (!parseHexValue(command, 2, &value)) return false;
+    mode = (uint8_t)(value + 0x40);
+    if (strlen(command) >= 4 && parseHexValue(command + 2, 2, &value)) pid = (int)value;
+  } else if (currentCommandIndex < commandCount) {
+    const OBDCommand& cmd = commandQueue[currentCommandIndex];
+    if (cmd.responseMode == 0) return false;   // Custom text command, nothing to match
+    mode = cmd.responseMode;
+    pid = cmd.pid;
+  } else {
+    return false;
+  }
   
-  int a = strtol(hex_a.c_str(), NULL, 16);
-  int b = strtol(hex_b.c_str(), NULL, 16);
+  if (reply.status != STATUS_DATA) return lateExpected;
   
-  *value = ((a * 256) + b) / 4.0;
-  return true;
+  OBDResponse response;
+  parseOBDResponse(text, length, response);
+  return !response.answers(mode, pid);
 }
 
-bool BLEOBDClient::parseSpeed(String response, float* value) {
-  if (response.length() < 6) return false;
+// Keep a status reply that may be a late answer until the request's own reply
+// arrives (the held one was stale) or the settle time passes without one
+void BLEOBDClient::holdReply(const char* text, unsigned int length) {
+  memcpy(heldReply, text, length);
+  heldLength = length;
+  heldDeadline = millis() + max((unsigned long)OBD_LATE_REPLY_SETTLE, 2 * stats.averageResponseTime);
   
-  response.replace(" ", "");
-  if (!response.startsWith("410D")) return false;
+  // Decided before the request would time out
+  unsigned long timeoutAt = lastCommandTime + activeTimeout;
+  if ((long)(heldDeadline - timeoutAt) > 0) heldDeadline = timeoutAt;
   
-  String hex_val = response.substring(4, 6);
-  *value = strtol(hex_val.c_str(), NULL, 16);
-  return true;
+  if (debugMode) {
+    Serial.print("⏸️ Holding reply: '");
+    Serial.write((const uint8_t*)text, length);
+    Serial.println("'");
+  }
 }
 
-bool BLEOBDClient::parseTemperature(String response, float* value) {
-  if (response.length() < 6) return false;
+// Nothing followed the held reply: it was the answer to the request in flight
+void BLEOBDClient::releaseHeldReply() {
+  if (heldLength == 0 || (long)(millis() - heldDeadline) < 0) return;
   
-  response.replace(" ", "");
-  String pid = response.substring(2, 4);
+  unsigned int length = heldLength;
+  heldLength = 0;
+  bool adapterCommand = setupInFlight ||
+                        (oneShotInFlight && isAdapterCommand(oneShotQueue[oneShotHead].command));
+  acceptReply(classifyResponse(heldReply, length, !adapterCommand), adapterCommand, heldReply, length);
+}
+
+// Adapter reply status to recovery: overrun errors back off the poll rate
+// (clean replies shrink it again), bus errors re-run the adapter setup.
+// Retries are done by the scheduler for periodic commands.
+void BLEOBDClient::applyRecovery(const ResponseClass& reply) {
+  if (reply.status == STATUS_DATA) {
+    if (pollBackoff > 0) pollBackoff -= min(pollBackoff, pollBackoff / 16 + 1);
+    return;
+  }
+  if (reply.recovery == RECOVER_NONE) return;
   
-  if (pid != "05" && pid != "5C") return false;
+  stats.adapterErrors++;
+  if (debugMode) {
+    Serial.print("⚠️ Adapter: ");
+    Serial.println(adapterStatusName(reply.status));
+  }
   
-  String hex_val = response.substring(4, 6);
-  *value = strtol(hex_val.c_str(), NULL, 16) - 40;
-  return true;
+  if (reply.recovery & RECOVER_SLOW_DOWN) {
+    pollBackoff = pollBackoff ? min(pollBackoff * 2, (uint32_t)OBD_MAX_POLL_BACKOFF) : OBD_MIN_POLL_BACKOFF;
+    if (debugMode) {
+      Serial.print("🐢 Poll spacing ");
+      Serial.print(pollBackoff);
+      Serial.println("ms");
+    }
+  }
+  if (reply.recovery & RECOVER_REINIT) {
+    queueAdapterReinit();
+  }
 }
 
-bool BLEOBDClient::parsePercentage(String response, float* value) {
-  if (response.length() < 6) return false;
+// Restore the settings of initializeOBD() without ATZ and restart the
+// protocol search (the adapter may have reset itself or lost the bus)
+void BLEOBDClient::queueAdapterReinit() {
+  if (lastReinit != 0 && millis() - lastReinit < OBD_REINIT_HOLDOFF) return;
+  lastReinit = millis();
+  if (lastReinit == 0) lastReinit = 1;
+  stats.adapterReinits++;
   
-  response.replace(" ", "");
-  String hex_val = response.substring(4, 6);
-  *value = (strtol(hex_val.c_str(), NULL, 16) * 100.0) / 255.0;
-  return true;
+  Serial.println("🔧 Re-initializing adapter");
+  queueSetup("ATE0");
+  queueSetup("ATL0");
+  queueSetup("ATS0");
+  queueSetup("ATH1");
+  queueSetup("ATSP0");
+  activeHeader = 0;
+  if (targetRequestHeader) {
+    queueECUFilter();
+  } else {
+    queueHeader(functionalHeader());
+  }
+  queueTimingSetup();
 }
 
-bool BLEOBDClient::parseAirflow(String response, float* value) {
-  if (response.length() < 8) return false;
-  
-  response.replace(" ", "");
-  if (!response.startsWith("4110")) return false;
+void BLEOBDClient::handleTimeout() {
+  linkMonitor.timedOut();
   
-  String hex_a = response.substring(4, 6);
-  String hex_b = response.substring(6, 8);
+  // Its answer may still come; unless a reply was already dropped as late
+  // during this request (that was most likely its own answer)
+  if (!droppedWhileWaiting && lateReplies < OBD_MAX_LATE_REPLIES) lateReplies++;
+  lateDeadline = millis() + OBD_LATE_REPLY_WINDOW;
   
-  int a = strtol(hex_a.c_str(), NULL, 16);
-  int b = strtol(hex_b.c_str(), NULL, 16);
+  if (setupInFlight) {
+    Serial.println("⏰ Setup command timeout");
+    setupInFlight = false;
+    waitingForResponse = false;
+    return;
+  }
+  
+  if (oneShotInFlight) {
+    Serial.print("⏰ Command timeout: ");
+    Serial.println(oneShotQueue[oneShotHead].command);
+    oneShotLength = 0;
+    oneShotTimedOut = true;
+    oneShotInFlight = false;
+    oneShotReady = true;
+    waitingForResponse = false;
+    return;
+  }
+  
+  if (currentCommandIndex < commandCount) {
+    OBDCommand& cmd = commandQueue[currentCommandIndex];
+    Serial.print("⏰ Command timeout: ");
+    Serial.println(cmd.request);
+    stats.failedCommands++;
+    waitingForResponse = false;
+    cmd.flags |= OBD_CMD_COMPLETED;
+    cmd.responseLength = 0;
+  }
+}
+
+void BLEOBDClient::resetCommandQueue() {
+  commandCount = 0;
+  setupCount = 0;
+  setupInFlight = false;
+  // Queued one-shots survive a reconnect; the one in flight is re-sent
+  oneShotInFlight = false;
+  // ...except the adapter and voltage reads initializeOBD() queues again,
+  // which would otherwise run twice and answer their callbacks twice
+  uint8_t kept = 0;
+  for (uint8_t i = 0; i < oneShotCount; i++) {
+    const OneShotRequest& req = oneShotQueue[(oneShotHead + i) % OBD_MAX_ONESHOTS];
+    if (req.context == this && (req.callback == onIdentifyResponse ||
+                                req.callback == onVoltageSupport ||
+                                req.callback == onVoltageResponse)) {
+      continue;
+    }
+    if (kept != i) oneShotQueue[(oneShotHead + kept) % OBD_MAX_ONESHOTS] = req;
+    kept++;
+  }
+  oneShotCount = kept;
+  oneShotReady = false;
+  periodicSinceOneShot = true;
+  currentCommandIndex = 0;
+  waitingForResponse = false;
+  pollRetried = false;
+  pollBackoff = 0;
+  lateReplies = 0;
+  heldLength = 0;
+  incomingData = "";
+  activeHeader = 0;  // ATZ restores the default header
+  monitorState = MONITOR_OFF;
+}
+
+// Split the raw adapter text into per-ECU messages and return the message
+// this command's value should be taken from
+const OBDMessage* BLEOBDClient::routeResponse(OBDCommand& cmd, OBDResponse& response) {
+  cmd.respondingECUs = 0;
+  if (!parseOBDResponse(responseText, cmd.responseLength, response)) {
+    return nullptr;
+  }
+  
+  for (uint8_t i = 0; i < response.messageCount; i++) {
+    const OBDMessage& msg = response.messages[i];
+    if (msg.ecuId != 0) recordECU(msg.ecuId);
+    if (msg.length > 0 && msg.data[0] == cmd.responseMode) cmd.respondingECUs++;
+  }
+  
+  if (verboseLogging && response.messageCount > 1) {
+    Serial.println("🧩 " + String(response.messageCount) + " ECUs answered " + String(cmd.request));
+  }
+  
+  return cmd.ecuId ? response.fromECU(cmd.ecuId) : response.primary(cmd.responseMode, cmd.pid);
+}
+
+bool BLEOBDClient::decodeCommand(uint8_t slot, const OBDMessage* msg) {
+  if (!msg) return false;
+  
+  const OBDCommandBinding& binding = commandBindings[slot];
+  if (commandQueue[slot].flags & OBD_CMD_DESCRIPTOR) {
+    return decodePIDValue(binding.descriptor, *msg, binding.target);
+  }
+  
+  // Custom string parsers see the selected ECU's payload as hex, headers stripped
+  static const char hexDigits[] = "0123456789ABCDEF";
+  char payload[OBD_MAX_PAYLOAD * 2 + 1];
+  for (uint8_t i = 0; i < msg->length; i++) {
+    payload[i * 2] = hexDigits[msg->data[i] >> 4];
+    payload[i * 2 + 1] = hexDigits[msg->data[i] & 0x0F];
+  }
+  payload[msg->length * 2] = '\0';
+  return binding.parser(payload, msg->length * 2, binding.target);
+}
+
+void BLEOBDClient::recordECU(uint32_t id) {
+  for (uint8_t i = 0; i < ecuCount; i++) {
+    if (ecuTable[i].id == id) {
+      ecuTable[i].responses++;
+      ecuTable[i].lastSeen = millis();
+      return;
+    }
+  }
+  
+  if (ecuCount < OBD_MAX_ECUS) {
+    ecuTable[ecuCount].id = id;
+    ecuTable[ecuCount].responses = 1;
+    ecuTable[ecuCount].lastSeen = millis();
+    ecuCount++;
+    
+    if (debugMode) {
+      Serial.println("🧩 New ECU detected: " + String(id, HEX));
+    }
+  }
+}
+
+// OBDData field holding a signal (nullptr for engineRunning, a bool)
+float* BLEOBDClient::signalField(OBDSignal signal) {
+  float* fields[SIGNAL_COUNT] = {
+    &obdData.rpm, &obdData.speed, &obdData.coolantTemp, &obdData.oilTemp,
+    &obdData.fuelLevel, &obdData.throttlePos, &obdData.engineLoad,
+    &obdData.airflowRate, &obdData.boostPressure, &obdData.voltage,
+    &obdData.manifoldPressure, &obdData.baroPressure, &obdData.fuelRate,
+    &obdData.fuelEconomy, &obdData.avgFuelEconomy, &obdData.tripDistance,
+    nullptr
+  };
+  return signal < SIGNAL_COUNT ? fields[signal] : nullptr;
+}
+
+// OBDData field a command writes to, as a subscribable signal
+int8_t BLEOBDClient::signalForTarget(const float* target) {
+  for (uint8_t i = 0; i < SIGNAL_COUNT; i++) {
+    if (target && signalField((OBDSignal)i) == target) return i;
+  }
+  return -1;
+}
+
+void BLEOBDClient::publishSignal(OBDSignal signal, float value, unsigned long requestTime) {
+  freshness.sampled(signal, requestTime, millis());
+  derived.set(signal, value);
+  emitSignal(signal, value);
+}
+
+// Hand a new value to subscribers and the telemetry stream
+void BLEOBDClient::emitSignal(OBDSignal signal, float value) {
+  subscriptions.publish(signal, value, millis());
+  if (telemetryOut) {
+    telemetry.record(signal, value);
+    telemetryMask |= SIGNAL_BIT(signal);
+  }
+}
+
+void BLEOBDClient::startTelemetry(Print& out) {
+  OBDLockGuard guard(stateLock);
+  telemetry.reset();
+  telemetryMask = 0;
+  telemetryOut = &out;
+}
+
+void BLEOBDClient::stopTelemetry() {
+  OBDLockGuard guard(stateLock);
+  telemetryOut = nullptr;
+}
+
+// One frame per service pass with every signal updated during it
+void BLEOBDClient::flushTelemetry() {
+  uint8_t frame[TELEMETRY_MAX_FRAME];
+  size_t length = telemetry.encode(millis(), frame, sizeof(frame));
+  if (length == 0) return;
+  telemetryOut->write(frame, length);
+  freshness.consumed(telemetryConsumer, telemetryMask, millis());
+  telemetryMask = 0;
+}
+
+// Recompute derived signals whose inputs were updated since the last pass
+void BLEOBDClient::updateDerivedSignals() {
+  uint32_t now = millis();
+  uint32_t changed = derived.update(now);
+  while (changed) {
+    OBDSignal signal = (OBDSignal)__builtin_ctz(changed);
+    changed &= changed - 1;
+    
+    freshness.derived(signal, derived.getInputs(signal), now);
+    float value = derived.get(signal);
+    if (float* field = signalField(signal)) {
+      *field = value;
+    } else if (signal == SIGNAL_ENGINE_RUNNING) {
+      obdData.engineRunning = value > 0.5f;
+    }
+    emitSignal(signal, value);
+  }
+}
+
+void BLEOBDClient::getSignalValues(float* values) {
+  OBDLockGuard guard(stateLock);
+  for (uint8_t i = 0; i < SIGNAL_COUNT; i++) {
+    float* field = signalField((OBDSignal)i);
+    values[i] = field ? *field : 0.0f;
+  }
+  values[SIGNAL_ENGINE_RUNNING] = obdData.engineRunning ? 1.0f : 0.0f;
+}
+
+size_t BLEOBDClient::serialize(const SnapshotSerializer& serializer, char* out, size_t outSize,
+                               int consumer) {
+  float values[SIGNAL_COUNT];
+  getSignalValues(values);
+  if (consumer >= 0) markConsumed(consumer);
+  return serializer.write(values, out, outSize);
+}
+
+OBDData BLEOBDClient::getCurrentData(int consumer) {
+  OBDLockGuard guard(stateLock);
+  freshness.consumed(consumer, FRESHNESS_ALL_SIGNALS, millis());
+  return obdData;
+}
+
+void BLEOBDClient::markConsumed(int consumer, uint32_t signalMask) {
+  OBDLockGuard guard(stateLock);
+  freshness.consumed(consumer, signalMask, millis());
+}
+
+void BLEOBDClient::resetTrip() {
+  OBDLockGuard guard(stateLock);
+  trip.reset();
+  obdData.tripDistance = 0.0f;
+  obdData.avgFuelEconomy = 0.0f;
+}
+
+// Response time statistics after a decoded periodic reply
+void BLEOBDClient::updateResponseStats(unsigned long responseTime) {
+  if (stats.averageResponseTime == 0) {
+    stats.averageResponseTime = responseTime;
+  } else {
+    stats.averageResponseTime = (stats.averageResponseTime + responseTime) / 2;
+  }
+}
+
+// Move currentCommandIndex to the next command whose poll interval has
+// elapsed; false when every command is waiting for its interval
+bool BLEOBDClient::selectDueCommand() {
+  unsigned long now = millis();
+  for (uint8_t n = 0; n < commandCount; n++) {
+    if (currentCommandIndex >= commandCount) currentCommandIndex = 0;
+    const OBDCommand& cmd = commandQueue[currentCommandIndex];
+    if (cmd.interval == 0 || cmd.lastPolled == 0 || now - cmd.lastPolled >= cmd.interval) {
+      return true;
+    }
+    currentCommandIndex++;
+  }
+  return false;
+}
+
+int BLEOBDClient::subscribe(OBDSignal signal, SignalCallback callback, void* context,
+                            float deadband, unsigned long minIntervalMs) {
+  OBDLockGuard guard(stateLock);
+  return subscriptions.subscribe(signal, callback, context, deadband, minIntervalMs);
+}
+
+void BLEOBDClient::unsubscribe(int handle) {
+  OBDLockGuard guard(stateLock);
+  subscriptions.unsubscribe(handle);
+}
+
+// Address requests to one ECU (ATSH) and only accept its replies (ATCRA).
+// The adapter then stops waiting for other ECUs after each request.
+void BLEOBDClient::setTargetECU(uint32_t requestHeader, uint32_t responseId) {
+  OBDLockGuard guard(stateLock);
+  targetRequestHeader = requestHeader;
+  targetResponseId = responseId;
+  resetResponseCounts();
+  queueECUFilter();
+}
+
+void BLEOBDClient::clearTargetECU() {
+  OBDLockGuard guard(stateLock);
+  targetRequestHeader = 0;
+  targetResponseId = 0;
+  resetResponseCounts();
+  if (deviceConnected) {
+    queueSetup("ATCRA");     // Accept all receive addresses
+    queueHeader(functionalHeader());
+  }
+}
+
+bool BLEOBDClient::submitRequest(const char* command, OneShotCallback callback, void* context,
+                                 unsigned long timeoutMs) {
+  OBDLockGuard guard(stateLock);
+  if (oneShotCount >= OBD_MAX_ONESHOTS || strlen(command) >= sizeof(OneShotRequest::command)) {
+    return false;
+  }
+  
+  OneShotRequest& req = oneShotQueue[(oneShotHead + oneShotCount) % OBD_MAX_ONESHOTS];
+  strcpy(req.command, command);
+  req.callback = callback;
+  req.context = context;
+  req.timeout = timeoutMs > 0 ? timeoutMs : defaultTimeout;
+  req.submitTime = millis();
+  oneShotCount++;
+  pollerWake.notify();
+  return true;
+}
+
+bool BLEOBDClient::requestFreezeFrame(uint8_t pid, OneShotCallback callback, void* context,
+                                      uint8_t frame) {
+  char cmd[8];
+  snprintf(cmd, sizeof(cmd), "02%02X%02X", pid, frame);
+  return submitRequest(cmd, callback, context);
+}
+
+bool BLEOBDClient::requestVehicleInfo(uint8_t infoType, OneShotCallback callback, void* context) {
+  char cmd[8];
+  snprintf(cmd, sizeof(cmd), "09%02X", infoType);
+  return submitRequest(cmd, callback, context);
+}
+
+bool BLEOBDClient::addMonitorFilter(uint32_t id, uint32_t mask) {
+  OBDLockGuard guard(stateLock);
+  if (monitorFilterCount >= OBD_MAX_MONITOR_FILTERS) return false;
+  monitorFilterIds[monitorFilterCount] = id;
+  monitorFilterMasks[monitorFilterCount] = mask;
+  monitorFilterCount++;
+  return true;
+}
+
+bool BLEOBDClient::startMonitor() {
+  OBDLockGuard guard(stateLock);
+  if (!deviceConnected || connectionState != CONNECTED || monitorState != MONITOR_OFF) return false;
+  
+  queueSetup("ATCAF0");  // Raw frames: no ISO-TP formatting
+  queueMonitorFilters();
+  monitorState = MONITOR_STARTING;
+  
+  Serial.println("📡 Starting CAN monitor (" + String(monitorFilterCount) + " filters)");
+  return true;
+}
+
+void BLEOBDClient::stopMonitor() {
+  OBDLockGuard guard(stateLock);
+  if (monitorState == MONITOR_STARTING) {
+    monitorState = MONITOR_OFF;
+    queueSetup("ATCAF1");
+  } else if (monitorState == MONITOR_ACTIVE) {
+    monitorState = MONITOR_STOPPING;
+    monitorStopTime = millis();
+    sendCommand("");  // Any character stops ATMA
+  }
+}
+
+void BLEOBDClient::queueMonitorFilters() {
+  if (monitorFilterCount == 0) return;
+  
+  char buf[32];
+  if (adapterIsSTN) {
+    // STN: real pass-filter list
+    queueSetup("STFCP");
+    for (uint8_t i = 0; i < monitorFilterCount; i++) {
+      snprintf(buf, sizeof(buf), monitorFilterIds[i] > 0x7FF ? "STFAP%08X,%08X" : "STFAP%03X,%03X",
+               (unsigned)monitorFilterIds[i], (unsigned)monitorFilterMasks[i]);
+      queueSetup(buf);
+    }
+    return;
+  }
+  
+  // ELM327 has a single filter/mask pair: merge all filters into one that
+  // passes every requested id (and possibly a few more)
+  uint32_t mask = monitorFilterMasks[0];
+  uint32_t id = monitorFilterIds[0];
+  for (uint8_t i = 1; i < monitorFilterCount; i++) {
+    mask &= monitorFilterMasks[i] & ~(id ^ monitorFilterIds[i]);
+  }
+  id &= mask;
+  
+  bool extended = id > 0x7FF || mask > 0x7FF;
+  snprintf(buf, sizeof(buf), extended ? "ATCF%08X" : "ATCF%03X", (unsigned)id);
+  queueSetup(buf);
+  snprintf(buf, sizeof(buf), extended ? "ATCM%08X" : "ATCM%03X", (unsigned)mask);
+  queueSetup(buf);
+}
+
+// BLE callback context: bytes go straight from the notification into the ring
+void BLEOBDClient::handleMonitorData(const uint8_t* data, size_t length) {
+  if (monitorParser.feed(data, length, millis(), frameRing)) {
+    monitorPromptSeen = true;
+  }
+}
+
+void BLEOBDClient::processMonitorFrames() {
+  const uint16_t MAX_FRAMES_PER_PASS = 128;
+  
+  if (monitorPromptSeen) {
+    monitorPromptSeen = false;
+    if (monitorState == MONITOR_STOPPING) {
+      monitorState = MONITOR_OFF;
+      queueSetup("ATCAF1");
+      Serial.println("📡 CAN monitor stopped");
+    } else if (monitorState == MONITOR_ACTIVE) {
+      // Adapter gave up on its own (BUFFER FULL): resume streaming
+      monitorRestarts++;
+      sendCommand(adapterIsSTN ? "STMA" : "ATMA");
+    }
+  } else if (monitorState == MONITOR_STOPPING && millis() - monitorStopTime > defaultTimeout) {
+    monitorState = MONITOR_OFF;
+    queueSetup("ATCAF1");
+  }
+  
+  CANFrame frame;
+  uint16_t processed = 0;
+  while (processed < MAX_FRAMES_PER_PASS && frameRing.pop(frame)) {
+    processed++;
+    monitorFrameTime = frame.timestamp;
+    signalDB.decodeFrame(frame, onCANSignal, this);
+    if (frameCallback) frameCallback(frame, frameCallbackContext);
+  }
+  
+  if (processed > 0) obdData.lastUpdate = millis();
+}
+
+bool BLEOBDClient::bindCANSignal(uint8_t index, OBDSignal signal) {
+  OBDLockGuard guard(stateLock);
+  if (index >= CAN_MAX_SIGNALS || signal >= SIGNAL_COUNT) return false;
+  canSignalBindings[index] = signal;
+  return true;
+}
+
+// A decoded broadcast signal takes the same path as a polled value, its
+// capture time standing in for the request time
+void BLEOBDClient::onCANSignal(uint8_t index, float value, void* context) {
+  BLEOBDClient* client = static_cast<BLEOBDClient*>(context);
+  if (index >= CAN_MAX_SIGNALS || client->canSignalBindings[index] >= SIGNAL_COUNT) return;
+  
+  OBDSignal signal = (OBDSignal)client->canSignalBindings[index];
+  float* field = client->signalField(signal);
+  if (field) *field = value;
+  client->publishSignal(signal, value, client->monitorFrameTime);
+}
+
+// Request text for a periodic command on the detected adapter, written
+// into out (at least 64 bytes); returns its length
+size_t BLEOBDClient::buildPollRequest(uint8_t slot, char* out, size_t outSize) {
+  const OBDCommand& cmd = commandQueue[slot];
+  bool countKnown = useResponseCount && cmd.expectedResponses > 0;
+  
+  if (adapterIsSTN) {
+    // STPX: header, data, response count and timeout in one request
+    uint32_t header = (cmd.flags & OBD_CMD_DESCRIPTOR) ? commandBindings[slot].descriptor.header : 0;
+    int len = snprintf(out, outSize, "STPX ");
+    if (header) {
+      len += snprintf(out + len, outSize - len, header > 0xFFF ? "H:%08X, " : "H:%03X, ",
+                      (unsigned)header);
+    }
+    len += snprintf(out + len, outSize - len, "D:%s", cmd.request);
+    if (countKnown) {
+      len += snprintf(out + len, outSize - len, ", R:%u", cmd.expectedResponses);
+    }
+    unsigned long ecuTimeout = adapterTimeoutValue ? adapterTimeoutValue * 4UL : 200UL;
+    len += snprintf(out + len, outSize - len, ", T:%lu", ecuTimeout);
+    return (size_t)len < outSize ? len : outSize - 1;
+  }
+  
+  memcpy(out, cmd.request, cmd.requestLength + 1);
+  if (countKnown) {
+    // e.g. "010C1": adapter returns as soon as that many ECUs answered
+    out[cmd.requestLength] = "0123456789ABCDEF"[cmd.expectedResponses];
+    out[cmd.requestLength + 1] = '\0';
+    return cmd.requestLength + 1;
+  }
+  return cmd.requestLength;
+}
+
+void BLEOBDClient::onIdentifyResponse(const OneShotResult& result, void* context) {
+  static_cast<BLEOBDClient*>(context)->handleIdentification(result);
+}
+
+// ATI answers on every adapter; STI only on STN chips ("?" on ELM327 clones)
+void BLEOBDClient::handleIdentification(const OneShotResult& result) {
+  bool isSTI = strcmp(result.command, "STI") == 0;
+  
+  if (!isSTI) {
+    if (result.status == ONESHOT_OK) {
+      strncpy(adapterVersion, result.text, sizeof(adapterVersion) - 1);
+      adapterVersion[sizeof(adapterVersion) - 1] = '\0';
+    }
+    adapterType = ADAPTER_ELM327;
+    submitRequest("STI", onIdentifyResponse, this);
+    return;
+  }
+  
+  if (result.status != ONESHOT_OK || strncmp(result.text, "STN", 3) != 0) {
+    if (debugMode) {
+      Serial.println("🔌 Adapter: " + String(adapterVersion));
+    }
+    return;
+  }
+  
+  adapterType = ADAPTER_STN;
+  strncpy(adapterVersion, result.text, sizeof(adapterVersion) - 1);
+  adapterVersion[sizeof(adapterVersion) - 1] = '\0';
+  Serial.println("🔌 Adapter: " + String(adapterVersion) + " (STN extensions " +
+                 (allowSTNExtensions ? "on" : "off") + ")");
+  
+  if (!allowSTNExtensions) return;
+  
+  adapterIsSTN = true;
+  queueSetup("STCSEGT1");  // Segment long requests (multi-DID, > 7 bytes)
+  
+  // Requests now carry their own header: return to the default one
+  if (activeHeader != 0) {
+    activeHeader = 0;
+    if (targetRequestHeader) {
+      queueHeader(targetRequestHeader);
+    } else {
+      queueHeader(functionalHeader());
+    }
+  }
+}
+
+// Decode the head one-shot's response and hand it to its callback
+void BLEOBDClient::completeOneShot(bool timedOut) {
+  if (oneShotCount == 0) return;
+  
+  OneShotRequest req = oneShotQueue[oneShotHead];
+  oneShotHead = (oneShotHead + 1) % OBD_MAX_ONESHOTS;
+  oneShotCount--;
+  
+  OBDResponse response;
+  OneShotResult result;
+  result.command = req.command;
+  responseText[oneShotLength] = '\0';
+  result.text = timedOut ? "TIMEOUT" : responseText;
+  result.response = &response;
+  result.message = nullptr;
+  result.latency = millis() - req.submitTime;
+  
+  bool hasData = !timedOut && parseOBDResponse(responseText, oneShotLength, response);
+  
+  uint32_t mode = 0, pid = 0;
+  result.adapterStatus = timedOut ? STATUS_EMPTY : replyClass.status;
+  
+  if (timedOut) {
+    result.status = ONESHOT_TIMEOUT;
+  } else if (isAdapterCommand(req.command) || !parseHexValue(req.command, 2, &mode)) {
+    result.status = (oneShotLength > 0 && replyClass.status != STATUS_UNKNOWN_COMMAND) ? ONESHOT_OK : ONESHOT_NO_DATA;
+  } else {
+    int expectedPid = (strlen(req.command) >= 4 && parseHexValue(req.command + 2, 2, &pid)) ? (int)pid : -1;
+    result.message = hasData ? response.primary(mode + 0x40, expectedPid) : nullptr;
+    if (result.message) {
+      result.status = ONESHOT_OK;
+    } else if (hasData && response.primary(0x7F)) {
+      result.status = ONESHOT_NEGATIVE;
+    } else {
+      result.status = ONESHOT_NO_DATA;
+    }
+  }
+  
+  if (verboseLogging) {
+    Serial.println("📬 One-shot " + String(req.command) + " done in " + String(result.latency) + "ms");
+  }
+  
+  if (req.callback) req.callback(result, req.context);
+}
+
+size_t BLEOBDClient::decodeVehicleInfoText(const OBDMessage* msg, char* out, size_t outSize) {
+  size_t len = 0;
+  if (!msg || outSize == 0) return 0;
+  
+  // CAN: 49 <type> <count> <data...>; legacy lines: 49 <type> <seq> <4 bytes>
+  bool legacy = msg->headerType == OBD_HEADER_LEGACY;
+  if (msg->headerType == OBD_HEADER_NONE) {
+    // Headers off: legacy lines each repeat 49 <type> with the next sequence number
+    legacy = msg->length > 7 && msg->length % 7 == 0;
+    for (uint8_t line = 0; legacy && line < msg->length; line += 7) {
+      legacy = msg->data[line] == msg->data[0] && msg->data[line + 1] == msg->data[1] &&
+               msg->data[line + 2] == line / 7 + 1;
+    }
+  }
+  for (uint8_t i = 3; i < msg->length && len + 1 < outSize; i++) {
+    if (legacy && i % 7 < 3) continue;
+    uint8_t c = msg->data[i];
+    if (c >= 0x20 && c < 0x7F) out[len++] = (char)c; // Skip padding and separators
+  }
+  out[len] = '\0';
+  return len;
+}
+
+void BLEOBDClient::readDTCs() {
+  OBDLockGuard guard(stateLock);
+  if (dtcStep >= 0) return; // Cycle already running
+  
+  dtcPendingReport = DTCReport();
+  dtcStep = DTC_STORED;
+  if (!submitRequest(dtcRequest(DTC_STORED), onDTCResponse, this)) {
+    dtcStep = -1;
+    lastDTCRead = millis(); // Queue full, try again next interval
+  }
+}
+
+void BLEOBDClient::clearDTCs() {
+  OBDLockGuard guard(stateLock);
+  submitRequest("04", onDTCClearResponse, this);
+}
+
+void BLEOBDClient::onDTCResponse(const OneShotResult& result, void* context) {
+  static_cast<BLEOBDClient*>(context)->handleDTCResponse(result);
+}
+
+void BLEOBDClient::onDTCClearResponse(const OneShotResult& result, void* context) {
+  BLEOBDClient* client = static_cast<BLEOBDClient*>(context);
+  if (result.status == ONESHOT_OK) {
+    Serial.println("🧹 DTCs cleared");
+    client->readDTCs(); // Confirm with a fresh read
+  } else {
+    Serial.println("❌ DTC clear failed: " + String(result.text));
+  }
+}
+
+void BLEOBDClient::handleDTCResponse(const OneShotResult& result) {
+  if (dtcStep < 0) return;
+  
+  if (result.status == ONESHOT_TIMEOUT) {
+    // Abandon this cycle rather than reporting a partial picture
+    dtcStep = -1;
+    lastDTCRead = millis();
+    return;
+  }
+  
+  // "NO DATA" or a negative response simply means no codes of this kind
+  if (result.status == ONESHOT_OK) {
+    decodeDTCs(*result.response, (DTCKind)dtcStep, dtcPendingReport.sets[dtcStep]);
+  }
+  
+  dtcStep++;
+  if (dtcStep < DTC_KIND_COUNT) {
+    if (!submitRequest(dtcRequest((DTCKind)dtcStep), onDTCResponse, this)) {
+      dtcStep = -1;
+      lastDTCRead = millis();
+    }
+    return;
+  }
   
-  *value = ((a * 256) + b) / 100.0;
+  // Full cycle done: publish
+  dtcStep = -1;
+  lastDTCRead = millis();
+  dtcPendingReport.lastRead = lastDTCRead;
+  
+  bool changed = false;
+  for (uint8_t k = 0; k < DTC_KIND_COUNT; k++) {
+    if (dtcPendingReport.sets[k] != dtcReport.sets[k]) changed = true;
+  }
+  
+  dtcReport = dtcPendingReport;
+  obdData.dtcCount = dtcReport.stored().count;
+  
+  if (changed) {
+    if (debugMode) {
+      Serial.println("⚠️  DTCs: " + String(dtcReport.stored().count) + " stored, " +
+                     String(dtcReport.pending().count) + " pending, " +
+                     String(dtcReport.permanent().count) + " permanent");
+    }
+    if (dtcCallback) dtcCallback(dtcReport);
+  }
+}
+
+void BLEOBDClient::onVoltageSupport(const OneShotResult& result, void* context) {
+  static_cast<BLEOBDClient*>(context)->handleVoltageSupport(result);
+}
+
+void BLEOBDClient::onVoltageResponse(const OneShotResult& result, void* context) {
+  static_cast<BLEOBDClient*>(context)->handleVoltageResponse(result);
+}
+
+void BLEOBDClient::handleVoltageSupport(const OneShotResult& result) {
+  // 4140 AABBCCDD: bit 7 of A is PID 41, bit 6 is PID 42
+  bool supported = result.status == ONESHOT_OK && result.message &&
+                   result.message->length >= 3 && (result.message->data[2] & 0x40);
+  voltageSource = supported ? VOLTAGE_PID : VOLTAGE_ADAPTER;
+  lastVoltageRead = 0;
+  
+  if (debugMode) {
+    Serial.println(supported ? "🔋 Voltage from PID 0142" : "🔋 Voltage from adapter (ATRV)");
+  }
+}
+
+void BLEOBDClient::readVoltage() {
+  const char* request = voltageSource == VOLTAGE_PID ? "0142" : "ATRV";
+  lastVoltageRead = millis();
+  voltageInFlight = submitRequest(request, onVoltageResponse, this);
+}
+
+void BLEOBDClient::handleVoltageResponse(const OneShotResult& result) {
+  voltageInFlight = false;
+  
+  float volts = 0.0f;
+  bool ok = false;
+  if (result.status == ONESHOT_OK) {
+    if (voltageSource == VOLTAGE_PID) {
+      ok = decodePIDValue(standardPID(0x42, 2, 0.001f), *result.message, &volts);
+    } else {
+      ok = parseVoltage(result.text, strlen(result.text), &volts);
+    }
+  }
+  
+  if (!ok) {
+    // ECU stopped answering 0142 (e.g. ignition off): use the adapter instead
+    if (voltageSource == VOLTAGE_PID && ++voltageFailures >= 3) {
+      voltageSource = VOLTAGE_ADAPTER;
+      voltageFailures = 0;
+      if (debugMode) Serial.println("🔋 PID 0142 not answering, switching to ATRV");
+    }
+    return;
+  }
+  
+  voltageFailures = 0;
+  updateVoltage(volts);
+}
+
+// Exponential smoothing plus low-voltage events with hysteresis
+void BLEOBDClient::updateVoltage(float volts) {
+  const float SMOOTHING = 0.3f;
+  const float HYSTERESIS = 0.3f;
+  
+  obdData.voltage = voltageSeen ? obdData.voltage + SMOOTHING * (volts - obdData.voltage) : volts;
+  voltageSeen = true;
+  publishSignal(SIGNAL_VOLTAGE, obdData.voltage, lastCommandTime); // One-shot send time
+  
+  bool low = voltageLow ? obdData.voltage < lowVoltageThreshold + HYSTERESIS
+                        : obdData.voltage < lowVoltageThreshold;
+  if (low != voltageLow) {
+    voltageLow = low;
+    Serial.println(low ? "🪫 Low voltage: " + String(obdData.voltage, 2) + "V"
+                       : "🔋 Voltage recovered: " + String(obdData.voltage, 2) + "V");
+    if (voltageCallback) voltageCallback(obdData.voltage, low, voltageCallbackContext);
+  }
+}
+
+// Learn how many ECUs answer a request over the first few polls. Only used on
+// CAN, where the ELM327 otherwise waits its full timeout for more replies.
+void BLEOBDClient::learnResponseCount(OBDCommand& cmd) {
+  const uint8_t DISCOVERY_POLLS = 3;
+  
+  if (cmd.expectedResponses > 0 || cmd.respondingECUs == 0) return;
+  
+  bool isCAN = false;
+  for (uint8_t i = 0; i < ecuCount; i++) {
+    if (ecuTable[i].id > 0xFF) isCAN = true;
+  }
+  if (!isCAN) return;
+  
+  if (cmd.respondingECUs > cmd.discoveredECUs) {
+    cmd.discoveredECUs = cmd.respondingECUs;
+  }
+  cmd.discoveryPolls++;
+  
+  if (cmd.discoveryPolls >= DISCOVERY_POLLS) {
+    cmd.expectedResponses = cmd.discoveredECUs > 0x0F ? 0x0F : cmd.discoveredECUs;
+    if (debugMode) {
+      Serial.print("📐 ");
+      Serial.print(cmd.request);
+      Serial.print(" answered by ");
+      Serial.print(cmd.expectedResponses);
+      Serial.println(" ECU(s)");
+    }
+  }
+}
+
+// A different responder set answers from now on: learn every count again
+void BLEOBDClient::resetResponseCounts() {
+  for (uint8_t i = 0; i < commandCount; i++) {
+    commandQueue[i].expectedResponses = 0;
+    commandQueue[i].discoveryPolls = 0;
+    commandQueue[i].discoveredECUs = 0;
+  }
+}
+
+void BLEOBDClient::setAdaptiveTiming(uint8_t mode) {
+  OBDLockGuard guard(stateLock);
+  adaptiveTimingMode = mode > 2 ? 2 : mode;
+  queueTimingSetup();
+}
+
+void BLEOBDClient::setAdapterTimeout(unsigned long timeoutMs) {
+  OBDLockGuard guard(stateLock);
+  unsigned long value = timeoutMs / 4;
+  adapterTimeoutValue = value > 0xFF ? 0xFF : (uint8_t)value;
+  queueTimingSetup();
+}
+
+void BLEOBDClient::queueTimingSetup() {
+  if (!deviceConnected) return;
+  
+  char buf[16];
+  snprintf(buf, sizeof(buf), "ATAT%u", adaptiveTimingMode);
+  queueSetup(buf);
+  if (adapterTimeoutValue > 0) {
+    snprintf(buf, sizeof(buf), "ATST%02X", adapterTimeoutValue);
+    queueSetup(buf);
+  }
+}
+
+// Copy a setup command into the fixed queue; false (and dropped) when full
+bool BLEOBDClient::queueSetup(const char* command) {
+  if (setupCount >= OBD_MAX_SETUP_COMMANDS || strlen(command) >= OBD_MAX_SETUP_LENGTH) {
+    if (debugMode) {
+      Serial.print("⚠️ Setup queue full, dropped: ");
+      Serial.println(command);
+    }
+    return false;
+  }
+  strcpy(setupQueue[(setupHead + setupCount) % OBD_MAX_SETUP_COMMANDS], command);
+  setupCount++;
+  return true;
+}
+
+void BLEOBDClient::queueECUFilter() {
+  if (!deviceConnected || targetRequestHeader == 0) return;
+  
+  queueHeader(targetRequestHeader);
+  
+  char buf[16];
+  snprintf(buf, sizeof(buf), targetResponseId > 0xFFF ? "ATCRA%08X" : "ATCRA%03X",
+           (unsigned)targetResponseId);
+  queueSetup(buf);
+}
+
+// Functional (broadcast) request header: 29-bit once an ECU has answered
+// with an extended id, 11-bit otherwise
+uint32_t BLEOBDClient::functionalHeader() const {
+  for (uint8_t i = 0; i < ecuCount; i++) {
+    if (ecuTable[i].id > 0xFFF) return 0x18DB33F1;
+  }
+  return 0x7DF;
+}
+
+void BLEOBDClient::queueHeader(uint32_t header) {
+  char buf[16];
+  if (header > 0xFFF) {
+    // 29-bit: priority byte via ATCP, remaining 24 bits via ATSH
+    snprintf(buf, sizeof(buf), "ATCP%02X", (unsigned)(header >> 24));
+    queueSetup(buf);
+    snprintf(buf, sizeof(buf), "ATSH%06X", (unsigned)(header & 0xFFFFFF));
+    queueSetup(buf);
+  } else {
+    snprintf(buf, sizeof(buf), "ATSH%03X", (unsigned)header);
+    queueSetup(buf);
+  }
+}
+
+void BLEOBDClient::updateConnectionState(ConnectionState newState) {
+  if (newState != connectionState) {
+    connectionState = newState;
+    lastStateChange = millis();
+    
+    String stateNames[] = {"DISCONNECTED", "SCANNING", "CONNECTING", "INITIALIZING", "CONNECTED", "ERROR"};
+    if (debugMode) {
+      Serial.println("🔄 State: " + stateNames[newState]);
+    }
+  }
+}
+
+void BLEOBDClient::displayOBDData() {
+  StatusSnapshot status;
+  {
+    OBDLockGuard guard(stateLock);
+    snapshotStatus(status, true);
+  }
+  printOBDData(status);
+}
+
+void BLEOBDClient::printOBDData(const StatusSnapshot& status) {
+  if (!status.connected) return;
+  const OBDData& data = status.data;
+  
+  Serial.println("━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━");
+  Serial.println("🚗 OBD2 DATA UPDATE");
+  Serial.println("━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━");
+  
+  // Lines are formatted on the stack: the display runs every 2s for hours
+  char line[112];
+  snprintf(line, sizeof(line), "🔄 RPM: %.0f rpm", data.rpm);
+  Serial.println(line);
+  snprintf(line, sizeof(line), "🏃 Speed: %.0f km/h", data.speed);
+  Serial.println(line);
+  snprintf(line, sizeof(line), "🌡️  Coolant: %.1f°C", data.coolantTemp);
+  Serial.println(line);
+  snprintf(line, sizeof(line), "🛢️  Oil: %.1f°C", data.oilTemp);
+  Serial.println(line);
+  snprintf(line, sizeof(line), "⛽ Fuel: %.1f%%", data.fuelLevel);
+  Serial.println(line);
+  snprintf(line, sizeof(line), "💨 Throttle: %.1f%%", data.throttlePos);
+  Serial.println(line);
+  snprintf(line, sizeof(line), "🔧 Load: %.1f%%", data.engineLoad);
+  Serial.println(line);
+  snprintf(line, sizeof(line), "🌬️  Airflow: %.2f g/s", data.airflowRate);
+  Serial.println(line);
+  snprintf(line, sizeof(line), "🚀 Boost: %.1f kPa", data.boostPressure);
+  Serial.println(line);
+  snprintf(line, sizeof(line), "⛽ Economy: %.1f L/100km (trip %.1f over %.1f km)",
+           data.fuelEconomy, data.avgFuelEconomy, data.tripDistance);
+  Serial.println(line);
+  
+  snprintf(line, sizeof(line), "⏰ Data age: %lums (oldest %s %lums)",
+           status.dataAge, signalName(status.oldestSignal), (unsigned long)status.oldestAge);
+  Serial.println(line);
+  Serial.println("━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━");
+}
+
+void BLEOBDClient::printProfile() {
+  char table[640];
+  {
+    OBDLockGuard guard(stateLock);
+    profiler.report(table, sizeof(table));
+  }
+  Serial.println("⏱️ Poll cycle profile (µs)");
+  Serial.print(table);
+}
+
+void BLEOBDClient::printFreshness() {
+  char table[1536];
+  {
+    OBDLockGuard guard(stateLock);
+    freshness.report(table, sizeof(table));
+  }
+  Serial.println("⏰ Data freshness at read (ms)");
+  Serial.print(table);
+}
+
+void BLEOBDClient::displayStatistics() {
+  StatusSnapshot status;
+  {
+    OBDLockGuard guard(stateLock);
+    snapshotStatus(status, false);
+  }
+  printStatistics(status);
+}
+
+void BLEOBDClient::printStatistics(const StatusSnapshot& status) {
+  const Statistics& stats = status.stats;
+  char line[96];
+  
+  Serial.println("📊 STATISTICS:");
+  snprintf(line, sizeof(line), "   📨 Total Commands: %lu", stats.totalCommands);
+  Serial.println(line);
+  snprintf(line, sizeof(line), "   ✅ Successful: %lu", stats.successfulCommands);
+  Serial.println(line);
+  snprintf(line, sizeof(line), "   ❌ Failed: %lu", stats.failedCommands);
+  Serial.println(line);
+  snprintf(line, sizeof(line), "   📈 Success Rate: %.1f%%", status.successRate);
+  Serial.println(line);
+  snprintf(line, sizeof(line), "   ⚡ Avg Response: %lums", stats.averageResponseTime);
+  Serial.println(line);
+  
+  if (status.connected) {
+    snprintf(line, sizeof(line), "   ⏰ Current Uptime: %lus", status.uptime / 1000);
+    Serial.println(line);
+  }
+  
+  snprintf(line, sizeof(line), "   🔄 Reconnect Attempts: %lu", stats.reconnectAttempts);
+  Serial.println(line);
+  
+  const ConnectionTiming& timing = status.timing;
+  if (timing.connects > 0) {
+    snprintf(line, sizeof(line), "   🔗 Connect: %lums avg, reconnect %lums avg (%lu drops)",
+             (unsigned long)timing.avgConnect, (unsigned long)timing.avgReconnect,
+             (unsigned long)timing.drops);
+    Serial.println(line);
+  }
+  
+  if (stats.adapterErrors > 0) {
+    snprintf(line, sizeof(line), "   🧯 Adapter errors: %lu (%lu retried, %lu re-inits, +%lums spacing)",
+             stats.adapterErrors, stats.retriedCommands, stats.adapterReinits, (unsigned long)status.pollBackoff);
+    Serial.println(line);
+  }
+  
+  if (status.connected) {
+    const LinkQuality& link = status.link;
+    snprintf(line, sizeof(line), "   📶 Link: %u/100 %s, RSSI %d dBm, gap %lums, %lu timeouts",
+             link.score, linkLevelName(link.level), link.rssi,
+             (unsigned long)link.replyGap, (unsigned long)link.timeouts);
+    Serial.println(line);
+  }
+  
+  if (status.staticMemory) {
+    const MemoryReport& mem = status.memory;
+    snprintf(line, sizeof(line), "   💾 Heap: %lu free, %lu min",
+             (unsigned long)mem.freeNow, (unsigned long)mem.minFree);
+    Serial.println(line);
+  }
+}
+
+MemoryReport BLEOBDClient::getMemoryReport() const {
+  MemoryReport report;
+  uint32_t allocations = obdAllocationCount();
+  report.freeAtBegin = heapAtBegin;
+  report.freeAtConnect = heapAtConnect;
+  report.freeNow = ESP.getFreeHeap();
+  report.minFree = ESP.getMinFreeHeap();
+  report.largestBlock = ESP.getMaxAllocHeap();
+  report.clientBytes = sizeof(BLEOBDClient);
+  report.allocationsSinceBegin = allocations - allocationsAtBegin;
+  report.allocationsSinceConnect = heapAtConnect ? allocations - allocationsAtConnect : 0;
+  report.rxDropped = rxDropped;
+  return report;
+}
+
+void BLEOBDClient::printMemoryReport() {
+  MemoryReport mem = getMemoryReport();
+  char line[96];
+  
+  Serial.println("💾 MEMORY:");
+  snprintf(line, sizeof(line), "   Client object: %lu bytes", (unsigned long)mem.clientBytes);
+  Serial.println(line);
+  snprintf(line, sizeof(line), "   Free heap: %lu (begin %lu, connect %lu)", (unsigned long)mem.freeNow,
+           (unsigned long)mem.freeAtBegin, (unsigned long)mem.freeAtConnect);
+  Serial.println(line);
+  snprintf(line, sizeof(line), "   Watermark: %lu, largest block %lu",
+           (unsigned long)mem.minFree, (unsigned long)mem.largestBlock);
+  Serial.println(line);
+  if (obdAllocationCounting()) {
+    snprintf(line, sizeof(line), "   Allocations: %lu since begin, %lu since connect",
+             (unsigned long)mem.allocationsSinceBegin, (unsigned long)mem.allocationsSinceConnect);
+    Serial.println(line);
+  }
+  if (mem.rxDropped > 0) {
+    snprintf(line, sizeof(line), "   Receive bytes dropped: %lu", (unsigned long)mem.rxDropped);
+    Serial.println(line);
+  }
+}
+
+void BLEOBDClient::printConnectionInfo() {
+  StatusSnapshot status;
+  {
+    OBDLockGuard guard(stateLock);
+    snapshotStatus(status, false);
+  }
+  printConnectionState(status);
+}
+
+void BLEOBDClient::printConnectionState(const StatusSnapshot& status) {
+  String stateNames[] = {"DISCONNECTED", "SCANNING", "CONNECTING", "INITIALIZING", "CONNECTED", "ERROR"};
+  Serial.println("📱 Connection Status: " + stateNames[status.state]);
+  
+  if (status.state == SCANNING) {
+    Serial.println("🔍 Scanning for: " + String(status.deviceName) + " (" + String(status.scanDuration/1000) + "s)");
+  }
+}
+
+void BLEOBDClient::printSystemInfo() {
+  Serial.println("🔧 System Information:");
+  Serial.println("   📋 ESP32 Chip: " + String(ESP.getChipModel()));
+  Serial.println("   🔢 Revision: " + String(ESP.getChipRevision()));
+  Serial.println("   💾 Free Heap: " + String(ESP.getFreeHeap()) + " bytes");
+  Serial.println("   ⏰ CPU Frequency: " + String(ESP.getCpuFreqMHz()) + " MHz");
+  Serial.println();
+}
+
+float BLEOBDClient::getSuccessRate() const {
+  if (stats.totalCommands == 0) return 0.0;
+  return (stats.successfulCommands * 100.0) / stats.totalCommands;
+}
+
+unsigned long BLEOBDClient::getUptime() const {
+  if (!deviceConnected) return 0;
+  return millis() - stats.lastConnectionTime;
+}
+
+// Static parsing functions
+// Copy text without spaces into out, truncated to outSize - 1 and NUL
+// terminated; returns the untruncated count
+static size_t stripSpaces(const char* text, size_t length, char* out, size_t outSize) {
+  size_t count = 0;
+  for (size_t i = 0; i < length && text[i]; i++) {
+    if (text[i] == ' ') continue;
+    if (count + 1 < outSize) out[count] = text[i];
+    count++;
+  }
+  out[count < outSize ? count : outSize - 1] = '\0';
+  return count;
+}
+
+// Mode 01 reply "41" + PID followed by at least `bytes` data bytes, all hex.
+// pid < 0 accepts any PID (returned in *pidOut).
+static bool readPIDBytes(const char* response, size_t length, int pid, uint8_t bytes, uint32_t* raw,
+                         uint8_t* pidOut = nullptr) {
+  char text[16];
+  uint32_t mode, replyPid;
+  
+  if (stripSpaces(response, length, text, sizeof(text)) < 4 + bytes * 2u) return false;
+  if (!parseHexValue(text, 2, &mode) || mode != 0x41) return false;
+  if (!parseHexValue(text + 2, 2, &replyPid) || (pid >= 0 && (int)replyPid != pid)) return false;
+  if (!parseHexValue(text + 4, bytes * 2, raw)) return false;
+  
+  if (pidOut) *pidOut = replyPid;
+  return true;
+}
+
+bool BLEOBDClient::parseRPM(const char* response, size_t length, float* value) {
+  uint32_t raw;
+  if (!readPIDBytes(response, length, 0x0C, 2, &raw)) return false;
+  *value = raw / 4.0;
+  return true;
+}
+
+bool BLEOBDClient::parseSpeed(const char* response, size_t length, float* value) {
+  uint32_t raw;
+  if (!readPIDBytes(response, length, 0x0D, 1, &raw)) return false;
+  *value = raw;
   return true;
 }
 
-bool BLEOBDClient::parseVoltage(String response, float* value) {
-  // Implementation depends on specific voltage PID used
-  // This is a placeholder for voltage parsing
-  *value = 12.6; // Default voltage
+bool BLEOBDClient::parseTemperature(const char* response, size_t length, float* value) {
+  uint32_t raw;
+  uint8_t pid;
+  if (!readPIDBytes(response, length, -1, 1, &raw, &pid)) return false;
+  
+  // Coolant, intake air, ambient air, oil: A - 40
+  if (pid != 0x05 && pid != 0x0F && pid != 0x46 && pid != 0x5C) return false;
+  *value = (float)raw - 40;
+  return true;
+}
+
+bool BLEOBDClient::parsePercentage(const char* response, size_t length, float* value) {
+  uint32_t raw;
+  uint8_t pid;
+  if (!readPIDBytes(response, length, -1, 1, &raw, &pid)) return false;
+  
+  // PIDs scaled A * 100 / 255: load, throttle, fuel level, pedal positions, ...
+  static const uint8_t percentPIDs[] = {
+    0x04, 0x11, 0x2C, 0x2E, 0x2F, 0x45, 0x47, 0x48, 0x49, 0x4A, 0x4B, 0x4C, 0x52, 0x5A, 0x5B
+  };
+  for (uint8_t i = 0; i < sizeof(percentPIDs); i++) {
+    if (percentPIDs[i] == pid) {
+      *value = (raw * 100.0) / 255.0;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool BLEOBDClient::parseAirflow(const char* response, size_t length, float* value) {
+  uint32_t raw;
+  if (!readPIDBytes(response, length, 0x10, 2, &raw)) return false;
+  *value = raw / 100.0;
+  return true;
+}
+
+// Accepts a PID 42 payload ("4142317A" -> 12.666V) or ATRV text ("12.6V")
+bool BLEOBDClient::parseVoltage(const char* response, size_t length, float* value) {
+  char text[24];
+  size_t count = stripSpaces(response, length, text, sizeof(text));
+  if (count >= sizeof(text)) return false;
+  
+  if (count >= 4 && memcmp(text, "4142", 4) == 0) {
+    uint32_t raw;
+    if (count < 8 || !parseHexValue(text + 4, 4, &raw)) return false;
+    *value = raw / 1000.0f;
+    return true;
+  }
+  
+  char* end;
+  float volts = strtof(text, &end);
+  if (end == text || (*end != 'V' && *end != '\0') || volts <= 0.0f || volts > 30.0f) return false;
+  *value = volts;
   return true;
 }
 
@@ -525,58 +2192,102 @@ void OBDClientCallbacks::onConnect(BLEClient* pClient) {
   // Connection state will be updated in main connectToDevice function
 }
 
+// Runs on the BLE task: only flag the loss, service() handles it under the lock
 void OBDClientCallbacks::onDisconnect(BLEClient* pClient) {
-  g_bleClient->deviceConnected = false;
-  g_bleClient->updateConnectionState(DISCONNECTED);
-  
-  unsigned long uptime = g_bleClient->getUptime();
-  g_bleClient->stats.connectionUptime += uptime;
+  BLEOBDClient* client = BLEOBDClient::fromBLEClient(pClient);
+  if (!client) return;
   
-  Serial.println("💔 BLE Disconnected! Uptime was: " + String(uptime) + "ms");
-  
-  if (g_bleClient->autoReconnect) {
-    Serial.println("🔄 Will attempt reconnection...");
-    g_bleClient->doScan = true;
-  }
+  client->linkLost = true;
+  client->pollerWake.notify();
 }
 
 void OBDScanCallbacks::onResult(BLEAdvertisedDevice advertisedDevice) {
-  if (g_bleClient->verboseLogging) {
-    Serial.println("🔍 Found device: " + String(advertisedDevice.getName().c_str()));
+  BLEOBDClient* owner = nullptr;
+  bool verbose = false;
+  
+  for (uint8_t i = 0; i < BLEOBDClient::instanceCount; i++) {
+    BLEOBDClient* client = BLEOBDClient::instances[i];
+    verbose |= client->verboseLogging;
+    if (client->ownsAddress(advertisedDevice)) return; // Claimed by another instance
   }
   
-  bool targetFound = false;
+  if (verbose) {
+    Serial.println("🔍 Found device: " + String(advertisedDevice.getName().c_str()));
+  }
   
-  // Check by service UUID first
-  if (advertisedDevice.haveServiceUUID() && 
-      advertisedDevice.isAdvertisingService(BLEUUID(SERVICE_UUID))) {
-    Serial.println("✅ Found OBD2 BLE service!");
-    targetFound = true;
+  // Exact name match wins; otherwise hand a Nordic UART device to the first
+  // instance still scanning
+  for (uint8_t pass = 0; pass < 2 && !owner; pass++) {
+    for (uint8_t i = 0; i < BLEOBDClient::instanceCount; i++) {
+      if (BLEOBDClient::instances[i]->wantsDevice(advertisedDevice, pass == 0)) {
+        owner = BLEOBDClient::instances[i];
+        break;
+      }
+    }
   }
-  // Check by device name
-  else if (advertisedDevice.getName() == g_bleClient->deviceName) {
-    Serial.println("✅ Found target device by name: " + g_bleClient->deviceName);
-    targetFound = true;
+  if (!owner) return;
+  
+  Serial.println("✅ Found target device for " + owner->deviceName + ": " +
+                 String(advertisedDevice.getName().c_str()));
+  
+  // BLE task: the poller reads these in service()
+  {
+    OBDLockGuard guard(owner->stateLock);
+    owner->connection.setDevice(advertisedDevice);
+    owner->deviceFound = true;
+    owner->doConnect = true;
+    owner->doScan = false;
   }
   
-  if (targetFound) {
+  // Keep scanning while another instance still needs an adapter
+  bool othersScanning = false;
+  for (uint8_t i = 0; i < BLEOBDClient::instanceCount; i++) {
+    BLEOBDClient* client = BLEOBDClient::instances[i];
+    if (client->connectionState == SCANNING && !client->doConnect) othersScanning = true;
+  }
+  if (!othersScanning) {
     BLEDevice::getScan()->stop();
-    g_bleClient->targetDevice = new BLEAdvertisedDevice(advertisedDevice);
-    g_bleClient->deviceFound = true;
-    g_bleClient->doConnect = true;
-    g_bleClient->doScan = false;
   }
 }
 
 // BLE notification callback
 void bleNotifyCallback(BLERemoteCharacteristic* pBLERemoteCharacteristic, 
                       uint8_t* pData, size_t length, bool isNotify) {
-  String response = "";
-  for (int i = 0; i < length; i++) {
-    response += (char)pData[i];
+  BLEOBDClient* client = BLEOBDClient::fromCharacteristic(pBLERemoteCharacteristic);
+  if (!client) return;
+  
+  // Monitor mode: parse frames in place, no String building
+  if (client->monitorState == MONITOR_ACTIVE || client->monitorState == MONITOR_STOPPING) {
+    client->handleMonitorData(pData, length);
+    client->pollerWake.notify();
+    return;
   }
   
-  if (g_bleClient) {
-    g_bleClient->processIncomingData(response);
+  // Profiler stamps are only taken here; service() applies them
+  bool stamp = client->profiler.isEnabled();
+  uint32_t cycles = stamp ? client->profiler.now() : 0;
+  
+  // One append per notification; past the cap the bytes are dropped rather
+  // than growing the buffer while service() is late
+  client->rxLock.lock();
+  if (stamp) {
+    if (!client->rxFirstByteStamped) {
+      client->rxFirstByteStamped = true;
+      client->rxFirstByteCycles = cycles;
+    }
+    if (!client->rxPromptStamped && memchr(pData, '>', length)) {
+      client->rxPromptStamped = true;
+      client->rxPromptCycles = cycles;
+    }
+  }
+  uint32_t now = millis();
+  if (client->rxPending.length() == 0) client->rxFirstNotify = now;
+  client->rxLastNotify = now;
+  if (client->rxPending.length() + length <= OBD_MAX_RESPONSE_TEXT) {
+    client->rxPending.concat((const char*)pData, length);
+  } else {
+    client->rxDropped += length;
   }
+  client->rxLock.unlock();
+  client->pollerWake.notify();
 }
\ No newline at end of file
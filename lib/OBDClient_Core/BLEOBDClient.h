@@ -7,12 +7,62 @@
 #include <BLEScan.h>
 #include <BLEAdvertisedDevice.h>
 #include <BLEClient.h>
+#include <atomic>
 #include <vector>
+#include <utility>
+#include "BLEConnection.h"
+#include "OBDResponse.h"
+#include "OBDDtc.h"
+#include "OBDPidDecoder.h"
+#include "OBDMonitor.h"
+#include "CANSignalDB.h"
+#include "OBDSync.h"
+#include "OBDSubscription.h"
+#include "OBDDerived.h"
+#include "OBDTelemetry.h"
+#include "OBDSerializer.h"
+#include "OBDProfiler.h"
+#include "OBDFreshness.h"
+#include "OBDMemory.h"
+#include "OBDLinkQuality.h"
+#include "OBDStatus.h"
 
-// BLE UUIDs (Nordic UART Service compatible)
-#define SERVICE_UUID    "6E400001-B5A3-F393-E0A9-E50E24DCCA9E"
-#define TX_CHAR_UUID    "6E400002-B5A3-F393-E0A9-E50E24DCCA9E"  // Write to this
-#define RX_CHAR_UUID    "6E400003-B5A3-F393-E0A9-E50E24DCCA9E"  // Notifications from this
+// Maximum client instances (one per adapter) in one process
+#define OBD_MAX_CLIENTS 4
+
+// Response text kept while waiting for the prompt; more is treated as garbage
+#define OBD_MAX_RESPONSE_TEXT 1024
+
+// Periodic command slots (standard PIDs, extended PIDs, user commands)
+#define OBD_MAX_COMMANDS 32
+
+// Longest request text of a periodic command ("221234" for a Mode 22 DID)
+#define OBD_MAX_REQUEST 12
+
+// Adapter setup commands (AT/ST) waiting to be sent between polls
+#define OBD_MAX_SETUP_COMMANDS 16
+#define OBD_MAX_SETUP_LENGTH   24
+
+// Poll spacing added after BUFFER FULL / STOPPED / BUS BUSY (doubles per
+// error up to the max, shrinks again with every clean reply)
+#define OBD_MIN_POLL_BACKOFF 50
+#define OBD_MAX_POLL_BACKOFF 1000
+
+// Minimum time between two adapter re-initializations after bus errors (ms)
+#define OBD_REINIT_HOLDOFF 5000
+
+// A timed-out request may still be answered this long afterwards (ms);
+// until then a reply without a matching echo is taken as that late answer
+#define OBD_LATE_REPLY_WINDOW 5000
+#define OBD_MAX_LATE_REPLIES  4
+
+// A status reply that may be that late answer is held this long (ms, or
+// twice the average reply time if longer) for the request's own reply
+#define OBD_LATE_REPLY_SETTLE 100
+#define OBD_MAX_HELD_REPLY    64
+
+// Poller task wakes at least this often when no notification arrives (ms)
+#define OBD_POLLER_IDLE_MS 20
 
 // OBD2 Data structure
 struct OBDData {
@@ -24,23 +74,126 @@ struct OBDData {
   float throttlePos = 0.0;
   float engineLoad = 0.0;
   float airflowRate = 0.0;
-  float boostPressure = 0.0;
+  float boostPressure = 0.0;     // kPa above ambient (MAP - baro)
   float voltage = 0.0;
+  float manifoldPressure = 0.0;  // kPa absolute
+  float baroPressure = 0.0;      // kPa
+  float fuelRate = 0.0;          // L/h, from MAF
+  float fuelEconomy = 0.0;       // L/100km, 0 when stopped
+  float avgFuelEconomy = 0.0;    // L/100km since resetTrip()
+  float tripDistance = 0.0;      // km since resetTrip()
   int dtcCount = 0;
   bool engineRunning = false;
   unsigned long lastUpdate = 0;
 };
 
-// Command structure for non-blocking operations
+// OBDCommand flags
+#define OBD_CMD_DESCRIPTOR  0x01  // Decode with the slot's descriptor instead of its parser
+#define OBD_CMD_COMPLETED   0x02  // Reply (or timeout) waiting to be decoded
+
+// Custom reply parser: the selected ECU's payload as hex digits without
+// headers or spaces (e.g. "410C1AF8"), NUL terminated at response[length]
+typedef bool (*OBDParseFunction)(const char* response, size_t length, float* value);
+
+// Periodic command: plain data in a fixed array, so the scheduler scans a
+// few cache lines and a poll cycle allocates nothing. The reply text sits
+// in the client's shared response buffer (one request is in flight at a
+// time); target, parser and descriptor live in OBDCommandBinding at the
+// same slot index.
 struct OBDCommand {
-  String command;
-  String expectedResponse;
-  float* targetVariable;
-  bool (*parseFunction)(String response, float* value);
+  char request[OBD_MAX_REQUEST];  // Pre-encoded request text ("010C")
+  uint8_t requestLength;
+  uint8_t responseMode;       // Expected mode byte in the reply (request mode + 0x40)
+  int16_t pid;                // Expected PID byte, -1 if the request has none
+  int8_t signal;              // OBDSignal published after a decode, -1 if none
+  uint8_t flags;
+  uint8_t respondingECUs;     // ECUs that answered the last request
+  uint8_t expectedResponses;  // Learned CAN response count appended to the request (0 = learning)
+  uint8_t discoveryPolls;     // Polls observed while learning the response count
+  uint8_t discoveredECUs;     // Highest responder count seen while learning
+  uint16_t responseLength;    // Reply text length in the response buffer (0 = none)
+  uint32_t ecuId;             // ECU whose answer is stored (0 = primary responder)
+  uint32_t timeout;
+  uint32_t interval;          // Minimum time between polls (0 = every cycle)
+  uint32_t lastPolled;
+  uint32_t sentTime;
+};
+
+// Cold per-slot data, only touched when a reply is decoded
+struct OBDCommandBinding {
+  float* target;
+  OBDParseFunction parser;    // Custom parser when the slot has no descriptor
+  PIDDescriptor descriptor;
+};
+
+// ECU seen on the bus (tracked from CAN/legacy response headers)
+struct ECUInfo {
+  uint32_t id = 0;
+  unsigned long responses = 0;
+  unsigned long lastSeen = 0;
+};
+
+// One-shot request support (freeze frames, vehicle info, DTCs, AT queries)
+#define OBD_MAX_ONESHOTS 8
+
+enum OneShotStatus {
+  ONESHOT_OK,          // Positive answer (or any text for AT/ST commands)
+  ONESHOT_NO_DATA,     // No ECU answered with the expected mode
+  ONESHOT_NEGATIVE,    // ECU answered with a negative response (7F)
+  ONESHOT_TIMEOUT
+};
+
+struct OneShotResult {
+  OneShotStatus status;
+  const char* command;           // Request as submitted
+  const char* text;              // Raw adapter text
+  AdapterStatus adapterStatus;   // Adapter status found in the text
+  const OBDResponse* response;   // All ECU messages (valid during the callback only)
+  const OBDMessage* message;     // Primary positive message, or nullptr
+  unsigned long latency;         // Submit to completion (ms)
+};
+
+typedef void (*OneShotCallback)(const OneShotResult& result, void* context);
+
+struct OneShotRequest {
+  char command[24];
+  OneShotCallback callback;
+  void* context;
   unsigned long timeout;
-  bool completed;
-  String rawResponse;
-  unsigned long sentTime;
+  unsigned long submitTime;
+};
+
+// Passive CAN monitoring (ATMA / STMA)
+#define OBD_MAX_MONITOR_FILTERS 4
+
+enum MonitorState {
+  MONITOR_OFF,
+  MONITOR_STARTING,    // Filters being configured
+  MONITOR_ACTIVE,      // Adapter streaming frames
+  MONITOR_STOPPING     // Waiting for the prompt after stop
+};
+
+typedef void (*CANFrameCallback)(const CANFrame& frame, void* context);
+
+// Called after a DTC read cycle when any stored/pending/permanent set changed
+typedef void (*DTCChangeCallback)(const DTCReport& report);
+
+// Where the supply voltage is read from (decided by PID 0140 after connecting)
+enum VoltageSource {
+  VOLTAGE_UNKNOWN,
+  VOLTAGE_PID,         // Mode 01 PID 42, control module voltage
+  VOLTAGE_ADAPTER      // ATRV, measured by the adapter at the OBD socket
+};
+
+// Called when the smoothed voltage drops below the low threshold and again
+// once it has recovered (threshold + hysteresis)
+typedef void (*VoltageCallback)(float volts, bool low, void* context);
+
+// Adapter chip family, detected with ATI / STI after initialization
+enum AdapterType {
+  ADAPTER_UNKNOWN,
+  ADAPTER_ELM327,      // ELM327 or clone
+  ADAPTER_STN          // OBDLink STN11xx / STN2xxx
 };
 
 // Connection states
@@ -62,43 +215,226 @@ struct Statistics {
   unsigned long connectionUptime = 0;
   unsigned long lastConnectionTime = 0;
   unsigned long reconnectAttempts = 0;
+  unsigned long adapterErrors = 0;     // Replies with an adapter error status
+  unsigned long retriedCommands = 0;
+  unsigned long adapterReinits = 0;
+  unsigned long staleReplies = 0;      // Late replies dropped instead of misattributed
+};
+
+// What the periodic display prints, copied under the client lock so the
+// (possibly slow) Serial output runs without holding it
+struct StatusSnapshot {
+  ConnectionState state;
+  bool connected;
+  char deviceName[32];
+  unsigned long scanDuration;
+  OBDData data;
+  unsigned long dataAge;
+  OBDSignal oldestSignal;
+  uint32_t oldestAge;
+  Statistics stats;
+  float successRate;
+  unsigned long uptime;
+  ConnectionTiming timing;
+  uint32_t pollBackoff;
+  LinkQuality link;
+  bool staticMemory;
+  MemoryReport memory;
 };
 
 // Main BLE OBD Client class
 class BLEOBDClient {
 public:
-  // Constructor
+  // Constructor / destructor (instances register for BLE callback dispatch)
   BLEOBDClient();
+  ~BLEOBDClient();
   
   // Initialization
   void begin(String targetDeviceName = "OBD2_Simulator_BLE");
   
-  // Main loop processing
+  // Static memory mode (call before begin()): receive buffers are reserved
+  // at their caps so polling never grows them, and the statistics display
+  // adds a heap line. Queues, tables and callbacks are always fixed-size.
+  void setStaticMemory(bool enabled) { staticMemory = enabled; }
+  MemoryReport getMemoryReport() const;
+  void printMemoryReport();
+  
+  // Main loop processing: service() runs connection handling and the
+  // scheduler, loop() = service() + periodic display (service() is skipped
+  // while the poller task owns it)
   void loop();
+  void service();
+  void displayStatus();
+  
+  // Optional poller task: runs service() pinned to a core, woken by BLE
+  // notifications. Public methods may then be called from any task; the
+  // getLinkMonitor()/getProfiler()/getFreshness()/getSignalDB() handles hold
+  // the client lock until they go out of scope.
+  bool startPollerTask(int8_t core = 0, uint8_t priority = 3, uint32_t stackSize = 8192);
+  void stopPollerTask();
+  bool isPollerRunning() const { return pollerThread.isRunning(); }
   
   // Connection management
   bool connectToDevice();
   void disconnect();
   void startScan();
+  ConnectionTiming getConnectionTiming() const { OBDLockGuard guard(stateLock); return connection.getTiming(); }
+  
+  // Link quality from RSSI, reply gaps and timeouts. A degrading link spaces
+  // out periodic polls; one that stays poor is reconnected (with auto-reconnect)
+  // before it drops on its own.
+  LinkQuality getLinkQuality() const { OBDLockGuard guard(stateLock); return linkMonitor.getQuality(); }
+  OBDLockedRef<LinkQualityMonitor> getLinkMonitor() { return OBDLockedRef<LinkQualityMonitor>(stateLock, linkMonitor); }
+  void setRssiInterval(unsigned long intervalMs) { rssiInterval = intervalMs; } // 0 = off
   
   // OBD2 initialization and commands
   void initializeOBD();
   void setupOBDCommands();
-  void addCommand(String cmd, float* target, bool (*parser)(String, float*));
+  bool addCommand(String cmd, float* target, OBDParseFunction parser, uint32_t ecuId = 0);
+  void addPID(const PIDDescriptor& desc, float* target, unsigned long intervalMs = 0);
+  
+  // Extended PIDs (Mode 22 DIDs etc.), polled after the standard PIDs on every connection
+  int addExtendedPID(const PIDDescriptor& desc, float* target = nullptr);
+  int loadExtendedPIDs(const uint8_t* blob, size_t length);
+  uint8_t getExtendedPIDCount() const { return extendedCount; }
+  float getExtendedValue(uint8_t index) const {
+    OBDLockGuard guard(stateLock);
+    return index < extendedCount ? *extendedTargets[index] : 0.0f;
+  }
   void processCommandQueue();
   void sendCommand(String command);
+  void sendRequest(const char* request, size_t length);
   
   // Data access
-  OBDData getCurrentData() const { return obdData; }
-  Statistics getStatistics() const { return stats; }
+  OBDData getCurrentData() const { OBDLockGuard guard(stateLock); return obdData; }
+  OBDData getCurrentData(int consumer);   // Same, recorded in that consumer's freshness
+  Statistics getStatistics() const { OBDLockGuard guard(stateLock); return stats; }
   ConnectionState getConnectionState() const { return connectionState; }
   
+  // Adapter replies by status (NO DATA, BUFFER FULL, CAN ERROR, ...) and the
+  // extra poll spacing currently applied after overrun errors
+  uint32_t getStatusCount(AdapterStatus status) const { return status < STATUS_COUNT ? statusCounts[status] : 0; }
+  uint32_t getPollBackoff() const { return pollBackoff; }
+  
+  // Change notifications: callback when a signal moves by more than the
+  // deadband, at most once per minInterval (runs in service())
+  int subscribe(OBDSignal signal, SignalCallback callback, void* context = nullptr,
+                float deadband = 0.0f, unsigned long minIntervalMs = 0);
+  void unsubscribe(int handle);
+  uint32_t getDeliveredEvents() const { return subscriptions.getDelivered(); }
+  uint32_t getSuppressedEvents() const { return subscriptions.getSuppressed(); }
+  
+  // Derived signals (boost, fuel economy, trip distance, engine running)
+  // are recomputed after their inputs update
+  void resetTrip();
+  
+  // Binary telemetry (COBS/CRC16 frames, see OBDTelemetry.h) written to out,
+  // normally the USB CDC Serial. The periodic text display is suppressed
+  // while active; turn debug output off for a clean stream.
+  void startTelemetry(Print& out);
+  void stopTelemetry();
+  bool isTelemetryActive() const { return telemetryOut != nullptr; }
+  uint32_t getTelemetryBytes() const { return telemetry.getBytes(); }
+  
+  // Snapshot of every signal indexed by OBDSignal, and the same snapshot
+  // written as JSON/CSV into a caller buffer (returns length, 0 if too small)
+  void getSignalValues(float* values);
+  size_t serialize(const SnapshotSerializer& serializer, char* out, size_t outSize,
+                   int consumer = -1);
+  
+  // Per-stage poll cycle profiling (cycle counter, see OBDProfiler.h)
+  void setProfiling(bool enabled) { OBDLockGuard guard(stateLock); profiler.setEnabled(enabled); }
+  OBDLockedRef<PollProfiler> getProfiler() { return OBDLockedRef<PollProfiler>(stateLock, profiler); }
+  void printProfile();
+  
+  // End-to-end freshness: age of each value (from its request being sent)
+  // when a consumer reads it, per signal and per consumer, plus refresh Hz.
+  // The display and telemetry stream are registered as consumers.
+  int addConsumer(const char* name) { OBDLockGuard guard(stateLock); return freshness.addConsumer(name); }
+  void markConsumed(int consumer, uint32_t signalMask = FRESHNESS_ALL_SIGNALS);
+  uint32_t getSignalAge(OBDSignal signal) const {
+    OBDLockGuard guard(stateLock);
+    return freshness.getAge(signal, millis());
+  }
+  float getRefreshHz(OBDSignal signal) const { OBDLockGuard guard(stateLock); return freshness.getRefreshHz(signal); }
+  OBDLockedRef<FreshnessTracker> getFreshness() { return OBDLockedRef<FreshnessTracker>(stateLock, freshness); }
+  void printFreshness();
+  
+  // Multi-ECU support
+  uint8_t getECUCount() const { return ecuCount; }
+  ECUInfo getECUInfo(uint8_t index) const {
+    OBDLockGuard guard(stateLock);
+    return index < ecuCount ? ecuTable[index] : ECUInfo();
+  }
+  void setTargetECU(uint32_t requestHeader, uint32_t responseId);
+  void clearTargetECU();
+  
+  // Diagnostic trouble codes (Modes 03/07/0A, cleared with Mode 04)
+  DTCReport getDTCReport() const { OBDLockGuard guard(stateLock); return dtcReport; }
+  void setDTCInterval(unsigned long intervalMs) { dtcInterval = intervalMs; } // 0 = manual only
+  void setDTCCallback(DTCChangeCallback callback) { dtcCallback = callback; }
+  void readDTCs();
+  void clearDTCs();
+  
+  // Supply voltage: PID 0142 when the ECU supports it, ATRV otherwise, read
+  // as a low-rate one-shot and smoothed into OBDData::voltage
+  void setVoltageInterval(unsigned long intervalMs) { voltageInterval = intervalMs; } // 0 = off
+  void setLowVoltageThreshold(float volts) { lowVoltageThreshold = volts; }
+  void setVoltageCallback(VoltageCallback callback, void* context = nullptr) {
+    voltageCallback = callback;
+    voltageCallbackContext = context;
+  }
+  VoltageSource getVoltageSource() const { return voltageSource; }
+  bool isVoltageLow() const { return voltageLow; }
+  
+  // One-shot requests: queued and sent between periodic polls, result via callback
+  bool submitRequest(const char* command, OneShotCallback callback, void* context = nullptr,
+                     unsigned long timeoutMs = 0);
+  bool requestFreezeFrame(uint8_t pid, OneShotCallback callback, void* context = nullptr,
+                          uint8_t frame = 0);
+  bool requestVehicleInfo(uint8_t infoType, OneShotCallback callback, void* context = nullptr);
+  bool requestVIN(OneShotCallback callback, void* context = nullptr) {
+    return requestVehicleInfo(0x02, callback, context);
+  }
+  void setOneShotMaxDelay(unsigned long ms) { oneShotMaxDelay = ms; }
+  uint8_t getPendingOneShots() const { return oneShotCount; }
+  
+  // Passive monitor mode: polling pauses while the adapter streams bus traffic
+  bool addMonitorFilter(uint32_t id, uint32_t mask);
+  void clearMonitorFilters() { OBDLockGuard guard(stateLock); monitorFilterCount = 0; }
+  OBDLockedRef<CANSignalDB> getSignalDB() { return OBDLockedRef<CANSignalDB>(stateLock, signalDB); }
+  // Publish a database signal (by index) as an OBD signal: it then updates
+  // getCurrentData(), subscriptions, derived signals, telemetry and freshness
+  bool bindCANSignal(uint8_t index, OBDSignal signal);
+  void setFrameCallback(CANFrameCallback callback, void* context = nullptr) {
+    frameCallback = callback;
+    frameCallbackContext = context;
+  }
+  bool startMonitor();
+  void stopMonitor();
+  bool isMonitoring() const { return monitorState != MONITOR_OFF; }
+  uint32_t getMonitorFrames() const { return monitorParser.framesParsed; }
+  uint32_t getMonitorDrops() const { return frameRing.getDropped(); }
+  
+  // ASCII text of a Mode 09 answer (VIN, calibration IDs); returns length
+  static size_t decodeVehicleInfoText(const OBDMessage* msg, char* out, size_t outSize);
+  
   // Configuration
   void setDebugMode(bool enabled) { debugMode = enabled; }
   void setVerboseLogging(bool enabled) { verboseLogging = enabled; }
   void setAutoReconnect(bool enabled) { autoReconnect = enabled; }
   void setTimeout(unsigned long timeoutMs) { defaultTimeout = timeoutMs; }
   
+  // Adapter timing
+  void setResponseCountEnabled(bool enabled) { useResponseCount = enabled; }
+  void setAdaptiveTiming(uint8_t mode);
+  void setAdapterTimeout(unsigned long timeoutMs);
+  void setSTNExtensions(bool enabled) { allowSTNExtensions = enabled; }
+  
+  // Adapter identification
+  AdapterType getAdapterType() const { return adapterType; }
+  const char* getAdapterVersion() const { return adapterVersion; }
+  
   // Status checks
   bool isConnected() const { return deviceConnected; }
   float getSuccessRate() const;
@@ -110,20 +446,20 @@ public:
   void printConnectionInfo();
   
   // Parsing functions (static for use in function pointers)
-  static bool parseRPM(String response, float* value);
-  static bool parseSpeed(String response, float* value);
-  static bool parseTemperature(String response, float* value);
-  static bool parsePercentage(String response, float* value);
-  static bool parseVoltage(String response, float* value);
-  static bool parseAirflow(String response, float* value);
+  static bool parseRPM(const char* response, size_t length, float* value);
+  static bool parseSpeed(const char* response, size_t length, float* value);
+  static bool parseTemperature(const char* response, size_t length, float* value);
+  static bool parsePercentage(const char* response, size_t length, float* value);
+  static bool parseVoltage(const char* response, size_t length, float* value);
+  static bool parseAirflow(const char* response, size_t length, float* value);
   
 private:
-  // Connection components
-  BLEClient* pClient = nullptr;
-  BLERemoteCharacteristic* pTxCharacteristic = nullptr;
-  BLERemoteCharacteristic* pRxCharacteristic = nullptr;
-  BLEAdvertisedDevice* targetDevice = nullptr;
+  // Connection components (BLE objects reused across reconnects)
+  BLEConnection connection;
   BLEScan* pBLEScan = nullptr;
+  LinkQualityMonitor linkMonitor;
+  unsigned long rssiInterval = 2000;
+  unsigned long lastRssiSample = 0;
   
   // Connection state
   bool deviceConnected = false;
@@ -135,14 +471,128 @@ private:
   // Data storage
   OBDData obdData;
   Statistics stats;
+  SubscriptionTable subscriptions;
+  DerivedEngine derived;
+  TripState trip;
+  TelemetryEncoder telemetry;
+  PollProfiler profiler;
+  FreshnessTracker freshness;
+  int displayConsumer = -1;
+  int telemetryConsumer = -1;
+  uint32_t telemetryMask = 0;        // Signals recorded since the last frame
+  Print* telemetryOut = nullptr;
   
   // Command management
-  std::vector<OBDCommand> commandQueue;
+  OBDCommand commandQueue[OBD_MAX_COMMANDS];
+  OBDCommandBinding commandBindings[OBD_MAX_COMMANDS];
+  uint8_t commandCount = 0;
+  char responseText[OBD_MAX_RESPONSE_TEXT + 1];   // Reply to the request in flight
   int currentCommandIndex = 0;
   unsigned long lastCommandTime = 0;
   bool waitingForResponse = false;
   String incomingData = "";
   
+  // Adapter status of the last reply and the recovery it triggered
+  ResponseClass replyClass;
+  uint32_t statusCounts[STATUS_COUNT] = {};
+  uint32_t pollBackoff = 0;          // ms, see OBD_MIN_POLL_BACKOFF
+  bool pollRetried = false;          // Current periodic command already resent once
+  unsigned long lastReinit = 0;
+  
+  // Late replies to timed-out requests, told apart from the current answer
+  uint8_t lateReplies = 0;
+  unsigned long lateDeadline = 0;
+  bool droppedWhileWaiting = false;  // A reply was dropped during the current request
+  char heldReply[OBD_MAX_HELD_REPLY];
+  unsigned int heldLength = 0;       // Status reply held for the request in flight (0 = none)
+  unsigned long heldDeadline = 0;
+  
+  // Adapter setup commands (AT...) sent between polls
+  char setupQueue[OBD_MAX_SETUP_COMMANDS][OBD_MAX_SETUP_LENGTH];
+  uint8_t setupHead = 0;
+  uint8_t setupCount = 0;
+  bool setupInFlight = false;
+  
+  // ECU tracking
+  ECUInfo ecuTable[OBD_MAX_ECUS];
+  uint8_t ecuCount = 0;
+  uint32_t targetRequestHeader = 0;
+  uint32_t targetResponseId = 0;
+  uint32_t activeHeader = 0;         // Header set by ATSH for a descriptor, 0 = default
+  
+  // Monitor mode
+  volatile MonitorState monitorState = MONITOR_OFF;
+  volatile bool monitorPromptSeen = false;
+  CANFrameRing frameRing;
+  MonitorLineParser monitorParser;
+  uint32_t monitorFilterIds[OBD_MAX_MONITOR_FILTERS];
+  uint32_t monitorFilterMasks[OBD_MAX_MONITOR_FILTERS];
+  uint8_t monitorFilterCount = 0;
+  CANSignalDB signalDB;
+  CANFrameCallback frameCallback = nullptr;
+  void* frameCallbackContext = nullptr;
+  uint8_t canSignalBindings[CAN_MAX_SIGNALS];   // DB signal index -> OBDSignal, SIGNAL_COUNT = none
+  uint32_t monitorFrameTime = 0;                // Capture time of the frame being decoded
+  unsigned long monitorStopTime = 0;
+  uint32_t monitorRestarts = 0;
+  bool adapterIsSTN = false;        // STN detected and extensions enabled
+  
+  // Adapter identification
+  AdapterType adapterType = ADAPTER_UNKNOWN;
+  char adapterVersion[32] = "";
+  bool allowSTNExtensions = true;
+  
+  // Extended PID registry
+  PIDDescriptor extendedPIDs[OBD_MAX_EXTENDED_PIDS];
+  float* extendedTargets[OBD_MAX_EXTENDED_PIDS];
+  float extendedValues[OBD_MAX_EXTENDED_PIDS];
+  uint8_t extendedCount = 0;
+  
+  // Adapter timing (ATAT / ATST / response count suffix)
+  bool useResponseCount = true;
+  uint8_t adaptiveTimingMode = 1;
+  uint8_t adapterTimeoutValue = 0;   // ATST units of 4ms, 0 = adapter default
+  
+  // One-shot queue, at most one request sent between two periodic polls
+  OneShotRequest oneShotQueue[OBD_MAX_ONESHOTS];
+  uint8_t oneShotHead = 0;
+  uint8_t oneShotCount = 0;
+  uint16_t oneShotLength = 0;              // Reply text in responseText
+  bool oneShotTimedOut = false;
+  bool oneShotInFlight = false;
+  bool oneShotReady = false;
+  bool periodicSinceOneShot = true;
+  unsigned long oneShotMaxDelay = 1000;   // Upper bound on one-shot timeout
+  unsigned long activeTimeout = 2000;     // Timeout of the request in flight
+  
+  // DTC state
+  DTCReport dtcReport;
+  DTCReport dtcPendingReport;
+  DTCChangeCallback dtcCallback = nullptr;
+  unsigned long dtcInterval = 30000;
+  unsigned long lastDTCRead = 0;
+  int8_t dtcStep = -1;               // DTCKind being read, -1 when idle
+  
+  // Voltage state
+  VoltageSource voltageSource = VOLTAGE_UNKNOWN;
+  unsigned long voltageInterval = 5000;
+  unsigned long lastVoltageRead = 0;
+  bool voltageInFlight = false;
+  bool voltageLow = false;
+  bool voltageSeen = false;
+  uint8_t voltageFailures = 0;
+  float lowVoltageThreshold = 11.8f;
+  VoltageCallback voltageCallback = nullptr;
+  void* voltageCallbackContext = nullptr;
+  
+  // Memory accounting
+  bool staticMemory = false;
+  uint32_t heapAtBegin = 0;
+  uint32_t heapAtConnect = 0;
+  uint32_t allocationsAtBegin = 0;
+  uint32_t allocationsAtConnect = 0;
+  volatile uint32_t rxDropped = 0;    // Bytes over the receive cap (BLE callback)
+  
   // Configuration
   String deviceName = "OBD2_Simulator_BLE";
   bool debugMode = true;
@@ -161,23 +611,97 @@ private:
   void resetCommandQueue();
   void printSystemInfo();
   void handleTimeout();
-  void processIncomingData(String data);
+  void applyRecovery(const ResponseClass& reply);
+  void queueAdapterReinit();
+  void checkLink();
+  void handleLinkLost();
+  void snapshotStatus(StatusSnapshot& out, bool consumeData);
+  void printOBDData(const StatusSnapshot& status);
+  void printStatistics(const StatusSnapshot& status);
+  void printConnectionState(const StatusSnapshot& status);
+  void processIncomingData(const String& data);
+  void dispatchReply(const char* text, unsigned int length);
+  void acceptReply(const ResponseClass& reply, bool adapterCommand, const char* text, unsigned int length);
+  bool isStaleReply(const ResponseClass& reply, const char* text, unsigned int length);
+  void holdReply(const char* text, unsigned int length);
+  void releaseHeldReply();
+  const OBDMessage* routeResponse(OBDCommand& cmd, OBDResponse& response);
+  bool decodeCommand(uint8_t slot, const OBDMessage* msg);
+  void recordECU(uint32_t id);
+  int8_t signalForTarget(const float* target);
+  float* signalField(OBDSignal signal);
+  void publishSignal(OBDSignal signal, float value, unsigned long requestTime);
+  void emitSignal(OBDSignal signal, float value);
+  void flushTelemetry();
+  void updateDerivedSignals();
+  bool selectDueCommand();
+  void updateResponseStats(unsigned long responseTime);
+  bool queueSetup(const char* command);
+  void queueECUFilter();
+  void queueHeader(uint32_t header);
+  uint32_t functionalHeader() const;
+  void queueTimingSetup();
+  void learnResponseCount(OBDCommand& cmd);
+  void resetResponseCounts();
+  void completeOneShot(bool timedOut);
+  size_t buildPollRequest(uint8_t slot, char* out, size_t outSize);
+  void handleIdentification(const OneShotResult& result);
+  static void onIdentifyResponse(const OneShotResult& result, void* context);
+  void queueMonitorFilters();
+  void processMonitorFrames();
+  static void onCANSignal(uint8_t index, float value, void* context);
+  void handleMonitorData(const uint8_t* data, size_t length);
+  void handleDTCResponse(const OneShotResult& result);
+  static void onDTCResponse(const OneShotResult& result, void* context);
+  static void onDTCClearResponse(const OneShotResult& result, void* context);
+  void readVoltage();
+  void handleVoltageSupport(const OneShotResult& result);
+  void handleVoltageResponse(const OneShotResult& result);
+  void updateVoltage(float volts);
+  static void onVoltageSupport(const OneShotResult& result, void* context);
+  static void onVoltageResponse(const OneShotResult& result, void* context);
+  
+  // Callback dispatch: BLE callbacks carry no user context, so the owning
+  // instance is looked up by its client / characteristic pointer
+  static BLEOBDClient* instances[OBD_MAX_CLIENTS];
+  static uint8_t instanceCount;
+  static BLEOBDClient* fromBLEClient(BLEClient* client);
+  static BLEOBDClient* fromCharacteristic(BLERemoteCharacteristic* characteristic);
+  bool wantsDevice(BLEAdvertisedDevice& device, bool byName);
+  bool ownsAddress(BLEAdvertisedDevice& device) const;
+  
+  // Per-instance scheduler throttle
+  unsigned long lastCommandCheck = 0;
+  
+  // Threading: stateLock guards everything the public API touches. The BLE
+  // callbacks only append to rxPending and take profiler stamps (under
+  // rxLock, never held across a BLE call), or flag a lost link, and wake the
+  // poller; responses are framed and the link loss handled in service().
+  mutable OBDMutex stateLock;
+  OBDMutex rxLock;
+  String rxPending = "";
+  String rxDraining = "";            // Swapped with rxPending, framed unlocked (poller)
+  uint32_t rxFirstNotify = 0;        // Notifications since the last drain (rxLock)
+  uint32_t rxLastNotify = 0;
+  bool rxFirstByteStamped = false;   // Profiler stamps since the last drain (rxLock)
+  bool rxPromptStamped = false;
+  uint32_t rxFirstByteCycles = 0;
+  uint32_t rxPromptCycles = 0;
+  std::atomic<bool> linkLost{false}; // onDisconnect, handled in service()
+  OBDEvent pollerWake;
+  OBDThread pollerThread;
+  volatile bool pollerStop = false;
+  static void pollerEntry(void* self);
+  void drainIncoming();
   
   // Friend classes for callbacks
   friend class OBDClientCallbacks;
   friend class OBDScanCallbacks;
   friend void bleNotifyCallback(BLERemoteCharacteristic* pBLERemoteCharacteristic, 
                                uint8_t* pData, size_t length, bool isNotify);
-};
-
-// Global instance pointer for callbacks
-extern BLEOBDClient* g_bleClient;
-
-// BLE Client callbacks - using unique class names
-class OBDClientCallbacks : public BLEClientCallbacks {
-public:
-  void onConnect(BLEClient* pClient) override;
-  void onDisconnect(BLEClient* pClient) override;
+  
+  // Host tests and benchmarks (test/) reach single pipeline stages through this
+  friend class BLEOBDClientProbe;
 };
 
 // BLE Device scan callbacks - using unique class names
@@ -0,0 +1,176 @@
+#include "CANSignalDB.h"
+#include <string.h>
+
+#define CAN_BLOB_VERSION     1
+#define CAN_BLOB_RECORD_SIZE 15
+
+static inline uint8_t hashId(uint32_t id) {
+  return (uint8_t)((id ^ (id >> 6) ^ (id >> 12)) & (CAN_HASH_SIZE - 1));
+}
+
+int CANSignalDB::addSignal(uint32_t canId, uint8_t startBit, uint8_t length, uint8_t flags,
+                           float scale, float offset, float* target) {
+  if (signalCount >= CAN_MAX_SIGNALS || length == 0 || length > 64 || startBit > 63) return -1;
+
+  CANSignal& sig = signals[signalCount];
+  sig.canId = canId;
+  sig.startBit = startBit;
+  sig.length = length;
+  sig.flags = flags;
+  sig.scale = scale;
+  sig.offset = offset;
+  sig.target = target;
+  sig.value = 0.0f;
+  sig.index = signalCount;
+  dirty = true;
+  return signalCount++;
+}
+
+void CANSignalDB::clear() {
+  signalCount = 0;
+  messageCount = 0;
+  dirty = true;
+}
+
+static uint32_t readLE(const uint8_t* p, uint8_t bytes) {
+  uint32_t v = 0;
+  for (uint8_t i = 0; i < bytes; i++) {
+    v |= (uint32_t)p[i] << (8 * i);
+  }
+  return v;
+}
+
+int CANSignalDB::loadBlob(const uint8_t* blob, size_t length) {
+  if (length < 7 || memcmp(blob, "CDBC", 4) != 0 || blob[4] != CAN_BLOB_VERSION) return -1;
+
+  uint16_t count = (uint16_t)readLE(blob + 5, 2);
+  if (length < 7 + (size_t)count * CAN_BLOB_RECORD_SIZE) return -1;
+
+  int loaded = 0;
+  const uint8_t* p = blob + 7;
+  for (uint16_t i = 0; i < count; i++, p += CAN_BLOB_RECORD_SIZE) {
+    float scale, offset;
+    uint32_t bits = readLE(p + 7, 4);
+    memcpy(&scale, &bits, sizeof(scale));
+    bits = readLE(p + 11, 4);
+    memcpy(&offset, &bits, sizeof(offset));
+
+    if (addSignal(readLE(p, 4), p[4], p[5], p[6], scale, offset) < 0) break;
+    loaded++;
+  }
+  return loaded;
+}
+
+// Group signals by CAN ID, precompute shift/mask and build the ID hash
+void CANSignalDB::finalize() {
+  dirty = false;
+
+  // Stable insertion sort by CAN ID (signal counts are small)
+  for (uint8_t i = 1; i < signalCount; i++) {
+    CANSignal sig = signals[i];
+    uint8_t slot = i;
+    while (slot > 0 && signals[slot - 1].canId > sig.canId) {
+      signals[slot] = signals[slot - 1];
+      slot--;
+    }
+    signals[slot] = sig;
+  }
+
+  messageCount = 0;
+  memset(hashTable, -1, sizeof(hashTable));
+
+  for (uint8_t i = 0; i < signalCount; i++) {
+    CANSignal& sig = signals[i];
+
+    if (messageCount == 0 || messages[messageCount - 1].id != sig.canId) {
+      if (messageCount >= CAN_MAX_MESSAGES) {
+        sig.minDlc = 0xFF; // Out of message slots: never decoded
+        continue;
+      }
+      messages[messageCount].id = sig.canId;
+      messages[messageCount].firstSignal = i;
+      messages[messageCount].signalCount = 0;
+
+      uint8_t h = hashId(sig.canId);
+      while (hashTable[h] >= 0) h = (h + 1) & (CAN_HASH_SIZE - 1);
+      hashTable[h] = messageCount;
+      messageCount++;
+    }
+    messages[messageCount - 1].signalCount++;
+
+    sig.mask = (sig.length == 64) ? ~0ull : ((1ull << sig.length) - 1);
+
+    uint8_t lastBit;
+    if (sig.flags & CAN_SIGNAL_LITTLE_ENDIAN) {
+      // Intel: frame read as a little-endian u64, startBit is the LSB
+      sig.shift = sig.startBit;
+      lastBit = sig.startBit + sig.length - 1;
+    } else {
+      // Motorola: frame read as a big-endian u64, startBit is the MSB in
+      // DBC sawtooth numbering
+      uint8_t msbLinear = (sig.startBit / 8) * 8 + (7 - sig.startBit % 8);
+      uint8_t lsbLinear = msbLinear + sig.length - 1;
+      sig.shift = 63 - lsbLinear;
+      lastBit = lsbLinear;
+    }
+    sig.minDlc = lastBit / 8 + 1;
+  }
+
+  // Keep the public index stable: signals[] was reordered
+  for (uint8_t i = 0; i < signalCount; i++) {
+    order[signals[i].index] = i;
+  }
+}
+
+int CANSignalDB::findMessage(uint32_t id) const {
+  uint8_t h = hashId(id);
+  for (uint8_t probes = 0; probes < CAN_HASH_SIZE; probes++) {
+    int8_t entry = hashTable[h];
+    if (entry < 0) return -1;
+    if (messages[entry].id == id) return entry;
+    h = (h + 1) & (CAN_HASH_SIZE - 1);
+  }
+  return -1;
+}
+
+uint8_t CANSignalDB::decodeFrame(const CANFrame& frame, CANSignalCallback callback, void* context) {
+  if (dirty) finalize();
+
+  int m = findMessage(frame.id);
+  if (m < 0) {
+    unknownFrames++;
+    return 0;
+  }
+
+  // Load the payload once in both byte orders
+  uint64_t little = 0, big = 0;
+  for (uint8_t i = 0; i < 8; i++) {
+    uint8_t b = i < frame.dlc ? frame.data[i] : 0;
+    little |= (uint64_t)b << (8 * i);
+    big = (big << 8) | b;
+  }
+
+  const MessageEntry& msg = messages[m];
+  uint8_t updated = 0;
+  for (uint8_t i = msg.firstSignal; i < msg.firstSignal + msg.signalCount; i++) {
+    CANSignal& sig = signals[i];
+    if (frame.dlc < sig.minDlc) continue;
+
+    uint64_t raw = (((sig.flags & CAN_SIGNAL_LITTLE_ENDIAN) ? little : big) >> sig.shift) & sig.mask;
+
+    float physical;
+    if ((sig.flags & CAN_SIGNAL_SIGNED) && sig.length < 64 && (raw >> (sig.length - 1)) & 1) {
+      physical = (float)((int64_t)raw - (int64_t)(1ull << sig.length));
+    } else {
+      physical = (float)raw;
+    }
+
+    sig.value = physical * sig.scale + sig.offset;
+    if (sig.target) *sig.target = sig.value;
+    if (callback) callback(sig.index, sig.value, context);
+    updated++;
+  }
+
+  decodedSignals += updated;
+  return updated;
+}
@@ -0,0 +1,85 @@
+#ifndef CAN_SIGNAL_DB_H
+#define CAN_SIGNAL_DB_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "OBDMonitor.h"
+
+#define CAN_MAX_SIGNALS   64
+#define CAN_MAX_MESSAGES  32
+#define CAN_HASH_SIZE     64    // Power of two, > 2 * CAN_MAX_MESSAGES for short probes
+
+// Signal flags
+#define CAN_SIGNAL_LITTLE_ENDIAN 0x01   // Intel byte order (DBC "@1"), otherwise Motorola ("@0")
+#define CAN_SIGNAL_SIGNED        0x02   // DBC "-"
+
+// One signal inside a broadcast frame, DBC conventions for startBit
+struct CANSignal {
+  uint32_t canId;
+  uint8_t startBit;
+  uint8_t length;        // 1..64
+  uint8_t flags;
+  float scale;
+  float offset;
+  float* target;         // Optional external destination
+  float value;           // Last decoded physical value
+  uint8_t index;         // Position in addSignal()/blob order
+
+  // Precomputed by finalize()
+  uint8_t shift;
+  uint8_t minDlc;
+  uint64_t mask;
+};
+
+// Called by decodeFrame() for each signal it updated (index as returned
+// by addSignal() / blob record order)
+typedef void (*CANSignalCallback)(uint8_t index, float value, void* context);
+
+// Compact signal database: CAN ID -> signals, decoded one frame per pass.
+//
+// Blob format ("CDBC", version 1, little-endian):
+//   "CDBC" u8 version, u16 count, then count records of 15 bytes:
+//   u32 canId, u8 startBit, u8 length, u8 flags, f32 scale, f32 offset
+// Generated from a .dbc file by tools/dbc2blob.py; signal index = record order.
+class CANSignalDB {
+public:
+  int addSignal(uint32_t canId, uint8_t startBit, uint8_t length, uint8_t flags,
+                float scale, float offset, float* target = nullptr);
+  int loadBlob(const uint8_t* blob, size_t length);
+  void clear();
+
+  // Decode every signal carried by the frame; returns how many were updated
+  uint8_t decodeFrame(const CANFrame& frame, CANSignalCallback callback = nullptr,
+                      void* context = nullptr);
+
+  float getValue(uint8_t index) const {
+    return (index < signalCount && !dirty) ? signals[order[index]].value : 0.0f;
+  }
+  uint8_t getSignalCount() const { return signalCount; }
+  uint8_t getMessageCount() const { return messageCount; }
+  uint32_t getDecodedSignals() const { return decodedSignals; }
+  uint32_t getUnknownFrames() const { return unknownFrames; }
+
+private:
+  struct MessageEntry {
+    uint32_t id;
+    uint8_t firstSignal;
+    uint8_t signalCount;
+  };
+
+  void finalize();
+  int findMessage(uint32_t id) const;
+
+  CANSignal signals[CAN_MAX_SIGNALS];     // Grouped by CAN ID after finalize()
+  uint8_t order[CAN_MAX_SIGNALS];         // Signal index -> slot in signals[]
+  uint8_t signalCount = 0;
+  MessageEntry messages[CAN_MAX_MESSAGES];
+  uint8_t messageCount = 0;
+  int8_t hashTable[CAN_HASH_SIZE];        // CAN ID hash -> message, -1 = empty
+  bool dirty = false;
+
+  uint32_t decodedSignals = 0;
+  uint32_t unknownFrames = 0;
+};
+
+#endif // CAN_SIGNAL_DB_H
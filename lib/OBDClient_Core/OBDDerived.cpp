@@ -0,0 +1,149 @@
+#include "OBDDerived.h"
+
+bool DerivedEngine::add(OBDSignal output, uint32_t inputs, DerivedFunction compute, void* state) {
+  if (defCount >= OBD_MAX_DERIVED || output >= SIGNAL_COUNT || !compute) return false;
+  if (inputs & SIGNAL_BIT(output)) return false;
+
+  DerivedSignal& def = defs[defCount++];
+  def.output = output;
+  def.inputs = inputs;
+  def.compute = compute;
+  def.state = state;
+  sortByDependencies();
+  return true;
+}
+
+void DerivedEngine::clear() {
+  defCount = 0;
+  seen = 0;
+  dirty = 0;
+}
+
+// Order definitions so each one comes after every definition producing one
+// of its inputs. Definitions caught in a cycle keep their relative order.
+void DerivedEngine::sortByDependencies() {
+  DerivedSignal sorted[OBD_MAX_DERIVED];
+  bool placed[OBD_MAX_DERIVED] = {};
+  uint8_t count = 0;
+
+  while (count < defCount) {
+    uint32_t unplacedOutputs = 0;
+    for (uint8_t i = 0; i < defCount; i++) {
+      if (!placed[i]) unplacedOutputs |= SIGNAL_BIT(defs[i].output);
+    }
+
+    bool progress = false;
+    for (uint8_t i = 0; i < defCount; i++) {
+      if (placed[i] || (defs[i].inputs & unplacedOutputs)) continue;
+      sorted[count++] = defs[i];
+      placed[i] = true;
+      progress = true;
+    }
+
+    if (!progress) {
+      for (uint8_t i = 0; i < defCount; i++) {
+        if (!placed[i]) sorted[count++] = defs[i];
+      }
+    }
+  }
+
+  for (uint8_t i = 0; i < defCount; i++) defs[i] = sorted[i];
+}
+
+uint32_t DerivedEngine::getInputs(OBDSignal output) const {
+  for (uint8_t i = 0; i < defCount; i++) {
+    if (defs[i].output == output) return defs[i].inputs;
+  }
+  return 0;
+}
+
+void DerivedEngine::set(OBDSignal signal, float value) {
+  if (signal >= SIGNAL_COUNT) return;
+  values[signal] = value;
+  seen |= SIGNAL_BIT(signal);
+  dirty |= SIGNAL_BIT(signal);
+}
+
+uint32_t DerivedEngine::update(uint32_t now) {
+  uint32_t changed = 0;
+  if (!dirty) return 0;
+
+  for (uint8_t i = 0; i < defCount; i++) {
+    DerivedSignal& def = defs[i];
+    if (!(def.inputs & dirty) || (def.inputs & seen) != def.inputs) continue;
+
+    float result;
+    evaluations++;
+    if (!def.compute(values, now, def.state, &result)) continue;
+
+    uint32_t bit = SIGNAL_BIT(def.output);
+    if (result != values[def.output] || !(seen & bit)) {
+      values[def.output] = result;
+      seen |= bit;
+      dirty |= bit;       // Later definitions see the new value
+      changed |= bit;
+    }
+  }
+
+  dirty = 0;
+  return changed;
+}
+
+// Standard definitions
+
+static bool computeBoost(const float* v, uint32_t, void*, float* out) {
+  *out = v[SIGNAL_MANIFOLD_PRESSURE] - v[SIGNAL_BARO_PRESSURE];
+  return true;
+}
+
+static bool computeEngineRunning(const float* v, uint32_t, void*, float* out) {
+  *out = v[SIGNAL_RPM] > OBD_RUNNING_RPM ? 1.0f : 0.0f;
+  return true;
+}
+
+static bool computeFuelRate(const float* v, uint32_t, void*, float* out) {
+  // g/s of air -> L/h of fuel
+  *out = v[SIGNAL_AIRFLOW] * 3600.0f / (OBD_STOICH_AFR * OBD_FUEL_DENSITY);
+  return true;
+}
+
+static bool computeFuelEconomy(const float* v, uint32_t, void*, float* out) {
+  float speed = v[SIGNAL_SPEED];
+  *out = speed > 1.0f ? v[SIGNAL_FUEL_RATE] * 100.0f / speed : 0.0f;
+  return true;
+}
+
+// Rectangle rule over the time since the previous sample of the rate input
+static float integrate(float rate, uint32_t now, uint32_t& lastTime) {
+  uint32_t dt = lastTime ? now - lastTime : 0;
+  lastTime = now;
+  if (dt > OBD_MAX_INTEGRATE_MS) return 0.0f;
+  return rate * dt / 3600000.0f;   // rate per hour -> amount
+}
+
+static bool computeTripDistance(const float* v, uint32_t now, void* state, float* out) {
+  TripState* trip = static_cast<TripState*>(state);
+  trip->distanceKm += integrate(v[SIGNAL_SPEED], now, trip->lastDistanceTime);
+  *out = trip->distanceKm;
+  return true;
+}
+
+static bool computeAverageEconomy(const float* v, uint32_t now, void* state, float* out) {
+  TripState* trip = static_cast<TripState*>(state);
+  trip->fuelLiters += integrate(v[SIGNAL_FUEL_RATE], now, trip->lastFuelTime);
+  if (trip->distanceKm < 0.1f) return false;
+  *out = trip->fuelLiters * 100.0f / trip->distanceKm;
+  return true;
+}
+
+void addStandardDerivedSignals(DerivedEngine& engine, TripState& trip) {
+  engine.add(SIGNAL_BOOST, SIGNAL_BIT(SIGNAL_MANIFOLD_PRESSURE) | SIGNAL_BIT(SIGNAL_BARO_PRESSURE),
+             computeBoost);
+  engine.add(SIGNAL_ENGINE_RUNNING, SIGNAL_BIT(SIGNAL_RPM), computeEngineRunning);
+  engine.add(SIGNAL_FUEL_RATE, SIGNAL_BIT(SIGNAL_AIRFLOW), computeFuelRate);
+  engine.add(SIGNAL_FUEL_ECONOMY, SIGNAL_BIT(SIGNAL_FUEL_RATE) | SIGNAL_BIT(SIGNAL_SPEED),
+             computeFuelEconomy);
+  engine.add(SIGNAL_TRIP_DISTANCE, SIGNAL_BIT(SIGNAL_SPEED), computeTripDistance, &trip);
+  engine.add(SIGNAL_AVG_FUEL_ECONOMY, SIGNAL_BIT(SIGNAL_FUEL_RATE) | SIGNAL_BIT(SIGNAL_TRIP_DISTANCE),
+             computeAverageEconomy, &trip);
+}
@@ -0,0 +1,69 @@
+#ifndef OBD_DERIVED_H
+#define OBD_DERIVED_H
+
+#include <stdint.h>
+#include "OBDSubscription.h"
+
+#define OBD_MAX_DERIVED 12
+#define SIGNAL_BIT(s) (1u << (s))
+
+// Gasoline defaults for MAF based fuel flow
+#define OBD_STOICH_AFR        14.7f    // Air/fuel mass ratio
+#define OBD_FUEL_DENSITY      740.0f   // g/L
+#define OBD_RUNNING_RPM       400.0f   // Engine counts as running above this
+#define OBD_MAX_INTEGRATE_MS  5000     // Longer sample gaps are not integrated
+
+// Computes one output from the current signal values; return false to leave
+// the output unchanged (e.g. an input has not been seen yet)
+typedef bool (*DerivedFunction)(const float* values, uint32_t now, void* state, float* out);
+
+struct DerivedSignal {
+  uint8_t output;            // OBDSignal
+  uint32_t inputs;           // Bit per input OBDSignal
+  DerivedFunction compute;
+  void* state;
+};
+
+// Incremental evaluation: set() marks a base signal dirty, update() runs only
+// the definitions whose inputs changed, in dependency order, so an output
+// feeding another definition is recomputed before it. No allocation.
+class DerivedEngine {
+public:
+  // Returns false when full or when the output would depend on itself
+  bool add(OBDSignal output, uint32_t inputs, DerivedFunction compute, void* state = nullptr);
+  void clear();
+
+  void set(OBDSignal signal, float value);
+  uint32_t update(uint32_t now);    // Returns a bit per output that changed
+
+  float get(OBDSignal signal) const { return signal < SIGNAL_COUNT ? values[signal] : 0.0f; }
+  bool has(OBDSignal signal) const { return signal < SIGNAL_COUNT && (seen & (1u << signal)); }
+  const float* getValues() const { return values; }
+  uint32_t getInputs(OBDSignal output) const;    // 0 when output is not derived
+  uint32_t getEvaluations() const { return evaluations; }
+
+private:
+  void sortByDependencies();
+
+  DerivedSignal defs[OBD_MAX_DERIVED];
+  uint8_t defCount = 0;
+  float values[SIGNAL_COUNT] = {};
+  uint32_t seen = 0;
+  uint32_t dirty = 0;
+  uint32_t evaluations = 0;
+};
+
+// Trip integrators (distance and fuel used since resetTrip)
+struct TripState {
+  float distanceKm = 0.0f;
+  float fuelLiters = 0.0f;
+  uint32_t lastDistanceTime = 0;
+  uint32_t lastFuelTime = 0;
+
+  void reset() { *this = TripState(); }
+};
+
+// Boost, fuel rate/economy, trip distance, average economy and engine running
+void addStandardDerivedSignals(DerivedEngine& engine, TripState& trip);
+
+#endif // OBD_DERIVED_H
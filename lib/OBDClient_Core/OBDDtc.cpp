@@ -0,0 +1,79 @@
+#include "OBDDtc.h"
+
+static const uint8_t dtcModes[DTC_KIND_COUNT] = { 0x43, 0x47, 0x4A };
+static const char* const dtcRequests[DTC_KIND_COUNT] = { "03", "07", "0A" };
+
+const char* dtcRequest(DTCKind kind) {
+  return dtcRequests[kind];
+}
+
+void formatDTC(DTCCode code, char* out) {
+  static const char systems[] = { 'P', 'C', 'B', 'U' };
+  static const char hexDigits[] = "0123456789ABCDEF";
+
+  out[0] = systems[code >> 14];
+  out[1] = '0' + ((code >> 12) & 0x03);
+  out[2] = hexDigits[(code >> 8) & 0x0F];
+  out[3] = hexDigits[(code >> 4) & 0x0F];
+  out[4] = hexDigits[code & 0x0F];
+  out[5] = '\0';
+}
+
+bool DTCSet::contains(DTCCode code) const {
+  for (uint8_t i = 0; i < count; i++) {
+    if (codes[i] == code) return true;
+  }
+  return false;
+}
+
+bool DTCSet::add(DTCCode code) {
+  if (code == 0 || contains(code)) return true;  // 0000 is padding
+  if (count >= OBD_MAX_DTCS) return false;
+  codes[count++] = code;
+  return true;
+}
+
+// Order-insensitive: ECUs may answer in a different order each time
+bool DTCSet::operator==(const DTCSet& other) const {
+  if (count != other.count) return false;
+  for (uint8_t i = 0; i < count; i++) {
+    if (!other.contains(codes[i])) return false;
+  }
+  return true;
+}
+
+bool decodeDTCs(const OBDResponse& response, DTCKind kind, DTCSet& out) {
+  uint8_t mode = dtcModes[kind];
+  bool answered = false;
+
+  for (uint8_t m = 0; m < response.messageCount; m++) {
+    const OBDMessage& msg = response.messages[m];
+    if (msg.length < 1 || msg.data[0] != mode) continue;
+    answered = true;
+
+    bool can = msg.headerType == OBD_HEADER_CAN_11BIT || msg.headerType == OBD_HEADER_CAN_29BIT;
+    if (msg.headerType == OBD_HEADER_NONE) {
+      // Headers off: only the layout can tell the two forms apart
+      can = msg.length >= 2 && msg.length == 2 + msg.data[1] * 2;
+    }
+
+    if (can) {
+      // CAN: 43 <count> <A B>...
+      if (msg.length < 2) continue;
+      size_t end = 2 + (size_t)msg.data[1] * 2;
+      if (end > msg.length) end = msg.length;
+      for (size_t i = 2; i + 1 < end; i += 2) {
+        out.add((DTCCode)((msg.data[i] << 8) | msg.data[i + 1]));
+      }
+    } else {
+      // Legacy: each line is 43 + three pairs, lines appended back to back
+      for (uint8_t line = 0; line < msg.length; line += 7) {
+        for (uint8_t i = line + 1; i + 1 < msg.length && i < line + 7; i += 2) {
+          out.add((DTCCode)((msg.data[i] << 8) | msg.data[i + 1]));
+        }
+      }
+    }
+  }
+
+  return answered;
+}
@@ -0,0 +1,52 @@
+#ifndef OBD_DTC_H
+#define OBD_DTC_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "OBDResponse.h"
+
+#define OBD_MAX_DTCS 32
+
+// Compact DTC: the two raw bytes from the ECU.
+// Bits 15-14 = system (P/C/B/U), bits 13-12 = first digit, then three hex digits.
+typedef uint16_t DTCCode;
+
+enum DTCKind {
+  DTC_STORED = 0,     // Mode 03
+  DTC_PENDING,        // Mode 07
+  DTC_PERMANENT,      // Mode 0A
+  DTC_KIND_COUNT
+};
+
+struct DTCSet {
+  uint8_t count = 0;
+  DTCCode codes[OBD_MAX_DTCS];
+
+  bool contains(DTCCode code) const;
+  bool add(DTCCode code);
+  bool operator==(const DTCSet& other) const;
+  bool operator!=(const DTCSet& other) const { return !(*this == other); }
+};
+
+struct DTCReport {
+  DTCSet sets[DTC_KIND_COUNT];
+  unsigned long lastRead = 0;
+
+  const DTCSet& stored() const { return sets[DTC_STORED]; }
+  const DTCSet& pending() const { return sets[DTC_PENDING]; }
+  const DTCSet& permanent() const { return sets[DTC_PERMANENT]; }
+};
+
+// Request mode for a DTC kind ("03", "07", "0A")
+const char* dtcRequest(DTCKind kind);
+
+// Write "P0301" style text (5 chars + terminator); out needs 6 bytes
+void formatDTC(DTCCode code, char* out);
+
+// Add every code found in an OBD response (all ECUs) to the set.
+// Each message's header type picks the CAN form (mode, count, pairs) or
+// the legacy form (mode byte repeated every 7 bytes). Returns false if no
+// ECU answered with the expected mode.
+bool decodeDTCs(const OBDResponse& response, DTCKind kind, DTCSet& out);
+
+#endif // OBD_DTC_H
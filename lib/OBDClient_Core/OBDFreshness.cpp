@@ -0,0 +1,123 @@
+#include "OBDFreshness.h"
+#include <stdio.h>
+#include <string.h>
+
+static const uint32_t bucketEdges[FRESHNESS_BUCKETS - 1] = {
+  10, 20, 50, 100, 200, 500, 1000, 2000, 5000
+};
+
+void FreshnessHistogram::add(uint32_t ageMs) {
+  uint8_t bucket = 0;
+  while (bucket < FRESHNESS_BUCKETS - 1 && ageMs > bucketEdges[bucket]) bucket++;
+  buckets[bucket]++;
+  count++;
+  sum += ageMs;
+  if (ageMs > max) max = ageMs;
+}
+
+uint32_t FreshnessHistogram::percentile(uint8_t percent) const {
+  if (count == 0) return 0;
+  uint32_t wanted = (uint32_t)(((uint64_t)count * percent + 99) / 100);
+  uint32_t seenCount = 0;
+  for (uint8_t i = 0; i < FRESHNESS_BUCKETS - 1; i++) {
+    seenCount += buckets[i];
+    if (seenCount >= wanted) return bucketEdges[i] < max ? bucketEdges[i] : max;
+  }
+  return max;
+}
+
+FreshnessTracker::FreshnessTracker() {
+  reset();
+}
+
+void FreshnessTracker::reset() {
+  memset(sampleTime, 0, sizeof(sampleTime));
+  memset(lastUpdate, 0, sizeof(lastUpdate));
+  memset(interval, 0, sizeof(interval));
+  memset(signals, 0, sizeof(signals));
+  memset(consumers, 0, sizeof(consumers));
+  seen = 0;
+}
+
+void FreshnessTracker::update(OBDSignal signal, uint32_t time, uint32_t now) {
+  uint32_t bit = 1u << signal;
+  if (seen & bit) {
+    float gap = (float)(now - lastUpdate[signal]);
+    interval[signal] = interval[signal] > 0.0f ? interval[signal] + (gap - interval[signal]) / 8.0f : gap;
+  }
+  sampleTime[signal] = time;
+  lastUpdate[signal] = now;
+  seen |= bit;
+}
+
+void FreshnessTracker::sampled(OBDSignal signal, uint32_t requestTime, uint32_t now) {
+  if (signal >= SIGNAL_COUNT) return;
+  update(signal, requestTime, now);
+}
+
+void FreshnessTracker::derived(OBDSignal signal, uint32_t inputs, uint32_t now) {
+  if (signal >= SIGNAL_COUNT) return;
+
+  // Oldest input decides how fresh the derived value is
+  uint32_t oldestAge = 0;
+  uint32_t oldest = now;
+  for (uint32_t bits = inputs & seen; bits; bits &= bits - 1) {
+    uint8_t input = __builtin_ctz(bits);
+    uint32_t age = now - sampleTime[input];
+    if (age >= oldestAge) {
+      oldestAge = age;
+      oldest = sampleTime[input];
+    }
+  }
+  update(signal, oldest, now);
+}
+
+int FreshnessTracker::addConsumer(const char* name) {
+  if (consumerCount >= OBD_MAX_CONSUMERS) return -1;
+  consumerNames[consumerCount] = name;
+  return consumerCount++;
+}
+
+void FreshnessTracker::consumed(int consumer, uint32_t signalMask, uint32_t now) {
+  bool known = consumer >= 0 && consumer < consumerCount;
+
+  for (uint32_t bits = signalMask & seen; bits; bits &= bits - 1) {
+    uint8_t signal = __builtin_ctz(bits);
+    uint32_t age = now - sampleTime[signal];
+    signals[signal].add(age);
+    if (known) consumers[consumer].add(age);
+  }
+}
+
+uint32_t FreshnessTracker::getAge(OBDSignal signal, uint32_t now) const {
+  if (signal >= SIGNAL_COUNT || !(seen & (1u << signal))) return 0;
+  return now - sampleTime[signal];
+}
+
+float FreshnessTracker::getRefreshHz(OBDSignal signal) const {
+  if (signal >= SIGNAL_COUNT || interval[signal] <= 0.0f) return 0.0f;
+  return 1000.0f / interval[signal];
+}
+
+size_t FreshnessTracker::report(char* out, size_t outSize) const {
+  size_t n = snprintf(out, outSize, "%-18s %7s %6s %6s %6s %6s %7s\n",
+                      "signal", "reads", "mean", "p50", "p90", "max", "Hz");
+
+  for (uint8_t i = 0; i < SIGNAL_COUNT && n < outSize; i++) {
+    if (!(seen & (1u << i))) continue;
+    const FreshnessHistogram& h = signals[i];
+    n += snprintf(out + n, outSize - n, "%-18s %7lu %6lu %6lu %6lu %6lu %7.2f\n",
+                  signalName((OBDSignal)i), (unsigned long)h.count, (unsigned long)h.mean(),
+                  (unsigned long)h.percentile(50), (unsigned long)h.percentile(90),
+                  (unsigned long)h.max, getRefreshHz((OBDSignal)i));
+  }
+
+  for (uint8_t i = 0; i < consumerCount && n < outSize; i++) {
+    const FreshnessHistogram& h = consumers[i];
+    n += snprintf(out + n, outSize - n, "consumer %-9s %7lu %6lu %6lu %6lu %6lu\n",
+                  consumerNames[i], (unsigned long)h.count, (unsigned long)h.mean(),
+                  (unsigned long)h.percentile(50), (unsigned long)h.percentile(90),
+                  (unsigned long)h.max);
+  }
+  return n < outSize ? n : outSize - 1;
+}
@@ -0,0 +1,67 @@
+#ifndef OBD_FRESHNESS_H
+#define OBD_FRESHNESS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "OBDSubscription.h"
+
+#define OBD_MAX_CONSUMERS   4
+#define FRESHNESS_BUCKETS   10
+
+// Signal mask covering every OBDSignal
+#define FRESHNESS_ALL_SIGNALS ((1u << SIGNAL_COUNT) - 1)
+
+// Age histogram with fixed millisecond edges: 10, 20, 50, 100, 200, 500,
+// 1000, 2000, 5000, and everything above
+struct FreshnessHistogram {
+  uint32_t count;
+  uint64_t sum;
+  uint32_t max;
+  uint32_t buckets[FRESHNESS_BUCKETS];
+
+  void add(uint32_t ageMs);
+  uint32_t mean() const { return count ? (uint32_t)(sum / count) : 0; }
+  uint32_t percentile(uint8_t percent) const;   // Upper edge of the bucket
+};
+
+// End-to-end freshness: how old a value was, measured from the moment its
+// request was sent, when a consumer read it. Derived signals inherit the
+// oldest sample time of their inputs.
+class FreshnessTracker {
+public:
+  FreshnessTracker();
+
+  // A signal got a new value from a request sent at requestTime
+  void sampled(OBDSignal signal, uint32_t requestTime, uint32_t now);
+  void derived(OBDSignal signal, uint32_t inputs, uint32_t now);
+
+  // Returns a consumer id, -1 when full; name must outlive the tracker
+  int addConsumer(const char* name);
+  // A consumer read a snapshot holding the signals in signalMask
+  void consumed(int consumer, uint32_t signalMask, uint32_t now);
+  void reset();
+
+  uint32_t getAge(OBDSignal signal, uint32_t now) const;
+  float getRefreshHz(OBDSignal signal) const;
+  const FreshnessHistogram& getSignalHistogram(OBDSignal signal) const { return signals[signal]; }
+  const FreshnessHistogram& getConsumerHistogram(uint8_t consumer) const { return consumers[consumer]; }
+  uint8_t getConsumerCount() const { return consumerCount; }
+
+  // Per-signal and per-consumer table (ms, Hz) into out
+  size_t report(char* out, size_t outSize) const;
+
+private:
+  void update(OBDSignal signal, uint32_t sampleTime, uint32_t now);
+
+  uint32_t sampleTime[SIGNAL_COUNT];
+  uint32_t lastUpdate[SIGNAL_COUNT];
+  float interval[SIGNAL_COUNT];       // Smoothed time between updates (ms)
+  uint32_t seen = 0;                  // Bit per signal with a sample
+
+  FreshnessHistogram signals[SIGNAL_COUNT];
+  FreshnessHistogram consumers[OBD_MAX_CONSUMERS];
+  const char* consumerNames[OBD_MAX_CONSUMERS];
+  uint8_t consumerCount = 0;
+};
+
+#endif // OBD_FRESHNESS_H
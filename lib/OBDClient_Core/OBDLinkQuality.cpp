@@ -0,0 +1,132 @@
+#include "OBDLinkQuality.h"
+
+const char* linkLevelName(LinkLevel level) {
+  switch (level) {
+    case LINK_GOOD:     return "good";
+    case LINK_DEGRADED: return "degraded";
+    case LINK_POOR:     return "poor";
+  }
+  return "unknown";
+}
+
+void LinkQualityMonitor::reset(uint32_t now) {
+  rssiAverage = 0.0f;
+  gapAverage = 0.0f;
+  timeoutRate = 0.0f;
+  rssiSeen = false;
+  gapSeen = false;
+  awaiting = false;
+  lastActivity = now;
+  currentGap = 0;
+  low = false;
+  lowSince = 0;
+  reconnectRequested = false;
+
+  // Totals survive a reconnect; the live picture starts over
+  quality.rssi = 0;
+  quality.replyGap = 0;
+  quality.timeoutBurst = 0;
+  quality.level = LINK_GOOD;
+  update();
+}
+
+void LinkQualityMonitor::rssiSample(int rssi) {
+  if (rssi >= 0 || rssi < -127) return;   // Not a reading
+  rssiAverage = rssiSeen ? rssiAverage + ((float)rssi - rssiAverage) / 4.0f : (float)rssi;
+  rssiSeen = true;
+  quality.rssi = (int8_t)(rssiAverage - 0.5f);
+  update();
+}
+
+void LinkQualityMonitor::requestSent(uint32_t now) {
+  awaiting = true;
+  lastActivity = now;
+  currentGap = 0;
+}
+
+void LinkQualityMonitor::notified(uint32_t now) {
+  if (!awaiting) return;
+  uint32_t gap = now - lastActivity;
+  if (gap > currentGap) currentGap = gap;
+  lastActivity = now;
+}
+
+void LinkQualityMonitor::replyComplete() {
+  if (!awaiting) return;
+  awaiting = false;
+
+  gapAverage = gapSeen ? gapAverage + ((float)currentGap - gapAverage) / 4.0f : (float)currentGap;
+  gapSeen = true;
+  quality.replyGap = (uint32_t)gapAverage;
+  if (currentGap > quality.maxReplyGap) quality.maxReplyGap = currentGap;
+
+  timeoutRate -= timeoutRate / 8.0f;
+  quality.timeoutBurst = 0;
+  update();
+}
+
+void LinkQualityMonitor::timedOut() {
+  awaiting = false;
+  quality.timeouts++;
+  if (quality.timeoutBurst < 255) quality.timeoutBurst++;
+  if (quality.timeoutBurst > quality.maxTimeoutBurst) quality.maxTimeoutBurst = quality.timeoutBurst;
+  timeoutRate += (1.0f - timeoutRate) / 8.0f;
+  update();
+}
+
+bool LinkQualityMonitor::shouldReconnect(uint32_t now) {
+  if (reconnectHold == 0) return false;
+  if (quality.score >= reconnectScore) {
+    low = false;
+    return false;
+  }
+  if (!low) {
+    low = true;
+    lowSince = now;
+  }
+  if (reconnectRequested || now - lowSince < reconnectHold) return false;
+  reconnectRequested = true;
+  quality.reconnects++;
+  return true;
+}
+
+// 100 at good, 0 at poor, linear in between (works for either direction)
+uint8_t LinkQualityMonitor::scale(float value, float good, float poor) {
+  if (good == poor) return value == good ? 100 : 0;
+  float t = (value - poor) / (good - poor);
+  if (t <= 0.0f) return 0;
+  if (t >= 1.0f) return 100;
+  return (uint8_t)(t * 100.0f + 0.5f);
+}
+
+void LinkQualityMonitor::update() {
+  quality.rssiScore = rssiSeen ? scale(rssiAverage, rssiGood, rssiPoor) : 100;
+  quality.gapScore = gapSeen ? scale(gapAverage, (float)gapGood, (float)gapPoor) : 100;
+  quality.timeoutScore = scale(timeoutRate, 0.0f, 0.5f);
+
+  int score = (3 * quality.rssiScore + 3 * quality.gapScore + 4 * quality.timeoutScore) / 10;
+
+  // Back-to-back timeouts mean the link (or adapter) has stopped answering
+  int burstCap = 100 - 30 * (int)quality.timeoutBurst;
+  if (score > burstCap) score = burstCap > 0 ? burstCap : 0;
+  quality.score = (uint8_t)score;
+
+  // Enter a level below its threshold, leave it 10 points above
+  switch (quality.level) {
+    case LINK_GOOD:
+      if (score < poorScore) quality.level = LINK_POOR;
+      else if (score < degradedScore) quality.level = LINK_DEGRADED;
+      break;
+    case LINK_DEGRADED:
+      if (score < poorScore) quality.level = LINK_POOR;
+      else if (score >= degradedScore + 10) quality.level = LINK_GOOD;
+      break;
+    case LINK_POOR:
+      if (score >= degradedScore + 10) quality.level = LINK_GOOD;
+      else if (score >= poorScore + 10) quality.level = LINK_DEGRADED;
+      break;
+  }
+
+  quality.pollSpacing = quality.level == LINK_POOR ? poorSpacing :
+                        quality.level == LINK_DEGRADED ? degradedSpacing : 0;
+}
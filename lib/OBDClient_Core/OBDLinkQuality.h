@@ -0,0 +1,94 @@
+#ifndef OBD_LINK_QUALITY_H
+#define OBD_LINK_QUALITY_H
+
+#include <stdint.h>
+
+enum LinkLevel {
+  LINK_GOOD,
+  LINK_DEGRADED,       // Polls are spaced out
+  LINK_POOR            // Polls spaced further; reconnect if it stays this bad
+};
+
+const char* linkLevelName(LinkLevel level);
+
+// Link quality snapshot for the statistics API
+struct LinkQuality {
+  uint8_t score = 100;            // 0 (unusable) .. 100
+  LinkLevel level = LINK_GOOD;
+  int8_t rssi = 0;                // Smoothed dBm, 0 before the first sample
+  uint8_t rssiScore = 100;
+  uint8_t gapScore = 100;
+  uint8_t timeoutScore = 100;
+  uint32_t replyGap = 0;          // Smoothed longest silence within a reply (ms)
+  uint32_t maxReplyGap = 0;
+  uint32_t timeouts = 0;
+  uint8_t timeoutBurst = 0;       // Consecutive timeouts right now
+  uint8_t maxTimeoutBurst = 0;
+  uint32_t pollSpacing = 0;       // Minimum time between periodic polls (ms)
+  uint32_t reconnects = 0;        // Controlled reconnects requested by the monitor
+};
+
+// Scores the link from three inputs the client already sees: RSSI samples,
+// silences between notifications while a reply is outstanding, and request
+// timeouts. Each maps to 0..100; the score is their weighted mean, capped
+// by the current timeout burst. Pure bookkeeping with caller timestamps, so
+// it runs unchanged on a host.
+class LinkQualityMonitor {
+public:
+  LinkQualityMonitor() { reset(0); }
+
+  // RSSI (dBm) and reply gap (ms) mapped linearly onto 100..0 between good and poor
+  void setRssiRange(int8_t good, int8_t poor) { rssiGood = good; rssiPoor = poor; }
+  void setGapRange(uint32_t good, uint32_t poor) { gapGood = good; gapPoor = poor; }
+  // Score below which the link is degraded / poor (leaves 10 points higher)
+  void setLevels(uint8_t degradedBelow, uint8_t poorBelow) { degradedScore = degradedBelow; poorScore = poorBelow; }
+  // Minimum time between periodic polls per level
+  void setThrottle(uint32_t degradedMs, uint32_t poorMs) { degradedSpacing = degradedMs; poorSpacing = poorMs; }
+  // Reconnect once the score stays below belowScore for holdMs (0 = never)
+  void setReconnect(uint8_t belowScore, uint32_t holdMs) { reconnectScore = belowScore; reconnectHold = holdMs; }
+
+  void reset(uint32_t now);               // New connection: history cleared, counters kept
+  void rssiSample(int rssi);
+  void requestSent(uint32_t now);
+  void notified(uint32_t now);
+  void replyComplete();
+  void timedOut();
+
+  uint8_t getScore() const { return quality.score; }
+  LinkLevel getLevel() const { return quality.level; }
+  uint32_t getPollSpacing() const { return quality.pollSpacing; }
+  const LinkQuality& getQuality() const { return quality; }
+
+  // True once per low-score episode after the hold time; counts a reconnect
+  bool shouldReconnect(uint32_t now);
+
+private:
+  void update();
+  static uint8_t scale(float value, float good, float poor);
+
+  int8_t rssiGood = -60;
+  int8_t rssiPoor = -90;
+  uint32_t gapGood = 200;
+  uint32_t gapPoor = 1500;
+  uint8_t degradedScore = 60;
+  uint8_t poorScore = 30;
+  uint32_t degradedSpacing = 150;
+  uint32_t poorSpacing = 500;
+  uint8_t reconnectScore = 20;
+  uint32_t reconnectHold = 5000;
+
+  float rssiAverage = 0.0f;
+  float gapAverage = 0.0f;
+  float timeoutRate = 0.0f;       // Smoothed fraction of requests that timed out
+  bool rssiSeen = false;
+  bool gapSeen = false;
+  bool awaiting = false;          // Request sent, reply not complete
+  uint32_t lastActivity = 0;      // Request sent or last notification
+  uint32_t currentGap = 0;        // Longest silence in the reply so far
+  bool low = false;               // Score below reconnectScore...
+  uint32_t lowSince = 0;          // ...since this time
+  bool reconnectRequested = false;
+  LinkQuality quality;
+};
+
+#endif // OBD_LINK_QUALITY_H
@@ -0,0 +1,47 @@
+#include "OBDMemory.h"
+#include <stddef.h>
+
+#if defined(OBD_COUNT_ALLOCATIONS)
+
+static uint32_t allocations = 0;
+
+extern "C" {
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t count, size_t size);
+void* __real_realloc(void* ptr, size_t size);
+
+void* __wrap_malloc(size_t size) {
+  __atomic_fetch_add(&allocations, 1, __ATOMIC_RELAXED);
+  return __real_malloc(size);
+}
+
+void* __wrap_calloc(size_t count, size_t size) {
+  __atomic_fetch_add(&allocations, 1, __ATOMIC_RELAXED);
+  return __real_calloc(count, size);
+}
+
+void* __wrap_realloc(void* ptr, size_t size) {
+  __atomic_fetch_add(&allocations, 1, __ATOMIC_RELAXED);
+  return __real_realloc(ptr, size);
+}
+}
+
+uint32_t obdAllocationCount() {
+  return __atomic_load_n(&allocations, __ATOMIC_RELAXED);
+}
+
+bool obdAllocationCounting() {
+  return true;
+}
+
+#else
+
+uint32_t obdAllocationCount() {
+  return 0;
+}
+
+bool obdAllocationCounting() {
+  return false;
+}
+
+#endif
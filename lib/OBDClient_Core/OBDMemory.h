@@ -0,0 +1,26 @@
+#ifndef OBD_MEMORY_H
+#define OBD_MEMORY_H
+
+#include <stdint.h>
+
+// Heap usage seen by one client (see BLEOBDClient::getMemoryReport)
+struct MemoryReport {
+  uint32_t freeAtBegin;           // Free heap when begin() returned
+  uint32_t freeAtConnect;         // Free heap when polling last started
+  uint32_t freeNow;
+  uint32_t minFree;               // Lowest free heap since boot (watermark)
+  uint32_t largestBlock;          // Largest block that can still be allocated
+  uint32_t clientBytes;           // Reserved statically inside the client object
+  uint32_t allocationsSinceBegin; // 0 unless allocation counting is built in
+  uint32_t allocationsSinceConnect;
+  uint32_t rxDropped;             // Notification bytes dropped at the receive cap
+};
+
+// Heap call counter. Build with -DOBD_COUNT_ALLOCATIONS and
+// -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc to count every malloc,
+// calloc and realloc in the firmware (String, new and std containers all
+// end up there); otherwise the count stays 0.
+uint32_t obdAllocationCount();
+bool obdAllocationCounting();
+
+#endif // OBD_MEMORY_H
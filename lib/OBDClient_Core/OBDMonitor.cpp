@@ -0,0 +1,79 @@
+#include "OBDMonitor.h"
+#include <string.h>
+#include "OBDResponse.h"
+
+bool CANFrameRing::push(const CANFrame& frame) {
+  uint32_t h = head.load(std::memory_order_relaxed);
+  uint32_t used = h - tail.load(std::memory_order_acquire);   // Slot is free once tail moved past it
+  if (used >= CAN_FRAME_RING_SIZE) {
+    dropped++;
+    return false;
+  }
+  frames[h & (CAN_FRAME_RING_SIZE - 1)] = frame;
+  head.store(h + 1, std::memory_order_release);               // Frame visible before the index
+  if (used + 1 > highWater) highWater = used + 1;
+  return true;
+}
+
+bool CANFrameRing::pop(CANFrame& frame) {
+  uint32_t t = tail.load(std::memory_order_relaxed);
+  if (head.load(std::memory_order_acquire) == t) return false;
+  frame = frames[t & (CAN_FRAME_RING_SIZE - 1)];
+  tail.store(t + 1, std::memory_order_release);               // Copy done before the slot is reused
+  return true;
+}
+
+bool parseMonitorLine(const char* line, size_t length, CANFrame& out) {
+  // 11-bit ids give an odd digit count (3 + 2n), 29-bit ids an even one (8 + 2n)
+  size_t idDigits = (length % 2 == 1) ? 3 : 8;
+  if (length < idDigits || length - idDigits > 16) return false;
+
+  uint32_t value;
+  if (!parseHexValue(line, idDigits, &value)) return false;
+  out.id = value;
+  out.dlc = (length - idDigits) / 2;
+
+  for (uint8_t i = 0; i < out.dlc; i++) {
+    if (!parseHexValue(line + idDigits + i * 2, 2, &value)) return false;
+    out.data[i] = (uint8_t)value;
+  }
+  return true;
+}
+
+void MonitorLineParser::finishLine(uint32_t timestamp, CANFrameRing& ring) {
+  if (lineLength == 0) return;
+
+  CANFrame frame;
+  if (!overflow && parseMonitorLine(line, lineLength, frame)) {
+    frame.timestamp = timestamp;
+    ring.push(frame);
+    framesParsed++;
+  } else if (lineLength >= 10 && memcmp(line, "BUFFERFULL", 10) == 0) { // Spaces are skipped
+    bufferFull++;
+  } else {
+    badLines++;
+  }
+  lineLength = 0;
+  overflow = false;
+}
+
+bool MonitorLineParser::feed(const uint8_t* data, size_t length, uint32_t timestamp, CANFrameRing& ring) {
+  bool prompt = false;
+
+  for (size_t i = 0; i < length; i++) {
+    char c = (char)data[i];
+    if (c == '\r' || c == '\n') {
+      finishLine(timestamp, ring);
+    } else if (c == '>') {
+      finishLine(timestamp, ring);
+      prompt = true;
+    } else if (c != ' ') {
+      if (lineLength < sizeof(line)) {
+        line[lineLength++] = c;
+      } else {
+        overflow = true;
+      }
+    }
+  }
+  return prompt;
+}
@@ -0,0 +1,64 @@
+#ifndef OBD_MONITOR_H
+#define OBD_MONITOR_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+// Frame ring size, must be a power of two
+#define CAN_FRAME_RING_SIZE 256
+
+// One raw CAN frame captured in monitor mode (ATMA / STMA)
+struct CANFrame {
+  uint32_t id;
+  uint32_t timestamp;    // millis() when the line was completed
+  uint8_t dlc;
+  uint8_t data[8];
+};
+
+// Single-producer (BLE callback) / single-consumer (loop) frame ring.
+// Frames are dropped, not overwritten, when the consumer falls behind.
+// Publishing an index with release (and reading the other side's with
+// acquire) orders the frame copy with it on both cores.
+class CANFrameRing {
+public:
+  bool push(const CANFrame& frame);
+  bool pop(CANFrame& frame);
+  void clear() { head.store(0); tail.store(0); }   // Only while nothing is streaming
+  uint32_t size() const { return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire); }
+  uint32_t getDropped() const { return dropped; }
+  uint32_t getHighWater() const { return highWater; }
+
+private:
+  CANFrame frames[CAN_FRAME_RING_SIZE];
+  std::atomic<uint32_t> head{0};   // Written by producer only
+  std::atomic<uint32_t> tail{0};   // Written by consumer only
+  uint32_t dropped = 0;
+  uint32_t highWater = 0;
+};
+
+// Parse one monitor line ("1F01122334455", "18FEF10011223344"), headers on,
+// spaces off, no DLC. Returns false for status text and malformed lines.
+bool parseMonitorLine(const char* line, size_t length, CANFrame& out);
+
+// Assembles notification bytes into lines in a fixed buffer and pushes
+// completed frames straight into the ring - no per-frame allocation.
+class MonitorLineParser {
+public:
+  // Returns true once the adapter prompt ('>') is seen, i.e. monitoring stopped
+  bool feed(const uint8_t* data, size_t length, uint32_t timestamp, CANFrameRing& ring);
+  void reset() { lineLength = 0; overflow = false; }
+
+  uint32_t framesParsed = 0;
+  uint32_t badLines = 0;
+  uint32_t bufferFull = 0;    // "BUFFER FULL" reports from the adapter
+
+private:
+  void finishLine(uint32_t timestamp, CANFrameRing& ring);
+
+  char line[32];
+  uint8_t lineLength = 0;
+  bool overflow = false;
+};
+
+#endif // OBD_MONITOR_H
@@ -0,0 +1,134 @@
+#include "OBDPidDecoder.h"
+#include <string.h>
+#include <stdio.h>
+
+#define PID_BLOB_VERSION     1
+#define PID_BLOB_RECORD_SIZE 23
+
+PIDDescriptor standardPID(uint8_t pid, uint8_t bytes, float scale, float offset) {
+  PIDDescriptor desc;
+  desc.mode = 0x01;
+  desc.pid = pid;
+  desc.header = 0;
+  desc.ecuId = 0;
+  desc.byteOffset = 0;
+  desc.bitOffset = 0;
+  desc.bitLength = bytes * 8;
+  desc.flags = 0;
+  desc.scale = scale;
+  desc.offset = offset;
+  return desc;
+}
+
+PIDDescriptor extendedPID(uint16_t did, uint32_t header, uint32_t ecuId, uint8_t byteOffset,
+                          uint8_t bitLength, float scale, float offset, uint8_t flags) {
+  PIDDescriptor desc;
+  desc.mode = 0x22;
+  desc.pid = did;
+  desc.header = header;
+  desc.ecuId = ecuId;
+  desc.byteOffset = byteOffset;
+  desc.bitOffset = 0;
+  desc.bitLength = bitLength;
+  desc.flags = flags;
+  desc.scale = scale;
+  desc.offset = offset;
+  return desc;
+}
+
+uint8_t pidEchoLength(uint8_t mode) {
+  return mode == 0x22 ? 2 : 1;
+}
+
+void formatPIDRequest(const PIDDescriptor& desc, char* out) {
+  if (pidEchoLength(desc.mode) == 2) {
+    snprintf(out, 8, "%02X%04X", desc.mode, desc.pid);
+  } else {
+    snprintf(out, 8, "%02X%02X", desc.mode, desc.pid & 0xFF);
+  }
+}
+
+// The field must fit a raw read of at most 8 bytes and lie inside the
+// largest payload a message can hold
+bool pidDescriptorValid(const PIDDescriptor& desc) {
+  if (desc.bitLength == 0 || desc.bitLength > 32 || desc.bitOffset > 7) return false;
+  size_t byteCount = ((size_t)desc.bitOffset + desc.bitLength + 7) / 8;
+  return 1 + (size_t)pidEchoLength(desc.mode) + desc.byteOffset + byteCount <= OBD_MAX_PAYLOAD;
+}
+
+bool decodePIDValue(const PIDDescriptor& desc, const OBDMessage& msg, float* value) {
+  uint8_t echo = pidEchoLength(desc.mode);
+  if (msg.length < 1 + echo || msg.data[0] != (uint8_t)(desc.mode + 0x40)) return false;
+
+  if (echo == 2) {
+    if (msg.data[1] != (desc.pid >> 8) || msg.data[2] != (desc.pid & 0xFF)) return false;
+  } else if (msg.data[1] != (desc.pid & 0xFF)) {
+    return false;
+  }
+
+  if (!pidDescriptorValid(desc)) return false;
+
+  // Gather the covering bytes, then shift/mask the field out
+  size_t first = 1 + (size_t)echo + desc.byteOffset;
+  size_t totalBits = (size_t)desc.bitOffset + desc.bitLength;
+  size_t byteCount = (totalBits + 7) / 8;
+  if (first + byteCount > msg.length) return false;
+
+  uint64_t raw = 0;
+  for (size_t i = 0; i < byteCount; i++) {
+    raw = (raw << 8) | msg.data[first + i];
+  }
+  raw >>= byteCount * 8 - totalBits;
+  raw &= (desc.bitLength == 32) ? 0xFFFFFFFFull : ((1ull << desc.bitLength) - 1);
+
+  float physical;
+  if ((desc.flags & PID_FLAG_SIGNED) && (raw & (1ull << (desc.bitLength - 1)))) {
+    physical = (float)((int64_t)raw - (int64_t)(1ull << desc.bitLength));
+  } else {
+    physical = (float)raw;
+  }
+
+  *value = physical * desc.scale + desc.offset;
+  return true;
+}
+
+static uint32_t readLE(const uint8_t* p, uint8_t bytes) {
+  uint32_t v = 0;
+  for (uint8_t i = 0; i < bytes; i++) {
+    v |= (uint32_t)p[i] << (8 * i);
+  }
+  return v;
+}
+
+static float readFloatLE(const uint8_t* p) {
+  uint32_t bits = readLE(p, 4);
+  float f;
+  memcpy(&f, &bits, sizeof(f));
+  return f;
+}
+
+int parsePIDBlob(const uint8_t* blob, size_t length, PIDDescriptor* out, uint8_t maxCount) {
+  if (length < 6 || memcmp(blob, "XPID", 4) != 0 || blob[4] != PID_BLOB_VERSION) return -1;
+
+  uint8_t count = blob[5];
+  if (length < 6 + (size_t)count * PID_BLOB_RECORD_SIZE) return -1;
+
+  uint8_t loaded = 0;
+  const uint8_t* p = blob + 6;
+  for (uint8_t i = 0; i < count && loaded < maxCount; i++, p += PID_BLOB_RECORD_SIZE) {
+    PIDDescriptor& desc = out[loaded];
+    desc.mode = p[0];
+    desc.pid = (uint16_t)readLE(p + 1, 2);
+    desc.header = readLE(p + 3, 4);
+    desc.ecuId = readLE(p + 7, 4);
+    desc.byteOffset = p[11];
+    desc.bitOffset = p[12];
+    desc.bitLength = p[13];
+    desc.flags = p[14];
+    desc.scale = readFloatLE(p + 15);
+    desc.offset = readFloatLE(p + 19);
+    if (!pidDescriptorValid(desc)) return -1;
+    loaded++;
+  }
+  return loaded;
+}
@@ -0,0 +1,58 @@
+#ifndef OBD_PID_DECODER_H
+#define OBD_PID_DECODER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "OBDResponse.h"
+
+#define OBD_MAX_EXTENDED_PIDS 16
+
+// Descriptor flags
+#define PID_FLAG_SIGNED 0x01    // Two's complement raw value
+
+// How to request and decode one value.
+// Raw value = bitLength bits starting bitOffset bits into the data byte at
+// byteOffset (big-endian, MSB first); physical = raw * scale + offset.
+// byteOffset counts from the first byte after the mode/PID echo.
+struct PIDDescriptor {
+  uint8_t mode;          // 0x01 (standard), 0x22 (ReadDataByIdentifier), ...
+  uint16_t pid;          // PID (modes 01/02) or DID (mode 22)
+  uint32_t header;       // Request header for ATSH (0x7E0, 0x18DA10F1), 0 = default
+  uint32_t ecuId;        // Responder to take the value from, 0 = primary
+  uint8_t byteOffset;
+  uint8_t bitOffset;
+  uint8_t bitLength;     // 1..32
+  uint8_t flags;
+  float scale;
+  float offset;
+};
+
+// Descriptor for a standard Mode 01 PID spanning whole bytes
+PIDDescriptor standardPID(uint8_t pid, uint8_t bytes, float scale, float offset = 0.0f);
+
+// Descriptor for a Mode 22 DID addressed to a specific ECU
+PIDDescriptor extendedPID(uint16_t did, uint32_t header, uint32_t ecuId, uint8_t byteOffset,
+                          uint8_t bitLength, float scale, float offset = 0.0f, uint8_t flags = 0);
+
+// Bytes used by the PID/DID echo for a mode (2 for mode 22, 1 otherwise)
+uint8_t pidEchoLength(uint8_t mode);
+
+// Request text, e.g. "010C" or "22F40D"; out needs 8 bytes
+void formatPIDRequest(const PIDDescriptor& desc, char* out);
+
+// False when the field can never be decoded: bitLength outside 1..32,
+// bitOffset past the first byte, or a field ending beyond OBD_MAX_PAYLOAD
+bool pidDescriptorValid(const PIDDescriptor& desc);
+
+// Validate the mode/PID echo and extract the physical value
+bool decodePIDValue(const PIDDescriptor& desc, const OBDMessage& msg, float* value);
+
+// Compact config blob: "XPID", version (1), count, then count records of
+// 23 bytes, little-endian:
+//   mode u8, pid u16, header u32, ecuId u32, byteOffset u8, bitOffset u8,
+//   bitLength u8, flags u8, scale f32, offset f32
+// Returns the number of descriptors written to out, or -1 on a malformed blob
+// (including any record pidDescriptorValid() rejects).
+int parsePIDBlob(const uint8_t* blob, size_t length, PIDDescriptor* out, uint8_t maxCount);
+
+#endif // OBD_PID_DECODER_H
@@ -0,0 +1,113 @@
+#include "OBDProfiler.h"
+#include <stdio.h>
+#include <string.h>
+
+#if defined(ESP_PLATFORM)
+#include <esp_cpu.h>
+#include <esp32-hal-cpu.h>
+
+static uint32_t defaultCounter() { return (uint32_t)esp_cpu_get_cycle_count(); }
+static uint32_t defaultRate() { return getCpuFrequencyMhz(); }
+#else
+#include <chrono>
+
+static uint32_t defaultCounter() {
+  return (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+static uint32_t defaultRate() { return 1000; }
+#endif
+
+static const char* const stageNames[STAGE_COUNT] = {
+  "response", "transfer", "dispatch", "parse", "publish", "total"
+};
+
+static uint8_t bucketFor(uint32_t cycles) {
+  if (cycles < 4) return cycles;
+  uint8_t octave = 31 - __builtin_clz(cycles);
+  return (octave - 1) * 4 + ((cycles >> (octave - 2)) & 3);
+}
+
+static uint32_t bucketUpperBound(uint8_t bucket) {
+  if (bucket < 4) return bucket;
+  uint8_t octave = bucket / 4 + 1;
+  uint32_t width = 1u << (octave - 2);
+  return (uint32_t)((4 + bucket % 4) * (uint64_t)width + width - 1);
+}
+
+void StageHistogram::add(uint32_t cycles) {
+  if (count == 0 || cycles < min) min = cycles;
+  if (cycles > max) max = cycles;
+  count++;
+  sum += cycles;
+  buckets[bucketFor(cycles)]++;
+}
+
+uint32_t StageHistogram::percentile(uint8_t percent) const {
+  if (count == 0) return 0;
+  uint64_t wanted = ((uint64_t)count * percent + 99) / 100;
+  uint64_t seen = 0;
+  for (uint8_t i = 0; i < PROFILE_BUCKETS; i++) {
+    seen += buckets[i];
+    if (seen >= wanted) {
+      uint32_t upper = bucketUpperBound(i);
+      return upper < max ? upper : max;
+    }
+  }
+  return max;
+}
+
+PollProfiler::PollProfiler() : counter(defaultCounter), cyclesPerMicro(defaultRate()) {
+  reset();
+}
+
+void PollProfiler::setCounter(CycleCounter newCounter, uint32_t newCyclesPerMicro) {
+  counter = newCounter ? newCounter : defaultCounter;
+  cyclesPerMicro = newCyclesPerMicro ? newCyclesPerMicro : 1;
+  reset();
+}
+
+void PollProfiler::reset() {
+  memset(stages, 0, sizeof(stages));
+  flags = 0;
+  decodedReady = false;
+}
+
+void PollProfiler::markDecoded() {
+  if (!enabled || !(flags & FLAG_PROMPT)) return;
+  stamp(current.decoded);
+  decoded = current;
+  decodedReady = true;
+  flags = 0;
+}
+
+void PollProfiler::markPublished() {
+  if (!enabled || !decodedReady) return;
+  uint32_t now = counter();
+
+  stages[STAGE_RESPONSE].add(decoded.firstByte - decoded.send);
+  stages[STAGE_TRANSFER].add(decoded.prompt - decoded.firstByte);
+  stages[STAGE_DISPATCH].add(decoded.decode - decoded.prompt);
+  stages[STAGE_PARSE].add(decoded.decoded - decoded.decode);
+  stages[STAGE_PUBLISH].add(now - decoded.decoded);
+  stages[STAGE_TOTAL].add(now - decoded.send);
+  decodedReady = false;
+}
+
+size_t PollProfiler::report(char* out, size_t outSize) const {
+  size_t n = snprintf(out, outSize, "%-9s %7s %9s %9s %9s %9s %9s %9s\n",
+                      "stage", "count", "min", "mean", "p50", "p90", "p99", "max");
+
+  for (uint8_t i = 0; i < STAGE_COUNT && n < outSize; i++) {
+    const StageHistogram& h = stages[i];
+    uint32_t mean = h.count ? (uint32_t)(h.sum / h.count) : 0;
+    n += snprintf(out + n, outSize - n, "%-9s %7lu %9lu %9lu %9lu %9lu %9lu %9lu\n",
+                  stageNames[i], (unsigned long)h.count,
+                  (unsigned long)(h.min / cyclesPerMicro), (unsigned long)(mean / cyclesPerMicro),
+                  (unsigned long)(h.percentile(50) / cyclesPerMicro),
+                  (unsigned long)(h.percentile(90) / cyclesPerMicro),
+                  (unsigned long)(h.percentile(99) / cyclesPerMicro),
+                  (unsigned long)(h.max / cyclesPerMicro));
+  }
+  return n < outSize ? n : outSize - 1;
+}
@@ -0,0 +1,95 @@
+#ifndef OBD_PROFILER_H
+#define OBD_PROFILER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Poll cycle stages, each measured between two marks:
+//   send -> first notification byte -> prompt -> decode start -> decoded -> published
+enum ProfileStage {
+  STAGE_RESPONSE,      // Request written until the first reply byte arrives
+  STAGE_TRANSFER,      // First reply byte until the '>' prompt
+  STAGE_DISPATCH,      // Prompt until the scheduler picks the response up
+  STAGE_PARSE,         // Response split, routed and decoded
+  STAGE_PUBLISH,       // Derived signals, subscribers, telemetry
+  STAGE_TOTAL,         // Send until published
+  STAGE_COUNT
+};
+
+// Log-linear histogram: 4 buckets per power of two (<= 25% bucket width)
+#define PROFILE_BUCKETS 124
+
+typedef uint32_t (*CycleCounter)();
+
+struct StageHistogram {
+  uint32_t count;
+  uint32_t min;
+  uint32_t max;
+  uint64_t sum;
+  uint32_t buckets[PROFILE_BUCKETS];
+
+  void add(uint32_t cycles);
+  uint32_t percentile(uint8_t percent) const;   // Upper bound of the bucket
+};
+
+// Timestamps come from a free-running 32-bit cycle counter (wraps are fine
+// for durations under one period). The default is the CPU cycle counter on
+// the ESP32 and a nanosecond clock on a host; tests inject a fake one.
+//
+// The ESP32 cycle counter is per core: stages spanning the BLE callback
+// (response, transfer, dispatch) are exact only when service() runs on the
+// BLE host core (startPollerTask() on core 0).
+class PollProfiler {
+public:
+  PollProfiler();
+
+  void setEnabled(bool on) { enabled = on; }
+  bool isEnabled() const { return enabled; }
+  void setCounter(CycleCounter counter, uint32_t cyclesPerMicro);
+  void reset();
+
+  // Marks; cheap no-ops while disabled. A decoded cycle is handed off on
+  // markDecoded() and recorded on markPublished(), so the next request can
+  // be sent (and its cycle started or cancelled) before the publish step.
+  // Marks only count when the ones before them were taken in order. The
+  // receive marks are stamped with now() in the BLE callback and applied by
+  // the task that owns the profiler.
+  uint32_t now() const { return counter(); }
+  void markSend()        { if (enabled) { stamp(current.send); flags = FLAG_SEND; } }
+  void markFirstByte(uint32_t at) { if (enabled && flags == FLAG_SEND) { current.firstByte = at; flags |= FLAG_FIRST; } }
+  void markPrompt(uint32_t at)    { if (enabled && (flags & FLAG_FIRST) && !(flags & FLAG_PROMPT)) { current.prompt = at; flags |= FLAG_PROMPT; } }
+  void markDecodeStart() { if (enabled && (flags & FLAG_PROMPT)) stamp(current.decode); }
+  void markDecoded();
+  void markPublished();
+  void cancel() { flags = 0; }               // Timeout / no data: drop the cycle in progress
+
+  const StageHistogram& getStage(ProfileStage stage) const { return stages[stage]; }
+  uint32_t getCyclesPerMicro() const { return cyclesPerMicro; }
+
+  // Text table (count, min/mean/p50/p90/p99/max in microseconds) into out
+  size_t report(char* out, size_t outSize) const;
+
+private:
+  enum { FLAG_SEND = 1, FLAG_FIRST = 2, FLAG_PROMPT = 4 };
+
+  struct CycleMarks {
+    uint32_t send;
+    uint32_t firstByte;
+    uint32_t prompt;
+    uint32_t decode;
+    uint32_t decoded;
+  };
+
+  void stamp(uint32_t& slot) { slot = counter(); }
+
+  CycleCounter counter;
+  uint32_t cyclesPerMicro;
+  bool enabled = false;
+  uint8_t flags = 0;
+  CycleMarks current = {};           // Cycle in progress
+  CycleMarks decoded = {};           // Decoded, waiting for markPublished()
+  bool decodedReady = false;
+  StageHistogram stages[STAGE_COUNT];
+};
+
+#endif // OBD_PROFILER_H
@@ -0,0 +1,196 @@
+#include "OBDResponse.h"
+
+static int hexNibble(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  return -1;
+}
+
+bool parseHexValue(const char* text, size_t digits, uint32_t* value) {
+  uint32_t result = 0;
+  for (size_t i = 0; i < digits; i++) {
+    int nibble = hexNibble(text[i]);
+    if (nibble < 0) return false;
+    result = (result << 4) | nibble;
+  }
+  *value = result;
+  return true;
+}
+
+static uint8_t hexByte(const char* text) {
+  return (uint8_t)((hexNibble(text[0]) << 4) | hexNibble(text[1]));
+}
+
+static OBDMessage* messageFor(OBDResponse& out, uint32_t ecuId, OBDHeaderType headerType) {
+  for (uint8_t i = 0; i < out.messageCount; i++) {
+    if (out.messages[i].ecuId == ecuId) return &out.messages[i];
+  }
+  if (out.messageCount >= OBD_MAX_ECUS) return nullptr;
+
+  OBDMessage* msg = &out.messages[out.messageCount++];
+  msg->ecuId = ecuId;
+  msg->headerType = headerType;
+  msg->length = 0;
+  msg->expectedLength = 0;
+  msg->nextSequence = 0;
+  return msg;
+}
+
+// Append hex byte pairs, honouring the ISO-TP length when one is known
+static void appendBytes(OBDMessage* msg, const char* hex, size_t digits) {
+  size_t limit = msg->expectedLength ? msg->expectedLength : OBD_MAX_PAYLOAD;
+  if (limit > OBD_MAX_PAYLOAD) limit = OBD_MAX_PAYLOAD;
+
+  for (size_t i = 0; i + 1 < digits && msg->length < limit; i += 2) {
+    msg->data[msg->length++] = hexByte(hex + i);
+  }
+}
+
+// One CAN frame after the header: PCI byte followed by data
+static bool parseCANFrame(OBDResponse& out, uint32_t ecuId, OBDHeaderType headerType,
+                          const char* frame, size_t digits) {
+  if (digits < 2) return false;
+
+  uint8_t pci = hexByte(frame);
+  OBDMessage* msg = messageFor(out, ecuId, headerType);
+  if (!msg) return false;
+
+  switch (pci >> 4) {
+    case 0: { // Single frame
+      size_t dataDigits = (pci & 0x0F) * 2;
+      if (dataDigits > digits - 2) dataDigits = digits - 2;
+      msg->length = 0;
+      msg->expectedLength = 0;
+      appendBytes(msg, frame + 2, dataDigits);
+      return true;
+    }
+    case 1: { // First frame of a multi-frame message
+      if (digits < 4) return false;
+      msg->length = 0;
+      msg->expectedLength = ((pci & 0x0F) << 8) | hexByte(frame + 2);
+      msg->nextSequence = 1;
+      appendBytes(msg, frame + 4, digits - 4);
+      return true;
+    }
+    case 2: { // Consecutive frame
+      if (msg->expectedLength == 0 || (pci & 0x0F) != (msg->nextSequence & 0x0F)) return false;
+      msg->nextSequence++;
+      appendBytes(msg, frame + 2, digits - 2);
+      return true;
+    }
+    default: // Flow control and anything else carries no payload for us
+      return false;
+  }
+}
+
+static bool parseLine(OBDResponse& out, const char* line, size_t lineLen) {
+  // Headerless multi-frame continuation ("0:4902...", "1:...")
+  if (lineLen >= 2 && line[1] == ':') {
+    line += 2;
+    lineLen -= 2;
+    for (size_t i = 0; i < lineLen; i++) {
+      if (hexNibble(line[i]) < 0) return false;
+    }
+    OBDMessage* msg = messageFor(out, 0, OBD_HEADER_NONE);
+    if (!msg) return false;
+    appendBytes(msg, line, lineLen);
+    return true;
+  }
+
+  for (size_t i = 0; i < lineLen; i++) {
+    if (hexNibble(line[i]) < 0) return false; // Status text, not data
+  }
+
+  uint32_t ecuId = 0;
+
+  if (lineLen % 2 == 1) {
+    // 11-bit CAN: 3 header digits + PCI
+    if (lineLen < 5) return false;
+    parseHexValue(line, 3, &ecuId);
+    return parseCANFrame(out, ecuId, OBD_HEADER_CAN_11BIT, line + 3, lineLen - 3);
+  }
+
+  if (lineLen >= 10 && line[0] == '1' && line[1] == '8' && line[2] == 'D' &&
+      (line[3] == 'A' || line[3] == 'B')) {
+    // 29-bit CAN: 8 header digits + PCI
+    parseHexValue(line, 8, &ecuId);
+    return parseCANFrame(out, ecuId, OBD_HEADER_CAN_29BIT, line + 8, lineLen - 8);
+  }
+
+  uint8_t first = lineLen >= 8 ? hexByte(line) : 0x40;
+  bool j1850Header = lineLen >= 8 && (first == 0x48 || first == 0x68) && hexByte(line + 2) == 0x6B;
+  if (lineLen >= 8 && (first < 0x40 || first >= 0x80 || j1850Header)) {
+    // Legacy 3-byte header (priority, target, source) + trailing checksum
+    ecuId = hexByte(line + 4);
+    OBDMessage* msg = messageFor(out, ecuId, OBD_HEADER_LEGACY);
+    if (!msg) return false;
+    appendBytes(msg, line + 6, lineLen - 8);
+    return true;
+  }
+
+  // Headers disabled: the whole line is payload
+  OBDMessage* msg = messageFor(out, 0, OBD_HEADER_NONE);
+  if (!msg) return false;
+  appendBytes(msg, line, lineLen);
+  return true;
+}
+
+bool parseOBDResponse(const char* text, size_t length, OBDResponse& out) {
+  out.messageCount = 0;
+
+  char line[OBD_MAX_PAYLOAD * 2 + 16];
+  size_t lineLen = 0;
+  bool overflow = false;
+  bool anyData = false;
+
+  for (size_t i = 0; i <= length; i++) {
+    char c = (i < length) ? text[i] : '\r';
+
+    if (c == '\r' || c == '\n') {
+      if (lineLen > 0 && !overflow) {
+        anyData |= parseLine(out, line, lineLen);
+      }
+      lineLen = 0;
+      overflow = false;
+      continue;
+    }
+    if (c == ' ') continue;
+
+    if (lineLen < sizeof(line)) {
+      line[lineLen++] = c;
+    } else {
+      overflow = true;
+    }
+  }
+
+  return anyData;
+}
+
+const OBDMessage* OBDResponse::fromECU(uint32_t ecuId) const {
+  for (uint8_t i = 0; i < messageCount; i++) {
+    if (messages[i].ecuId == ecuId) return &messages[i];
+  }
+  return nullptr;
+}
+
+const OBDMessage* OBDResponse::primary(uint8_t mode, int pid) const {
+  const OBDMessage* best = nullptr;
+  for (uint8_t i = 0; i < messageCount; i++) {
+    const OBDMessage& msg = messages[i];
+    if (msg.length < 1 || msg.data[0] != mode) continue;
+    if (pid >= 0 && (msg.length < 2 || msg.data[1] != pid)) continue;
+    if (!best || msg.ecuId < best->ecuId) best = &msg;
+  }
+  return best;
+}
+
+bool OBDResponse::answers(uint8_t mode, int pid) const {
+  for (uint8_t i = 0; i < messageCount; i++) {
+    const OBDMessage& msg = messages[i];
+    if (msg.length >= 2 && msg.data[0] == 0x7F && msg.data[1] == (uint8_t)(mode - 0x40)) return true;
+    if (msg.length < 1 || msg.data[0] != mode) continue;
+    if (pid < 0 || (msg.length >= 2 && msg.data[1] == pid)) return true;
+  }
+  return false;
+}
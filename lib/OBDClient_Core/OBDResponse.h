@@ -0,0 +1,52 @@
+#ifndef OBD_RESPONSE_H
+#define OBD_RESPONSE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Limits for a single adapter response (one request, all answering ECUs)
+#define OBD_MAX_ECUS        8
+#define OBD_MAX_PAYLOAD     64
+
+// Header form the responder's lines arrived with
+enum OBDHeaderType : uint8_t {
+  OBD_HEADER_NONE = 0,            // Headers off (ATH0): the bus is not known
+  OBD_HEADER_CAN_11BIT,
+  OBD_HEADER_CAN_29BIT,
+  OBD_HEADER_LEGACY               // J1850 / KWP 3-byte header
+};
+
+// One decoded message from one ECU (CAN frames already reassembled)
+struct OBDMessage {
+  uint32_t ecuId;                 // Responder header (0x7E8, 0x18DAF110, ...), 0 if no headers
+  OBDHeaderType headerType;
+  uint8_t length;                 // Payload bytes, starting with the response mode (0x41, ...)
+  uint8_t data[OBD_MAX_PAYLOAD];
+  uint16_t expectedLength;        // ISO-TP total length for multi-frame messages
+  uint8_t nextSequence;           // Next expected consecutive frame index
+};
+
+// All messages contained in one response text (everything before '>')
+struct OBDResponse {
+  uint8_t messageCount = 0;
+  OBDMessage messages[OBD_MAX_ECUS];
+
+  // Message from a given ECU, or nullptr
+  const OBDMessage* fromECU(uint32_t ecuId) const;
+  // Message from the lowest responder id that answered with the given mode/PID
+  const OBDMessage* primary(uint8_t mode, int pid = -1) const;
+  // Any message answering a request with this response mode/PID, positive
+  // or negative (7F); tells a reply to one request from a late one to another
+  bool answers(uint8_t mode, int pid = -1) const;
+};
+
+// Split a response text into per-ECU messages.
+// Handles headerless lines, 11-bit and 29-bit CAN headers (with ISO-TP
+// single/first/consecutive frames) and 3-byte legacy (J1850/KWP) headers.
+// Returns false when the text holds no hex data lines at all.
+bool parseOBDResponse(const char* text, size_t length, OBDResponse& out);
+
+// Parse a hex string of the given length into a value; false on invalid digits
+bool parseHexValue(const char* text, size_t digits, uint32_t* value);
+
+#endif // OBD_RESPONSE_H
@@ -0,0 +1,150 @@
+#include "OBDSerializer.h"
+#include <string.h>
+#include <math.h>
+
+size_t formatFixed(float value, uint8_t decimals, char* out) {
+  static const uint32_t powers[] = {1, 10, 100, 1000, 10000, 100000, 1000000};
+  if (decimals > 6) decimals = 6;
+  if (isnan(value) || isinf(value) || fabs((double)value) * powers[decimals] >= 1e18) {
+    out[0] = '\0';
+    return 0;
+  }
+
+  size_t n = 0;
+  double scaled = (double)value * powers[decimals];
+  if (scaled < 0) {
+    out[n++] = '-';
+    scaled = -scaled;
+  }
+  uint64_t fixed = (uint64_t)(scaled + 0.5);
+  if (fixed == 0 && n == 1) n = 0;   // No "-0.0"
+
+  // Digits are produced backwards into a scratch buffer
+  char digits[24];
+  uint8_t count = 0;
+  do {
+    digits[count++] = '0' + (fixed % 10);
+    fixed /= 10;
+    if (count == decimals) digits[count++] = '.';
+  } while (fixed > 0 || count <= decimals);
+  if (digits[count - 1] == '.') digits[count++] = '0';   // 0.5 -> "0.5", not ".5"
+
+  while (count > 0) out[n++] = digits[--count];
+  out[n] = '\0';
+  return n;
+}
+
+SnapshotSerializer::SnapshotSerializer(SerializeFormat format) : format(format) {
+  build();
+}
+
+bool SnapshotSerializer::addField(OBDSignal signal, uint8_t decimals, const char* name) {
+  if (fieldCount >= SERIALIZER_MAX_FIELDS || signal >= SIGNAL_COUNT) return false;
+
+  Field& field = fields[fieldCount++];
+  field.signal = signal;
+  field.decimals = decimals;
+  field.name = name ? name : signalName(signal);
+  build();
+
+  if (overflow) {
+    fieldCount--;
+    build();
+    return false;
+  }
+  return true;
+}
+
+void SnapshotSerializer::clear() {
+  fieldCount = 0;
+  build();
+}
+
+bool SnapshotSerializer::setFormat(SerializeFormat newFormat) {
+  SerializeFormat oldFormat = format;
+  format = newFormat;
+  build();
+
+  if (overflow) {
+    format = oldFormat;
+    build();
+    return false;
+  }
+  return true;
+}
+
+bool SnapshotSerializer::appendTemplate(const char* text) {
+  size_t length = strlen(text);
+  if (templLength + length > sizeof(templ)) {
+    overflow = true;
+    return false;
+  }
+  memcpy(templ + templLength, text, length);
+  templLength += length;
+  return true;
+}
+
+void SnapshotSerializer::build() {
+  templLength = 0;
+  overflow = false;
+
+  for (uint8_t i = 0; i < fieldCount; i++) {
+    Field& field = fields[i];
+    field.prefixOffset = templLength;
+    if (format == FORMAT_JSON) {
+      appendTemplate(i == 0 ? "{\"" : ",\"");
+      appendTemplate(field.name);
+      appendTemplate("\":");
+    } else if (i > 0) {
+      appendTemplate(",");
+    }
+    field.prefixLength = templLength - field.prefixOffset;
+  }
+
+  suffixOffset = templLength;
+  if (format == FORMAT_JSON) {
+    appendTemplate(fieldCount ? "}" : "{}");
+  } else {
+    appendTemplate("\n");
+  }
+  suffixLength = templLength - suffixOffset;
+}
+
+size_t SnapshotSerializer::write(const float* values, char* out, size_t outSize) const {
+  size_t n = 0;
+
+  for (uint8_t i = 0; i < fieldCount; i++) {
+    const Field& field = fields[i];
+    if (n + field.prefixLength + 24 >= outSize) return 0;
+    memcpy(out + n, templ + field.prefixOffset, field.prefixLength);
+    n += field.prefixLength;
+
+    size_t length = formatFixed(values[field.signal], field.decimals, out + n);
+    if (length == 0 && format == FORMAT_JSON) {
+      memcpy(out + n, "null", 4);   // JSON has no NaN
+      length = 4;
+    }
+    n += length;
+  }
+
+  if (n + suffixLength >= outSize) return 0;
+  memcpy(out + n, templ + suffixOffset, suffixLength);
+  n += suffixLength;
+  out[n] = '\0';
+  return n;
+}
+
+size_t SnapshotSerializer::writeHeader(char* out, size_t outSize) const {
+  size_t n = 0;
+  for (uint8_t i = 0; i < fieldCount; i++) {
+    size_t length = strlen(fields[i].name);
+    if (n + length + 2 >= outSize) return 0;
+    if (i > 0) out[n++] = ',';
+    memcpy(out + n, fields[i].name, length);
+    n += length;
+  }
+  if (n + 2 > outSize) return 0;
+  out[n++] = '\n';
+  out[n] = '\0';
+  return n;
+}
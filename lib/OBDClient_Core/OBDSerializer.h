@@ -0,0 +1,61 @@
+#ifndef OBD_SERIALIZER_H
+#define OBD_SERIALIZER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "OBDSubscription.h"
+
+#define SERIALIZER_MAX_FIELDS    SIGNAL_COUNT
+#define SERIALIZER_TEMPLATE_SIZE 320
+
+enum SerializeFormat {
+  FORMAT_JSON,       // {"rpm":812,"speed":0.0}
+  FORMAT_CSV         // 812,0.0 (header row from writeHeader())
+};
+
+// Fixed-point float to text ("-12.35"); returns length, out needs 24 bytes.
+// NaN, infinity and values beyond 1e18 fixed-point units give an empty string.
+size_t formatFixed(float value, uint8_t decimals, char* out);
+
+// Writes a snapshot of selected signals into a caller buffer. The literal
+// text between values (keys, quotes, separators) is assembled once when the
+// field list changes, so write() only copies template segments and formats
+// numbers - no String, no allocation.
+class SnapshotSerializer {
+public:
+  explicit SnapshotSerializer(SerializeFormat format = FORMAT_JSON);
+
+  // name defaults to signalName(); false when full or the template overflows
+  bool addField(OBDSignal signal, uint8_t decimals = 1, const char* name = nullptr);
+  void clear();
+  bool setFormat(SerializeFormat newFormat);   // false (format kept) when the template overflows
+  uint8_t getFieldCount() const { return fieldCount; }
+
+  // values is indexed by OBDSignal. Returns the length written (NUL
+  // terminated), 0 when out is too small.
+  size_t write(const float* values, char* out, size_t outSize) const;
+  size_t writeHeader(char* out, size_t outSize) const;   // CSV column names
+
+private:
+  struct Field {
+    uint8_t signal;
+    uint8_t decimals;
+    const char* name;
+    uint16_t prefixOffset;    // Literal text written before the value
+    uint16_t prefixLength;
+  };
+
+  void build();
+  bool appendTemplate(const char* text);
+
+  SerializeFormat format;
+  Field fields[SERIALIZER_MAX_FIELDS];
+  uint8_t fieldCount = 0;
+  char templ[SERIALIZER_TEMPLATE_SIZE];
+  uint16_t templLength = 0;
+  uint16_t suffixOffset = 0;
+  uint8_t suffixLength = 0;
+  bool overflow = false;
+};
+
+#endif // OBD_SERIALIZER_H
@@ -0,0 +1,152 @@
+#include "OBDStatus.h"
+#include <string.h>
+
+struct StatusText {
+  const char* text;
+  uint8_t length;
+  AdapterStatus status;
+};
+
+// Whole-line status strings (ELM327 datasheet, "Messages and their meanings")
+static const StatusText statusTexts[] = {
+  { "NO DATA",           7,  STATUS_NO_DATA },
+  { "OK",                2,  STATUS_OK },
+  { "?",                 1,  STATUS_UNKNOWN_COMMAND },
+  { "BUFFER FULL",       11, STATUS_BUFFER_FULL },
+  { "STOPPED",           7,  STATUS_STOPPED },
+  { "BUS BUSY",          8,  STATUS_BUS_BUSY },
+  { "DATA ERROR",        10, STATUS_DATA_ERROR },
+  { "CAN ERROR",         9,  STATUS_CAN_ERROR },
+  { "BUS ERROR",         9,  STATUS_BUS_ERROR },
+  { "FB ERROR",          8,  STATUS_FB_ERROR },
+  { "UNABLE TO CONNECT", 17, STATUS_UNABLE_TO_CONNECT },
+  { "LV RESET",          8,  STATUS_ADAPTER_RESET },
+  { "ACT ALERT",         9,  STATUS_ACT_ALERT },
+};
+
+static bool isHexDigit(char c) {
+  return (c >= '0' && c <= '9') || (c >= 'A' && c <= 'F') || (c >= 'a' && c <= 'f');
+}
+
+static bool startsWith(const char* line, size_t length, const char* prefix) {
+  size_t n = strlen(prefix);
+  return length >= n && memcmp(line, prefix, n) == 0;
+}
+
+// One trimmed, non-empty line; sets searching for progress lines
+static AdapterStatus lineStatus(const char* line, size_t length, bool obdRequest, bool& searching) {
+  // Hex data, optionally with a "0:" multi-frame index
+  size_t start = (length >= 2 && line[1] == ':' && isHexDigit(line[0])) ? 2 : 0;
+  bool hex = start < length;
+  for (size_t i = start; i < length && hex; i++) {
+    hex = isHexDigit(line[i]) || line[i] == ' ';
+  }
+  if (hex) return STATUS_DATA;
+  if (memchr(line, '<', length)) return STATUS_DATA_ERROR;   // "41 0D 00 <DATA ERROR"
+
+  for (size_t i = 0; i < sizeof(statusTexts) / sizeof(statusTexts[0]); i++) {
+    const StatusText& s = statusTexts[i];
+    if (s.length == length && memcmp(line, s.text, length) == 0) return s.status;
+  }
+
+  if (startsWith(line, length, "SEARCHING")) {
+    searching = true;
+    return STATUS_EMPTY;
+  }
+  if (startsWith(line, length, "BUS INIT")) {
+    if (length >= 5 && memcmp(line + length - 5, "ERROR", 5) == 0) return STATUS_BUS_INIT_ERROR;
+    searching = true;
+    return STATUS_EMPTY;
+  }
+  if (startsWith(line, length, "ELM327")) return obdRequest ? STATUS_ADAPTER_RESET : STATUS_TEXT;
+  if (length >= 4 && startsWith(line, length, "ERR") && line[3] >= '0' && line[3] <= '9') {
+    return STATUS_INTERNAL_ERROR;
+  }
+  return STATUS_TEXT;
+}
+
+static bool isError(AdapterStatus status) {
+  return status >= STATUS_UNKNOWN_COMMAND && status != STATUS_ACT_ALERT;
+}
+
+ResponseClass classifyResponse(const char* text, size_t length, bool obdRequest) {
+  ResponseClass result;
+  AdapterStatus error = STATUS_EMPTY;
+  AdapterStatus other = STATUS_EMPTY;     // First NO DATA / OK / text line
+  size_t lineStart = 0;
+
+  for (size_t i = 0; i <= length; i++) {
+    if (i < length && text[i] != '\r' && text[i] != '\n') continue;
+
+    size_t start = lineStart, end = i;
+    lineStart = i + 1;
+    while (start < end && text[start] == ' ') start++;
+    while (end > start && text[end - 1] == ' ') end--;
+    if (start == end) continue;
+
+    AdapterStatus status = lineStatus(text + start, end - start, obdRequest, result.searching);
+    if (status == STATUS_DATA) {
+      if (result.dataLines < 255) result.dataLines++;
+    } else if (isError(status)) {
+      if (error == STATUS_EMPTY) error = status;
+    } else if (status != STATUS_EMPTY && other == STATUS_EMPTY) {
+      other = status;
+    }
+  }
+
+  if (error != STATUS_EMPTY) {
+    result.status = error;
+  } else if (result.dataLines > 0) {
+    result.status = STATUS_DATA;
+  } else {
+    result.status = other;
+  }
+  result.recovery = recoveryFor(result.status);
+  return result;
+}
+
+uint8_t recoveryFor(AdapterStatus status) {
+  switch (status) {
+    case STATUS_UNKNOWN_COMMAND:
+    case STATUS_DATA_ERROR:
+      return RECOVER_RETRY;
+    case STATUS_BUFFER_FULL:
+    case STATUS_STOPPED:
+    case STATUS_BUS_BUSY:
+      return RECOVER_RETRY | RECOVER_SLOW_DOWN;
+    case STATUS_CAN_ERROR:
+    case STATUS_BUS_ERROR:
+    case STATUS_FB_ERROR:
+    case STATUS_BUS_INIT_ERROR:
+    case STATUS_UNABLE_TO_CONNECT:
+    case STATUS_ADAPTER_RESET:
+    case STATUS_INTERNAL_ERROR:
+      return RECOVER_REINIT;
+    default:
+      return RECOVER_NONE;
+  }
+}
+
+const char* adapterStatusName(AdapterStatus status) {
+  switch (status) {
+    case STATUS_DATA:              return "DATA";
+    case STATUS_OK:                return "OK";
+    case STATUS_TEXT:              return "TEXT";
+    case STATUS_EMPTY:             return "EMPTY";
+    case STATUS_NO_DATA:           return "NO DATA";
+    case STATUS_UNKNOWN_COMMAND:   return "?";
+    case STATUS_BUFFER_FULL:       return "BUFFER FULL";
+    case STATUS_STOPPED:           return "STOPPED";
+    case STATUS_BUS_BUSY:          return "BUS BUSY";
+    case STATUS_DATA_ERROR:        return "DATA ERROR";
+    case STATUS_CAN_ERROR:         return "CAN ERROR";
+    case STATUS_BUS_ERROR:         return "BUS ERROR";
+    case STATUS_FB_ERROR:          return "FB ERROR";
+    case STATUS_BUS_INIT_ERROR:    return "BUS INIT ERROR";
+    case STATUS_UNABLE_TO_CONNECT: return "UNABLE TO CONNECT";
+    case STATUS_ADAPTER_RESET:     return "ADAPTER RESET";
+    case STATUS_INTERNAL_ERROR:    return "INTERNAL ERROR";
+    case STATUS_ACT_ALERT:         return "ACT ALERT";
+    default:                       return "UNKNOWN";
+  }
+}
@@ -0,0 +1,52 @@
+#ifndef OBD_STATUS_H
+#define OBD_STATUS_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// What an adapter reply (everything before '>') amounts to
+enum AdapterStatus {
+  STATUS_DATA,              // Hex data lines
+  STATUS_OK,                // "OK"
+  STATUS_TEXT,              // Other text (AT answers: version, voltage, ...)
+  STATUS_EMPTY,
+  STATUS_NO_DATA,           // No ECU answered
+  STATUS_UNKNOWN_COMMAND,   // "?": request not understood (garbled on the way in)
+  STATUS_BUFFER_FULL,       // Adapter's receive buffer overflowed
+  STATUS_STOPPED,           // Interrupted by a byte arriving mid-request
+  STATUS_BUS_BUSY,
+  STATUS_DATA_ERROR,        // "DATA ERROR", "<DATA ERROR", "<RX ERROR"
+  STATUS_CAN_ERROR,
+  STATUS_BUS_ERROR,
+  STATUS_FB_ERROR,          // Feedback error on the bus lines
+  STATUS_BUS_INIT_ERROR,    // "BUS INIT: ...ERROR"
+  STATUS_UNABLE_TO_CONNECT, // Protocol search found nothing
+  STATUS_ADAPTER_RESET,     // "LV RESET", or an "ELM327 v..." banner answering an OBD request
+  STATUS_INTERNAL_ERROR,    // "ERRxx"
+  STATUS_ACT_ALERT,         // No activity, adapter about to sleep
+  STATUS_COUNT
+};
+
+// Recovery flags per status, applied by the client
+#define RECOVER_NONE       0x00
+#define RECOVER_RETRY      0x01   // Resend the same request once
+#define RECOVER_SLOW_DOWN  0x02   // Space out polls (backs off, decays on clean replies)
+#define RECOVER_REINIT     0x04   // Re-run the adapter setup and protocol search
+
+struct ResponseClass {
+  AdapterStatus status = STATUS_EMPTY;
+  uint8_t recovery = RECOVER_NONE;
+  uint8_t dataLines = 0;         // Hex lines seen (alongside an error, data is not trusted)
+  bool searching = false;        // "SEARCHING..." or "BUS INIT: ...OK" preceded the answer
+};
+
+// Classify a reply in one pass over its lines. An error line outranks data
+// (BUFFER FULL after partial data means the data is incomplete); otherwise
+// data outranks NO DATA and plain text. The version banner is the expected
+// answer to ATI or ATZ, so it only means a reset when obdRequest is set.
+ResponseClass classifyResponse(const char* text, size_t length, bool obdRequest = true);
+
+const char* adapterStatusName(AdapterStatus status);
+uint8_t recoveryFor(AdapterStatus status);
+
+#endif // OBD_STATUS_H
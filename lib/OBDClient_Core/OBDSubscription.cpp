@@ -0,0 +1,112 @@
+#include "OBDSubscription.h"
+#include <math.h>
+
+const char* signalName(OBDSignal signal) {
+  static const char* const names[SIGNAL_COUNT] = {
+    "rpm", "speed", "coolant_temp", "oil_temp", "fuel_level", "throttle",
+    "engine_load", "airflow", "boost", "voltage", "manifold_pressure",
+    "baro_pressure", "fuel_rate", "fuel_economy", "avg_fuel_economy",
+    "trip_distance", "engine_running"
+  };
+  return signal < SIGNAL_COUNT ? names[signal] : "";
+}
+
+int SubscriptionTable::subscribe(OBDSignal signal, SignalCallback callback, void* context,
+                                 float deadband, uint32_t minIntervalMs) {
+  if (signal >= SIGNAL_COUNT || !callback) return -1;
+
+  for (uint8_t i = 0; i < OBD_MAX_SUBSCRIPTIONS; i++) {
+    if (usedMask & (1u << i)) continue;
+
+    OBDSubscription& sub = slots[i];
+    sub.callback = callback;
+    sub.context = context;
+    sub.deadband = deadband;
+    sub.minInterval = minIntervalMs;
+    sub.lastValue = 0.0f;
+    sub.pendingValue = 0.0f;
+    sub.lastTime = 0;
+    sub.signal = signal;
+    sub.delivered = false;
+    sub.pending = false;
+
+    usedMask |= 1u << i;
+    signalMask[signal] |= 1u << i;
+    return i;
+  }
+  return -1;
+}
+
+void SubscriptionTable::unsubscribe(int handle) {
+  if (handle < 0 || handle >= OBD_MAX_SUBSCRIPTIONS || !(usedMask & (1u << handle))) return;
+
+  uint16_t bit = 1u << handle;
+  usedMask &= ~bit;
+  pendingMask &= ~bit;
+  signalMask[slots[handle].signal] &= ~bit;
+}
+
+void SubscriptionTable::clear() {
+  usedMask = 0;
+  pendingMask = 0;
+  for (uint8_t i = 0; i < SIGNAL_COUNT; i++) signalMask[i] = 0;
+}
+
+void SubscriptionTable::deliver(OBDSubscription& sub, float value, uint32_t now) {
+  sub.lastValue = value;
+  sub.lastTime = now;
+  sub.delivered = true;
+  sub.pending = false;
+  delivered++;
+  sub.callback((OBDSignal)sub.signal, value, sub.context);
+}
+
+void SubscriptionTable::publish(OBDSignal signal, float value, uint32_t now) {
+  if (signal >= SIGNAL_COUNT) return;
+
+  uint16_t mask = signalMask[signal];
+  while (mask) {
+    uint8_t i = __builtin_ctz(mask);
+    mask &= mask - 1;
+    // A callback earlier in this loop may have unsubscribed this slot
+    if (!(signalMask[signal] & (1u << i))) continue;
+    OBDSubscription& sub = slots[i];
+
+    // Inside the deadband of the last delivered value: nothing to report,
+    // and any held-back change has been undone
+    if (sub.delivered && fabsf(value - sub.lastValue) <= sub.deadband) {
+      if (sub.pending) {
+        sub.pending = false;
+        pendingMask &= ~(1u << i);
+      }
+      suppressed++;
+      continue;
+    }
+
+    if (sub.delivered && now - sub.lastTime < sub.minInterval) {
+      sub.pendingValue = value;
+      sub.pending = true;
+      pendingMask |= 1u << i;
+      suppressed++;
+      continue;
+    }
+
+    pendingMask &= ~(1u << i);
+    deliver(sub, value, now);
+  }
+}
+
+void SubscriptionTable::poll(uint32_t now) {
+  uint16_t mask = pendingMask;
+  while (mask) {
+    uint8_t i = __builtin_ctz(mask);
+    mask &= mask - 1;
+    if (!(pendingMask & (1u << i))) continue;
+    OBDSubscription& sub = slots[i];
+
+    if (now - sub.lastTime >= sub.minInterval) {
+      pendingMask &= ~(1u << i);
+      deliver(sub, sub.pendingValue, now);
+    }
+  }
+}
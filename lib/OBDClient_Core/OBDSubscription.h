@@ -0,0 +1,78 @@
+#ifndef OBD_SUBSCRIPTION_H
+#define OBD_SUBSCRIPTION_H
+
+#include <stdint.h>
+
+// Subscription slots shared by all signals (bit per slot in the signal masks)
+#define OBD_MAX_SUBSCRIPTIONS 16
+
+// Published signals, in OBDData field order
+enum OBDSignal {
+  SIGNAL_RPM,
+  SIGNAL_SPEED,
+  SIGNAL_COOLANT_TEMP,
+  SIGNAL_OIL_TEMP,
+  SIGNAL_FUEL_LEVEL,
+  SIGNAL_THROTTLE,
+  SIGNAL_ENGINE_LOAD,
+  SIGNAL_AIRFLOW,
+  SIGNAL_BOOST,
+  SIGNAL_VOLTAGE,
+  SIGNAL_MANIFOLD_PRESSURE,
+  SIGNAL_BARO_PRESSURE,
+  SIGNAL_FUEL_RATE,          // Derived (L/h)
+  SIGNAL_FUEL_ECONOMY,       // Derived (L/100km, 0 when stopped)
+  SIGNAL_AVG_FUEL_ECONOMY,   // Derived (L/100km over the trip)
+  SIGNAL_TRIP_DISTANCE,      // Derived (km)
+  SIGNAL_ENGINE_RUNNING,     // Derived (1/0)
+  SIGNAL_COUNT
+};
+
+// Short snake_case name ("rpm", "coolant_temp"), used as JSON key / CSV column
+const char* signalName(OBDSignal signal);
+
+typedef void (*SignalCallback)(OBDSignal signal, float value, void* context);
+
+struct OBDSubscription {
+  SignalCallback callback;
+  void* context;
+  float deadband;               // Minimum change from the last delivered value
+  uint32_t minInterval;         // Minimum time between deliveries (ms)
+  float lastValue;              // Last delivered value
+  float pendingValue;           // Change held back by minInterval
+  uint32_t lastTime;
+  uint8_t signal;
+  bool delivered;               // lastValue is valid
+  bool pending;
+};
+
+// Fixed subscription table: publish() only looks at the slots registered for
+// that signal and never allocates. A change held back by the minimum
+// interval is delivered by a later publish() or poll().
+class SubscriptionTable {
+public:
+  // Returns a handle for unsubscribe(), -1 when the table is full
+  int subscribe(OBDSignal signal, SignalCallback callback, void* context,
+                float deadband, uint32_t minIntervalMs);
+  void unsubscribe(int handle);
+  void clear();
+
+  void publish(OBDSignal signal, float value, uint32_t now);
+  void poll(uint32_t now);        // Deliver held-back changes that are due
+  bool hasSubscribers(OBDSignal signal) const { return signal < SIGNAL_COUNT && signalMask[signal]; }
+
+  uint32_t getDelivered() const { return delivered; }
+  uint32_t getSuppressed() const { return suppressed; }
+
+private:
+  void deliver(OBDSubscription& sub, float value, uint32_t now);
+
+  OBDSubscription slots[OBD_MAX_SUBSCRIPTIONS];
+  uint16_t signalMask[SIGNAL_COUNT] = {};
+  uint16_t pendingMask = 0;
+  uint16_t usedMask = 0;
+  uint32_t delivered = 0;
+  uint32_t suppressed = 0;
+};
+
+#endif // OBD_SUBSCRIPTION_H
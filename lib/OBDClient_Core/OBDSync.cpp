@@ -0,0 +1,108 @@
+#include "OBDSync.h"
+
+#if defined(ESP_PLATFORM)
+
+OBDMutex::OBDMutex() : handle(xSemaphoreCreateRecursiveMutex()) {}
+OBDMutex::~OBDMutex() { vSemaphoreDelete(handle); }
+void OBDMutex::lock() { xSemaphoreTakeRecursive(handle, portMAX_DELAY); }
+void OBDMutex::unlock() { xSemaphoreGiveRecursive(handle); }
+
+OBDEvent::OBDEvent() : handle(xSemaphoreCreateBinary()) {}
+OBDEvent::~OBDEvent() { vSemaphoreDelete(handle); }
+void OBDEvent::notify() { xSemaphoreGive(handle); }
+bool OBDEvent::wait(uint32_t timeoutMs) {
+  return xSemaphoreTake(handle, pdMS_TO_TICKS(timeoutMs)) == pdTRUE;
+}
+
+bool OBDThread::start(Function fn, void* arg, const char* name, uint32_t stackSize,
+                      uint8_t priority, int8_t core) {
+  if (running) return false;
+  if (!finished) finished = xSemaphoreCreateBinary();
+  if (!finished) return false;
+  xSemaphoreTake(finished, 0);        // Left given by a run that was never joined
+  function = fn;
+  argument = arg;
+  running = true;
+
+  BaseType_t ok = xTaskCreatePinnedToCore(entry, name, stackSize, this, priority, &task,
+                                          core < 0 ? tskNO_AFFINITY : core);
+  if (ok != pdPASS) {
+    running = false;
+    task = nullptr;
+  }
+  return running;
+}
+
+void OBDThread::entry(void* self) {
+  OBDThread* thread = static_cast<OBDThread*>(self);
+  thread->function(thread->argument);
+  thread->running = false;
+  xSemaphoreGive(thread->finished);   // Last access: the owner may go away after join()
+  vTaskDelete(nullptr);
+}
+
+void OBDThread::join() {
+  if (!task) return;
+  // fn asking for its own stop: it returns by itself, waiting would deadlock
+  if (xTaskGetCurrentTaskHandle() == task) return;
+  xSemaphoreTake(finished, portMAX_DELAY);
+  task = nullptr;
+}
+
+OBDThread::~OBDThread() {
+  join();
+  if (finished) vSemaphoreDelete(finished);
+}
+
+#else
+
+OBDMutex::OBDMutex() {}
+OBDMutex::~OBDMutex() {}
+void OBDMutex::lock() { mutex.lock(); }
+void OBDMutex::unlock() { mutex.unlock(); }
+
+OBDEvent::OBDEvent() {}
+OBDEvent::~OBDEvent() {}
+void OBDEvent::notify() {
+  std::lock_guard<std::mutex> guard(mutex);
+  signaled = true;
+  cv.notify_one();
+}
+bool OBDEvent::wait(uint32_t timeoutMs) {
+  std::unique_lock<std::mutex> guard(mutex);
+  bool notified = cv.wait_for(guard, std::chrono::milliseconds(timeoutMs), [this] { return signaled; });
+  signaled = false;
+  return notified;
+}
+
+bool OBDThread::start(Function fn, void* arg, const char*, uint32_t, uint8_t, int8_t) {
+  if (running) return false;
+  if (thread.joinable()) thread.join();   // Finished on its own, not joined yet
+  function = fn;
+  argument = arg;
+  running = true;
+  thread = std::thread(entry, this);
+  return true;
+}
+
+void OBDThread::entry(void* self) {
+  OBDThread* thread = static_cast<OBDThread*>(self);
+  thread->function(thread->argument);
+  thread->running = false;
+}
+
+void OBDThread::join() {
+  if (!thread.joinable()) return;
+  // fn asking for its own stop: it returns by itself, joining would deadlock
+  if (thread.get_id() == std::this_thread::get_id()) {
+    thread.detach();
+    return;
+  }
+  thread.join();
+}
+
+OBDThread::~OBDThread() {
+  join();
+}
+
+#endif
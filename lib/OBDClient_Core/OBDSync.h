@@ -0,0 +1,110 @@
+#ifndef OBD_SYNC_H
+#define OBD_SYNC_H
+
+#include <stdint.h>
+
+// Thin synchronization layer: FreeRTOS on the ESP32, std::thread primitives
+// on a host build, so the poller/scheduler logic can run in both.
+#if defined(ESP_PLATFORM)
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+#else
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif
+
+// Recursive mutex (user callbacks may call back into the client)
+class OBDMutex {
+public:
+  OBDMutex();
+  ~OBDMutex();
+  void lock();
+  void unlock();
+
+private:
+#if defined(ESP_PLATFORM)
+  SemaphoreHandle_t handle;
+#else
+  std::recursive_mutex mutex;
+#endif
+};
+
+class OBDLockGuard {
+public:
+  explicit OBDLockGuard(OBDMutex& m) : mutex(m) { mutex.lock(); }
+  ~OBDLockGuard() { mutex.unlock(); }
+  OBDLockGuard(const OBDLockGuard&) = delete;
+  OBDLockGuard& operator=(const OBDLockGuard&) = delete;
+
+private:
+  OBDMutex& mutex;
+};
+
+// Reference to an object owned by a locked structure: the lock is held for
+// the lifetime of the handle, so keep it short (one statement or one block)
+template <typename T>
+class OBDLockedRef {
+public:
+  OBDLockedRef(OBDMutex& m, T& target) : mutex(&m), object(&target) { mutex->lock(); }
+  OBDLockedRef(OBDLockedRef&& other) : mutex(other.mutex), object(other.object) { other.mutex = nullptr; }
+  ~OBDLockedRef() { if (mutex) mutex->unlock(); }
+  OBDLockedRef(const OBDLockedRef&) = delete;
+  OBDLockedRef& operator=(const OBDLockedRef&) = delete;
+
+  T* operator->() const { return object; }
+  T& operator*() const { return *object; }
+
+private:
+  OBDMutex* mutex;
+  T* object;
+};
+
+// Binary wake-up event: BLE callback -> poller
+class OBDEvent {
+public:
+  OBDEvent();
+  ~OBDEvent();
+  void notify();
+  bool wait(uint32_t timeoutMs);   // true if notified, false on timeout
+
+private:
+#if defined(ESP_PLATFORM)
+  SemaphoreHandle_t handle;
+#else
+  std::mutex mutex;
+  std::condition_variable cv;
+  bool signaled = false;
+#endif
+};
+
+// Worker thread: pinned FreeRTOS task on the ESP32, std::thread on a host
+class OBDThread {
+public:
+  typedef void (*Function)(void* arg);
+
+  // core < 0 lets the platform choose; priority/core are ignored on a host
+  bool start(Function fn, void* arg, const char* name, uint32_t stackSize,
+             uint8_t priority, int8_t core);
+  void join();                        // Returns once fn has returned (no-op from fn itself)
+  bool isRunning() const { return running; }
+  ~OBDThread();
+
+private:
+  static void entry(void* self);
+
+  Function function = nullptr;
+  void* argument = nullptr;
+#if defined(ESP_PLATFORM)
+  TaskHandle_t task = nullptr;
+  SemaphoreHandle_t finished = nullptr;   // Given by the task as fn returns
+  volatile bool running = false;
+#else
+  std::thread thread;
+  std::atomic<bool> running{false};
+#endif
+};
+
+#endif // OBD_SYNC_H
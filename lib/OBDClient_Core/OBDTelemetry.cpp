@@ -0,0 +1,99 @@
+#include "OBDTelemetry.h"
+#include <math.h>
+
+uint16_t crc16CCITT(const uint8_t* data, size_t length, uint16_t crc) {
+  for (size_t i = 0; i < length; i++) {
+    crc ^= (uint16_t)data[i] << 8;
+    for (uint8_t bit = 0; bit < 8; bit++) {
+      crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+    }
+  }
+  return crc;
+}
+
+size_t cobsEncode(const uint8_t* in, size_t length, uint8_t* out) {
+  size_t codeIndex = 0;
+  size_t outIndex = 1;
+  uint8_t code = 1;
+
+  for (size_t i = 0; i < length; i++) {
+    if (in[i] != 0) {
+      out[outIndex++] = in[i];
+      code++;
+    }
+    if (in[i] == 0 || code == 0xFF) {
+      out[codeIndex] = code;
+      code = 1;
+      codeIndex = outIndex;
+      if (in[i] == 0 || i + 1 < length) outIndex++;
+    }
+  }
+  out[codeIndex] = code;
+  return outIndex;
+}
+
+static size_t putVarint(uint8_t* out, uint32_t value) {
+  size_t n = 0;
+  while (value >= 0x80) {
+    out[n++] = (uint8_t)(value | 0x80);
+    value >>= 7;
+  }
+  out[n++] = (uint8_t)value;
+  return n;
+}
+
+static uint32_t zigzag(int32_t value) {
+  return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+void TelemetryEncoder::record(OBDSignal signal, float value) {
+  if (signal >= SIGNAL_COUNT) return;
+  current[signal] = (int32_t)lroundf(value * TELEMETRY_SCALE);
+  pendingMask |= 1u << signal;
+  knownMask |= 1u << signal;
+}
+
+void TelemetryEncoder::reset() {
+  needKeyframe = true;
+}
+
+size_t TelemetryEncoder::encode(uint32_t now, uint8_t* out, size_t outSize) {
+  if (!pendingMask || outSize < TELEMETRY_MAX_FRAME) return 0;
+
+  bool keyframe = needKeyframe || sinceKeyframe >= TELEMETRY_KEYFRAME_EVERY;
+  uint32_t mask = keyframe ? knownMask : pendingMask;
+
+  uint8_t packet[TELEMETRY_MAX_PACKET];
+  size_t n = 0;
+  packet[n++] = keyframe ? TELEMETRY_FRAME_KEY : TELEMETRY_FRAME_DELTA;
+  packet[n++] = sequence++;
+  n += putVarint(packet + n, keyframe ? now : now - lastTime);
+  n += putVarint(packet + n, mask);
+
+  for (uint32_t bits = mask; bits; bits &= bits - 1) {
+    uint8_t signal = __builtin_ctz(bits);
+    int32_t value = keyframe ? current[signal] : current[signal] - sent[signal];
+    n += putVarint(packet + n, zigzag(value));
+    sent[signal] = current[signal];
+    samples++;
+  }
+
+  uint16_t crc = crc16CCITT(packet, n);
+  packet[n++] = crc & 0xFF;
+  packet[n++] = crc >> 8;
+
+  // A keyframe also starts with a delimiter so text printed before it
+  // (boot messages, debug output) cannot swallow the frame
+  size_t length = 0;
+  if (keyframe) out[length++] = 0x00;
+  length += cobsEncode(packet, n, out + length);
+  out[length++] = 0x00;
+
+  lastTime = now;
+  pendingMask = 0;
+  needKeyframe = false;
+  sinceKeyframe = keyframe ? 0 : sinceKeyframe + 1;
+  frames++;
+  bytes += length;
+  return length;
+}
@@ -0,0 +1,56 @@
+#ifndef OBD_TELEMETRY_H
+#define OBD_TELEMETRY_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "OBDSubscription.h"
+
+// Binary telemetry stream (decoded by tools/telemetry_decode.py)
+//
+// Each frame is COBS encoded and terminated by 0x00 (keyframes also start with one):
+//   type (1)  seq (1)  time (varint)  mask (varint)  values (zigzag varints)  crc16 (2, LE)
+// Keyframe (type 2): time = absolute ms, mask = every known signal, values absolute.
+// Delta frame (type 1): time = ms since the previous frame, mask = signals
+// updated since then, values = change from the previous value.
+// Values are fixed point in TELEMETRY_SCALE units per signal unit.
+// CRC16-CCITT (0x1021, init 0xFFFF) covers everything before it.
+#define TELEMETRY_FRAME_DELTA     1
+#define TELEMETRY_FRAME_KEY       2
+#define TELEMETRY_SCALE           100
+#define TELEMETRY_KEYFRAME_EVERY  50     // Frames between keyframes (resync after loss)
+#define TELEMETRY_MAX_PACKET      (4 + 5 + 5 + SIGNAL_COUNT * 5)
+#define TELEMETRY_MAX_FRAME       (TELEMETRY_MAX_PACKET + TELEMETRY_MAX_PACKET / 254 + 3)
+
+uint16_t crc16CCITT(const uint8_t* data, size_t length, uint16_t crc = 0xFFFF);
+
+// COBS encode (no trailing delimiter); out needs length + length / 254 + 1 bytes
+size_t cobsEncode(const uint8_t* in, size_t length, uint8_t* out);
+
+class TelemetryEncoder {
+public:
+  void record(OBDSignal signal, float value);
+  // Encode everything recorded since the last call into one delimited frame.
+  // Returns the frame length, 0 when nothing changed or out is too small.
+  size_t encode(uint32_t now, uint8_t* out, size_t outSize);
+  void reset();                       // Next frame is a keyframe
+
+  uint32_t getFrames() const { return frames; }
+  uint32_t getSamples() const { return samples; }
+  uint32_t getBytes() const { return bytes; }
+
+private:
+  int32_t current[SIGNAL_COUNT] = {};
+  int32_t sent[SIGNAL_COUNT] = {};
+  uint32_t pendingMask = 0;
+  uint32_t knownMask = 0;
+  uint32_t lastTime = 0;
+  uint8_t sequence = 0;
+  uint8_t sinceKeyframe = 0;
+  bool needKeyframe = true;
+
+  uint32_t frames = 0;
+  uint32_t samples = 0;
+  uint32_t bytes = 0;
+};
+
+#endif // OBD_TELEMETRY_H
@@ -52,6 +52,14 @@ void loop() {
 
 // Optional: Add custom functions for your specific application
 /*
+// Redraw only what changed: subscribe once in setup(), e.g.
+//   obdClient.subscribe(SIGNAL_RPM, onSignalChange, nullptr, 50.0f, 200);    // 50 rpm, 5 Hz max
+//   obdClient.subscribe(SIGNAL_SPEED, onSignalChange, nullptr, 1.0f, 500);
+void onSignalChange(OBDSignal signal, float value, void* context) {
+  lcd.setCursor(0, signal == SIGNAL_RPM ? 0 : 1);
+  lcd.print(value);
+}
+
 void displayOnLCD() {
   if (obdClient.isConnected()) {
     OBDData data = obdClient.getCurrentData();
@@ -65,11 +73,15 @@ void displayOnLCD() {
 
 void sendToWebServer() {
   if (obdClient.isConnected()) {
-    OBDData data = obdClient.getCurrentData();
-    // Your web server code here
-    webServer.send(200, "application/json", 
-      "{\"rpm\":" + String(data.rpm) + 
-      ",\"speed\":" + String(data.speed) + "}");
+    // Your web server code here (JSON template built once: {"rpm":...,"speed":...})
+    static SnapshotSerializer json;
+    if (json.getFieldCount() == 0) {
+      json.addField(SIGNAL_RPM, 0);
+      json.addField(SIGNAL_SPEED, 0);
+    }
+    char payload[64];
+    obdClient.serialize(json, payload, sizeof(payload));
+    webServer.send(200, "application/json", payload);
   }
 }
 */
\ No newline at end of file
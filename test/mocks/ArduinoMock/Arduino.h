@@ -0,0 +1,181 @@
+#ifndef ARDUINO_MOCK_H
+#define ARDUINO_MOCK_H
+
+// Host stand-in for the parts of the Arduino core the OBD library uses.
+// Native test builds only (see [env:native] in platformio.ini).
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
+#include <string>
+#include <algorithm>
+
+using std::min;
+using std::max;
+
+#define DEC 10
+#define HEX 16
+
+// Time runs only when a test advances it (or the code under test calls delay)
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void yield();
+
+// Arduino String with the ESP32 core's storage rules: a small inline buffer,
+// heap past that, growth rounded up to 16 bytes and never shrunk, so the
+// host allocation counts match what the library does on the device
+class String {
+public:
+  String(const char* text = "") { copy(text ? text : "", text ? (unsigned int)strlen(text) : 0); }
+  String(const String& other) { copy(other.buffer(), other.len); }
+  String(String&& other) noexcept { take(other); }
+  explicit String(char c) { copy(&c, 1); }
+  explicit String(int value, unsigned char base = DEC);
+  explicit String(unsigned int value, unsigned char base = DEC);
+  explicit String(long value, unsigned char base = DEC);
+  explicit String(unsigned long value, unsigned char base = DEC);
+  explicit String(float value, unsigned int decimals = 2);
+  explicit String(double value, unsigned int decimals = 2);
+  ~String();
+
+  String& operator=(const String& other) { if (this != &other) copy(other.buffer(), other.len); return *this; }
+  String& operator=(String&& other) noexcept;
+  String& operator=(const char* text) { copy(text ? text : "", text ? (unsigned int)strlen(text) : 0); return *this; }
+
+  unsigned int length() const { return len; }
+  bool isEmpty() const { return len == 0; }
+  const char* c_str() const { return buffer(); }
+  char charAt(unsigned int index) const { return index < len ? buffer()[index] : 0; }
+  char operator[](unsigned int index) const { return charAt(index); }
+  bool reserve(unsigned int size);
+  void clear() { setLength(0); }
+
+  bool concat(const String& other) { return concat(other.buffer(), other.len); }
+  bool concat(const char* text) { return text ? concat(text, (unsigned int)strlen(text)) : false; }
+  bool concat(const char* text, unsigned int length);
+  bool concat(char c) { return concat(&c, 1); }
+  String& operator+=(const String& other) { concat(other); return *this; }
+  String& operator+=(const char* text) { concat(text); return *this; }
+  String& operator+=(char c) { concat(c); return *this; }
+
+  int indexOf(char c, unsigned int from = 0) const;
+  int indexOf(const char* text, unsigned int from = 0) const;
+  int indexOf(const String& text, unsigned int from = 0) const { return indexOf(text.buffer(), from); }
+  int lastIndexOf(char c) const;
+  bool startsWith(const String& prefix) const {
+    return prefix.len <= len && memcmp(buffer(), prefix.buffer(), prefix.len) == 0;
+  }
+  bool endsWith(const String& suffix) const {
+    return suffix.len <= len && memcmp(buffer() + len - suffix.len, suffix.buffer(), suffix.len) == 0;
+  }
+  bool equals(const String& other) const { return len == other.len && memcmp(buffer(), other.buffer(), len) == 0; }
+  bool equalsIgnoreCase(const String& other) const;
+
+  String substring(unsigned int from) const { return substring(from, len); }
+  String substring(unsigned int from, unsigned int to) const;
+  void remove(unsigned int index) { if (index < len) setLength(index); }
+  void remove(unsigned int index, unsigned int count);
+  void replace(const String& find, const String& with);
+  void replace(char find, char with);
+  void trim();
+  void toUpperCase();
+  void toLowerCase();
+  long toInt() const { return strtol(buffer(), nullptr, 10); }
+  float toFloat() const { return strtof(buffer(), nullptr); }
+
+  bool operator==(const String& other) const { return equals(other); }
+  bool operator==(const char* text) const { return strcmp(buffer(), text ? text : "") == 0; }
+  bool operator!=(const String& other) const { return !equals(other); }
+  bool operator!=(const char* text) const { return !(*this == text); }
+  bool operator<(const String& other) const { return strcmp(buffer(), other.buffer()) < 0; }
+
+  friend String operator+(const String& a, const String& b) { String sum(a); sum.concat(b); return sum; }
+  friend String operator+(const String& a, const char* b) { String sum(a); sum.concat(b); return sum; }
+  friend String operator+(const char* a, const String& b) { String sum(a); sum.concat(b); return sum; }
+  friend String operator+(const String& a, char b) { String sum(a); sum.concat(b); return sum; }
+
+  // Host-only convenience for tests
+  explicit String(const std::string& text) { copy(text.data(), (unsigned int)text.size()); }
+  std::string str() const { return std::string(buffer(), len); }
+
+private:
+  enum { INLINE_CAPACITY = 10 };    // ESP32 core: 11-byte small-string buffer
+
+  const char* buffer() const { return heap ? heap : inlineBuffer; }
+  char* buffer() { return heap ? heap : inlineBuffer; }
+  unsigned int capacity() const { return heap ? heapCapacity : (unsigned int)INLINE_CAPACITY; }
+  void setLength(unsigned int length) { len = length; buffer()[len] = 0; }
+  void copy(const char* text, unsigned int length);
+  void take(String& other);
+  void setFormatted(const char* text) { copy(text, (unsigned int)strlen(text)); }
+
+  char* heap = nullptr;
+  unsigned int heapCapacity = 0;
+  unsigned int len = 0;
+  char inlineBuffer[INLINE_CAPACITY + 1] = {0};
+};
+
+class Print {
+public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t write(const uint8_t* buffer, size_t size);
+  size_t write(const char* text) { return text ? write((const uint8_t*)text, strlen(text)) : 0; }
+  size_t write(const char* buffer, size_t size) { return write((const uint8_t*)buffer, size); }
+
+  size_t print(const char* text) { return write(text); }
+  size_t print(const String& text) { return write((const uint8_t*)text.c_str(), text.length()); }
+  size_t print(char c) { return write((uint8_t)c); }
+  size_t print(int value, int base = DEC) { return print(String(value, (unsigned char)base)); }
+  size_t print(unsigned int value, int base = DEC) { return print(String(value, (unsigned char)base)); }
+  size_t print(long value, int base = DEC) { return print(String(value, (unsigned char)base)); }
+  size_t print(unsigned long value, int base = DEC) { return print(String(value, (unsigned char)base)); }
+  size_t print(double value, int decimals = 2) { return print(String(value, (unsigned int)decimals)); }
+
+  template <typename T> size_t println(const T& value) { return print(value) + println(); }
+  template <typename T> size_t println(const T& value, int format) { return print(value, format) + println(); }
+  size_t println() { return write("\r\n"); }
+
+  size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+};
+
+// Serial: output is collected for tests that check it and echoed to stdout
+// when OBD_TEST_VERBOSE is set in the environment
+class HardwareSerial : public Print {
+public:
+  void begin(unsigned long) {}
+  void flush() {}
+  operator bool() const { return true; }
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t* buffer, size_t size) override;
+  using Print::write;
+
+  std::string takeOutput();       // Everything printed since the last call
+  void setWriteHook(void (*hook)()) { writeHook = hook; }   // Runs after each write
+
+private:
+  void (*volatile writeHook)() = nullptr;
+};
+
+extern HardwareSerial Serial;
+
+class EspClass {
+public:
+  uint32_t getFreeHeap();
+  uint32_t getMinFreeHeap();
+  uint32_t getHeapSize();
+  uint32_t getMaxAllocHeap();
+  const char* getChipModel() { return "host"; }
+  uint8_t getChipRevision() { return 0; }
+  uint32_t getCpuFreqMHz() { return 240; }
+  void restart() {}
+};
+
+extern EspClass ESP;
+
+#endif // ARDUINO_MOCK_H
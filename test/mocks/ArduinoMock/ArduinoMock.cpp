@@ -0,0 +1,298 @@
+#include "Arduino.h"
+#include "MockClock.h"
+#include <stdarg.h>
+#include <atomic>
+#include <mutex>
+#include <new>
+#include <thread>
+
+// ---- Clock -------------------------------------------------------------
+
+static std::atomic<unsigned long> nowMs(1000);
+static std::atomic<unsigned long> extraMicros(0);
+static std::atomic<MockDelayHook> delayHook(nullptr);
+
+unsigned long millis() { return nowMs.load(); }
+unsigned long micros() { return nowMs.load() * 1000UL + extraMicros.load(); }
+
+void delay(unsigned long ms) {
+  mockAdvance(ms);
+  std::this_thread::yield();
+}
+
+void yield() { std::this_thread::yield(); }
+
+void mockSetMillis(unsigned long ms) { nowMs = ms; }
+
+void mockAdvance(unsigned long ms) {
+  nowMs += ms;
+  MockDelayHook hook = delayHook.load();
+  if (hook) hook();
+}
+
+void mockSetDelayHook(MockDelayHook hook) { delayHook = hook; }
+
+// ---- Harness allocations -----------------------------------------------
+// operator new goes through malloc so the --wrap=malloc counter in
+// OBDMemory.cpp sees String and container allocations made by the library.
+// Allocations the simulator makes on the library's behalf (inside a
+// MockHarnessScope) bypass the counter.
+
+static thread_local int harnessDepth = 0;
+
+MockHarnessScope::MockHarnessScope() { harnessDepth++; }
+MockHarnessScope::~MockHarnessScope() { harnessDepth--; }
+MockLibraryScope::MockLibraryScope() : saved(harnessDepth) { harnessDepth = 0; }
+MockLibraryScope::~MockLibraryScope() { harnessDepth = saved; }
+
+#if defined(OBD_COUNT_ALLOCATIONS)
+extern "C" void* __real_malloc(size_t size);
+static void* mockMalloc(size_t size) { return harnessDepth ? __real_malloc(size) : malloc(size); }
+#else
+static void* mockMalloc(size_t size) { return malloc(size); }
+#endif
+
+void* operator new(size_t size) {
+  void* p = mockMalloc(size ? size : 1);
+  if (!p) throw std::bad_alloc();
+  return p;
+}
+void* operator new[](size_t size) { return operator new(size); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return mockMalloc(size ? size : 1); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return mockMalloc(size ? size : 1); }
+void operator delete(void* p) noexcept { free(p); }
+void operator delete[](void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+void operator delete[](void* p, size_t) noexcept { free(p); }
+
+// ---- String ------------------------------------------------------------
+
+#if defined(OBD_COUNT_ALLOCATIONS)
+extern "C" void* __real_realloc(void* p, size_t size);
+static void* mockRealloc(void* p, size_t size) { return harnessDepth ? __real_realloc(p, size) : realloc(p, size); }
+#else
+static void* mockRealloc(void* p, size_t size) { return realloc(p, size); }
+#endif
+
+static void formatUnsigned(char* out, unsigned long value, unsigned char base) {
+  if (base < 2 || base > 36) base = DEC;
+  char digits[72];
+  size_t pos = sizeof(digits);
+  digits[--pos] = 0;
+  do {
+    unsigned digit = (unsigned)(value % base);
+    digits[--pos] = (char)(digit < 10 ? '0' + digit : 'A' + digit - 10);
+    value /= base;
+  } while (value);
+  strcpy(out, digits + pos);
+}
+
+static void formatSigned(char* out, long value, unsigned char base) {
+  if (base == DEC) snprintf(out, 72, "%ld", value);
+  else formatUnsigned(out, (unsigned long)value, base);
+}
+
+String::String(int value, unsigned char base) { char t[72]; formatSigned(t, value, base); setFormatted(t); }
+String::String(unsigned int value, unsigned char base) { char t[72]; formatUnsigned(t, value, base); setFormatted(t); }
+String::String(long value, unsigned char base) { char t[72]; formatSigned(t, value, base); setFormatted(t); }
+String::String(unsigned long value, unsigned char base) { char t[72]; formatUnsigned(t, value, base); setFormatted(t); }
+String::String(float value, unsigned int decimals) { char t[72]; snprintf(t, sizeof(t), "%.*f", (int)decimals, value); setFormatted(t); }
+String::String(double value, unsigned int decimals) { char t[72]; snprintf(t, sizeof(t), "%.*f", (int)decimals, value); setFormatted(t); }
+
+String::~String() { free(heap); }
+
+String& String::operator=(String&& other) noexcept {
+  if (this != &other) {
+    free(heap);
+    heap = nullptr;
+    take(other);
+  }
+  return *this;
+}
+
+void String::take(String& other) {
+  heap = other.heap;
+  heapCapacity = other.heapCapacity;
+  len = other.len;
+  if (!heap) memcpy(inlineBuffer, other.inlineBuffer, sizeof(inlineBuffer));
+  other.heap = nullptr;
+  other.heapCapacity = 0;
+  other.setLength(0);
+}
+
+// Like the core's changeBuffer(): grow to the next multiple of 16, keep the
+// contents, never shrink
+bool String::reserve(unsigned int size) {
+  if (size <= capacity()) return true;
+  unsigned int rounded = (size + 16) & ~0xfu;
+  char* grown = (char*)mockRealloc(heap, rounded);
+  if (!grown) return false;
+  if (!heap) memcpy(grown, inlineBuffer, len + 1);
+  heap = grown;
+  heapCapacity = rounded - 1;
+  return true;
+}
+
+void String::copy(const char* text, unsigned int length) {
+  if (!reserve(length)) return;
+  memmove(buffer(), text, length);
+  setLength(length);
+}
+
+bool String::concat(const char* text, unsigned int length) {
+  if (!text) return false;
+  if (length == 0) return true;
+  // Appending part of ourselves: remember the offset across a realloc
+  const char* base = buffer();
+  bool self = text >= base && text < base + len + 1;
+  size_t offset = self ? (size_t)(text - base) : 0;
+  if (!reserve(len + length)) return false;
+  memmove(buffer() + len, self ? buffer() + offset : text, length);
+  setLength(len + length);
+  return true;
+}
+
+int String::indexOf(char c, unsigned int from) const {
+  if (from >= len) return -1;
+  const char* hit = (const char*)memchr(buffer() + from, c, len - from);
+  return hit ? (int)(hit - buffer()) : -1;
+}
+
+int String::indexOf(const char* text, unsigned int from) const {
+  if (!text || from > len) return -1;
+  const char* hit = strstr(buffer() + from, text);
+  return hit ? (int)(hit - buffer()) : -1;
+}
+
+int String::lastIndexOf(char c) const {
+  for (unsigned int i = len; i-- > 0;) {
+    if (buffer()[i] == c) return (int)i;
+  }
+  return -1;
+}
+
+bool String::equalsIgnoreCase(const String& other) const {
+  if (len != other.len) return false;
+  for (unsigned int i = 0; i < len; i++) {
+    if (tolower((unsigned char)buffer()[i]) != tolower((unsigned char)other.buffer()[i])) return false;
+  }
+  return true;
+}
+
+String String::substring(unsigned int from, unsigned int to) const {
+  if (from > to) std::swap(from, to);
+  String out;
+  if (from >= len) return out;
+  if (to > len) to = len;
+  out.copy(buffer() + from, to - from);
+  return out;
+}
+
+void String::remove(unsigned int index, unsigned int count) {
+  if (index >= len || count == 0) return;
+  if (count > len - index) count = len - index;
+  memmove(buffer() + index, buffer() + index + count, len - index - count);
+  setLength(len - count);
+}
+
+void String::replace(const String& find, const String& with) {
+  if (find.len == 0 || len == 0) return;
+  // Count first so a longer replacement grows the buffer once
+  unsigned int hits = 0;
+  for (int pos = indexOf(find); pos >= 0; pos = indexOf(find, pos + find.len)) hits++;
+  if (!hits) return;
+  if (with.len > find.len && !reserve(len + hits * (with.len - find.len))) return;
+  if (&find == this || &with == this) {
+    String pattern(find), replacement(with);
+    replace(pattern, replacement);
+    return;
+  }
+  for (int pos = indexOf(find); pos >= 0; pos = indexOf(find, pos + with.len)) {
+    char* at = buffer() + pos;
+    memmove(at + with.len, at + find.len, len - pos - find.len);
+    memcpy(at, with.buffer(), with.len);
+    setLength(len - find.len + with.len);
+  }
+}
+
+void String::replace(char find, char with) {
+  for (unsigned int i = 0; i < len; i++) {
+    if (buffer()[i] == find) buffer()[i] = with;
+  }
+}
+
+void String::trim() {
+  unsigned int start = 0;
+  while (start < len && isspace((unsigned char)buffer()[start])) start++;
+  unsigned int end = len;
+  while (end > start && isspace((unsigned char)buffer()[end - 1])) end--;
+  memmove(buffer(), buffer() + start, end - start);
+  setLength(end - start);
+}
+
+void String::toUpperCase() {
+  for (unsigned int i = 0; i < len; i++) buffer()[i] = (char)toupper((unsigned char)buffer()[i]);
+}
+
+void String::toLowerCase() {
+  for (unsigned int i = 0; i < len; i++) buffer()[i] = (char)tolower((unsigned char)buffer()[i]);
+}
+
+// ---- Print / Serial ----------------------------------------------------
+
+size_t Print::write(const uint8_t* buffer, size_t size) {
+  size_t written = 0;
+  while (size--) written += write(*buffer++);
+  return written;
+}
+
+size_t Print::printf(const char* format, ...) {
+  char buf[256];
+  va_list args;
+  va_start(args, format);
+  int length = vsnprintf(buf, sizeof(buf), format, args);
+  va_end(args);
+  if (length < 0) return 0;
+  return write((const uint8_t*)buf, std::min((size_t)length, sizeof(buf) - 1));
+}
+
+static std::mutex serialLock;
+static std::string serialOutput;
+static const bool serialEcho = getenv("OBD_TEST_VERBOSE") != nullptr;
+
+size_t HardwareSerial::write(uint8_t c) {
+  return write(&c, 1);
+}
+
+size_t HardwareSerial::write(const uint8_t* buffer, size_t size) {
+  MockHarnessScope harness;
+  {
+    std::lock_guard<std::mutex> guard(serialLock);
+    if (serialEcho) fwrite(buffer, 1, size, stdout);
+    // Bounded: long runs keep only the tail
+    if (serialOutput.size() > 1 << 20) serialOutput.erase(0, serialOutput.size() / 2);
+    serialOutput.append((const char*)buffer, size);
+  }
+  void (*hook)() = writeHook;
+  if (hook) hook();
+  return size;
+}
+
+std::string HardwareSerial::takeOutput() {
+  MockHarnessScope harness;
+  std::lock_guard<std::mutex> guard(serialLock);
+  std::string out;
+  out.swap(serialOutput);
+  return out;
+}
+
+HardwareSerial Serial;
+
+// ---- ESP ---------------------------------------------------------------
+
+uint32_t EspClass::getFreeHeap() { return 250000; }
+uint32_t EspClass::getMinFreeHeap() { return 240000; }
+uint32_t EspClass::getHeapSize() { return 320000; }
+uint32_t EspClass::getMaxAllocHeap() { return 110000; }
+
+EspClass ESP;
@@ -0,0 +1,6 @@
+#ifndef BLE_ADVERTISED_DEVICE_MOCK_H
+#define BLE_ADVERTISED_DEVICE_MOCK_H
+
+#include "BLEMock.h"
+
+#endif // BLE_ADVERTISED_DEVICE_MOCK_H
@@ -0,0 +1,6 @@
+#ifndef BLE_CLIENT_MOCK_H
+#define BLE_CLIENT_MOCK_H
+
+#include "BLEMock.h"
+
+#endif // BLE_CLIENT_MOCK_H
@@ -0,0 +1,6 @@
+#ifndef BLE_DEVICE_MOCK_H
+#define BLE_DEVICE_MOCK_H
+
+#include "BLEMock.h"
+
+#endif // BLE_DEVICE_MOCK_H
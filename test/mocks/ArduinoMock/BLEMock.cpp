@@ -0,0 +1,100 @@
+#include "BLEMock.h"
+#include "MockClock.h"
+#include "SimAdapter.h"
+
+#define MOCK_TX_UUID "6E400002-B5A3-F393-E0A9-E50E24DCCA9E"
+#define MOCK_RX_UUID "6E400003-B5A3-F393-E0A9-E50E24DCCA9E"
+
+static BLEScan scan;
+static bool initialized = false;
+static uint32_t clientsCreated = 0;
+static uint32_t scanBeforeInit = 0;
+
+// ---- BLEDevice ---------------------------------------------------------
+
+void BLEDevice::init(const String&) { initialized = true; }
+void BLEDevice::deinit(bool) { initialized = false; }
+
+BLEScan* BLEDevice::getScan() {
+  if (!initialized) scanBeforeInit++;
+  return &scan;
+}
+
+BLEClient* BLEDevice::createClient() {
+  clientsCreated++;
+  return new BLEClient();
+}
+
+bool BLEDevice::isInitialized() { return initialized; }
+uint32_t BLEDevice::getClientsCreated() { return clientsCreated; }
+uint32_t BLEDevice::getScanBeforeInit() { return scanBeforeInit; }
+
+// ---- BLEScan -----------------------------------------------------------
+
+void BLEScan::setAdvertisedDeviceCallbacks(BLEAdvertisedDeviceCallbacks* callbacks, bool, bool) {
+  this->callbacks = callbacks;
+}
+
+// Results arrive through the callbacks while the scan runs; tests deliver
+// them with SimAdapter::advertise()
+BLEScanResults BLEScan::start(uint32_t, bool) {
+  scanning = true;
+  starts++;
+  return BLEScanResults();
+}
+
+void BLEScan::stop() { scanning = false; }
+
+// ---- BLEClient ---------------------------------------------------------
+
+BLEClient::BLEClient() {
+  service.tx.owner = this;
+  service.rx.owner = this;
+  service.rx.notifies = true;
+}
+
+bool BLEClient::connect(BLEAdvertisedDevice* device) {
+  SimAdapter* found = SimAdapter::find(device->getAddress().raw());
+  if (!found || !found->acceptConnections || found->isConnected()) return false;
+  adapter = found;
+  connected = true;
+  adapter->attach(this);
+  if (callbacks) callbacks->onConnect(this);
+  return true;
+}
+
+void BLEClient::disconnect() {
+  linkLost();
+}
+
+void BLEClient::linkLost() {
+  if (!connected) return;
+  connected = false;
+  if (adapter) adapter->detach(this);
+  if (callbacks) callbacks->onDisconnect(this);
+}
+
+BLERemoteService* BLEClient::getService(BLEUUID) {
+  return connected ? &service : nullptr;
+}
+
+int BLEClient::getRssi() {
+  return connected && adapter ? adapter->rssi : 0;
+}
+
+// ---- Characteristics ---------------------------------------------------
+
+BLERemoteCharacteristic* BLERemoteService::getCharacteristic(BLEUUID uuid) {
+  if (uuid.equals(BLEUUID(MOCK_TX_UUID))) return &tx;
+  if (uuid.equals(BLEUUID(MOCK_RX_UUID))) return &rx;
+  return nullptr;
+}
+
+void BLERemoteCharacteristic::registerForNotify(notify_callback callback, bool, bool) {
+  onNotify = callback;
+}
+
+void BLERemoteCharacteristic::writeValue(uint8_t* data, size_t length, bool) {
+  if (!owner || !owner->isConnected() || !owner->getAdapter()) return;
+  owner->getAdapter()->received(data, length);
+}
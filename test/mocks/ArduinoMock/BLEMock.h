@@ -0,0 +1,163 @@
+#ifndef BLE_MOCK_H
+#define BLE_MOCK_H
+
+// Host stand-in for the ESP32 Arduino BLE client API. Every client talks to
+// a SimAdapter (SimAdapter.h) picked by the advertised device address.
+
+#include <Arduino.h>
+#include <functional>
+#include <string>
+
+class BLEClient;
+class BLERemoteCharacteristic;
+class SimAdapter;
+
+class BLEUUID {
+public:
+  BLEUUID() {}
+  BLEUUID(const char* uuid) : value(uuid ? uuid : "") {}
+  bool equals(const BLEUUID& other) const { return value == other.value; }
+  String toString() const { return String(value.c_str()); }
+private:
+  std::string value;
+};
+
+class BLEAddress {
+public:
+  BLEAddress() {}
+  BLEAddress(const char* address) : value(address ? address : "") {}
+  bool equals(const BLEAddress& other) const { return value == other.value; }
+  String toString() const { return String(value.c_str()); }
+  const std::string& raw() const { return value; }
+private:
+  std::string value;
+};
+
+class BLEAdvertisedDevice {
+public:
+  BLEAdvertisedDevice() {}
+  BLEAdvertisedDevice(const char* name, const char* address, int rssi, bool uartService)
+    : name(name), address(address), rssi(rssi), uartService(uartService) {}
+
+  String getName() { return String(name.c_str()); }
+  bool haveName() { return !name.empty(); }
+  BLEAddress getAddress() { return BLEAddress(address.c_str()); }
+  int getRSSI() { return rssi; }
+  bool haveRSSI() { return true; }
+  bool haveServiceUUID() { return uartService; }
+  bool isAdvertisingService(BLEUUID) { return uartService; }
+  String toString() { return String((name + " " + address).c_str()); }
+
+private:
+  std::string name;
+  std::string address;
+  int rssi = 0;
+  bool uartService = false;
+};
+
+class BLEAdvertisedDeviceCallbacks {
+public:
+  virtual ~BLEAdvertisedDeviceCallbacks() {}
+  virtual void onResult(BLEAdvertisedDevice advertisedDevice) = 0;
+};
+
+class BLEScanResults {
+public:
+  int getCount() { return 0; }
+};
+
+class BLEScan {
+public:
+  void setAdvertisedDeviceCallbacks(BLEAdvertisedDeviceCallbacks* callbacks,
+                                    bool wantDuplicates = false, bool shouldParse = true);
+  void setInterval(uint16_t) {}
+  void setWindow(uint16_t) {}
+  void setActiveScan(bool) {}
+  BLEScanResults start(uint32_t duration, bool isContinue = false);
+  void stop();
+  void clearResults() {}
+
+  // Host-only
+  bool isScanning() const { return scanning; }
+  BLEAdvertisedDeviceCallbacks* getCallbacks() const { return callbacks; }
+  uint32_t getStarts() const { return starts; }
+
+private:
+  BLEAdvertisedDeviceCallbacks* callbacks = nullptr;
+  bool scanning = false;
+  uint32_t starts = 0;
+};
+
+typedef std::function<void(BLERemoteCharacteristic* characteristic, uint8_t* data,
+                           size_t length, bool isNotify)> notify_callback;
+
+class BLERemoteCharacteristic {
+public:
+  bool canNotify() { return notifies; }
+  bool canWrite() { return !notifies; }
+  bool canWriteNoResponse() { return !notifies; }
+  void registerForNotify(notify_callback callback, bool notifications = true,
+                         bool descriptorRequiresRegistration = true);
+  void writeValue(uint8_t* data, size_t length, bool response = false);
+  void writeValue(const char* text, bool response = false) {
+    writeValue((uint8_t*)text, strlen(text), response);
+  }
+
+  // Host-only
+  BLEClient* owner = nullptr;
+  bool notifies = false;
+  notify_callback onNotify;
+};
+
+class BLERemoteService {
+public:
+  BLERemoteCharacteristic* getCharacteristic(BLEUUID uuid);
+
+  // Host-only
+  BLERemoteCharacteristic tx;
+  BLERemoteCharacteristic rx;
+};
+
+class BLEClientCallbacks {
+public:
+  virtual ~BLEClientCallbacks() {}
+  virtual void onConnect(BLEClient* client) = 0;
+  virtual void onDisconnect(BLEClient* client) = 0;
+};
+
+class BLEClient {
+public:
+  BLEClient();
+  void setClientCallbacks(BLEClientCallbacks* callbacks) { this->callbacks = callbacks; }
+  bool connect(BLEAdvertisedDevice* device);
+  void disconnect();
+  bool isConnected() { return connected; }
+  BLERemoteService* getService(BLEUUID uuid);
+  int getRssi();
+
+  // Host-only
+  void linkLost();                // Stack-side drop: onDisconnect without disconnect()
+  SimAdapter* getAdapter() const { return adapter; }
+  BLERemoteCharacteristic* getRx() { return &service.rx; }
+
+private:
+  BLEClientCallbacks* callbacks = nullptr;
+  SimAdapter* adapter = nullptr;
+  BLERemoteService service;
+  bool connected = false;
+};
+
+class BLEDevice {
+public:
+  static void init(const String& name);
+  static void deinit(bool releaseMemory = false);
+  static BLEScan* getScan();
+  static BLEClient* createClient();
+
+  // Host-only
+  static bool isInitialized();
+  static uint32_t getClientsCreated();
+  static uint32_t getScanBeforeInit();   // getScan() calls made before init()
+};
+
+#endif // BLE_MOCK_H
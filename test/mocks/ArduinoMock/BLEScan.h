@@ -0,0 +1,6 @@
+#ifndef BLE_SCAN_MOCK_H
+#define BLE_SCAN_MOCK_H
+
+#include "BLEMock.h"
+
+#endif // BLE_SCAN_MOCK_H
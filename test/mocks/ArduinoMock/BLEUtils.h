@@ -0,0 +1,6 @@
+#ifndef BLE_UTILS_MOCK_H
+#define BLE_UTILS_MOCK_H
+
+#include "BLEMock.h"
+
+#endif // BLE_UTILS_MOCK_H
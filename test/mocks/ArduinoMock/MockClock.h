@@ -0,0 +1,29 @@
+#ifndef MOCK_CLOCK_H
+#define MOCK_CLOCK_H
+
+// Test control over the mocked Arduino clock and heap accounting
+
+typedef void (*MockDelayHook)();
+
+void mockSetMillis(unsigned long ms);
+void mockAdvance(unsigned long ms);          // Also runs the delay hook
+void mockSetDelayHook(MockDelayHook hook);   // Called whenever time moves
+
+// Allocations made while a harness scope is open on this thread are not
+// seen by obdAllocationCount(); a library scope re-enables counting for
+// callbacks the harness makes into the code under test
+class MockHarnessScope {
+public:
+  MockHarnessScope();
+  ~MockHarnessScope();
+};
+
+class MockLibraryScope {
+public:
+  MockLibraryScope();
+  ~MockLibraryScope();
+private:
+  int saved;
+};
+
+#endif // MOCK_CLOCK_H
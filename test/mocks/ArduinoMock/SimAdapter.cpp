@@ -0,0 +1,499 @@
+#include "SimAdapter.h"
+#include "MockClock.h"
+#include <mutex>
+
+static std::recursive_mutex simLock;
+static std::vector<SimAdapter*> adapters;
+
+static std::string upperNoSpaces(const std::string& text) {
+  std::string out;
+  for (char c : text) {
+    if (c != ' ') out += (char)toupper((unsigned char)c);
+  }
+  return out;
+}
+
+static bool isHex(const std::string& text) {
+  if (text.empty()) return false;
+  for (char c : text) {
+    if (!isxdigit((unsigned char)c)) return false;
+  }
+  return true;
+}
+
+static std::string hexText(const char* ascii) {
+  std::string out;
+  char buf[3];
+  for (; *ascii; ascii++) {
+    snprintf(buf, sizeof(buf), "%02X", (unsigned char)*ascii);
+    out += buf;
+  }
+  return out;
+}
+
+SimAdapter::SimAdapter(const char* name, const char* address) : name(name), address(address) {
+  MockHarnessScope harness;
+  std::lock_guard<std::recursive_mutex> guard(simLock);
+
+  SimECU& engine = addECU(0x7E8, 0x18DAF110, 0x10);
+  engine.responses["0100"] = "4100BE1FA813";
+  engine.responses["010C"] = "410C1AF8";       // 1726 rpm
+  engine.responses["010D"] = "410D3C";         // 60 km/h
+  engine.responses["0105"] = "41055A";         // 50 C
+  engine.responses["015C"] = "415C6E";         // 70 C
+  engine.responses["012F"] = "412F80";
+  engine.responses["0111"] = "411140";
+  engine.responses["0104"] = "410450";
+  engine.responses["0110"] = "41100BB8";       // 30 g/s
+  engine.responses["010B"] = "410BA0";
+  engine.responses["0133"] = "413364";
+  engine.responses["0140"] = "414040000000";   // 0142 supported
+  engine.responses["0142"] = "41423138";       // 12.6 V
+  engine.responses["03"] = "4300";
+  engine.responses["07"] = "4700";
+  engine.responses["0A"] = "4A00";
+  engine.responses["0902"] = "490201" + hexText("1HGCM82633A004352");
+
+  adapters.push_back(this);
+  mockSetDelayHook(pumpAll);
+}
+
+SimAdapter::~SimAdapter() {
+  MockHarnessScope harness;
+  std::lock_guard<std::recursive_mutex> guard(simLock);
+  if (client) {
+    BLEClient* attached = client;
+    client = nullptr;
+    attached->linkLost();
+  }
+  adapters.erase(std::remove(adapters.begin(), adapters.end(), this), adapters.end());
+}
+
+void SimAdapter::setProtocol(SimProtocol protocol) {
+  std::lock_guard<std::recursive_mutex> guard(simLock);
+  this->protocol = protocol;
+  header = protocol == SIM_CAN_29BIT ? 0x18DB33F1 : 0x7DF;
+}
+
+SimECU& SimAdapter::addECU(uint32_t canId, uint32_t extendedId, uint8_t address) {
+  MockHarnessScope harness;
+  std::lock_guard<std::recursive_mutex> guard(simLock);
+  SimECU added;
+  added.canId = canId;
+  added.extendedId = extendedId;
+  added.address = address;
+  ecus.push_back(added);
+  return ecus.back();
+}
+
+void SimAdapter::setResponse(size_t ecuIndex, const char* request, const char* payload) {
+  MockHarnessScope harness;
+  std::lock_guard<std::recursive_mutex> guard(simLock);
+  ecus[ecuIndex].responses[upperNoSpaces(request)] = upperNoSpaces(payload);
+}
+
+void SimAdapter::removeResponse(size_t ecuIndex, const char* request) {
+  MockHarnessScope harness;
+  std::lock_guard<std::recursive_mutex> guard(simLock);
+  ecus[ecuIndex].responses.erase(upperNoSpaces(request));
+}
+
+uint32_t SimAdapter::lastHeader() const {
+  std::lock_guard<std::recursive_mutex> guard(simLock);
+  return header;
+}
+
+bool SimAdapter::isConnected() const {
+  std::lock_guard<std::recursive_mutex> guard(simLock);
+  return client != nullptr;
+}
+
+size_t SimAdapter::pendingReplies() const {
+  std::lock_guard<std::recursive_mutex> guard(simLock);
+  return queue.size();
+}
+
+size_t SimAdapter::countWrites(const char* command) const {
+  std::lock_guard<std::recursive_mutex> guard(simLock);
+  return std::count(writes.begin(), writes.end(), std::string(command));
+}
+
+BLERemoteCharacteristic* SimAdapter::notifyCharacteristic() const {
+  std::lock_guard<std::recursive_mutex> guard(simLock);
+  return client ? client->getRx() : nullptr;
+}
+
+SimAdapter* SimAdapter::find(const std::string& address) {
+  std::lock_guard<std::recursive_mutex> guard(simLock);
+  for (SimAdapter* adapter : adapters) {
+    if (adapter->address == address) return adapter;
+  }
+  return nullptr;
+}
+
+// ---- Link --------------------------------------------------------------
+
+void SimAdapter::advertise() {
+  BLEAdvertisedDeviceCallbacks* callbacks = BLEDevice::getScan()->getCallbacks();
+  if (!callbacks) return;
+  BLEAdvertisedDevice device(name.c_str(), address.c_str(), rssi, true);
+  MockLibraryScope library;
+  callbacks->onResult(device);
+}
+
+void SimAdapter::dropLink() {
+  BLEClient* attached;
+  {
+    std::lock_guard<std::recursive_mutex> guard(simLock);
+    attached = client;
+  }
+  if (attached) attached->linkLost();
+}
+
+void SimAdapter::attach(BLEClient* connecting) {
+  std::lock_guard<std::recursive_mutex> guard(simLock);
+  client = connecting;
+  connects++;
+}
+
+void SimAdapter::detach(BLEClient* leaving) {
+  MockHarnessScope harness;
+  std::lock_guard<std::recursive_mutex> guard(simLock);
+  if (client != leaving) return;
+  client = nullptr;
+  queue.clear();
+  pendingInput.clear();
+  monitorActive = false;
+}
+
+void SimAdapter::streamFrame(uint32_t id, const char* dataHex) {
+  MockHarnessScope harness;
+  std::lock_guard<std::recursive_mutex> guard(simLock);
+  if (!monitorActive) return;
+  char head[16];
+  snprintf(head, sizeof(head), id > 0x7FF ? "%08X" : "%03X", (unsigned)id);
+  std::string line = head;
+  if (spaces) line += ' ';
+  line += formatBytes(upperNoSpaces(dataHex));
+  queueReply(line + "\r", 0);
+}
+
+void SimAdapter::stopStreaming(const char* reason) {
+  MockHarnessScope harness;
+  std::lock_guard<std::recursive_mutex> guard(simLock);
+  if (!monitorActive) return;
+  monitorActive = false;
+  queueReply(std::string(reason) + "\r\r>", 0);
+}
+
+// ---- Requests ----------------------------------------------------------
+
+void SimAdapter::received(const uint8_t* data, size_t length) {
+  MockHarnessScope harness;
+  std::lock_guard<std::recursive_mutex> guard(simLock);
+
+  for (size_t i = 0; i < length; i++) {
+    char c = (char)data[i];
+    if (c == '\n') continue;
+    if (c != '\r') {
+      pendingInput += c;
+      continue;
+    }
+
+    std::string command = pendingInput;
+    pendingInput.clear();
+    writes.push_back(command);
+
+    // Any input ends monitoring; the adapter answers with a prompt
+    if (monitorActive) {
+      monitorActive = false;
+      queueReply("\r>", latency);
+      continue;
+    }
+    if (command.empty()) continue;
+    if (!replying) continue;
+    if (dropNext > 0) {
+      dropNext--;
+      continue;
+    }
+
+    std::string reply;
+    unsigned long wait = latency;
+    if (!scripted.empty()) {
+      reply = scripted.front();
+      scripted.pop_front();
+    } else {
+      searched = false;
+      reply = answer(command);
+      if (reply.empty()) continue;           // Monitoring started: no prompt
+      if (searched) wait += searchWait;
+    }
+    if (!prefixNext.empty()) {
+      reply = prefixNext + reply;
+      prefixNext.clear();
+    }
+    wait += delayNext;
+    delayNext = 0;
+    queueReply(reply, wait);
+  }
+}
+
+std::string SimAdapter::answer(const std::string& command) {
+  std::string normalized = upperNoSpaces(command);
+  std::string prefix = echo ? command + "\r" : "";
+  std::string body;
+
+  if (normalized.compare(0, 2, "AT") == 0) {
+    body = answerAT(normalized.substr(2));
+  } else if (normalized.compare(0, 2, "ST") == 0) {
+    body = stn ? answerST(command) : "?";
+  } else if (isHex(normalized)) {
+    int count = 0;
+    std::string request = normalized;
+    if (request.size() % 2 == 1) {
+      count = (int)strtol(request.substr(request.size() - 1).c_str(), nullptr, 16);
+      request.pop_back();
+    }
+    body = answerOBD(request, count, header);
+  } else {
+    body = "?";
+  }
+  if (body.empty()) return "";
+  return prefix + body + "\r\r>";
+}
+
+std::string SimAdapter::answerAT(const std::string& command) {
+  if (command == "Z" || command == "WS") {
+    resetSettings();
+    return "\r\r" + banner;
+  }
+  if (command == "I") return banner;
+  if (command == "RV") {
+    char buf[16];
+    snprintf(buf, sizeof(buf), "%.1fV", voltage);
+    return buf;
+  }
+  if (command == "E0" || command == "E1") { echo = command[1] == '1'; return "OK"; }
+  if (command == "S0" || command == "S1") { spaces = command[1] == '1'; return "OK"; }
+  if (command == "H0" || command == "H1") { headers = command[1] == '1'; return "OK"; }
+  if (command == "D") { resetSettings(); return "OK"; }
+  if (command == "DPN") return protocol == SIM_CAN_11BIT ? "A6" : protocol == SIM_CAN_29BIT ? "A7" : "A3";
+  if (command.compare(0, 2, "SH") == 0) {
+    std::string value = command.substr(2);
+    if (!isHex(value)) return "?";
+    uint32_t parsed = (uint32_t)strtoul(value.c_str(), nullptr, 16);
+    header = value.size() == 3 ? parsed : ((uint32_t)priority << 24) | (parsed & 0xFFFFFF);
+    return "OK";
+  }
+  if (command.compare(0, 2, "CP") == 0) {
+    priority = (uint8_t)strtoul(command.c_str() + 2, nullptr, 16);
+    if (header > 0xFFF) header = ((uint32_t)priority << 24) | (header & 0xFFFFFF);
+    return "OK";
+  }
+  if (command.compare(0, 3, "CRA") == 0) {
+    receiveFilter = command.size() > 3 ? (uint32_t)strtoul(command.c_str() + 3, nullptr, 16) : 0;
+    return "OK";
+  }
+  if (command == "AR") { receiveFilter = 0; return "OK"; }
+  if (command == "MA") {
+    monitorActive = true;
+    return "";
+  }
+  return "OK";
+}
+
+std::string SimAdapter::answerST(const std::string& command) {
+  std::string normalized = upperNoSpaces(command);
+  if (normalized == "STI") return "STN1110 v4.2.0";
+  if (normalized == "STDI") return "OBDLink LX r1.1";
+  if (normalized == "STMA" || normalized == "STM") {
+    monitorActive = true;
+    return "";
+  }
+  if (normalized.compare(0, 4, "STPX") == 0) {
+    // STPX H:7E0, D:22F40D, R:1, T:200 - header applies to this request only
+    uint32_t requestHeader = header;
+    std::string data;
+    int count = 0;
+    size_t pos = 4;
+    while (pos < normalized.size()) {
+      size_t end = normalized.find(',', pos);
+      if (end == std::string::npos) end = normalized.size();
+      std::string field = normalized.substr(pos, end - pos);
+      if (field.size() > 2 && field[1] == ':') {
+        std::string value = field.substr(2);
+        if (field[0] == 'H') {
+          requestHeader = (uint32_t)strtoul(value.c_str(), nullptr, 16);
+        } else if (field[0] == 'D') {
+          data = value;
+        } else if (field[0] == 'R') {
+          count = atoi(value.c_str());
+        }
+      }
+      pos = end + 1;
+    }
+    if (!isHex(data)) return "?";
+    return answerOBD(data, count, requestHeader);
+  }
+  return "OK";
+}
+
+bool SimAdapter::addressed(const SimECU& target, uint32_t requestHeader) const {
+  uint32_t responseId = protocol == SIM_CAN_11BIT ? target.canId
+                      : protocol == SIM_CAN_29BIT ? target.extendedId : target.address;
+  if (receiveFilter && receiveFilter != responseId) return false;
+
+  switch (protocol) {
+    case SIM_CAN_11BIT:
+      return requestHeader == 0x7DF || requestHeader + 8 == target.canId;
+    case SIM_CAN_29BIT:
+      if (requestHeader == 0x18DB33F1) return true;
+      return (requestHeader & 0xFFFF00FF) == 0x18DA00F1 &&
+             ((requestHeader >> 8) & 0xFF) == (target.extendedId & 0xFF);
+    case SIM_LEGACY:
+      return true;
+  }
+  return false;
+}
+
+// Without a response count (or with fewer answers than the count) an
+// ELM327 keeps listening for more ECUs before it prints the prompt
+std::string SimAdapter::answerOBD(const std::string& request, int responseCount, uint32_t requestHeader) {
+  std::string out;
+  int answers = 0;
+  for (const SimECU& target : ecus) {
+    if (!addressed(target, requestHeader)) continue;
+    auto found = target.responses.find(request);
+    if (found == target.responses.end()) continue;
+    if (!out.empty()) out += "\r";
+    out += formatMessage(target, found->second);
+    if (++answers == responseCount) break;
+  }
+  searched = responseCount == 0 || answers < responseCount;
+  return out.empty() ? "NO DATA" : out;
+}
+
+// Hex digits to "41 0C 1A F8" or "410C1AF8" depending on ATS
+std::string SimAdapter::formatBytes(const std::string& hex) const {
+  if (!spaces) return hex;
+  std::string out;
+  for (size_t i = 0; i + 1 < hex.size(); i += 2) {
+    if (i) out += ' ';
+    out += hex.substr(i, 2);
+  }
+  return out;
+}
+
+std::string SimAdapter::formatMessage(const SimECU& target, const std::string& payload) const {
+  size_t length = payload.size() / 2;
+  char buf[32];
+
+  if (protocol == SIM_LEGACY) {
+    if (!headers) return formatBytes(payload);
+    snprintf(buf, sizeof(buf), "486B%02X", target.address);
+    std::string frame = buf + payload;
+    unsigned sum = 0;
+    for (size_t i = 0; i + 1 < frame.size(); i += 2) {
+      sum += (unsigned)strtoul(frame.substr(i, 2).c_str(), nullptr, 16);
+    }
+    snprintf(buf, sizeof(buf), "%02X", sum & 0xFF);
+    return formatBytes(frame + buf);
+  }
+
+  std::string head;
+  if (headers) {
+    if (protocol == SIM_CAN_29BIT) {
+      snprintf(buf, sizeof(buf), "%08X", (unsigned)target.extendedId);
+      head = spaces ? formatBytes(buf) + " " : buf;
+    } else {
+      snprintf(buf, sizeof(buf), "%03X", (unsigned)target.canId);
+      head = spaces ? std::string(buf) + " " : buf;
+    }
+  }
+
+  if (length <= 7) {
+    if (!headers) return formatBytes(payload);
+    snprintf(buf, sizeof(buf), "%02X", (unsigned)length);
+    return head + formatBytes(buf + payload);
+  }
+
+  // ISO-TP: first frame with 6 bytes, consecutive frames with 7
+  std::string out;
+  if (headers) {
+    snprintf(buf, sizeof(buf), "1%03X", (unsigned)length);
+    out = head + formatBytes(buf + payload.substr(0, 12));
+  } else {
+    snprintf(buf, sizeof(buf), "%03X\r0:", (unsigned)length);
+    out = std::string(buf) + formatBytes(payload.substr(0, 12));
+  }
+  unsigned sequence = 1;
+  for (size_t pos = 12; pos < payload.size(); pos += 14, sequence++) {
+    out += "\r";
+    if (headers) {
+      snprintf(buf, sizeof(buf), "2%X", sequence & 0x0F);
+      out += head + formatBytes(buf + payload.substr(pos, 14));
+    } else {
+      snprintf(buf, sizeof(buf), "%X:", sequence & 0x0F);
+      out += buf + formatBytes(payload.substr(pos, 14));
+    }
+  }
+  return out;
+}
+
+void SimAdapter::resetSettings() {
+  echo = true;
+  spaces = true;
+  headers = false;
+  header = protocol == SIM_CAN_29BIT ? 0x18DB33F1 : 0x7DF;
+  priority = 0x18;
+  receiveFilter = 0;
+  monitorActive = false;
+}
+
+// ---- Delivery ----------------------------------------------------------
+
+// Replies leave in order: one that is late holds back the ones behind it
+void SimAdapter::queueReply(const std::string& text, unsigned long wait) {
+  unsigned long due = millis() + wait;
+  if (due < lastDue) due = lastDue;
+  lastDue = due;
+  queue.push_back({due, text});
+}
+
+void SimAdapter::pump() {
+  std::vector<std::string> due;
+  BLEClient* target;
+  {
+    MockHarnessScope harness;
+    std::lock_guard<std::recursive_mutex> guard(simLock);
+    target = client;
+    if (!target || !target->isConnected()) return;
+    unsigned long now = millis();
+    while (!queue.empty() && queue.front().due <= now) {
+      due.push_back(queue.front().text);
+      queue.pop_front();
+    }
+  }
+
+  BLERemoteCharacteristic* rx = target->getRx();
+  for (const std::string& text : due) {
+    for (size_t offset = 0; offset < text.size(); offset += mtu) {
+      size_t length = std::min(mtu, text.size() - offset);
+      uint8_t chunk[512];
+      memcpy(chunk, text.data() + offset, length);
+      if (!rx->onNotify) continue;
+      MockLibraryScope library;
+      rx->onNotify(rx, chunk, length, true);
+    }
+  }
+}
+
+void SimAdapter::pumpAll() {
+  std::vector<SimAdapter*> all;
+  {
+    MockHarnessScope harness;
+    std::lock_guard<std::recursive_mutex> guard(simLock);
+    all = adapters;
+  }
+  for (SimAdapter* adapter : all) adapter->pump();
+}
@@ -0,0 +1,124 @@
+#ifndef SIM_ADAPTER_H
+#define SIM_ADAPTER_H
+
+// Scripted ELM327 / STN adapter on the far side of the mocked BLE link.
+// Answers AT/ST commands and OBD requests from a table of ECU responses,
+// formatted the way a real adapter prints them (headers, spaces, ISO-TP
+// frames, legacy 3-byte headers), after a configurable latency on the
+// mocked clock. Replies are split into notifications of `mtu` bytes.
+
+#include <Arduino.h>
+#include <BLEDevice.h>
+#include <stdint.h>
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+
+enum SimProtocol {
+  SIM_CAN_11BIT,
+  SIM_CAN_29BIT,
+  SIM_LEGACY        // J1850 / KWP: 3-byte header plus checksum
+};
+
+struct SimECU {
+  uint32_t canId;       // 11-bit response id (0x7E8, 0x7E9, ...)
+  uint32_t extendedId;  // 29-bit response id (0x18DAF110, ...)
+  uint8_t address;      // Legacy source address (0x10, ...)
+  std::map<std::string, std::string> responses; // Request hex -> response payload hex
+};
+
+class SimAdapter {
+public:
+  explicit SimAdapter(const char* name = "OBD2_Simulator_BLE", const char* address = "aa:bb:cc:dd:ee:01");
+  ~SimAdapter();
+
+  // Vehicle: one engine ECU with the standard PIDs is present by default
+  void setProtocol(SimProtocol protocol);
+  SimECU& addECU(uint32_t canId, uint32_t extendedId, uint8_t address);
+  SimECU& ecu(size_t index) { return ecus[index]; }
+  void setResponse(size_t ecuIndex, const char* request, const char* payload);
+  void removeResponse(size_t ecuIndex, const char* request);
+
+  // Adapter behaviour
+  bool stn = false;                   // Answers ST commands (STI, STPX, STMA)
+  std::string banner = "ELM327 v1.5";
+  float voltage = 12.6f;
+  unsigned long latency = 30;         // Request to complete reply (ms)
+  unsigned long searchWait = 0;       // Extra wait for more ECUs without a response count
+  bool replying = true;               // false: requests vanish (timeouts)
+  bool acceptConnections = true;
+  int rssi = -60;
+  size_t mtu = 20;                    // Notification payload bytes
+
+  // Fault injection for the next generated reply
+  std::deque<std::string> scripted;   // Verbatim replies (include the '>') used first
+  std::string prefixNext;             // Prepended to the next reply
+  unsigned long delayNext = 0;        // Extra latency for the next reply
+  int dropNext = 0;                   // Swallow this many requests
+
+  // Observations
+  std::vector<std::string> writes;    // Commands received, without the CR
+  uint32_t connects = 0;
+  uint32_t lastHeader() const;        // Current request header (priority included for 29-bit)
+  bool isConnected() const;
+  bool monitoring() const { return monitorActive; }
+  size_t pendingReplies() const;
+  size_t countWrites(const char* command) const;
+  BLERemoteCharacteristic* notifyCharacteristic() const;  // Client's RX, nullptr when not connected
+  void clearWrites() { writes.clear(); }
+
+  // Link control
+  void advertise();                   // Deliver a scan result to the scanning client
+  void dropLink();                    // Link lost without a disconnect() call
+  void streamFrame(uint32_t id, const char* dataHex);   // Monitor mode output
+  void stopStreaming(const char* reason);               // Adapter ends monitoring (BUFFER FULL)
+
+  // Deliver every reply that is due on the mocked clock (all adapters).
+  // Installed as the clock's delay hook, so mockAdvance() and delay() pump.
+  static void pumpAll();
+  static SimAdapter* find(const std::string& address);
+
+  // BLE side (called by the BLE mock)
+  void attach(BLEClient* client);
+  void detach(BLEClient* client);
+  void received(const uint8_t* data, size_t length);
+
+private:
+  struct Pending {
+    unsigned long due;
+    std::string text;
+  };
+
+  std::string answer(const std::string& command);
+  std::string answerAT(const std::string& command);
+  std::string answerST(const std::string& command);
+  std::string answerOBD(const std::string& request, int responseCount, uint32_t header);
+  std::string formatMessage(const SimECU& ecu, const std::string& payload) const;
+  std::string formatBytes(const std::string& hex) const;
+  bool addressed(const SimECU& ecu, uint32_t header) const;
+  void queueReply(const std::string& text, unsigned long wait);
+  void resetSettings();
+  void pump();
+
+  std::string name;
+  std::string address;
+  SimProtocol protocol = SIM_CAN_11BIT;
+  std::vector<SimECU> ecus;
+  BLEClient* client = nullptr;
+  std::deque<Pending> queue;
+  unsigned long lastDue = 0;
+  std::string pendingInput;
+
+  // Adapter settings
+  bool echo = true;
+  bool spaces = true;
+  bool headers = false;
+  uint32_t header = 0x7DF;
+  uint8_t priority = 0x18;
+  uint32_t receiveFilter = 0;         // ATCRA, 0 = accept all
+  bool monitorActive = false;
+  bool searched = false;              // Last OBD answer waited for more ECUs
+};
+
+#endif // SIM_ADAPTER_H
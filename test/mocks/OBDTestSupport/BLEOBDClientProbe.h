@@ -0,0 +1,57 @@
+#ifndef BLE_OBD_CLIENT_PROBE_H
+#define BLE_OBD_CLIENT_PROBE_H
+
+// Host-only access to single stages of a BLEOBDClient's pipeline, so tests
+// and benchmarks can drive one stage without the rest of service()
+
+#include "BLEOBDClient.h"
+
+class BLEOBDClientProbe {
+public:
+  explicit BLEOBDClientProbe(BLEOBDClient& client) : client(client) {}
+
+  // Receive path
+  void frame(const String& data) { OBDLockGuard guard(client.stateLock); client.processIncomingData(data); }
+  void drain() { OBDLockGuard guard(client.stateLock); client.drainIncoming(); }
+  void clearReceive() {
+    client.rxPending.remove(0);
+    client.incomingData.remove(0);
+  }
+  unsigned int pendingBytes() const { return client.rxPending.length(); }
+  unsigned int framedBytes() const { return client.incomingData.length(); }
+
+  // Scheduler and bookkeeping
+  bool selectDueCommand() { return client.selectDueCommand(); }
+  int currentCommand() const { return client.currentCommandIndex; }
+  uint8_t commandCount() const { return client.commandCount; }
+  OBDCommand& command(uint8_t slot) { return client.commandQueue[slot]; }
+  void clearCommands() {
+    OBDLockGuard guard(client.stateLock);
+    client.commandCount = 0;
+    client.currentCommandIndex = 0;
+  }
+  void updateResponseStats(unsigned long responseTime) { client.updateResponseStats(responseTime); }
+  void publishSignal(OBDSignal signal, float value, unsigned long requestTime) {
+    client.publishSignal(signal, value, requestTime);
+  }
+  void processMonitorFrames() { OBDLockGuard guard(client.stateLock); client.processMonitorFrames(); }
+  bool isWaiting() const { return client.waitingForResponse; }
+  uint32_t activeHeader() const { return client.activeHeader; }
+  void setActiveHeader(uint32_t header) { OBDLockGuard guard(client.stateLock); client.activeHeader = header; }
+  uint8_t setupPending() const { return client.setupCount; }
+
+  // Adapter identification reply (ATI / STI) as the one-shot would deliver it
+  void identify(const char* command, const char* text) {
+    OBDLockGuard guard(client.stateLock);
+    OneShotResult result = OneShotResult();
+    result.status = ONESHOT_OK;
+    result.command = command;
+    result.text = text;
+    client.handleIdentification(result);
+  }
+
+private:
+  BLEOBDClient& client;
+};
+
+#endif // BLE_OBD_CLIENT_PROBE_H
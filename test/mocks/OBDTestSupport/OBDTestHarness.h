@@ -0,0 +1,38 @@
+#ifndef OBD_TEST_HARNESS_H
+#define OBD_TEST_HARNESS_H
+
+// Run a BLEOBDClient against a SimAdapter on the mocked clock
+
+#include "BLEOBDClient.h"
+#include "MockClock.h"
+#include "SimAdapter.h"
+
+// Advance the clock in steps (delivering due replies) and service the client
+inline void runFor(BLEOBDClient& client, unsigned long ms, unsigned long step = 5) {
+  for (unsigned long elapsed = 0; elapsed < ms; elapsed += step) {
+    mockAdvance(step);
+    client.service();
+  }
+}
+
+// Same, until the condition holds; false on timeout
+template <typename Condition>
+bool runUntil(BLEOBDClient& client, Condition done, unsigned long timeoutMs, unsigned long step = 5) {
+  for (unsigned long elapsed = 0; elapsed < timeoutMs; elapsed += step) {
+    if (done()) return true;
+    mockAdvance(step);
+    client.service();
+  }
+  return done();
+}
+
+// begin(), scan, find the adapter and run the connect/initialize sequence
+inline bool connectClient(BLEOBDClient& client, SimAdapter& adapter, const char* name = "OBD2_Simulator_BLE") {
+  client.setDebugMode(false);
+  client.begin(name);
+  client.service();
+  adapter.advertise();
+  return runUntil(client, [&]() { return client.getConnectionState() == CONNECTED; }, 5000);
+}
+
+#endif // OBD_TEST_HARNESS_H
@@ -0,0 +1,128 @@
+#ifndef OBD_BENCH_H
+#define OBD_BENCH_H
+
+// Minimal Google Benchmark style runner for the host benchmarks: each
+// benchmark loops `while (state.running())`, the runner grows the iteration
+// count until one run takes OBD_BENCH_MIN_MS (default 50 ms), and results
+// are written in Google Benchmark's JSON layout so tools/bench_compare.py
+// (or Google's compare.py) can diff two commits.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Named values a benchmark reports besides its timing (Google Benchmark's
+// user counters), e.g. frames dropped during the run
+typedef std::vector<std::pair<std::string, double>> BenchCounters;
+
+class BenchState {
+public:
+  explicit BenchState(uint64_t iterations) : remaining(iterations), total(iterations) {}
+
+  bool running() {
+    if (remaining == total) start = Clock::now();
+    if (remaining-- > 0) return true;
+    stop = Clock::now();
+    return false;
+  }
+
+  // Exclude setup inside the loop from the measured time
+  void pause() { pausedAt = Clock::now(); }
+  void resume() { excluded += Clock::now() - pausedAt; }
+
+  void setBytesProcessed(uint64_t bytes) { bytesProcessed = bytes; }
+  void setItemsProcessed(uint64_t items) { itemsProcessed = items; }
+  void setCounter(const char* name, double value) { userCounters.push_back({name, value}); }
+  uint64_t iterations() const { return total; }
+
+  double elapsedNs() const {
+    return std::chrono::duration<double, std::nano>(stop - start - excluded).count();
+  }
+  uint64_t bytes() const { return bytesProcessed; }
+  uint64_t items() const { return itemsProcessed; }
+  const BenchCounters& counters() const { return userCounters; }
+
+private:
+  typedef std::chrono::steady_clock Clock;
+  uint64_t remaining;
+  uint64_t total;
+  Clock::time_point start, stop, pausedAt;
+  Clock::duration excluded = Clock::duration::zero();
+  uint64_t bytesProcessed = 0;
+  uint64_t itemsProcessed = 0;
+  BenchCounters userCounters;
+};
+
+struct BenchResult {
+  std::string name;
+  uint64_t iterations;
+  double nsPerIteration;
+  double bytesPerSecond;      // 0 when the benchmark reports no bytes
+  double itemsPerSecond;
+  BenchCounters counters;     // From the final run
+};
+
+typedef void (*BenchFunction)(BenchState& state, long arg);
+
+// Keep a computed value alive without a volatile store in the loop body
+template <typename T> inline void benchKeep(const T& value) {
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+
+// arg is passed to the function and, with nameArg, appended as "name/arg"
+inline BenchResult runBenchmark(const char* name, BenchFunction function, long arg = -1,
+                                bool nameArg = true) {
+  const char* env = getenv("OBD_BENCH_MIN_MS");
+  double minNs = (env ? atof(env) : 50.0) * 1e6;
+
+  uint64_t iterations = 1;
+  for (;;) {
+    BenchState state(iterations);
+    function(state, arg);
+    double elapsed = state.elapsedNs();
+    if (elapsed >= minNs || iterations >= (1ULL << 32)) {
+      BenchResult result;
+      result.name = name;
+      if (arg >= 0 && nameArg) result.name += "/" + std::to_string(arg);
+      result.iterations = iterations;
+      result.nsPerIteration = elapsed / iterations;
+      result.bytesPerSecond = state.bytes() ? state.bytes() * 1e9 / elapsed : 0;
+      result.itemsPerSecond = state.items() ? state.items() * 1e9 / elapsed : 0;
+      result.counters = state.counters();
+      return result;
+    }
+    // Aim just past the minimum, growing at most 10x per round
+    double factor = elapsed > 0 ? minNs * 1.4 / elapsed : 10.0;
+    if (factor > 10.0) factor = 10.0;
+    if (factor < 2.0) factor = 2.0;
+    iterations = (uint64_t)(iterations * factor);
+  }
+}
+
+inline void writeBenchJson(FILE* out, const std::vector<BenchResult>& results, const char* executable) {
+  fprintf(out, "{\n  \"context\": {\n    \"executable\": \"%s\",\n", executable);
+  fprintf(out, "    \"library_build_type\": \"release\",\n    \"time_unit\": \"ns\"\n  },\n");
+  fprintf(out, "  \"benchmarks\": [\n");
+  for (size_t i = 0; i < results.size(); i++) {
+    const BenchResult& r = results[i];
+    fprintf(out, "    {\n      \"name\": \"%s\",\n      \"run_name\": \"%s\",\n", r.name.c_str(), r.name.c_str());
+    fprintf(out, "      \"run_type\": \"iteration\",\n      \"iterations\": %llu,\n",
+            (unsigned long long)r.iterations);
+    fprintf(out, "      \"real_time\": %.3f,\n      \"cpu_time\": %.3f,\n      \"time_unit\": \"ns\"",
+            r.nsPerIteration, r.nsPerIteration);
+    if (r.bytesPerSecond > 0) fprintf(out, ",\n      \"bytes_per_second\": %.1f", r.bytesPerSecond);
+    if (r.itemsPerSecond > 0) fprintf(out, ",\n      \"items_per_second\": %.1f", r.itemsPerSecond);
+    for (const auto& counter : r.counters) {
+      fprintf(out, ",\n      \"%s\": %.1f", counter.first.c_str(), counter.second);
+    }
+    fprintf(out, "\n    }%s\n", i + 1 < results.size() ? "," : "");
+  }
+  fprintf(out, "  ]\n}\n");
+}
+
+#endif // OBD_BENCH_H
@@ -0,0 +1,90 @@
+// Generated by tools/dbc2blob.py from bench_vehicle.dbc
+#define CAN_SIGNAL_ENGINESPEED 0  // 0xC9
+#define CAN_SIGNAL_ENGINETORQUE 1  // 0xC9
+#define CAN_SIGNAL_ENGINERUNNING 2  // 0xC9
+#define CAN_SIGNAL_IDLEACTIVE 3  // 0xC9
+#define CAN_SIGNAL_ECM1COUNTER 4  // 0xC9
+#define CAN_SIGNAL_ACCELERATORPEDAL 5  // 0xF1
+#define CAN_SIGNAL_THROTTLEPOSITION 6  // 0xF1
+#define CAN_SIGNAL_BRAKESWITCH 7  // 0xF1
+#define CAN_SIGNAL_CRUISEACTIVE 8  // 0xF1
+#define CAN_SIGNAL_COOLANTTEMP 9  // 0x3C1
+#define CAN_SIGNAL_INTAKEAIRTEMP 10  // 0x3C1
+#define CAN_SIGNAL_OILTEMP 11  // 0x3C1
+#define CAN_SIGNAL_OILPRESSURE 12  // 0x3C1
+#define CAN_SIGNAL_BOOSTPRESSURE 13  // 0x3C1
+#define CAN_SIGNAL_FUELRATE 14  // 0x3D1
+#define CAN_SIGNAL_FUELLEVEL 15  // 0x3D1
+#define CAN_SIGNAL_LAMBDABANK1 16  // 0x3D1
+#define CAN_SIGNAL_FUELTRIMSHORT 17  // 0x3D1
+#define CAN_SIGNAL_GEARENGAGED 18  // 0x1F5
+#define CAN_SIGNAL_GEARSELECTOR 19  // 0x1F5
+#define CAN_SIGNAL_TURBINESPEED 20  // 0x1F5
+#define CAN_SIGNAL_OUTPUTSPEED 21  // 0x1F5
+#define CAN_SIGNAL_TRANSOILTEMP 22  // 0x1F5
+#define CAN_SIGNAL_TORQUEREQUEST 23  // 0x1F5
+#define CAN_SIGNAL_WHEELSPEEDFL 24  // 0x1A1
+#define CAN_SIGNAL_WHEELSPEEDFR 25  // 0x1A1
+#define CAN_SIGNAL_WHEELSPEEDRL 26  // 0x1A1
+#define CAN_SIGNAL_WHEELSPEEDRR 27  // 0x1A1
+#define CAN_SIGNAL_YAWRATE 28  // 0x1B1
+#define CAN_SIGNAL_LATERALACCEL 29  // 0x1B1
+#define CAN_SIGNAL_LONGITUDINALACCEL 30  // 0x1B1
+#define CAN_SIGNAL_STEERINGANGLE 31  // 0x1B1
+#define CAN_SIGNAL_VEHICLESPEED 32  // 0x428
+#define CAN_SIGNAL_ODOMETER 33  // 0x428
+#define CAN_SIGNAL_AMBIENTTEMP 34  // 0x428
+#define CAN_SIGNAL_BATTERYVOLTAGE 35  // 0x428
+#define CAN_SIGNAL_J1939ENGINESPEED 36  // 0x18FEF1FE
+#define CAN_SIGNAL_J1939TORQUEPERCENT 37  // 0x18FEF1FE
+static const uint8_t CAN_SIGNAL_BLOB[577] = {
+  0x43, 0x44, 0x42, 0x43, 0x01, 0x26, 0x00, 0xC9, 0x00, 0x00, 0x00, 0x18,
+  0x10, 0x01, 0x00, 0x00, 0x80, 0x3E, 0x00, 0x00, 0x00, 0x00, 0xC9, 0x00,
+  0x00, 0x00, 0x08, 0x0C, 0x03, 0x00, 0x00, 0x00, 0x3F, 0x00, 0x00, 0x00,
+  0x00, 0xC9, 0x00, 0x00, 0x00, 0x00, 0x01, 0x01, 0x00, 0x00, 0x80, 0x3F,
+  0x00, 0x00, 0x00, 0x00, 0xC9, 0x00, 0x00, 0x00, 0x01, 0x01, 0x01, 0x00,
+  0x00, 0x80, 0x3F, 0x00, 0x00, 0x00, 0x00, 0xC9, 0x00, 0x00, 0x00, 0x38,
+  0x04, 0x01, 0x00, 0x00, 0x80, 0x3F, 0x00, 0x00, 0x00, 0x00, 0xF1, 0x00,
+  0x00, 0x00, 0x10, 0x08, 0x01, 0xCD, 0xCC, 0xCC, 0x3E, 0x00, 0x00, 0x00,
+  0x00, 0xF1, 0x00, 0x00, 0x00, 0x18, 0x08, 0x01, 0xCD, 0xC8, 0xC8, 0x3E,
+  0x00, 0x00, 0x00, 0x00, 0xF1, 0x00, 0x00, 0x00, 0x20, 0x01, 0x01, 0x00,
+  0x00, 0x80, 0x3F, 0x00, 0x00, 0x00, 0x00, 0xF1, 0x00, 0x00, 0x00, 0x21,
+  0x01, 0x01, 0x00, 0x00, 0x80, 0x3F, 0x00, 0x00, 0x00, 0x00, 0xC1, 0x03,
+  0x00, 0x00, 0x07, 0x08, 0x00, 0x00, 0x00, 0x80, 0x3F, 0x00, 0x00, 0x20,
+  0xC2, 0xC1, 0x03, 0x00, 0x00, 0x0F, 0x08, 0x00, 0x00, 0x00, 0x80, 0x3F,
+  0x00, 0x00, 0x20, 0xC2, 0xC1, 0x03, 0x00, 0x00, 0x17, 0x08, 0x00, 0x00,
+  0x00, 0x80, 0x3F, 0x00, 0x00, 0x20, 0xC2, 0xC1, 0x03, 0x00, 0x00, 0x1F,
+  0x10, 0x00, 0xCD, 0xCC, 0xCC, 0x3D, 0x00, 0x00, 0x00, 0x00, 0xC1, 0x03,
+  0x00, 0x00, 0x2F, 0x0C, 0x02, 0x00, 0x00, 0x00, 0x3F, 0x00, 0x00, 0x00,
+  0x00, 0xD1, 0x03, 0x00, 0x00, 0x00, 0x10, 0x01, 0xCD, 0xCC, 0x4C, 0x3D,
+  0x00, 0x00, 0x00, 0x00, 0xD1, 0x03, 0x00, 0x00, 0x10, 0x08, 0x01, 0xCD,
+  0xC8, 0xC8, 0x3E, 0x00, 0x00, 0x00, 0x00, 0xD1, 0x03, 0x00, 0x00, 0x18,
+  0x10, 0x01, 0x40, 0xDA, 0xFF, 0x37, 0x00, 0x00, 0x00, 0x00, 0xD1, 0x03,
+  0x00, 0x00, 0x28, 0x08, 0x03, 0x00, 0x00, 0x48, 0x3F, 0x00, 0x00, 0x00,
+  0x00, 0xF5, 0x01, 0x00, 0x00, 0x00, 0x04, 0x01, 0x00, 0x00, 0x80, 0x3F,
+  0x00, 0x00, 0x00, 0x00, 0xF5, 0x01, 0x00, 0x00, 0x04, 0x04, 0x01, 0x00,
+  0x00, 0x80, 0x3F, 0x00, 0x00, 0x00, 0x00, 0xF5, 0x01, 0x00, 0x00, 0x08,
+  0x10, 0x01, 0x00, 0x00, 0x80, 0x3E, 0x00, 0x00, 0x00, 0x00, 0xF5, 0x01,
+  0x00, 0x00, 0x18, 0x10, 0x01, 0x00, 0x00, 0x80, 0x3E, 0x00, 0x00, 0x00,
+  0x00, 0xF5, 0x01, 0x00, 0x00, 0x28, 0x08, 0x01, 0x00, 0x00, 0x80, 0x3F,
+  0x00, 0x00, 0x20, 0xC2, 0xF5, 0x01, 0x00, 0x00, 0x30, 0x0C, 0x03, 0x00,
+  0x00, 0x00, 0x3F, 0x00, 0x00, 0x00, 0x00, 0xA1, 0x01, 0x00, 0x00, 0x07,
+  0x10, 0x00, 0x0A, 0xD7, 0x23, 0x3C, 0x00, 0x00, 0x00, 0x00, 0xA1, 0x01,
+  0x00, 0x00, 0x17, 0x10, 0x00, 0x0A, 0xD7, 0x23, 0x3C, 0x00, 0x00, 0x00,
+  0x00, 0xA1, 0x01, 0x00, 0x00, 0x27, 0x10, 0x00, 0x0A, 0xD7, 0x23, 0x3C,
+  0x00, 0x00, 0x00, 0x00, 0xA1, 0x01, 0x00, 0x00, 0x37, 0x10, 0x00, 0x0A,
+  0xD7, 0x23, 0x3C, 0x00, 0x00, 0x00, 0x00, 0xB1, 0x01, 0x00, 0x00, 0x00,
+  0x10, 0x03, 0x0A, 0xD7, 0x23, 0x3C, 0x00, 0x00, 0x00, 0x00, 0xB1, 0x01,
+  0x00, 0x00, 0x10, 0x10, 0x03, 0x6F, 0x12, 0x83, 0x3A, 0x00, 0x00, 0x00,
+  0x00, 0xB1, 0x01, 0x00, 0x00, 0x20, 0x10, 0x03, 0x6F, 0x12, 0x83, 0x3A,
+  0x00, 0x00, 0x00, 0x00, 0xB1, 0x01, 0x00, 0x00, 0x30, 0x10, 0x03, 0xCD,
+  0xCC, 0xCC, 0x3D, 0x00, 0x00, 0x00, 0x00, 0x28, 0x04, 0x00, 0x00, 0x00,
+  0x10, 0x01, 0x0A, 0xD7, 0x23, 0x3C, 0x00, 0x00, 0x00, 0x00, 0x28, 0x04,
+  0x00, 0x00, 0x10, 0x18, 0x01, 0xCD, 0xCC, 0xCC, 0x3D, 0x00, 0x00, 0x00,
+  0x00, 0x28, 0x04, 0x00, 0x00, 0x28, 0x08, 0x01, 0x00, 0x00, 0x00, 0x3F,
+  0x00, 0x00, 0x20, 0xC2, 0x28, 0x04, 0x00, 0x00, 0x30, 0x08, 0x01, 0xCD,
+  0xCC, 0xCC, 0x3D, 0x00, 0x00, 0x00, 0x00, 0xFE, 0xF1, 0xFE, 0x18, 0x18,
+  0x10, 0x01, 0x00, 0x00, 0x00, 0x3E, 0x00, 0x00, 0x00, 0x00, 0xFE, 0xF1,
+  0xFE, 0x18, 0x10, 0x08, 0x01, 0x00, 0x00, 0x80, 0x3F, 0x00, 0x00, 0xFA,
+  0xC2,
+};
@@ -0,0 +1,561 @@
+// Host micro-benchmarks for the request/response hot path. Each Unity test
+// runs one group and checks the benchmarked code produced the right result;
+// the timings are printed as Google Benchmark JSON at the end (and written
+// to $OBD_BENCH_JSON when set), e.g.
+//   OBD_BENCH_JSON=bench.json pio test -e native -f test_benchmarks
+//   python3 tools/bench_compare.py before.json bench.json
+
+#include <unity.h>
+#include "OBDBench.h"
+#include "OBDTestHarness.h"
+#include "BLEOBDClientProbe.h"
+#include "OBDPidDecoder.h"
+#include "OBDResponse.h"
+#include "OBDSerializer.h"
+#include "CANSignalDB.h"
+#include "bench_signals.h"
+
+static std::vector<BenchResult> results;
+static SimAdapter* adapter = nullptr;
+static BLEOBDClient* client = nullptr;
+
+static void record(const BenchResult& result) {
+  TEST_ASSERT_TRUE(result.nsPerIteration > 0);
+  results.push_back(result);
+}
+
+void setUp() {
+  if (client) return;
+  adapter = new SimAdapter();
+  client = new BLEOBDClient();
+  TEST_ASSERT_TRUE(connectClient(*client, *adapter));
+  runFor(*client, 2000);
+  adapter->replying = false;     // Benchmarks drive the stages directly
+  runFor(*client, 3000);         // Let the request in flight time out
+}
+
+void tearDown() {}
+
+// ---- Notification ingestion ------------------------------------------
+
+// Stream bytes without a prompt in notification-sized chunks: callback
+// append plus drain into the framing buffer and prompt scan of the new bytes
+static void BM_Ingest(BenchState& state, long chunk) {
+  BLEOBDClientProbe probe(*client);
+  BLERemoteCharacteristic* rx = adapter->notifyCharacteristic();
+  uint8_t data[256];
+  for (long i = 0; i < chunk; i++) data[i] = "7E8064100BE3FA813\r"[i % 18];
+  probe.clearReceive();
+
+  while (state.running()) {
+    bleNotifyCallback(rx, data, chunk, true);
+    probe.drain();
+    if (probe.framedBytes() >= 256) {
+      state.pause();
+      probe.clearReceive();
+      state.resume();
+    }
+  }
+  probe.clearReceive();
+  state.setBytesProcessed(state.iterations() * chunk);
+}
+
+// The same stream through the ingestion path as it was before the
+// one-append-per-notification change, with the same locks and wakeup:
+// String += per byte, a copy of the pending text per drain, the framing
+// call taking it by value, and two prompt scans of the whole buffer
+static void referenceFrame(String data, String& incoming, long& found) {
+  incoming += data;
+  if (incoming.length() > OBD_MAX_RESPONSE_TEXT && incoming.indexOf('>') == -1) incoming = "";
+  if (incoming.indexOf('>') != -1) found++;
+}
+
+static void BM_IngestPerByteReference(BenchState& state, long chunk) {
+  uint8_t data[256];
+  for (long i = 0; i < chunk; i++) data[i] = "7E8064100BE3FA813\r"[i % 18];
+  OBDMutex rxLock, stateLock;
+  OBDEvent wake;
+  String pending;
+  String incoming;
+  long found = 0;
+
+  while (state.running()) {
+    rxLock.lock();
+    for (long i = 0; i < chunk; i++) pending += (char)data[i];
+    rxLock.unlock();
+    wake.notify();
+
+    OBDLockGuard guard(stateLock);
+    rxLock.lock();
+    String copy = pending;
+    pending = "";
+    rxLock.unlock();
+    if (copy.length() > 0) referenceFrame(copy, incoming, found);
+    if (incoming.length() >= 256) {
+      state.pause();
+      incoming = "";
+      state.resume();
+    }
+  }
+  benchKeep(found);
+  state.setBytesProcessed(state.iterations() * chunk);
+}
+
+void test_ingest() {
+  static const long chunks[] = {20, 64, 244};
+  for (long chunk : chunks) {
+    record(runBenchmark("BM_Ingest", BM_Ingest, chunk));
+    record(runBenchmark("BM_IngestPerByteReference", BM_IngestPerByteReference, chunk));
+  }
+  TEST_ASSERT_EQUAL_UINT32(0, BLEOBDClientProbe(*client).pendingBytes());
+}
+
+// ---- Prompt detection -------------------------------------------------
+
+// One complete reply framed at its prompt (trim, dispatch, in-place removal)
+static void BM_PromptDetection(BenchState& state, long ecus) {
+  BLEOBDClientProbe probe(*client);
+  String reply;
+  for (long i = 0; i < ecus; i++) {
+    char line[32];
+    snprintf(line, sizeof(line), "7E%X06410CBE3FA813\r", (unsigned)(8 + i));
+    reply += line;
+  }
+  reply += "\r>";
+  probe.clearReceive();
+
+  while (state.running()) {
+    probe.frame(reply);
+  }
+  state.setBytesProcessed(state.iterations() * reply.length());
+  state.setItemsProcessed(state.iterations());
+}
+
+void test_prompt_detection() {
+  Statistics before = client->getStatistics();
+  record(runBenchmark("BM_PromptDetection", BM_PromptDetection, 1));
+  record(runBenchmark("BM_PromptDetection", BM_PromptDetection, 3));
+  record(runBenchmark("BM_PromptDetection", BM_PromptDetection, 8));
+  // Nothing was in flight: every framed reply was dropped as stale
+  TEST_ASSERT_GREATER_THAN(before.staleReplies, client->getStatistics().staleReplies);
+  TEST_ASSERT_EQUAL_UINT32(0, BLEOBDClientProbe(*client).framedBytes());
+}
+
+// ---- Line splitting ---------------------------------------------------
+
+static const char* const LINE_TEXTS[] = {
+  "7E804410C1AF8",
+  "7E804410C1AF8\r7E904410C0FA0\r7EA04410C0000",
+  "7E804410C1AF8\r7E904410C0FA0\r7EA04410C0000\r7EB04410C0001\r"
+  "7EC04410C0002\r7ED04410C0003\r7EE04410C0004\r7EF04410C0005",
+  "7E81014490201314847\r7E821434D383236333341\r7E82230303433353200"
+};
+static const uint8_t LINE_MESSAGES[] = {1, 3, 8, 1};
+
+static void splitText(BenchState& state, const char* text) {
+  size_t length = strlen(text);
+  OBDResponse response;
+  while (state.running()) {
+    parseOBDResponse(text, length, response);
+    benchKeep(response.messageCount);
+  }
+  state.setBytesProcessed(state.iterations() * length);
+}
+
+// Single-frame replies from 1, 3 or 8 ECUs
+static void BM_LineSplit(BenchState& state, long ecus) {
+  splitText(state, LINE_TEXTS[ecus == 1 ? 0 : ecus == 3 ? 1 : 2]);
+}
+
+// One message in three ISO-TP frames (VIN)
+static void BM_LineSplitISOTP(BenchState& state, long) {
+  splitText(state, LINE_TEXTS[3]);
+}
+
+void test_line_split() {
+  for (long i = 0; i < 4; i++) {
+    OBDResponse response;
+    TEST_ASSERT_TRUE(parseOBDResponse(LINE_TEXTS[i], strlen(LINE_TEXTS[i]), response));
+    TEST_ASSERT_EQUAL_UINT8(LINE_MESSAGES[i], response.messageCount);
+  }
+  record(runBenchmark("BM_LineSplit", BM_LineSplit, 1));
+  record(runBenchmark("BM_LineSplit", BM_LineSplit, 3));
+  record(runBenchmark("BM_LineSplit", BM_LineSplit, 8));
+  record(runBenchmark("BM_LineSplitISOTP", BM_LineSplitISOTP));
+}
+
+// ---- PID decode -------------------------------------------------------
+
+struct PIDCase {
+  const char* name;
+  PIDDescriptor desc;
+  const char* reply;
+  float expected;
+};
+
+static PIDCase pidCases[] = {
+  {"BM_PIDDecode_010C_rpm",      standardPID(0x0C, 2, 0.25f),               "7E804410C1AF8", 1726.0f},
+  {"BM_PIDDecode_010D_speed",    standardPID(0x0D, 1, 1.0f),                "7E803410D3C", 60.0f},
+  {"BM_PIDDecode_0105_coolant",  standardPID(0x05, 1, 1.0f, -40.0f),        "7E80341055A", 50.0f},
+  {"BM_PIDDecode_015C_oil",      standardPID(0x5C, 1, 1.0f, -40.0f),        "7E803415C6E", 70.0f},
+  {"BM_PIDDecode_012F_fuel",     standardPID(0x2F, 1, 100.0f / 255.0f),     "7E803412FFF", 100.0f},
+  {"BM_PIDDecode_0111_throttle", standardPID(0x11, 1, 100.0f / 255.0f),     "7E803411100", 0.0f},
+  {"BM_PIDDecode_0104_load",     standardPID(0x04, 1, 100.0f / 255.0f),     "7E8034104FF", 100.0f},
+  {"BM_PIDDecode_0110_maf",      standardPID(0x10, 2, 0.01f),               "7E80441100BB8", 30.0f},
+  {"BM_PIDDecode_010B_map",      standardPID(0x0B, 1, 1.0f),                "7E803410BA0", 160.0f},
+  {"BM_PIDDecode_0133_baro",     standardPID(0x33, 1, 1.0f),                "7E803413364", 100.0f},
+  {"BM_PIDDecode_0142_voltage",  standardPID(0x42, 2, 0.001f),              "7E80441423138", 12.6f},
+  {"BM_PIDDecode_22F40D_did",    extendedPID(0xF40D, 0x7E0, 0x7E8, 0, 8, 1.0f), "7E80462F40D3C", 60.0f},
+};
+
+static void BM_PIDDecode(BenchState& state, long index) {
+  const PIDCase& pid = pidCases[index];
+  OBDResponse response;
+  parseOBDResponse(pid.reply, strlen(pid.reply), response);
+  const OBDMessage& msg = response.messages[0];
+  float value = 0;
+  while (state.running()) {
+    decodePIDValue(pid.desc, msg, &value);
+    benchKeep(value);
+  }
+  state.setItemsProcessed(state.iterations());
+}
+
+void test_pid_decode() {
+  for (size_t i = 0; i < sizeof(pidCases) / sizeof(pidCases[0]); i++) {
+    OBDResponse response;
+    TEST_ASSERT_TRUE(parseOBDResponse(pidCases[i].reply, strlen(pidCases[i].reply), response));
+    float value = -1;
+    TEST_ASSERT_TRUE(decodePIDValue(pidCases[i].desc, response.messages[0], &value));
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, pidCases[i].expected, value);
+    record(runBenchmark(pidCases[i].name, BM_PIDDecode, (long)i, false));
+  }
+}
+
+// ---- Scheduler --------------------------------------------------------
+
+static BLEOBDClient* schedulerClient = nullptr;
+static float schedulerTargets[OBD_MAX_COMMANDS];
+
+// Pick the next due periodic command with every slot due (first slot wins)
+// or none due (full scan of the table)
+static void BM_SchedulerPickNext(BenchState& state, long dueNone) {
+  BLEOBDClientProbe probe(*schedulerClient);
+  uint32_t now = millis();
+  for (uint8_t i = 0; i < probe.commandCount(); i++) {
+    probe.command(i).interval = dueNone ? 60000 : 0;
+    probe.command(i).lastPolled = now;
+  }
+  bool due = false;
+  while (state.running()) {
+    due = probe.selectDueCommand();
+    benchKeep(due);
+  }
+  state.setItemsProcessed(state.iterations());
+}
+
+void test_scheduler_pick_next() {
+  schedulerClient = new BLEOBDClient();
+  for (uint8_t i = 0; i < OBD_MAX_COMMANDS; i++) {
+    schedulerClient->addPID(standardPID(0x0C, 2, 0.25f), &schedulerTargets[i]);
+  }
+  BLEOBDClientProbe probe(*schedulerClient);
+  TEST_ASSERT_EQUAL_UINT8(OBD_MAX_COMMANDS, probe.commandCount());
+
+  record(runBenchmark("BM_SchedulerPickNext_AllDue", BM_SchedulerPickNext, 0, false));
+  TEST_ASSERT_TRUE(probe.selectDueCommand());
+  record(runBenchmark("BM_SchedulerPickNext_NoneDue", BM_SchedulerPickNext, 1, false));
+  TEST_ASSERT_FALSE(probe.selectDueCommand());
+}
+
+// ---- Stats update and snapshot publish --------------------------------
+
+static void BM_StatsUpdate(BenchState& state, long) {
+  BLEOBDClientProbe probe(*client);
+  unsigned long responseTime = 40;
+  while (state.running()) {
+    probe.updateResponseStats(responseTime);
+    responseTime ^= 0x0F;
+  }
+  state.setItemsProcessed(state.iterations());
+}
+
+class NullPrint : public Print {
+public:
+  size_t write(uint8_t) override { return 1; }
+  size_t write(const uint8_t*, size_t size) override { return size; }
+};
+
+static void onRPM(OBDSignal, float, void* context) { (*(uint32_t*)context)++; }
+
+// Decoded value to the snapshot: freshness, derived inputs, subscribers
+// and (when active) the telemetry record
+static void BM_SnapshotPublish(BenchState& state, long telemetryActive) {
+  BLEOBDClientProbe probe(*client);
+  static NullPrint sink;
+  if (telemetryActive) client->startTelemetry(sink);
+  float value = 800.0f;
+  while (state.running()) {
+    probe.publishSignal(SIGNAL_RPM, value, millis());
+    value = value > 5000.0f ? 800.0f : value + 13.0f;
+  }
+  if (telemetryActive) client->stopTelemetry();
+  state.setItemsProcessed(state.iterations());
+}
+
+static const struct { OBDSignal signal; uint8_t decimals; } serializedFields[] = {
+  {SIGNAL_RPM, 0}, {SIGNAL_SPEED, 1}, {SIGNAL_COOLANT_TEMP, 1},
+  {SIGNAL_VOLTAGE, 2}, {SIGNAL_FUEL_ECONOMY, 1}
+};
+
+static void addSerializedFields(SnapshotSerializer& serializer) {
+  for (const auto& field : serializedFields) serializer.addField(field.signal, field.decimals);
+}
+
+static void BM_SnapshotSerialize(BenchState& state, long format) {
+  SnapshotSerializer serializer(format ? FORMAT_CSV : FORMAT_JSON);
+  addSerializedFields(serializer);
+  char out[256];
+  size_t length = 0;
+  while (state.running()) {
+    length = client->serialize(serializer, out, sizeof(out));
+    benchKeep(length);
+  }
+  state.setBytesProcessed(state.iterations() * length);
+}
+
+// The same snapshot built the usual Arduino way: one String per value and
+// per key, concatenated into a String the caller prints
+static String referenceSerialize(const float* values, long format) {
+  String text = format ? "" : "{";
+  bool first = true;
+  for (const auto& field : serializedFields) {
+    if (!first) text += ",";
+    first = false;
+    if (!format) text += "\"" + String(signalName(field.signal)) + "\":";
+    text += String(values[field.signal], (unsigned int)field.decimals);
+  }
+  text += format ? "\n" : "}";
+  return text;
+}
+
+static void BM_SnapshotSerializeStringReference(BenchState& state, long format) {
+  float values[SIGNAL_COUNT];
+  size_t length = 0;
+  while (state.running()) {
+    client->getSignalValues(values);
+    String text = referenceSerialize(values, format);
+    length = text.length();
+    benchKeep(length);
+  }
+  state.setBytesProcessed(state.iterations() * length);
+}
+
+void test_stats_and_publish() {
+  Statistics before = client->getStatistics();
+  record(runBenchmark("BM_StatsUpdate", BM_StatsUpdate));
+  TEST_ASSERT_NOT_EQUAL(0, client->getStatistics().averageResponseTime);
+  TEST_ASSERT_EQUAL_UINT32(before.successfulCommands, client->getStatistics().successfulCommands);
+
+  uint32_t delivered = 0;
+  int handle = client->subscribe(SIGNAL_RPM, onRPM, &delivered, 50.0f);
+  record(runBenchmark("BM_SnapshotPublish", BM_SnapshotPublish, 0));
+  record(runBenchmark("BM_SnapshotPublish", BM_SnapshotPublish, 1));
+  client->unsubscribe(handle);
+  TEST_ASSERT_GREATER_THAN(0, delivered);
+
+  record(runBenchmark("BM_SnapshotSerialize_JSON", BM_SnapshotSerialize, 0, false));
+  record(runBenchmark("BM_SnapshotSerialize_CSV", BM_SnapshotSerialize, 1, false));
+  record(runBenchmark("BM_SnapshotSerializeStringReference_JSON", BM_SnapshotSerializeStringReference, 0, false));
+  record(runBenchmark("BM_SnapshotSerializeStringReference_CSV", BM_SnapshotSerializeStringReference, 1, false));
+
+  // Both paths produce the same text
+  float values[SIGNAL_COUNT];
+  client->getSignalValues(values);
+  for (long format = 0; format <= 1; format++) {
+    SnapshotSerializer serializer(format ? FORMAT_CSV : FORMAT_JSON);
+    addSerializedFields(serializer);
+    char out[256];
+    serializer.write(values, out, sizeof(out));
+    String reference = referenceSerialize(values, format);
+    TEST_ASSERT_EQUAL_STRING(reference.c_str(), out);
+  }
+}
+
+// ---- Monitor stream ---------------------------------------------------
+
+// Synthetic ATMA output: engine, pedal and wheel-speed frames with changing
+// payloads, as one text stream cut into BLE notifications of `mtu` bytes
+static std::vector<std::string> monitorNotifications(size_t mtu) {
+  std::string feed;
+  char line[32];
+  for (unsigned i = 0; i < 64; i++) {
+    unsigned rpm = 3200 + i * 40;
+    snprintf(line, sizeof(line), "0C9000000%02X%02X000000\r", rpm & 0xFF, rpm >> 8);
+    feed += line;
+    snprintf(line, sizeof(line), "1F00000%02X00\r", i * 3);
+    feed += line;
+    snprintf(line, sizeof(line), "3A0%04X%04X%04X%04X\r", i, i + 1, i + 2, i + 3);
+    feed += line;
+  }
+  std::string stream;
+  while (stream.empty() || stream.size() % mtu != 0) stream += feed;  // Wraps on a chunk edge
+  std::vector<std::string> chunks;
+  for (size_t pos = 0; pos < stream.size(); pos += mtu) chunks.push_back(stream.substr(pos, mtu));
+  return chunks;
+}
+
+// Notifications through the BLE callback into the frame ring, drained by
+// one service pass (128 frames at most) after every `burst` notifications;
+// frames parsed per second as items, frames the ring had to drop as the
+// "drops" counter
+static void BM_MonitorStream(BenchState& state, long burst) {
+  static const std::vector<std::string> chunks = monitorNotifications(20);
+  BLEOBDClientProbe probe(*client);
+  BLERemoteCharacteristic* rx = adapter->notifyCharacteristic();
+  uint32_t frames = client->getMonitorFrames();
+  uint32_t drops = client->getMonitorDrops();
+  size_t next = 0;
+
+  while (state.running()) {
+    for (long i = 0; i < burst; i++) {
+      const std::string& chunk = chunks[next];
+      next = next + 1 < chunks.size() ? next + 1 : 0;
+      bleNotifyCallback(rx, (uint8_t*)chunk.data(), chunk.size(), true);
+    }
+    probe.processMonitorFrames();
+  }
+  // Empty the ring so the next run starts from the same state
+  probe.processMonitorFrames();
+  probe.processMonitorFrames();
+  state.setItemsProcessed(client->getMonitorFrames() - frames);
+  state.setCounter("drops", client->getMonitorDrops() - drops);
+}
+
+static float monitorRPM = 0.0f;
+static uint32_t monitorDrops = 0;
+
+void test_monitor_stream() {
+  int rpmIndex = client->getSignalDB()->addSignal(0x0C9, 24, 16, CAN_SIGNAL_LITTLE_ENDIAN, 0.25f, 0.0f);
+  client->getSignalDB()->addSignal(0x1F0, 16, 8, CAN_SIGNAL_LITTLE_ENDIAN, 0.4f, 0.0f);
+  TEST_ASSERT_TRUE(client->bindCANSignal((uint8_t)rpmIndex, SIGNAL_RPM));
+  adapter->replying = true;
+  TEST_ASSERT_TRUE(client->startMonitor());
+  TEST_ASSERT_TRUE(runUntil(*client, [&]() { return adapter->monitoring(); }, 5000));
+
+  // Drained in time, then a service pass late by far more than the ring holds
+  BenchResult drained = runBenchmark("BM_MonitorStream", BM_MonitorStream, 8);
+  record(drained);
+  monitorRPM = client->getCurrentData().rpm;
+  BenchResult late = runBenchmark("BM_MonitorStream", BM_MonitorStream, 512);
+  record(late);
+  monitorDrops = client->getMonitorDrops();
+
+  client->stopMonitor();
+  TEST_ASSERT_TRUE(runUntil(*client, [&]() { return !client->isMonitoring(); }, 5000));
+  adapter->replying = false;
+  runFor(*client, 3000);
+
+  TEST_ASSERT_TRUE(drained.itemsPerSecond > 0);
+  TEST_ASSERT_TRUE(drained.counters[0].second == 0);
+  TEST_ASSERT_TRUE(late.counters[0].second > 0);
+  TEST_ASSERT_TRUE(monitorDrops > 0);
+  TEST_ASSERT_TRUE(monitorRPM >= 800.0f && monitorRPM <= 1500.0f);   // 3200..5720 * 0.25
+}
+
+// ---- Signal decode ----------------------------------------------------
+
+// One second of a powertrain/chassis bus at typical broadcast rates; about
+// a fifth of the traffic has no signals in the database
+static std::vector<CANFrame> busSecond() {
+  struct Message { uint32_t id; uint8_t dlc; uint16_t periodMs; };
+  static const Message messages[] = {
+    {0x0C9, 8, 10}, {0x0F1, 8, 10}, {0x1A1, 8, 20}, {0x1B1, 8, 20}, {0x1F5, 8, 20},
+    {0x18FEF1FE, 8, 20}, {0x3C1, 8, 100}, {0x3D1, 8, 100}, {0x428, 8, 100},
+    {0x1E9, 8, 10}, {0x2F0, 6, 20}, {0x5A0, 8, 100},   // Not in the database
+  };
+  std::vector<CANFrame> frames;
+  uint32_t seed = 0x2545F491;
+  for (uint16_t ms = 0; ms < 1000; ms += 10) {
+    for (const Message& m : messages) {
+      if (ms % m.periodMs != 0) continue;
+      CANFrame frame = CANFrame();
+      frame.id = m.id;
+      frame.dlc = m.dlc;
+      frame.timestamp = ms;
+      for (uint8_t i = 0; i < m.dlc; i++) {
+        seed = seed * 1664525 + 1013904223;
+        frame.data[i] = (uint8_t)(seed >> 24);
+      }
+      frames.push_back(frame);
+    }
+  }
+  return frames;
+}
+
+static void onDecodedSignal(uint8_t, float value, void* context) { *(float*)context += value; }
+
+// The bus through a database loaded from bench_vehicle.dbc (38 signals in
+// 9 messages, Intel and Motorola, signed, one 29-bit id); decoded signals
+// per second as items, with or without a per-signal callback
+static void BM_SignalDecode(BenchState& state, long withCallback) {
+  static const std::vector<CANFrame> frames = busSecond();
+  static CANSignalDB db;
+  if (db.getSignalCount() == 0) db.loadBlob(CAN_SIGNAL_BLOB, sizeof(CAN_SIGNAL_BLOB));
+  uint32_t decoded = db.getDecodedSignals();
+  float sum = 0.0f;
+  size_t next = 0;
+
+  while (state.running()) {
+    db.decodeFrame(frames[next], withCallback ? onDecodedSignal : nullptr, &sum);
+    next = next + 1 < frames.size() ? next + 1 : 0;
+  }
+  benchKeep(sum);
+  uint32_t signals = db.getDecodedSignals() - decoded;
+  state.setItemsProcessed(signals);
+  state.setCounter("signals_per_frame", (double)signals / state.iterations());
+}
+
+void test_signal_decode() {
+  CANSignalDB db;
+  TEST_ASSERT_EQUAL(38, db.loadBlob(CAN_SIGNAL_BLOB, sizeof(CAN_SIGNAL_BLOB)));
+  CANFrame engine = CANFrame();
+  engine.id = 0x0C9;
+  engine.dlc = 8;
+  engine.data[3] = 0xF8;
+  engine.data[4] = 0x1A;
+  TEST_ASSERT_EQUAL_UINT8(5, db.decodeFrame(engine));
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 1726.0f, db.getValue(CAN_SIGNAL_ENGINESPEED));
+  TEST_ASSERT_EQUAL_UINT8(9, db.getMessageCount());
+
+  BenchResult plain = runBenchmark("BM_SignalDecode", BM_SignalDecode, 0, false);
+  BenchResult callback = runBenchmark("BM_SignalDecode_Callback", BM_SignalDecode, 1, false);
+  record(plain);
+  record(callback);
+  TEST_ASSERT_TRUE(plain.itemsPerSecond > 0);
+  TEST_ASSERT_TRUE(plain.counters[0].second > 2.0 && plain.counters[0].second < 4.0);
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_ingest);
+  RUN_TEST(test_prompt_detection);
+  RUN_TEST(test_line_split);
+  RUN_TEST(test_pid_decode);
+  RUN_TEST(test_scheduler_pick_next);
+  RUN_TEST(test_stats_and_publish);
+  RUN_TEST(test_monitor_stream);
+  RUN_TEST(test_signal_decode);
+  int failures = UNITY_END();
+
+  writeBenchJson(stdout, results, "test_benchmarks");
+  const char* path = getenv("OBD_BENCH_JSON");
+  if (path) {
+    FILE* out = fopen(path, "w");
+    if (out) {
+      writeBenchJson(out, results, "test_benchmarks");
+      fclose(out);
+    }
+  }
+  return failures;
+}
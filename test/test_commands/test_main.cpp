@@ -0,0 +1,158 @@
+// Periodic command slots: the built-in reply parsers, custom parsers
+// receiving the decoded payload text, per-ECU slots and the table limits
+
+#include <unity.h>
+#include <type_traits>
+#include "OBDTestHarness.h"
+
+static SimAdapter* adapter = nullptr;
+static BLEOBDClient* client = nullptr;
+
+void setUp() {
+  adapter = new SimAdapter();
+  client = new BLEOBDClient();
+}
+
+void tearDown() {
+  client->disconnect();
+  delete client;
+  delete adapter;
+}
+
+// ---- Slots --------------------------------------------------------------
+
+void test_slots_are_plain_data() {
+  TEST_ASSERT_TRUE(std::is_trivially_copyable<OBDCommand>::value);
+  TEST_ASSERT_TRUE(std::is_standard_layout<OBDCommand>::value);
+  TEST_ASSERT_TRUE(std::is_trivially_copyable<OBDCommandBinding>::value);
+}
+
+// ---- Parsers ------------------------------------------------------------
+
+void test_standard_parsers() {
+  float value = 0;
+  TEST_ASSERT_TRUE(BLEOBDClient::parseRPM("410C1AF8", 8, &value));
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 1726.0f, value);
+  TEST_ASSERT_TRUE(BLEOBDClient::parseSpeed("410D3C", 6, &value));
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 60.0f, value);
+  TEST_ASSERT_TRUE(BLEOBDClient::parseTemperature("41055A", 6, &value));
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 50.0f, value);
+  TEST_ASSERT_TRUE(BLEOBDClient::parsePercentage("4111FF", 6, &value));
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 100.0f, value);
+  TEST_ASSERT_TRUE(BLEOBDClient::parseAirflow("41100BB8", 8, &value));
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 30.0f, value);
+}
+
+void test_parsers_skip_spaces() {
+  float value = 0;
+  const char* spaced = "41 0C 1A F8";
+  TEST_ASSERT_TRUE(BLEOBDClient::parseRPM(spaced, strlen(spaced), &value));
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 1726.0f, value);
+}
+
+void test_parsers_reject_other_replies() {
+  float value = -1;
+  TEST_ASSERT_FALSE(BLEOBDClient::parseRPM("410D3C", 6, &value));        // Wrong PID
+  TEST_ASSERT_FALSE(BLEOBDClient::parseRPM("410C1A", 6, &value));        // Short
+  TEST_ASSERT_FALSE(BLEOBDClient::parseRPM("7F0112", 6, &value));        // Negative response
+  TEST_ASSERT_FALSE(BLEOBDClient::parseSpeed("410DZZ", 6, &value));      // Not hex
+  TEST_ASSERT_FALSE(BLEOBDClient::parseTemperature("410D3C", 6, &value));
+  TEST_ASSERT_FALSE(BLEOBDClient::parsePercentage("41055A", 6, &value));
+  TEST_ASSERT_FALSE(BLEOBDClient::parseAirflow("", 0, &value));
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, -1.0f, value);
+}
+
+void test_parsers_stop_at_length() {
+  // Only the first `length` characters belong to the reply
+  float value = 0;
+  TEST_ASSERT_FALSE(BLEOBDClient::parseRPM("410C1AF8", 6, &value));
+  TEST_ASSERT_TRUE(BLEOBDClient::parseSpeed("410D3CFF", 6, &value));
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 60.0f, value);
+}
+
+void test_parse_voltage() {
+  float value = 0;
+  TEST_ASSERT_TRUE(BLEOBDClient::parseVoltage("12.6V", 5, &value));
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 12.6f, value);
+  TEST_ASSERT_TRUE(BLEOBDClient::parseVoltage("4142317A", 8, &value));
+  TEST_ASSERT_FLOAT_WITHIN(0.001f, 12.666f, value);
+  TEST_ASSERT_TRUE(BLEOBDClient::parseVoltage("41 42 31 7A", 11, &value));
+  TEST_ASSERT_FLOAT_WITHIN(0.001f, 12.666f, value);
+
+  TEST_ASSERT_FALSE(BLEOBDClient::parseVoltage("414231", 6, &value));
+  const char* longText = "12.6000000000000000000000000V";
+  TEST_ASSERT_FALSE(BLEOBDClient::parseVoltage(longText, strlen(longText), &value));
+}
+
+// ---- Client ---------------------------------------------------------------
+
+static char seenText[32];
+static size_t seenLength = 0;
+static int parseCalls = 0;
+
+static bool captureParser(const char* response, size_t length, float* value) {
+  parseCalls++;
+  seenLength = length;
+  snprintf(seenText, sizeof(seenText), "%s", response);
+  uint32_t raw;
+  if (length != 6 || !parseHexValue(response + 4, 2, &raw)) return false;
+  *value = (float)raw - 40;
+  return true;
+}
+
+void test_custom_parser_gets_payload() {
+  adapter->setResponse(0, "0146", "41465A");
+  float ambient = 0;
+  parseCalls = 0;
+  TEST_ASSERT_TRUE(connectClient(*client, *adapter));
+  TEST_ASSERT_TRUE(client->addCommand("0146", &ambient, captureParser));
+  runFor(*client, 2000);
+
+  TEST_ASSERT_TRUE(parseCalls > 0);
+  TEST_ASSERT_EQUAL_STRING("41465A", seenText);
+  TEST_ASSERT_EQUAL_UINT32(6, seenLength);
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 50.0f, ambient);
+}
+
+void test_command_for_second_ecu() {
+  SimECU& gearbox = adapter->addECU(0x7E9, 0x18DAF118, 0x18);
+  gearbox.responses["0105"] = "410564";
+  float gearboxTemp = 0;
+  TEST_ASSERT_TRUE(connectClient(*client, *adapter));
+  TEST_ASSERT_TRUE(client->addCommand("0105", &gearboxTemp, BLEOBDClient::parseTemperature, 0x7E9));
+  runFor(*client, 3000);
+
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 60.0f, gearboxTemp);
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 50.0f, client->getCurrentData().coolantTemp);
+}
+
+void test_table_limits() {
+  float value = 0;
+  TEST_ASSERT_TRUE(connectClient(*client, *adapter));
+  TEST_ASSERT_FALSE(client->addCommand("", &value, BLEOBDClient::parseSpeed));
+  TEST_ASSERT_FALSE(client->addCommand("0102030405AB", &value, BLEOBDClient::parseSpeed));
+
+  int added = 0;
+  while (client->addCommand("010D", &value, BLEOBDClient::parseSpeed)) added++;
+  TEST_ASSERT_TRUE(added > 0 && added < OBD_MAX_COMMANDS);
+  TEST_ASSERT_FALSE(client->addCommand("010D", &value, BLEOBDClient::parseSpeed));
+
+  // The full table still polls
+  runFor(*client, 3000);
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 60.0f, value);
+  TEST_ASSERT_FLOAT_WITHIN(0.5f, 1726.0f, client->getCurrentData().rpm);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_slots_are_plain_data);
+  RUN_TEST(test_standard_parsers);
+  RUN_TEST(test_parsers_skip_spaces);
+  RUN_TEST(test_parsers_reject_other_replies);
+  RUN_TEST(test_parsers_stop_at_length);
+  RUN_TEST(test_parse_voltage);
+  RUN_TEST(test_custom_parser_gets_payload);
+  RUN_TEST(test_command_for_second_ecu);
+  RUN_TEST(test_table_limits);
+  return UNITY_END();
+}
@@ -0,0 +1,189 @@
+// Derived signals: dependency ordering, incremental evaluation, the standard
+// definitions (boost, fuel rate/economy, trip integrators) and the client
+
+#include <unity.h>
+#include "OBDDerived.h"
+#include "OBDTestHarness.h"
+
+static DerivedEngine engine;
+static TripState trip;
+
+void setUp() {
+  engine = DerivedEngine();
+  trip.reset();
+}
+
+void tearDown() {}
+
+static bool sum(const float* v, uint32_t, void*, float* out) {
+  *out = v[SIGNAL_RPM] + v[SIGNAL_SPEED];
+  return true;
+}
+
+static bool doubleBoost(const float* v, uint32_t, void*, float* out) {
+  *out = v[SIGNAL_BOOST] * 2.0f;
+  return true;
+}
+
+static bool never(const float*, uint32_t, void*, float*) { return false; }
+
+// ---- Engine ---------------------------------------------------------------
+
+void test_waits_for_every_input() {
+  engine.add(SIGNAL_BOOST, SIGNAL_BIT(SIGNAL_RPM) | SIGNAL_BIT(SIGNAL_SPEED), sum);
+  engine.set(SIGNAL_RPM, 1000.0f);
+  TEST_ASSERT_EQUAL_HEX32(0, engine.update(0));
+  TEST_ASSERT_FALSE(engine.has(SIGNAL_BOOST));
+
+  engine.set(SIGNAL_SPEED, 50.0f);
+  TEST_ASSERT_EQUAL_HEX32(SIGNAL_BIT(SIGNAL_BOOST), engine.update(0));
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 1050.0f, engine.get(SIGNAL_BOOST));
+}
+
+void test_dependency_order_independent_of_add_order() {
+  // Consumer added before its producer: still sees this update's value
+  engine.add(SIGNAL_FUEL_RATE, SIGNAL_BIT(SIGNAL_BOOST), doubleBoost);
+  engine.add(SIGNAL_BOOST, SIGNAL_BIT(SIGNAL_RPM) | SIGNAL_BIT(SIGNAL_SPEED), sum);
+  engine.set(SIGNAL_RPM, 10.0f);
+  engine.set(SIGNAL_SPEED, 5.0f);
+  uint32_t changed = engine.update(0);
+  TEST_ASSERT_EQUAL_HEX32(SIGNAL_BIT(SIGNAL_BOOST) | SIGNAL_BIT(SIGNAL_FUEL_RATE), changed);
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 30.0f, engine.get(SIGNAL_FUEL_RATE));
+}
+
+void test_only_dirty_definitions_run() {
+  engine.add(SIGNAL_BOOST, SIGNAL_BIT(SIGNAL_RPM) | SIGNAL_BIT(SIGNAL_SPEED), sum);
+  engine.add(SIGNAL_FUEL_RATE, SIGNAL_BIT(SIGNAL_BOOST), doubleBoost);
+  engine.set(SIGNAL_RPM, 10.0f);
+  engine.set(SIGNAL_SPEED, 5.0f);
+  engine.update(0);
+  uint32_t before = engine.getEvaluations();
+
+  TEST_ASSERT_EQUAL_HEX32(0, engine.update(1));   // Nothing set
+  TEST_ASSERT_EQUAL_UINT32(before, engine.getEvaluations());
+
+  engine.set(SIGNAL_COOLANT_TEMP, 90.0f);          // Not an input
+  engine.update(2);
+  TEST_ASSERT_EQUAL_UINT32(before, engine.getEvaluations());
+
+  engine.set(SIGNAL_RPM, 10.0f);                   // Same value: boost runs, unchanged
+  TEST_ASSERT_EQUAL_HEX32(0, engine.update(3));
+  TEST_ASSERT_EQUAL_UINT32(before + 1, engine.getEvaluations());
+}
+
+void test_rejects_bad_definitions() {
+  TEST_ASSERT_FALSE(engine.add(SIGNAL_BOOST, SIGNAL_BIT(SIGNAL_BOOST), sum));
+  TEST_ASSERT_FALSE(engine.add(SIGNAL_COUNT, SIGNAL_BIT(SIGNAL_RPM), sum));
+  TEST_ASSERT_FALSE(engine.add(SIGNAL_BOOST, SIGNAL_BIT(SIGNAL_RPM), nullptr));
+  for (int i = 0; i < OBD_MAX_DERIVED; i++) {
+    TEST_ASSERT_TRUE(engine.add(SIGNAL_BOOST, SIGNAL_BIT(SIGNAL_RPM), never));
+  }
+  TEST_ASSERT_FALSE(engine.add(SIGNAL_BOOST, SIGNAL_BIT(SIGNAL_RPM), never));
+}
+
+void test_declined_output_left_alone() {
+  engine.add(SIGNAL_BOOST, SIGNAL_BIT(SIGNAL_RPM), never);
+  engine.set(SIGNAL_RPM, 1.0f);
+  TEST_ASSERT_EQUAL_HEX32(0, engine.update(0));
+  TEST_ASSERT_FALSE(engine.has(SIGNAL_BOOST));
+  TEST_ASSERT_EQUAL_HEX32(SIGNAL_BIT(SIGNAL_RPM), engine.getInputs(SIGNAL_BOOST));
+  TEST_ASSERT_EQUAL_HEX32(0, engine.getInputs(SIGNAL_SPEED));
+}
+
+// ---- Standard definitions -------------------------------------------------
+
+void test_boost_and_engine_running() {
+  addStandardDerivedSignals(engine, trip);
+  engine.set(SIGNAL_MANIFOLD_PRESSURE, 160.0f);
+  engine.set(SIGNAL_BARO_PRESSURE, 100.0f);
+  engine.set(SIGNAL_RPM, 300.0f);
+  engine.update(0);
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 60.0f, engine.get(SIGNAL_BOOST));
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 0.0f, engine.get(SIGNAL_ENGINE_RUNNING));
+
+  engine.set(SIGNAL_RPM, 800.0f);
+  TEST_ASSERT_EQUAL_HEX32(SIGNAL_BIT(SIGNAL_ENGINE_RUNNING), engine.update(1));
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 1.0f, engine.get(SIGNAL_ENGINE_RUNNING));
+}
+
+void test_fuel_rate_and_economy() {
+  addStandardDerivedSignals(engine, trip);
+  engine.set(SIGNAL_AIRFLOW, 30.0f);
+  engine.set(SIGNAL_SPEED, 60.0f);
+  engine.update(0);
+  float rate = 30.0f * 3600.0f / (OBD_STOICH_AFR * OBD_FUEL_DENSITY);
+  TEST_ASSERT_FLOAT_WITHIN(0.001f, rate, engine.get(SIGNAL_FUEL_RATE));
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, rate * 100.0f / 60.0f, engine.get(SIGNAL_FUEL_ECONOMY));
+
+  engine.set(SIGNAL_SPEED, 0.0f);   // Stopped: no L/100km
+  engine.update(1);
+  TEST_ASSERT_FLOAT_WITHIN(0.001f, 0.0f, engine.get(SIGNAL_FUEL_ECONOMY));
+}
+
+void test_trip_integrators() {
+  addStandardDerivedSignals(engine, trip);
+  engine.set(SIGNAL_AIRFLOW, 30.0f);
+
+  // 60 km/h for 6 minutes in 1 s steps
+  for (uint32_t t = 1000; t <= 361000; t += 1000) {
+    engine.set(SIGNAL_SPEED, 60.0f);
+    engine.update(t);
+  }
+  float rate = engine.get(SIGNAL_FUEL_RATE);
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 6.0f, trip.distanceKm);
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 6.0f, engine.get(SIGNAL_TRIP_DISTANCE));
+  TEST_ASSERT_FLOAT_WITHIN(0.05f, rate * 100.0f / 60.0f, engine.get(SIGNAL_AVG_FUEL_ECONOMY));
+}
+
+void test_long_gap_not_integrated() {
+  addStandardDerivedSignals(engine, trip);
+  engine.set(SIGNAL_SPEED, 100.0f);
+  engine.update(1000);
+  engine.set(SIGNAL_SPEED, 100.0f);
+  engine.update(1000 + OBD_MAX_INTEGRATE_MS + 1);   // e.g. a reconnect
+  TEST_ASSERT_FLOAT_WITHIN(0.0001f, 0.0f, trip.distanceKm);
+  engine.set(SIGNAL_SPEED, 100.0f);
+  engine.update(1000 + OBD_MAX_INTEGRATE_MS + 3601);
+  TEST_ASSERT_FLOAT_WITHIN(0.0001f, 0.1f, trip.distanceKm);
+}
+
+// ---- Client ---------------------------------------------------------------
+
+void test_client_fills_derived_fields() {
+  SimAdapter adapter;
+  BLEOBDClient client;
+  TEST_ASSERT_TRUE(connectClient(client, adapter));
+  runFor(client, 20000);
+
+  OBDData data = client.getCurrentData();
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 60.0f, data.boostPressure);
+  TEST_ASSERT_TRUE(data.engineRunning);
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 30.0f * 3600.0f / (OBD_STOICH_AFR * OBD_FUEL_DENSITY), data.fuelRate);
+  TEST_ASSERT_FLOAT_WITHIN(0.05f, data.fuelRate * 100.0f / 60.0f, data.fuelEconomy);
+  TEST_ASSERT_TRUE(data.tripDistance > 0.2f && data.tripDistance < 0.4f);   // ~20 s at 60 km/h
+  TEST_ASSERT_TRUE(data.avgFuelEconomy > 0.0f);
+
+  client.resetTrip();
+  data = client.getCurrentData();
+  TEST_ASSERT_FLOAT_WITHIN(0.0001f, 0.0f, data.tripDistance);
+  TEST_ASSERT_FLOAT_WITHIN(0.0001f, 0.0f, data.avgFuelEconomy);
+  runFor(client, 3000);
+  TEST_ASSERT_TRUE(client.getCurrentData().tripDistance < 0.1f);
+
+  client.disconnect();
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_waits_for_every_input);
+  RUN_TEST(test_dependency_order_independent_of_add_order);
+  RUN_TEST(test_only_dirty_definitions_run);
+  RUN_TEST(test_rejects_bad_definitions);
+  RUN_TEST(test_declined_output_left_alone);
+  RUN_TEST(test_boost_and_engine_running);
+  RUN_TEST(test_fuel_rate_and_economy);
+  RUN_TEST(test_trip_integrators);
+  RUN_TEST(test_long_gap_not_integrated);
+  RUN_TEST(test_client_fills_derived_fields);
+  return UNITY_END();
+}
@@ -0,0 +1,183 @@
+// DTC decoding (CAN and legacy forms chosen by header type), formatting,
+// and the read/clear cycle against the simulated adapter
+
+#include <unity.h>
+#include "OBDDtc.h"
+#include "OBDTestHarness.h"
+
+static SimAdapter* adapter = nullptr;
+static BLEOBDClient* client = nullptr;
+static int changes = 0;
+static DTCReport lastReport;
+
+static void onChange(const DTCReport& report) {
+  changes++;
+  lastReport = report;
+}
+
+void setUp() {
+  adapter = new SimAdapter();
+  client = new BLEOBDClient();
+  changes = 0;
+  lastReport = DTCReport();
+}
+
+void tearDown() {
+  client->disconnect();
+  delete client;
+  delete adapter;
+}
+
+static DTCSet decode(const char* text, DTCKind kind = DTC_STORED) {
+  OBDResponse response;
+  parseOBDResponse(text, strlen(text), response);
+  DTCSet set;
+  decodeDTCs(response, kind, set);
+  return set;
+}
+
+// ---- Decoding -----------------------------------------------------------
+
+void test_format() {
+  char text[6];
+  formatDTC(0x0301, text);
+  TEST_ASSERT_EQUAL_STRING("P0301", text);
+  formatDTC(0x4123, text);
+  TEST_ASSERT_EQUAL_STRING("C0123", text);
+  formatDTC(0x9ABC, text);
+  TEST_ASSERT_EQUAL_STRING("B1ABC", text);
+  formatDTC(0xC001, text);
+  TEST_ASSERT_EQUAL_STRING("U0001", text);
+}
+
+void test_can_11bit() {
+  DTCSet set = decode("7E8 06 43 02 01 33 03 01\r");
+  TEST_ASSERT_EQUAL_UINT8(2, set.count);
+  TEST_ASSERT_TRUE(set.contains(0x0133));
+  TEST_ASSERT_TRUE(set.contains(0x0301));
+}
+
+void test_can_29bit_two_ecus() {
+  DTCSet set = decode("18DAF1100443010420\r18DAF118044301C100\r");
+  TEST_ASSERT_EQUAL_UINT8(2, set.count);
+  TEST_ASSERT_TRUE(set.contains(0x0420));
+  TEST_ASSERT_TRUE(set.contains(0xC100));
+}
+
+void test_can_multi_frame() {
+  DTCSet set = decode("7E8 10 0A 43 04 01 33 03 01\r7E8 21 04 20 01 71 00 00 00\r");
+  TEST_ASSERT_EQUAL_UINT8(4, set.count);
+  TEST_ASSERT_TRUE(set.contains(0x0171));
+}
+
+void test_can_count_bounds_the_codes() {
+  // Count says one code; the padding after it is not a second code
+  DTCSet set = decode("7E8 06 43 01 01 33 00 00\r");
+  TEST_ASSERT_EQUAL_UINT8(1, set.count);
+  TEST_ASSERT_TRUE(set.contains(0x0133));
+}
+
+void test_can_no_codes() {
+  DTCSet set = decode("7E8 02 43 00\r");
+  TEST_ASSERT_EQUAL_UINT8(0, set.count);
+}
+
+void test_legacy_two_lines() {
+  DTCSet set = decode("48 6B 10 43 01 33 03 01 04 20 00\r48 6B 10 43 01 71 00 00 00 00 00\r");
+  TEST_ASSERT_EQUAL_UINT8(4, set.count);
+  TEST_ASSERT_TRUE(set.contains(0x0133));
+  TEST_ASSERT_TRUE(set.contains(0x0420));
+  TEST_ASSERT_TRUE(set.contains(0x0171));
+}
+
+void test_legacy_that_looks_like_can() {
+  // 14 payload bytes with 06 in the count position: 2 + 6 * 2 = 14, but the
+  // legacy header says these are two lines of three codes
+  DTCSet set = decode("48 6B 10 43 06 33 01 00 00 00 00\r48 6B 10 43 01 71 00 00 00 00 00\r");
+  TEST_ASSERT_EQUAL_UINT8(3, set.count);
+  TEST_ASSERT_TRUE(set.contains(0x0633));
+  TEST_ASSERT_TRUE(set.contains(0x0100));
+  TEST_ASSERT_TRUE(set.contains(0x0171));
+}
+
+void test_other_mode_not_answered() {
+  OBDResponse response;
+  const char* text = "7E8 06 47 01 01 33 00 00\r";
+  parseOBDResponse(text, strlen(text), response);
+  DTCSet set;
+  TEST_ASSERT_FALSE(decodeDTCs(response, DTC_STORED, set));
+  TEST_ASSERT_TRUE(decodeDTCs(response, DTC_PENDING, set));
+}
+
+// ---- Client ---------------------------------------------------------------
+
+void test_read_cycle() {
+  adapter->setResponse(0, "03", "430201330301");
+  adapter->setResponse(0, "07", "47010420");
+  client->setDTCCallback(onChange);
+  TEST_ASSERT_TRUE(connectClient(*client, *adapter));
+  runFor(*client, 1000);
+
+  client->readDTCs();
+  runFor(*client, 2000);
+  DTCReport report = client->getDTCReport();
+  TEST_ASSERT_EQUAL_UINT8(2, report.stored().count);
+  TEST_ASSERT_EQUAL_UINT8(1, report.pending().count);
+  TEST_ASSERT_TRUE(report.pending().contains(0x0420));
+  TEST_ASSERT_EQUAL_UINT8(0, report.permanent().count);
+  TEST_ASSERT_EQUAL(1, changes);
+
+  // Same codes again: no change reported
+  client->readDTCs();
+  runFor(*client, 2000);
+  TEST_ASSERT_EQUAL(1, changes);
+}
+
+void test_read_cycle_legacy() {
+  adapter->setProtocol(SIM_LEGACY);
+  adapter->setResponse(0, "03", "43063301000000");
+  TEST_ASSERT_TRUE(connectClient(*client, *adapter));
+  runFor(*client, 1000);
+
+  client->readDTCs();
+  runFor(*client, 2000);
+  DTCReport report = client->getDTCReport();
+  TEST_ASSERT_EQUAL_UINT8(2, report.stored().count);
+  TEST_ASSERT_TRUE(report.stored().contains(0x0633));
+  TEST_ASSERT_TRUE(report.stored().contains(0x0100));
+}
+
+void test_clear_rereads() {
+  adapter->setResponse(0, "03", "43010133");
+  adapter->setResponse(0, "04", "44");
+  client->setDTCCallback(onChange);
+  TEST_ASSERT_TRUE(connectClient(*client, *adapter));
+  client->readDTCs();
+  runFor(*client, 2000);
+  TEST_ASSERT_EQUAL_UINT8(1, client->getDTCReport().stored().count);
+
+  adapter->setResponse(0, "03", "4300");
+  client->clearDTCs();
+  runFor(*client, 2000);
+  TEST_ASSERT_EQUAL(1, (int)adapter->countWrites("04"));
+  TEST_ASSERT_EQUAL_UINT8(0, client->getDTCReport().stored().count);
+  TEST_ASSERT_EQUAL(2, changes);
+  TEST_ASSERT_EQUAL_UINT8(0, lastReport.stored().count);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_format);
+  RUN_TEST(test_can_11bit);
+  RUN_TEST(test_can_29bit_two_ecus);
+  RUN_TEST(test_can_multi_frame);
+  RUN_TEST(test_can_count_bounds_the_codes);
+  RUN_TEST(test_can_no_codes);
+  RUN_TEST(test_legacy_two_lines);
+  RUN_TEST(test_legacy_that_looks_like_can);
+  RUN_TEST(test_other_mode_not_answered);
+  RUN_TEST(test_read_cycle);
+  RUN_TEST(test_read_cycle_legacy);
+  RUN_TEST(test_clear_rereads);
+  return UNITY_END();
+}
@@ -0,0 +1,198 @@
+// Signal freshness: histogram bucket edges and percentiles, refresh rate,
+// derived signals aged by their oldest input, and per-consumer accounting
+
+#include <unity.h>
+#include <string.h>
+#include "OBDFreshness.h"
+#include "OBDTestHarness.h"
+
+static FreshnessTracker tracker;
+
+void setUp() { tracker = FreshnessTracker(); }
+void tearDown() {}
+
+// ---- Histogram --------------------------------------------------------------
+
+void test_bucket_edges() {
+  FreshnessHistogram h = {};
+  // An age on an edge belongs to the bucket below it
+  h.add(0);
+  h.add(10);
+  h.add(11);
+  h.add(20);
+  h.add(21);
+  h.add(5000);
+  h.add(5001);
+  h.add(0xFFFFFFFF);
+
+  TEST_ASSERT_EQUAL_UINT32(2, h.buckets[0]);
+  TEST_ASSERT_EQUAL_UINT32(2, h.buckets[1]);
+  TEST_ASSERT_EQUAL_UINT32(1, h.buckets[2]);
+  TEST_ASSERT_EQUAL_UINT32(1, h.buckets[FRESHNESS_BUCKETS - 2]);
+  TEST_ASSERT_EQUAL_UINT32(2, h.buckets[FRESHNESS_BUCKETS - 1]);
+  TEST_ASSERT_EQUAL_UINT32(8, h.count);
+  TEST_ASSERT_EQUAL_UINT32(0xFFFFFFFF, h.max);
+  // The sum does not wrap at 32 bits
+  TEST_ASSERT_TRUE(h.sum > 0xFFFFFFFFull);
+}
+
+void test_percentile_below_bucket_edge() {
+  FreshnessHistogram h = {};
+  TEST_ASSERT_EQUAL_UINT32(0, h.percentile(50));
+
+  // All in the 10-20 bucket: the largest age seen, not the edge
+  h.add(12);
+  h.add(13);
+  h.add(15);
+  TEST_ASSERT_EQUAL_UINT32(15, h.percentile(50));
+  TEST_ASSERT_EQUAL_UINT32(15, h.percentile(100));
+  TEST_ASSERT_EQUAL_UINT32(13, h.mean());
+
+  // Lower buckets report their edge, the top one the max
+  h.add(5);
+  h.add(150);
+  TEST_ASSERT_EQUAL_UINT32(20, h.percentile(50));
+  TEST_ASSERT_EQUAL_UINT32(150, h.percentile(90));
+  TEST_ASSERT_EQUAL_UINT32(10, h.percentile(1));
+}
+
+void test_percentile_above_last_edge() {
+  FreshnessHistogram h = {};
+  for (int i = 0; i < 9; i++) h.add(40);
+  h.add(7000);
+  TEST_ASSERT_EQUAL_UINT32(50, h.percentile(90));
+  TEST_ASSERT_EQUAL_UINT32(7000, h.percentile(91));
+  TEST_ASSERT_EQUAL_UINT32(7000, h.percentile(99));
+}
+
+// ---- Signals ----------------------------------------------------------------
+
+void test_refresh_rate() {
+  TEST_ASSERT_EQUAL_FLOAT(0.0f, tracker.getRefreshHz(SIGNAL_RPM));
+
+  // One sample gives no rate, the first gap sets it
+  tracker.sampled(SIGNAL_RPM, 0, 30);
+  TEST_ASSERT_EQUAL_FLOAT(0.0f, tracker.getRefreshHz(SIGNAL_RPM));
+  tracker.sampled(SIGNAL_RPM, 100, 130);
+  TEST_ASSERT_FLOAT_WITHIN(0.001f, 10.0f, tracker.getRefreshHz(SIGNAL_RPM));
+
+  // Later gaps move the smoothed interval an eighth of the way
+  tracker.sampled(SIGNAL_RPM, 300, 330);
+  TEST_ASSERT_FLOAT_WITHIN(0.001f, 1000.0f / 112.5f, tracker.getRefreshHz(SIGNAL_RPM));
+  for (uint32_t t = 530; t < 20000; t += 200) tracker.sampled(SIGNAL_RPM, t - 30, t);
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 5.0f, tracker.getRefreshHz(SIGNAL_RPM));
+
+  TEST_ASSERT_EQUAL_FLOAT(0.0f, tracker.getRefreshHz(SIGNAL_SPEED));
+  TEST_ASSERT_EQUAL_FLOAT(0.0f, tracker.getRefreshHz(SIGNAL_COUNT));
+}
+
+void test_age_from_request_time() {
+  TEST_ASSERT_EQUAL_UINT32(0, tracker.getAge(SIGNAL_RPM, 1000));
+  tracker.sampled(SIGNAL_RPM, 1000, 1040);
+  TEST_ASSERT_EQUAL_UINT32(40, tracker.getAge(SIGNAL_RPM, 1040));
+  TEST_ASSERT_EQUAL_UINT32(250, tracker.getAge(SIGNAL_RPM, 1250));
+}
+
+void test_derived_takes_oldest_input() {
+  const uint32_t inputs = SIGNAL_BIT(SIGNAL_SPEED) | SIGNAL_BIT(SIGNAL_AIRFLOW) |
+                          SIGNAL_BIT(SIGNAL_FUEL_RATE);
+  tracker.sampled(SIGNAL_SPEED, 1200, 1230);
+  tracker.sampled(SIGNAL_AIRFLOW, 1000, 1030);
+
+  // The unsampled fuel rate does not count; airflow is the oldest input
+  tracker.derived(SIGNAL_FUEL_ECONOMY, inputs, 1300);
+  TEST_ASSERT_EQUAL_UINT32(300, tracker.getAge(SIGNAL_FUEL_ECONOMY, 1300));
+
+  // A newer airflow sample leaves speed as the oldest
+  tracker.sampled(SIGNAL_AIRFLOW, 1400, 1430);
+  tracker.derived(SIGNAL_FUEL_ECONOMY, inputs, 1450);
+  TEST_ASSERT_EQUAL_UINT32(250, tracker.getAge(SIGNAL_FUEL_ECONOMY, 1450));
+
+  // No sampled input: fresh as of now
+  tracker.derived(SIGNAL_TRIP_DISTANCE, SIGNAL_BIT(SIGNAL_BOOST), 2000);
+  TEST_ASSERT_EQUAL_UINT32(0, tracker.getAge(SIGNAL_TRIP_DISTANCE, 2000));
+}
+
+// ---- Consumers --------------------------------------------------------------
+
+void test_consumer_accounting() {
+  int app = tracker.addConsumer("app");
+  int logger = tracker.addConsumer("logger");
+  TEST_ASSERT_EQUAL(0, app);
+  TEST_ASSERT_EQUAL(1, logger);
+
+  tracker.sampled(SIGNAL_RPM, 1000, 1030);
+  tracker.sampled(SIGNAL_SPEED, 1100, 1130);
+
+  // Unsampled signals in the mask are skipped
+  tracker.consumed(app, SIGNAL_BIT(SIGNAL_RPM) | SIGNAL_BIT(SIGNAL_BOOST), 1050);
+  tracker.consumed(logger, FRESHNESS_ALL_SIGNALS, 1500);
+  const FreshnessHistogram& appAges = tracker.getConsumerHistogram(app);
+  const FreshnessHistogram& loggerAges = tracker.getConsumerHistogram(logger);
+  TEST_ASSERT_EQUAL_UINT32(1, appAges.count);
+  TEST_ASSERT_EQUAL_UINT32(50, appAges.max);
+  TEST_ASSERT_EQUAL_UINT32(2, loggerAges.count);
+  TEST_ASSERT_EQUAL_UINT32(500, loggerAges.max);
+  TEST_ASSERT_EQUAL_UINT32(450, loggerAges.mean());
+
+  // Reads without a valid consumer still count per signal
+  tracker.consumed(-1, SIGNAL_BIT(SIGNAL_RPM), 1100);
+  tracker.consumed(OBD_MAX_CONSUMERS, SIGNAL_BIT(SIGNAL_RPM), 1100);
+  TEST_ASSERT_EQUAL_UINT32(4, tracker.getSignalHistogram(SIGNAL_RPM).count);
+  TEST_ASSERT_EQUAL_UINT32(1, tracker.getSignalHistogram(SIGNAL_SPEED).count);
+  TEST_ASSERT_EQUAL_UINT32(1, appAges.count);
+  TEST_ASSERT_EQUAL_UINT32(2, loggerAges.count);
+
+  char out[1024];
+  tracker.report(out, sizeof(out));
+  TEST_ASSERT_NOT_NULL(strstr(out, "consumer app"));
+  TEST_ASSERT_NOT_NULL(strstr(out, "consumer logger"));
+}
+
+void test_consumer_limit() {
+  for (int i = 0; i < OBD_MAX_CONSUMERS; i++) TEST_ASSERT_EQUAL(i, tracker.addConsumer("c"));
+  TEST_ASSERT_EQUAL(-1, tracker.addConsumer("full"));
+  TEST_ASSERT_EQUAL_UINT8(OBD_MAX_CONSUMERS, tracker.getConsumerCount());
+}
+
+// ---- Client -----------------------------------------------------------------
+
+void test_client_leaves_two_consumer_slots() {
+  SimAdapter adapter;
+  BLEOBDClient client;
+  // The display and telemetry consumers are registered up front
+  TEST_ASSERT_EQUAL_UINT8(2, client.getFreshness()->getConsumerCount());
+  int app = client.addConsumer("app");
+  int logger = client.addConsumer("logger");
+  TEST_ASSERT_EQUAL(2, app);
+  TEST_ASSERT_EQUAL(3, logger);
+  TEST_ASSERT_EQUAL(-1, client.addConsumer("extra"));
+
+  TEST_ASSERT_TRUE(connectClient(client, adapter));
+  runFor(client, 2000);
+  client.getCurrentData(app);
+  client.markConsumed(logger, SIGNAL_BIT(SIGNAL_RPM));
+  {
+    auto freshness = client.getFreshness();
+    TEST_ASSERT_TRUE(freshness->getConsumerHistogram(app).count > 1);
+    TEST_ASSERT_EQUAL_UINT32(1, freshness->getConsumerHistogram(logger).count);
+    // Polled at the simulator's pace, read right after
+    TEST_ASSERT_TRUE(freshness->getConsumerHistogram(logger).max < 2000);
+  }
+  TEST_ASSERT_TRUE(client.getRefreshHz(SIGNAL_RPM) > 0.0f);
+  client.disconnect();
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_bucket_edges);
+  RUN_TEST(test_percentile_below_bucket_edge);
+  RUN_TEST(test_percentile_above_last_edge);
+  RUN_TEST(test_refresh_rate);
+  RUN_TEST(test_age_from_request_time);
+  RUN_TEST(test_derived_takes_oldest_input);
+  RUN_TEST(test_consumer_accounting);
+  RUN_TEST(test_consumer_limit);
+  RUN_TEST(test_client_leaves_two_consumer_slots);
+  return UNITY_END();
+}
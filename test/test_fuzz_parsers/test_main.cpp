@@ -0,0 +1,427 @@
+// Property fuzzing of everything that parses adapter or user-supplied bytes:
+// reply framing, OBDResponse, DTCs, PID descriptors, the CAN signal blob and
+// the snapshot serializer. Each target runs its seeds from test/corpus/<target>
+// plus OBD_FUZZ_RUNS (default 3000) deterministic mutations (OBD_FUZZ_SEED),
+// checks invariants that must hold for any input, and prints the per-input
+// throughput. The same targets build as a libFuzzer binary, the first byte
+// picking the target (one command line):
+//   clang++ -std=gnu++17 -g -fsanitize=fuzzer,address,undefined -DOBD_LIBFUZZER
+//     -Itest/mocks/ArduinoMock -Itest/mocks/OBDTestSupport -Ilib/OBDClient_Core
+//     test/mocks/ArduinoMock/*.cpp lib/OBDClient_Core/*.cpp
+//     test/test_fuzz_parsers/test_main.cpp -lpthread -o fuzz_parsers
+//   ./fuzz_parsers fuzz_corpus/   (seed it from test/corpus/*)
+
+#include <dirent.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <string>
+#include <vector>
+#include "CANSignalDB.h"
+#include "OBDDtc.h"
+#include "OBDPidDecoder.h"
+#include "OBDResponse.h"
+#include "OBDSerializer.h"
+#include "OBDTestHarness.h"
+#include "BLEOBDClientProbe.h"
+
+#ifdef OBD_LIBFUZZER
+#define FUZZ_CHECK(condition) do { if (!(condition)) abort(); } while (0)
+#else
+#include <unity.h>
+
+static const uint8_t* currentInput = nullptr;
+static size_t currentSize = 0;
+
+// Print the failing input so it can be saved as a new seed
+static void dumpInput() {
+  printf("input (%u bytes):", (unsigned)currentSize);
+  for (size_t i = 0; i < currentSize; i++) printf(" %02X", currentInput[i]);
+  printf("\n");
+}
+
+#define FUZZ_CHECK(condition) do { \
+    if (!(condition)) { dumpInput(); TEST_FAIL_MESSAGE(#condition); } \
+  } while (0)
+#endif
+
+template <typename T> static T readLE(const uint8_t* data) {
+  T value;
+  memcpy(&value, data, sizeof(value));
+  return value;
+}
+
+// ---- Targets ----------------------------------------------------------------
+
+static SimAdapter* adapter = nullptr;
+static BLEOBDClient* client = nullptr;
+
+// A connected client whose adapter has gone quiet, so every reply comes from
+// the fuzzer while requests keep being sent and timing out
+static void startClient() {
+  if (client) return;
+  adapter = new SimAdapter();
+  client = new BLEOBDClient();
+  connectClient(*client, *adapter);
+  runFor(*client, 1000);
+  adapter->replying = false;
+}
+
+// Raw notification bytes, split in BLE-sized chunks, through the receive
+// callback, the drain and processIncomingData's prompt framing
+static void fuzzFraming(const uint8_t* data, size_t size) {
+  startClient();
+  BLERemoteCharacteristic* rx = adapter->notifyCharacteristic();
+  size_t chunk = size ? 1 + data[0] % 40 : 1;
+
+  for (size_t offset = 0; offset < size; offset += chunk) {
+    size_t length = size - offset < chunk ? size - offset : chunk;
+    bleNotifyCallback(rx, (uint8_t*)data + offset, length, true);
+    runFor(*client, 5);
+    BLEOBDClientProbe probe(*client);
+    FUZZ_CHECK(probe.pendingBytes() == 0);
+    FUZZ_CHECK(probe.framedBytes() <= OBD_MAX_RESPONSE_TEXT + chunk);
+  }
+  ConnectionState state = client->getConnectionState();
+  FUZZ_CHECK(state >= DISCONNECTED && state <= ERROR_STATE);
+  if (state != CONNECTED) {
+    // A reset banner or repeated errors can restart the adapter: bring it back
+    adapter->replying = true;
+    runUntil(*client, []() { return client->getConnectionState() == CONNECTED; }, 10000);
+    runFor(*client, 500);
+    adapter->replying = false;
+  }
+}
+
+static void checkResponse(const OBDResponse& response) {
+  FUZZ_CHECK(response.messageCount <= OBD_MAX_ECUS);
+  for (uint8_t i = 0; i < response.messageCount; i++) {
+    const OBDMessage& msg = response.messages[i];
+    FUZZ_CHECK(msg.length <= OBD_MAX_PAYLOAD);
+    FUZZ_CHECK(msg.headerType <= OBD_HEADER_LEGACY);
+  }
+}
+
+static void fuzzResponse(const uint8_t* data, size_t size) {
+  OBDResponse first, second;
+  bool parsed = parseOBDResponse((const char*)data, size, first);
+  checkResponse(first);
+
+  // Same text, same result
+  FUZZ_CHECK(parseOBDResponse((const char*)data, size, second) == parsed);
+  FUZZ_CHECK(first.messageCount == second.messageCount);
+  for (uint8_t i = 0; i < first.messageCount; i++) {
+    FUZZ_CHECK(first.messages[i].ecuId == second.messages[i].ecuId);
+    FUZZ_CHECK(first.messages[i].length == second.messages[i].length);
+    FUZZ_CHECK(memcmp(first.messages[i].data, second.messages[i].data, first.messages[i].length) == 0);
+  }
+
+  // Lookups only ever return messages that are part of the response
+  for (uint8_t i = 0; i < first.messageCount; i++) {
+    FUZZ_CHECK(first.fromECU(first.messages[i].ecuId) != nullptr);
+  }
+  const OBDMessage* primary = first.primary(0x41, 0x0C);
+  FUZZ_CHECK(!primary || (primary >= first.messages && primary < first.messages + first.messageCount));
+  if (primary) FUZZ_CHECK(first.answers(0x41, 0x0C));
+}
+
+static void fuzzDtc(const uint8_t* data, size_t size) {
+  OBDResponse response;
+  parseOBDResponse((const char*)data, size, response);
+  checkResponse(response);
+
+  for (int kind = DTC_STORED; kind <= DTC_PERMANENT; kind++) {
+    DTCSet set;
+    decodeDTCs(response, (DTCKind)kind, set);
+    FUZZ_CHECK(set.count <= OBD_MAX_DTCS);
+    for (uint8_t i = 0; i < set.count; i++) {
+      FUZZ_CHECK(set.contains(set.codes[i]));
+      char text[6];
+      formatDTC(set.codes[i], text);
+      FUZZ_CHECK(strlen(text) == 5);
+      FUZZ_CHECK(strchr("PCBU", text[0]) != nullptr);
+      for (uint8_t j = 0; j < i; j++) FUZZ_CHECK(set.codes[j] != set.codes[i]);   // No duplicates
+    }
+  }
+}
+
+// 15-byte descriptor (see test/corpus/pid), then the message payload. The
+// whole input is also offered to the XPID blob parser.
+static void fuzzPid(const uint8_t* data, size_t size) {
+  PIDDescriptor parsed[OBD_MAX_EXTENDED_PIDS];
+  int count = parsePIDBlob(data, size, parsed, OBD_MAX_EXTENDED_PIDS);
+  FUZZ_CHECK(count >= -1 && count <= OBD_MAX_EXTENDED_PIDS);
+  for (int i = 0; i < count; i++) FUZZ_CHECK(pidDescriptorValid(parsed[i]));
+
+  if (size < 15) return;
+  PIDDescriptor desc = PIDDescriptor();
+  desc.mode = data[0];
+  desc.pid = readLE<uint16_t>(data + 1);
+  desc.byteOffset = data[3];
+  desc.bitOffset = data[4];
+  desc.bitLength = data[5];
+  desc.flags = data[6];
+  desc.scale = readLE<float>(data + 7);
+  desc.offset = readLE<float>(data + 11);
+
+  OBDMessage msg = OBDMessage();
+  msg.length = (uint8_t)(size - 15 > OBD_MAX_PAYLOAD ? OBD_MAX_PAYLOAD : size - 15);
+  memcpy(msg.data, data + 15, msg.length);
+
+  float value = 0.0f;
+  bool decoded = decodePIDValue(desc, msg, &value);
+  if (!pidDescriptorValid(desc)) FUZZ_CHECK(!decoded);
+  if (decoded && isfinite(desc.scale) && isfinite(desc.offset) &&
+      fabsf(desc.scale) < 1e6f && fabsf(desc.offset) < 1e6f) {
+    FUZZ_CHECK(isfinite(value));
+  }
+
+  char request[8];
+  formatPIDRequest(desc, request);
+  FUZZ_CHECK(strlen(request) < sizeof(request));
+}
+
+// Blob length (LE16), CDBC blob, then frames: id (LE32), dlc, data
+static void fuzzSignalDB(const uint8_t* data, size_t size) {
+  static CANSignalDB db;
+  db.clear();
+  if (size < 2) return;
+  size_t blobLength = readLE<uint16_t>(data);
+  if (blobLength > size - 2) blobLength = size - 2;
+
+  int loaded = db.loadBlob(data + 2, blobLength);
+  FUZZ_CHECK(loaded >= -1 && loaded <= CAN_MAX_SIGNALS);
+  FUZZ_CHECK(db.getSignalCount() <= CAN_MAX_SIGNALS);
+  FUZZ_CHECK(db.getMessageCount() <= CAN_MAX_MESSAGES);
+
+  for (size_t pos = 2 + blobLength; pos + 5 <= size;) {
+    CANFrame frame = CANFrame();
+    frame.id = readLE<uint32_t>(data + pos);
+    frame.dlc = data[pos + 4] > 8 ? 8 : data[pos + 4];
+    pos += 5;
+    size_t available = size - pos < frame.dlc ? size - pos : frame.dlc;
+    memcpy(frame.data, data + pos, available);
+    pos += available;
+    FUZZ_CHECK(db.decodeFrame(frame) <= db.getSignalCount());
+  }
+  for (uint16_t i = 0; i < 256; i++) db.getValue((uint8_t)i);   // Out of range is 0, not a read past the table
+}
+
+// Format, output size, field count, (signal, decimals) pairs, then one
+// float per signal
+static void fuzzSerializer(const uint8_t* data, size_t size) {
+  if (size < 3) return;
+  SnapshotSerializer serializer(data[0] & 1 ? FORMAT_CSV : FORMAT_JSON);
+  size_t outSize = data[1];
+  size_t pos = 3;
+  for (uint8_t i = 0; i < data[2] && pos + 2 <= size; i++, pos += 2) {
+    uint8_t before = serializer.getFieldCount();
+    bool added = serializer.addField((OBDSignal)data[pos], data[pos + 1]);
+    FUZZ_CHECK(serializer.getFieldCount() == before + (added ? 1 : 0));
+  }
+
+  float values[SIGNAL_COUNT] = {};
+  for (uint8_t i = 0; i < SIGNAL_COUNT && pos + 4 <= size; i++, pos += 4) {
+    values[i] = readLE<float>(data + pos);
+    char text[24];
+    size_t length = formatFixed(values[i], data[pos] % 8, text);
+    FUZZ_CHECK(length < sizeof(text) && length == strlen(text));
+  }
+
+  // Guard bytes catch a write past outSize
+  char out[256 + 4];
+  memset(out, 0x5A, sizeof(out));
+  size_t length = serializer.write(values, out, outSize);
+  FUZZ_CHECK(memcmp(out + outSize, "\x5A\x5A\x5A\x5A", 4) == 0);
+  if (length > 0) {
+    FUZZ_CHECK(length < outSize && strlen(out) == length);
+    if (!(data[0] & 1)) FUZZ_CHECK(out[0] == '{' && out[length - 1] == '}');
+  }
+
+  memset(out, 0x5A, sizeof(out));
+  length = serializer.writeHeader(out, outSize);
+  FUZZ_CHECK(memcmp(out + outSize, "\x5A\x5A\x5A\x5A", 4) == 0);
+  if (length > 0) FUZZ_CHECK(length < outSize && strlen(out) == length);
+}
+
+typedef void (*FuzzTarget)(const uint8_t* data, size_t size);
+
+struct FuzzTargetInfo {
+  const char* name;          // Also the corpus directory
+  FuzzTarget run;
+};
+
+static const FuzzTargetInfo targets[] = {
+  {"framing", fuzzFraming},
+  {"response", fuzzResponse},
+  {"dtc", fuzzDtc},
+  {"pid", fuzzPid},
+  {"signal_db", fuzzSignalDB},
+  {"serializer", fuzzSerializer},
+};
+
+#ifdef OBD_LIBFUZZER
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+  if (size == 0) return 0;
+  targets[data[0] % (sizeof(targets) / sizeof(targets[0]))].run(data + 1, size - 1);
+  return 0;
+}
+
+#else
+
+// ---- Runner -----------------------------------------------------------------
+
+typedef std::vector<uint8_t> Input;
+
+static uint32_t rngState = 1;
+
+static uint32_t nextRandom() {
+  rngState ^= rngState << 13;
+  rngState ^= rngState >> 17;
+  rngState ^= rngState << 5;
+  return rngState;
+}
+
+static unsigned long envNumber(const char* name, unsigned long fallback) {
+  const char* value = getenv(name);
+  return value ? strtoul(value, nullptr, 0) : fallback;
+}
+
+// Seeds live next to this file unless OBD_CORPUS_DIR says otherwise
+static std::string corpusDir(const char* target) {
+  const char* env = getenv("OBD_CORPUS_DIR");
+  std::string base;
+  if (env) {
+    base = env;
+  } else {
+    base = __FILE__;
+    base = base.substr(0, base.find_last_of('/'));
+    base = base.substr(0, base.find_last_of('/')) + "/corpus";
+  }
+  return base + "/" + target;
+}
+
+static std::vector<Input> loadSeeds(const char* target) {
+  std::vector<Input> seeds;
+  std::string dir = corpusDir(target);
+  DIR* handle = opendir(dir.c_str());
+  if (!handle) return seeds;
+  while (dirent* entry = readdir(handle)) {
+    if (entry->d_name[0] == '.') continue;
+    FILE* file = fopen((dir + "/" + entry->d_name).c_str(), "rb");
+    if (!file) continue;
+    Input seed;
+    int c;
+    while ((c = fgetc(file)) != EOF) seed.push_back((uint8_t)c);
+    fclose(file);
+    seeds.push_back(seed);
+  }
+  closedir(handle);
+  return seeds;
+}
+
+// Bytes the parsers branch on, so mutations reach past the first check
+static const char dictionary[] = "0123456789ABCDEF \r\n>:?.\x7F\x00\xFF";
+
+static Input mutate(const std::vector<Input>& seeds) {
+  Input input = seeds[nextRandom() % seeds.size()];
+  uint32_t steps = 1 + nextRandom() % 4;
+  for (uint32_t step = 0; step < steps; step++) {
+    size_t at = input.empty() ? 0 : nextRandom() % input.size();
+    switch (nextRandom() % 7) {
+      case 0:   // Flip a bit
+        if (!input.empty()) input[at] ^= (uint8_t)(1u << (nextRandom() % 8));
+        break;
+      case 1:   // Random byte
+        if (!input.empty()) input[at] = (uint8_t)nextRandom();
+        break;
+      case 2:   // Dictionary byte
+        if (!input.empty()) input[at] = (uint8_t)dictionary[nextRandom() % (sizeof(dictionary) - 1)];
+        break;
+      case 3:   // Insert
+        input.insert(input.begin() + at, (uint8_t)dictionary[nextRandom() % (sizeof(dictionary) - 1)]);
+        break;
+      case 4:   // Erase a run
+        if (!input.empty()) {
+          size_t count = 1 + nextRandom() % 8;
+          if (count > input.size() - at) count = input.size() - at;
+          input.erase(input.begin() + at, input.begin() + at + count);
+        }
+        break;
+      case 5: { // Duplicate a run (long lines, repeated frames)
+        size_t count = 1 + nextRandom() % 32;
+        if (count > input.size() - at) count = input.size() - at;
+        Input run(input.begin() + at, input.begin() + at + count);
+        input.insert(input.begin() + at, run.begin(), run.end());
+        break;
+      }
+      case 6: { // Splice in the tail of another seed
+        const Input& other = seeds[nextRandom() % seeds.size()];
+        if (other.empty()) break;
+        size_t from = nextRandom() % other.size();
+        input.resize(at);
+        input.insert(input.end(), other.begin() + from, other.end());
+        break;
+      }
+    }
+  }
+  if (input.size() > 4096) input.resize(4096);
+  return input;
+}
+
+static void runTarget(const FuzzTargetInfo& target) {
+  std::vector<Input> seeds = loadSeeds(target.name);
+  TEST_ASSERT_TRUE_MESSAGE(!seeds.empty(), corpusDir(target.name).c_str());
+  rngState = (uint32_t)envNumber("OBD_FUZZ_SEED", 0x2545F491) | 1;
+  unsigned long runs = envNumber("OBD_FUZZ_RUNS", 3000);
+
+  // Seeds first, then mutations; empty input once
+  std::vector<Input> inputs = seeds;
+  inputs.push_back(Input());
+  for (unsigned long i = 0; i < runs; i++) inputs.push_back(mutate(seeds));
+
+  uint64_t bytes = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (const Input& input : inputs) {
+    currentInput = input.data();
+    currentSize = input.size();
+    target.run(input.data(), input.size());
+    bytes += input.size();
+  }
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  printf("fuzz_%s: %u inputs (%u seeds), %.0f inputs/s, %.2f MB/s, %.2f us/input\n", target.name,
+         (unsigned)inputs.size(), (unsigned)seeds.size(), inputs.size() / seconds,
+         bytes / seconds / 1e6, seconds * 1e6 / inputs.size());
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_fuzz_framing() { runTarget(targets[0]); }
+void test_fuzz_response() { runTarget(targets[1]); }
+void test_fuzz_dtc() { runTarget(targets[2]); }
+void test_fuzz_pid() { runTarget(targets[3]); }
+void test_fuzz_signal_db() { runTarget(targets[4]); }
+void test_fuzz_serializer() { runTarget(targets[5]); }
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_fuzz_framing);
+  RUN_TEST(test_fuzz_response);
+  RUN_TEST(test_fuzz_dtc);
+  RUN_TEST(test_fuzz_pid);
+  RUN_TEST(test_fuzz_signal_db);
+  RUN_TEST(test_fuzz_serializer);
+  int failures = UNITY_END();
+  if (client) {
+    client->disconnect();
+    delete client;
+    delete adapter;
+  }
+  return failures;
+}
+
+#endif // OBD_LIBFUZZER
@@ -0,0 +1,138 @@
+// Late replies after a timeout: data without the request's echo is dropped,
+// a status reply without an echo is held until the next reply (or its
+// absence) tells whether it was the late answer or the request's own
+
+#include <unity.h>
+#include "OBDTestHarness.h"
+
+static SimAdapter* adapter = nullptr;
+static BLEOBDClient* client = nullptr;
+
+void setUp() {
+  adapter = new SimAdapter();
+  client = new BLEOBDClient();
+}
+
+void tearDown() {
+  client->disconnect();
+  delete client;
+  delete adapter;
+}
+
+static void connectAndPoll() {
+  TEST_ASSERT_TRUE(connectClient(*client, *adapter));
+  runFor(*client, 2000);
+  adapter->clearWrites();
+}
+
+static uint32_t timeouts() {
+  return client->getLinkQuality().timeouts;
+}
+
+static OneShotResult lastResult;
+static int results = 0;
+
+static void onResult(const OneShotResult& result, void*) {
+  lastResult = result;
+  results++;
+}
+
+// ---- Lost replies ---------------------------------------------------------
+
+void test_lost_reply_then_no_data_costs_one_timeout() {
+  connectAndPoll();
+  unsigned long stale = client->getStatistics().staleReplies;
+
+  // The reply vanishes; the next request genuinely answers NO DATA
+  adapter->dropNext = 1;
+  adapter->scripted.push_back("NO DATA\r\r>");
+  runFor(*client, 3000);
+
+  TEST_ASSERT_EQUAL_UINT32(1, timeouts());
+  TEST_ASSERT_EQUAL_UINT32(1, client->getStatusCount(STATUS_NO_DATA));
+  TEST_ASSERT_EQUAL_UINT32(stale, client->getStatistics().staleReplies);
+  TEST_ASSERT_FLOAT_WITHIN(0.5f, 1726.0f, client->getCurrentData().rpm);
+}
+
+void test_lost_reply_then_one_shot_no_data() {
+  connectAndPoll();
+  results = 0;
+  adapter->dropNext = 1;
+  TEST_ASSERT_TRUE(runUntil(*client, [&]() { return timeouts() == 1; }, 3000));
+
+  // Unsupported PID: NO DATA while a late answer may still come
+  TEST_ASSERT_TRUE(client->submitRequest("01A6", onResult));
+  TEST_ASSERT_TRUE(runUntil(*client, [&]() { return results == 1; }, 3000));
+  TEST_ASSERT_EQUAL(ONESHOT_NO_DATA, lastResult.status);
+  TEST_ASSERT_TRUE(lastResult.latency < 1000);
+  TEST_ASSERT_EQUAL_UINT32(1, timeouts());
+}
+
+// ---- Late answers ---------------------------------------------------------
+
+void test_late_data_reply_dropped() {
+  connectAndPoll();
+  unsigned long stale = client->getStatistics().staleReplies;
+
+  adapter->delayNext = 2500;
+  runFor(*client, 4000);
+
+  TEST_ASSERT_EQUAL_UINT32(1, timeouts());
+  TEST_ASSERT_EQUAL_UINT32(stale + 1, client->getStatistics().staleReplies);
+  TEST_ASSERT_FLOAT_WITHIN(0.5f, 1726.0f, client->getCurrentData().rpm);
+}
+
+void test_late_no_data_held_then_dropped() {
+  connectAndPoll();
+  unsigned long stale = client->getStatistics().staleReplies;
+
+  // NO DATA answers the timed-out request, just before the next one's reply
+  adapter->delayNext = 2500;
+  adapter->scripted.push_back("NO DATA\r\r>");
+  runFor(*client, 4000);
+
+  TEST_ASSERT_EQUAL_UINT32(1, timeouts());
+  TEST_ASSERT_EQUAL_UINT32(0, client->getStatusCount(STATUS_NO_DATA));
+  TEST_ASSERT_EQUAL_UINT32(stale + 1, client->getStatistics().staleReplies);
+  TEST_ASSERT_FLOAT_WITHIN(0.5f, 1726.0f, client->getCurrentData().rpm);
+}
+
+void test_late_and_current_reply_in_one_chunk() {
+  connectAndPoll();
+  unsigned long stale = client->getStatistics().staleReplies;
+
+  adapter->dropNext = 1;
+  adapter->prefixNext = "NO DATA\r\r>";
+  runFor(*client, 3000);
+
+  TEST_ASSERT_EQUAL_UINT32(1, timeouts());
+  TEST_ASSERT_EQUAL_UINT32(0, client->getStatusCount(STATUS_NO_DATA));
+  TEST_ASSERT_EQUAL_UINT32(stale + 1, client->getStatistics().staleReplies);
+  TEST_ASSERT_FLOAT_WITHIN(0.5f, 1726.0f, client->getCurrentData().rpm);
+}
+
+void test_three_late_replies_in_a_row() {
+  connectAndPoll();
+  unsigned long stale = client->getStatistics().staleReplies;
+
+  // Each reply lands after its request timed out and the next was sent
+  adapter->latency = 2500;
+  TEST_ASSERT_TRUE(runUntil(*client, [&]() { return timeouts() == 3; }, 10000));
+  adapter->latency = 30;
+  runFor(*client, 5000);
+
+  TEST_ASSERT_EQUAL_UINT32(3, timeouts());
+  TEST_ASSERT_EQUAL_UINT32(stale + 3, client->getStatistics().staleReplies);
+  TEST_ASSERT_FLOAT_WITHIN(0.5f, 1726.0f, client->getCurrentData().rpm);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_lost_reply_then_no_data_costs_one_timeout);
+  RUN_TEST(test_lost_reply_then_one_shot_no_data);
+  RUN_TEST(test_late_data_reply_dropped);
+  RUN_TEST(test_late_no_data_held_then_dropped);
+  RUN_TEST(test_late_and_current_reply_in_one_chunk);
+  RUN_TEST(test_three_late_replies_in_a_row);
+  return UNITY_END();
+}
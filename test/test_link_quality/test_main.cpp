@@ -0,0 +1,211 @@
+// Link quality: scoring from RSSI, reply gaps and timeouts, level
+// hysteresis and poll spacing, the reconnect hold, and the client's
+// proactive reconnect straight back to the cached adapter
+
+#include <unity.h>
+#include "OBDLinkQuality.h"
+#include "OBDTestHarness.h"
+
+static SimAdapter* adapter = nullptr;
+static BLEOBDClient* client = nullptr;
+static LinkQualityMonitor* monitor = nullptr;
+
+void setUp() {
+  adapter = new SimAdapter();
+  client = new BLEOBDClient();
+  monitor = new LinkQualityMonitor();
+}
+
+void tearDown() {
+  client->disconnect();
+  delete monitor;
+  delete client;
+  delete adapter;
+}
+
+// One request answered after `gap` ms of silence
+static void reply(uint32_t& now, uint32_t gap) {
+  monitor->requestSent(now);
+  now += gap;
+  monitor->notified(now);
+  monitor->replyComplete();
+  now += 10;
+}
+
+// ---- Scoring --------------------------------------------------------------
+
+void test_starts_good() {
+  TEST_ASSERT_EQUAL_UINT8(100, monitor->getScore());
+  TEST_ASSERT_EQUAL(LINK_GOOD, monitor->getLevel());
+  TEST_ASSERT_EQUAL_UINT32(0, monitor->getPollSpacing());
+}
+
+void test_rssi_scored_between_good_and_poor() {
+  monitor->rssiSample(-75);
+  TEST_ASSERT_EQUAL_INT8(-75, monitor->getQuality().rssi);
+  TEST_ASSERT_EQUAL_UINT8(50, monitor->getQuality().rssiScore);
+  TEST_ASSERT_EQUAL_UINT8(85, monitor->getScore());   // 0.3 * 50 + 0.7 * 100
+
+  // 0 and positive values are not readings
+  monitor->rssiSample(0);
+  monitor->rssiSample(5);
+  TEST_ASSERT_EQUAL_INT8(-75, monitor->getQuality().rssi);
+
+  // Smoothed: a quarter of the way to each new sample
+  monitor->rssiSample(-95);
+  TEST_ASSERT_EQUAL_INT8(-80, monitor->getQuality().rssi);
+}
+
+void test_reply_gap_tracks_longest_silence() {
+  uint32_t now = 1000;
+  monitor->requestSent(now);
+  monitor->notified(now + 100);
+  monitor->notified(now + 950);    // 850 ms silence inside the reply
+  monitor->notified(now + 1000);
+  monitor->replyComplete();
+  TEST_ASSERT_EQUAL_UINT32(850, monitor->getQuality().replyGap);
+  TEST_ASSERT_EQUAL_UINT32(850, monitor->getQuality().maxReplyGap);
+  TEST_ASSERT_EQUAL_UINT8(50, monitor->getQuality().gapScore);
+
+  // Notifications outside a request are ignored
+  monitor->notified(now + 5000);
+  now += 6000;
+  reply(now, 50);
+  TEST_ASSERT_EQUAL_UINT32(650, monitor->getQuality().replyGap);   // 850 + (50 - 850) / 4
+  TEST_ASSERT_EQUAL_UINT32(850, monitor->getQuality().maxReplyGap);
+}
+
+void test_timeout_burst_caps_score() {
+  monitor->timedOut();
+  TEST_ASSERT_EQUAL_UINT8(1, monitor->getQuality().timeoutBurst);
+  TEST_ASSERT_TRUE(monitor->getScore() <= 70);
+  monitor->timedOut();
+  monitor->timedOut();
+  monitor->timedOut();
+  TEST_ASSERT_EQUAL_UINT8(0, monitor->getScore());
+  TEST_ASSERT_EQUAL(LINK_POOR, monitor->getLevel());
+  TEST_ASSERT_EQUAL_UINT32(500, monitor->getPollSpacing());
+
+  // A reply ends the burst; the smoothed timeout rate still weighs
+  uint32_t now = 0;
+  reply(now, 20);
+  TEST_ASSERT_EQUAL_UINT8(0, monitor->getQuality().timeoutBurst);
+  TEST_ASSERT_EQUAL_UINT8(4, monitor->getQuality().maxTimeoutBurst);
+  TEST_ASSERT_EQUAL_UINT32(4, monitor->getQuality().timeouts);
+  TEST_ASSERT_TRUE(monitor->getScore() > 0 && monitor->getScore() < 100);
+}
+
+void test_levels_leave_ten_points_above() {
+  monitor->setLevels(60, 30);
+  monitor->rssiSample(-90);              // rssiScore 0: score 70
+  uint32_t now = 0;
+  reply(now, 1500);                       // gapScore 0: score 40
+  TEST_ASSERT_EQUAL_UINT8(40, monitor->getScore());
+  TEST_ASSERT_EQUAL(LINK_DEGRADED, monitor->getLevel());
+  TEST_ASSERT_EQUAL_UINT32(150, monitor->getPollSpacing());
+
+  // Back above 60 but not 70: still degraded
+  for (int i = 0; i < 5; i++) reply(now, 200);
+  TEST_ASSERT_TRUE(monitor->getScore() >= 60 && monitor->getScore() < 70);
+  TEST_ASSERT_EQUAL(LINK_DEGRADED, monitor->getLevel());
+  for (int i = 0; i < 20; i++) {
+    monitor->rssiSample(-60);
+    reply(now, 200);
+  }
+  TEST_ASSERT_TRUE(monitor->getScore() >= 70);
+  TEST_ASSERT_EQUAL(LINK_GOOD, monitor->getLevel());
+}
+
+// ---- Reconnect ------------------------------------------------------------
+
+void test_reconnect_after_hold_once_per_episode() {
+  monitor->setReconnect(20, 5000);
+  for (int i = 0; i < 4; i++) monitor->timedOut();
+  TEST_ASSERT_FALSE(monitor->shouldReconnect(1000));
+  TEST_ASSERT_FALSE(monitor->shouldReconnect(5999));
+  TEST_ASSERT_TRUE(monitor->shouldReconnect(6000));
+  TEST_ASSERT_FALSE(monitor->shouldReconnect(20000));
+  TEST_ASSERT_EQUAL_UINT32(1, monitor->getQuality().reconnects);
+
+  // New connection: live picture cleared, totals kept
+  monitor->reset(20000);
+  TEST_ASSERT_EQUAL_UINT8(100, monitor->getScore());
+  TEST_ASSERT_EQUAL_UINT32(4, monitor->getQuality().timeouts);
+  TEST_ASSERT_EQUAL_UINT32(1, monitor->getQuality().reconnects);
+}
+
+void test_recovery_restarts_hold() {
+  monitor->setReconnect(20, 5000);
+  for (int i = 0; i < 4; i++) monitor->timedOut();
+  TEST_ASSERT_FALSE(monitor->shouldReconnect(0));
+  uint32_t now = 0;
+  reply(now, 20);                         // Burst over: score back above 20
+  TEST_ASSERT_FALSE(monitor->shouldReconnect(3000));
+  for (int i = 0; i < 4; i++) monitor->timedOut();
+  TEST_ASSERT_FALSE(monitor->shouldReconnect(4000));
+  TEST_ASSERT_FALSE(monitor->shouldReconnect(8999));
+  TEST_ASSERT_TRUE(monitor->shouldReconnect(9000));
+}
+
+void test_reconnect_disabled() {
+  monitor->setReconnect(20, 0);
+  for (int i = 0; i < 4; i++) monitor->timedOut();
+  TEST_ASSERT_FALSE(monitor->shouldReconnect(0));
+  TEST_ASSERT_FALSE(monitor->shouldReconnect(60000));
+}
+
+// ---- Client ---------------------------------------------------------------
+
+void test_client_samples_rssi() {
+  adapter->rssi = -75;
+  TEST_ASSERT_TRUE(connectClient(*client, *adapter));
+  runFor(*client, 3000);
+  LinkQuality link = client->getLinkQuality();
+  TEST_ASSERT_EQUAL_INT8(-75, link.rssi);
+  TEST_ASSERT_EQUAL_UINT8(50, link.rssiScore);
+  TEST_ASSERT_EQUAL_UINT32(0, link.timeouts);
+}
+
+void test_stalled_link_reconnects_without_scan() {
+  TEST_ASSERT_TRUE(connectClient(*client, *adapter));
+  runFor(*client, 2000);
+  uint32_t scans = BLEDevice::getScan()->getStarts();
+  uint32_t connects = adapter->connects;
+  unsigned long uptimeBefore = client->getStatistics().connectionUptime;
+  unsigned long connectedAt = millis() - client->getUptime();
+
+  // Adapter stops answering: timeouts drive the score to 0
+  adapter->replying = false;
+  TEST_ASSERT_TRUE(runUntil(*client, [&]() { return client->getLinkQuality().reconnects == 1; }, 20000));
+  unsigned long session = millis() - connectedAt;
+  TEST_ASSERT_TRUE(client->getStatistics().connectionUptime >= uptimeBefore + session - 10);
+  adapter->replying = true;
+
+  TEST_ASSERT_TRUE(runUntil(*client, [&]() { return client->getConnectionState() == CONNECTED; }, 5000));
+  TEST_ASSERT_EQUAL_UINT32(scans, BLEDevice::getScan()->getStarts());
+  TEST_ASSERT_EQUAL_UINT32(connects + 1, adapter->connects);
+  TEST_ASSERT_EQUAL_UINT32(1, client->getConnectionTiming().reconnects);
+  TEST_ASSERT_EQUAL_UINT32(0, client->getConnectionTiming().drops);   // Closed, not lost
+
+  // Polling resumes on the new link and the score recovers
+  runFor(*client, 3000);
+  TEST_ASSERT_FLOAT_WITHIN(0.5f, 1726.0f, client->getCurrentData().rpm);
+  TEST_ASSERT_EQUAL(CONNECTED, client->getConnectionState());
+  TEST_ASSERT_TRUE(client->getLinkQuality().score >= 60);
+  TEST_ASSERT_EQUAL_UINT32(scans, BLEDevice::getScan()->getStarts());
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_starts_good);
+  RUN_TEST(test_rssi_scored_between_good_and_poor);
+  RUN_TEST(test_reply_gap_tracks_longest_silence);
+  RUN_TEST(test_timeout_burst_caps_score);
+  RUN_TEST(test_levels_leave_ten_points_above);
+  RUN_TEST(test_reconnect_after_hold_once_per_episode);
+  RUN_TEST(test_recovery_restarts_hold);
+  RUN_TEST(test_reconnect_disabled);
+  RUN_TEST(test_client_samples_rssi);
+  RUN_TEST(test_stalled_link_reconnects_without_scan);
+  return UNITY_END();
+}
@@ -0,0 +1,134 @@
+// Zero-allocation polling: the --wrap=malloc counter sees no heap calls
+// from the library once the command table is built, with telemetry and
+// subscriptions running, and the memory report shows the same count
+
+#include <unity.h>
+#include "OBDTestHarness.h"
+
+static SimAdapter* adapter = nullptr;
+static BLEOBDClient* client = nullptr;
+
+void setUp() {
+  adapter = new SimAdapter();
+  client = new BLEOBDClient();
+}
+
+void tearDown() {
+  client->disconnect();
+  delete client;
+  delete adapter;
+}
+
+class CountingPrint : public Print {
+public:
+  size_t write(uint8_t) override { bytes++; return 1; }
+  size_t write(const uint8_t* buffer, size_t size) override { bytes += size; return size; }
+  size_t bytes = 0;
+};
+
+static int tripEvents = 0;
+
+static void onTrip(OBDSignal, float, void*) { tripEvents++; }
+
+// Connect and poll long enough for response-count learning to settle
+static void connectAndWarmUp() {
+  TEST_ASSERT_TRUE(connectClient(*client, *adapter));
+  runFor(*client, 5000);
+}
+
+// ---- Counter --------------------------------------------------------------
+
+void test_counter_sees_heap_calls() {
+  TEST_ASSERT_TRUE(obdAllocationCounting());
+  uint32_t before = obdAllocationCount();
+  void* p = malloc(16);
+  p = realloc(p, 64);
+  free(p);
+  TEST_ASSERT_EQUAL_UINT32(before + 2, obdAllocationCount());
+}
+
+// ---- Polling --------------------------------------------------------------
+
+void test_poll_cycles_allocate_nothing() {
+  connectAndWarmUp();
+  Statistics before = client->getStatistics();
+  uint32_t allocations = obdAllocationCount();
+
+  runFor(*client, 10000);
+
+  TEST_ASSERT_EQUAL_UINT32(allocations, obdAllocationCount());
+  TEST_ASSERT_TRUE(client->getStatistics().successfulCommands > before.successfulCommands + 100);
+  TEST_ASSERT_FLOAT_WITHIN(0.5f, 1726.0f, client->getCurrentData().rpm);
+}
+
+void test_consumers_allocate_nothing() {
+  CountingPrint out;
+  tripEvents = 0;
+  client->subscribe(SIGNAL_TRIP_DISTANCE, onTrip);   // Grows every speed update
+  connectAndWarmUp();
+  client->startTelemetry(out);
+  runFor(*client, 1000);
+  uint32_t allocations = obdAllocationCount();
+  size_t bytes = out.bytes;
+  int events = tripEvents;
+
+  runFor(*client, 10000);
+
+  TEST_ASSERT_EQUAL_UINT32(allocations, obdAllocationCount());
+  TEST_ASSERT_TRUE(out.bytes > bytes);
+  TEST_ASSERT_TRUE(tripEvents > events);
+  client->stopTelemetry();
+}
+
+void test_timeouts_allocate_nothing() {
+  connectAndWarmUp();
+  uint32_t allocations = obdAllocationCount();
+  unsigned long failed = client->getStatistics().failedCommands;
+
+  // Requests vanish: every cycle times out instead of decoding
+  adapter->replying = false;
+  runFor(*client, 5000);
+  adapter->replying = true;
+  runFor(*client, 5000);
+
+  TEST_ASSERT_EQUAL_UINT32(allocations, obdAllocationCount());
+  TEST_ASSERT_TRUE(client->getStatistics().failedCommands > failed);
+  TEST_ASSERT_FLOAT_WITHIN(0.5f, 1726.0f, client->getCurrentData().rpm);
+}
+
+void test_static_mode_from_connect() {
+  // Receive buffers reserved up front: nothing allocates after the command
+  // table is built, warm-up included
+  client->setStaticMemory(true);
+  TEST_ASSERT_TRUE(connectClient(*client, *adapter));
+  runFor(*client, 10000);
+  TEST_ASSERT_EQUAL_UINT32(0, client->getMemoryReport().allocationsSinceConnect);
+  TEST_ASSERT_FLOAT_WITHIN(0.5f, 1726.0f, client->getCurrentData().rpm);
+}
+
+// ---- Report ---------------------------------------------------------------
+
+void test_report_matches_counter() {
+  connectAndWarmUp();
+  MemoryReport mem = client->getMemoryReport();
+  runFor(*client, 5000);
+  MemoryReport after = client->getMemoryReport();
+  TEST_ASSERT_EQUAL_UINT32(mem.allocationsSinceConnect, after.allocationsSinceConnect);
+  TEST_ASSERT_TRUE(after.allocationsSinceBegin >= after.allocationsSinceConnect);
+
+  Serial.takeOutput();
+  client->printMemoryReport();
+  std::string out = Serial.takeOutput();
+  TEST_ASSERT_TRUE(out.find("since connect\r\n") != std::string::npos);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_counter_sees_heap_calls);
+  RUN_TEST(test_poll_cycles_allocate_nothing);
+  RUN_TEST(test_consumers_allocate_nothing);
+  RUN_TEST(test_timeouts_allocate_nothing);
+  RUN_TEST(test_static_mode_from_connect);
+  RUN_TEST(test_report_matches_counter);
+  return UNITY_END();
+}
@@ -0,0 +1,208 @@
+// Passive monitor: line parsing, the SPSC frame ring (including a two-thread
+// run), and decoded broadcast signals reaching the client's consumers
+
+#include <unity.h>
+#include <thread>
+#include "OBDMonitor.h"
+#include "OBDTestHarness.h"
+
+static SimAdapter* adapter = nullptr;
+static BLEOBDClient* client = nullptr;
+
+void setUp() {
+  adapter = new SimAdapter();
+  client = new BLEOBDClient();
+}
+
+void tearDown() {
+  client->disconnect();
+  delete client;
+  delete adapter;
+}
+
+static CANFrame frameWithId(uint32_t id) {
+  CANFrame frame = CANFrame();
+  frame.id = id;
+  frame.dlc = 8;
+  for (uint8_t i = 0; i < 8; i++) frame.data[i] = (uint8_t)(id * 7 + i);
+  return frame;
+}
+
+// ---- Parsing --------------------------------------------------------------
+
+void test_parse_lines() {
+  CANFrame frame;
+  TEST_ASSERT_TRUE(parseMonitorLine("1F01122334455", 13, frame));
+  TEST_ASSERT_EQUAL_HEX32(0x1F0, frame.id);
+  TEST_ASSERT_EQUAL_UINT8(5, frame.dlc);
+  TEST_ASSERT_EQUAL_HEX8(0x55, frame.data[4]);
+
+  TEST_ASSERT_TRUE(parseMonitorLine("18FEF10011223344", 16, frame));
+  TEST_ASSERT_EQUAL_HEX32(0x18FEF100, frame.id);
+  TEST_ASSERT_EQUAL_UINT8(4, frame.dlc);
+
+  TEST_ASSERT_FALSE(parseMonitorLine("BUFFERFULL", 10, frame));
+  TEST_ASSERT_FALSE(parseMonitorLine("1F0112233445566778899", 21, frame));   // More than 8 bytes
+  TEST_ASSERT_FALSE(parseMonitorLine("1F", 2, frame));
+}
+
+void test_line_parser_split_notifications() {
+  CANFrameRing ring;
+  MonitorLineParser parser;
+  const char* a = "1F0 11 22 3";
+  const char* b = "3\r3A0 01\rBUFFER FULL\r";
+  TEST_ASSERT_FALSE(parser.feed((const uint8_t*)a, strlen(a), 100, ring));
+  TEST_ASSERT_FALSE(parser.feed((const uint8_t*)b, strlen(b), 105, ring));
+  TEST_ASSERT_TRUE(parser.feed((const uint8_t*)">", 1, 110, ring));
+
+  TEST_ASSERT_EQUAL_UINT32(2, parser.framesParsed);
+  TEST_ASSERT_EQUAL_UINT32(1, parser.bufferFull);
+  CANFrame frame;
+  TEST_ASSERT_TRUE(ring.pop(frame));
+  TEST_ASSERT_EQUAL_HEX32(0x1F0, frame.id);
+  TEST_ASSERT_EQUAL_HEX8(0x33, frame.data[2]);
+  TEST_ASSERT_EQUAL_UINT32(105, frame.timestamp);
+  TEST_ASSERT_TRUE(ring.pop(frame));
+  TEST_ASSERT_EQUAL_HEX32(0x3A0, frame.id);
+  TEST_ASSERT_FALSE(ring.pop(frame));
+}
+
+// ---- Ring ---------------------------------------------------------------
+
+void test_ring_drops_when_full() {
+  static CANFrameRing ring;
+  ring.clear();
+  for (uint32_t i = 0; i < CAN_FRAME_RING_SIZE; i++) TEST_ASSERT_TRUE(ring.push(frameWithId(i)));
+  TEST_ASSERT_FALSE(ring.push(frameWithId(999)));
+  TEST_ASSERT_EQUAL_UINT32(1, ring.getDropped());
+  TEST_ASSERT_EQUAL_UINT32(CAN_FRAME_RING_SIZE, ring.size());
+  TEST_ASSERT_EQUAL_UINT32(CAN_FRAME_RING_SIZE, ring.getHighWater());
+
+  CANFrame frame;
+  TEST_ASSERT_TRUE(ring.pop(frame));
+  TEST_ASSERT_EQUAL_UINT32(0, frame.id);   // Oldest kept, newest dropped
+  TEST_ASSERT_TRUE(ring.push(frameWithId(1000)));
+}
+
+void test_ring_two_threads() {
+  static CANFrameRing ring;
+  ring.clear();
+  const uint32_t FRAMES = 200000;
+  uint32_t received = 0, corrupt = 0, outOfOrder = 0;
+
+  std::thread producer([&]() {
+    for (uint32_t id = 0; id < FRAMES;) {
+      if (ring.push(frameWithId(id))) id++;
+    }
+  });
+
+  uint32_t expected = 0;
+  while (received < FRAMES) {
+    CANFrame frame;
+    if (!ring.pop(frame)) continue;
+    if (frame.id != expected) outOfOrder++;
+    expected = frame.id + 1;
+    for (uint8_t i = 0; i < 8; i++) {
+      if (frame.data[i] != (uint8_t)(frame.id * 7 + i)) corrupt++;
+    }
+    received++;
+  }
+  producer.join();
+
+  TEST_ASSERT_EQUAL_UINT32(0, outOfOrder);
+  TEST_ASSERT_EQUAL_UINT32(0, corrupt);
+  TEST_ASSERT_EQUAL_UINT32(0, ring.size());
+}
+
+// ---- Client ---------------------------------------------------------------
+
+static int rpmEvents = 0;
+static float rpmSeen = 0;
+
+static void onRpm(OBDSignal, float value, void*) {
+  rpmEvents++;
+  rpmSeen = value;
+}
+
+class CountingPrint : public Print {
+public:
+  size_t write(uint8_t) override { bytes++; return 1; }
+  size_t write(const uint8_t*, size_t size) override { bytes += size; return size; }
+  size_t bytes = 0;
+};
+
+static void startMonitoring() {
+  TEST_ASSERT_TRUE(connectClient(*client, *adapter));
+  runFor(*client, 1000);
+  TEST_ASSERT_TRUE(client->startMonitor());
+  TEST_ASSERT_TRUE(runUntil(*client, [&]() { return adapter->monitoring(); }, 2000));
+}
+
+void test_frames_decoded_while_monitoring() {
+  float pedal = 0;
+  client->addMonitorFilter(0x1F0, 0x7FF);
+  client->getSignalDB()->addSignal(0x1F0, 16, 8, CAN_SIGNAL_LITTLE_ENDIAN, 0.4f, 0.0f, &pedal);
+  startMonitoring();
+
+  adapter->streamFrame(0x1F0, "0000FA0000000000");
+  runFor(*client, 200);
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 100.0f, pedal);
+  TEST_ASSERT_EQUAL_UINT32(1, client->getMonitorFrames());
+
+  client->stopMonitor();
+  TEST_ASSERT_TRUE(runUntil(*client, [&]() { return !client->isMonitoring(); }, 2000));
+  TEST_ASSERT_FALSE(adapter->monitoring());
+}
+
+void test_bound_signal_published() {
+  rpmEvents = 0;
+  CountingPrint telemetryOut;
+  int rpmIndex = client->getSignalDB()->addSignal(0x0C9, 24, 16, CAN_SIGNAL_LITTLE_ENDIAN, 0.25f, 0.0f);
+  TEST_ASSERT_TRUE(client->bindCANSignal((uint8_t)rpmIndex, SIGNAL_RPM));
+  client->subscribe(SIGNAL_RPM, onRpm);
+  startMonitoring();
+  client->startTelemetry(telemetryOut);
+  int before = rpmEvents;
+  size_t telemetryBefore = telemetryOut.bytes;
+
+  adapter->streamFrame(0x0C9, "000000803E000000");   // 0x3E80 * 0.25 = 4000
+  runFor(*client, 200);
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 4000.0f, client->getCurrentData().rpm);
+  TEST_ASSERT_TRUE(rpmEvents > before);
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 4000.0f, rpmSeen);
+  TEST_ASSERT_TRUE(telemetryOut.bytes > telemetryBefore);
+  TEST_ASSERT_TRUE(client->getSignalAge(SIGNAL_RPM) < 250);
+  TEST_ASSERT_TRUE(client->getCurrentData().engineRunning);   // Derived from the new RPM
+
+  client->stopTelemetry();
+}
+
+void test_unbound_signal_not_published() {
+  rpmEvents = 0;
+  client->getSignalDB()->addSignal(0x0C9, 24, 16, CAN_SIGNAL_LITTLE_ENDIAN, 0.25f, 0.0f);
+  client->subscribe(SIGNAL_SPEED, onRpm);
+  startMonitoring();
+  int before = rpmEvents;
+  adapter->streamFrame(0x0C9, "000000803E000000");
+  runFor(*client, 200);
+  TEST_ASSERT_EQUAL(before, rpmEvents);
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 4000.0f, client->getSignalDB()->getValue(0));
+}
+
+void test_bind_rejects_bad_arguments() {
+  TEST_ASSERT_FALSE(client->bindCANSignal(CAN_MAX_SIGNALS, SIGNAL_RPM));
+  TEST_ASSERT_FALSE(client->bindCANSignal(0, SIGNAL_COUNT));
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_parse_lines);
+  RUN_TEST(test_line_parser_split_notifications);
+  RUN_TEST(test_ring_drops_when_full);
+  RUN_TEST(test_ring_two_threads);
+  RUN_TEST(test_frames_decoded_while_monitoring);
+  RUN_TEST(test_bound_signal_published);
+  RUN_TEST(test_unbound_signal_not_published);
+  RUN_TEST(test_bind_rejects_bad_arguments);
+  return UNITY_END();
+}
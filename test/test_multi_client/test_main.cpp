@@ -0,0 +1,112 @@
+// Several clients in one process: one BLE init, each advertisement handed
+// to one instance, and independent connections and polling
+
+#include <unity.h>
+#include "OBDTestHarness.h"
+
+static SimAdapter* vehicle = nullptr;
+static SimAdapter* bench = nullptr;
+static BLEOBDClient* vehicleBus = nullptr;
+static BLEOBDClient* benchBus = nullptr;
+
+void setUp() {
+  vehicle = new SimAdapter("OBDLink CX", "aa:bb:cc:dd:ee:01");
+  bench = new SimAdapter("OBD2_Simulator_BLE", "aa:bb:cc:dd:ee:02");
+  bench->setResponse(0, "010C", "410C0FA0");   // 1000 rpm
+  vehicleBus = new BLEOBDClient();
+  benchBus = new BLEOBDClient();
+  vehicleBus->setDebugMode(false);
+  benchBus->setDebugMode(false);
+}
+
+void tearDown() {
+  vehicleBus->disconnect();
+  benchBus->disconnect();
+  delete vehicleBus;
+  delete benchBus;
+  delete vehicle;
+  delete bench;
+}
+
+static void runBoth(unsigned long ms) {
+  for (unsigned long elapsed = 0; elapsed < ms; elapsed += 5) {
+    mockAdvance(5);
+    vehicleBus->service();
+    benchBus->service();
+  }
+}
+
+template <typename Condition>
+static bool runBothUntil(Condition done, unsigned long timeoutMs) {
+  for (unsigned long elapsed = 0; elapsed < timeoutMs; elapsed += 5) {
+    if (done()) return true;
+    runBoth(5);
+  }
+  return done();
+}
+
+static bool bothConnected() {
+  return vehicleBus->getConnectionState() == CONNECTED && benchBus->getConnectionState() == CONNECTED;
+}
+
+static void connectBoth() {
+  vehicleBus->begin("OBDLink CX");
+  benchBus->begin("OBD2_Simulator_BLE");
+  bench->advertise();
+  vehicle->advertise();
+  TEST_ASSERT_TRUE(runBothUntil(bothConnected, 5000));
+}
+
+// ---- Tests ----------------------------------------------------------------
+
+void test_ble_initialized_once() {
+  // First test in the process: nothing may touch the scan before init()
+  vehicleBus->begin("OBDLink CX");
+  TEST_ASSERT_TRUE(BLEDevice::isInitialized());
+  benchBus->begin("OBD2_Simulator_BLE");
+  TEST_ASSERT_EQUAL_UINT32(0, BLEDevice::getScanBeforeInit());
+}
+
+void test_each_client_gets_its_adapter() {
+  connectBoth();
+  runBoth(3000);
+  TEST_ASSERT_EQUAL_UINT32(1, vehicle->connects);
+  TEST_ASSERT_EQUAL_UINT32(1, bench->connects);
+  TEST_ASSERT_FLOAT_WITHIN(0.5f, 1726.0f, vehicleBus->getCurrentData().rpm);
+  TEST_ASSERT_FLOAT_WITHIN(0.5f, 1000.0f, benchBus->getCurrentData().rpm);
+}
+
+void test_claimed_device_not_shared() {
+  // Both want the bench adapter; only one may have it
+  vehicleBus->begin("OBD2_Simulator_BLE");
+  benchBus->begin("OBD2_Simulator_BLE");
+  bench->advertise();
+  TEST_ASSERT_TRUE(runBothUntil([]() {
+    return vehicleBus->getConnectionState() == CONNECTED || benchBus->getConnectionState() == CONNECTED;
+  }, 5000));
+  bench->advertise();
+  runBoth(2000);
+  TEST_ASSERT_EQUAL_UINT32(1, bench->connects);
+  TEST_ASSERT_FALSE(bothConnected());
+}
+
+void test_lost_link_leaves_other_polling() {
+  connectBoth();
+  runBoth(2000);
+  benchBus->setAutoReconnect(false);
+  bench->dropLink();
+  uint32_t before = vehicleBus->getStatistics().successfulCommands;
+  runBoth(2000);
+  TEST_ASSERT_TRUE(benchBus->getConnectionState() != CONNECTED);
+  TEST_ASSERT_EQUAL(CONNECTED, vehicleBus->getConnectionState());
+  TEST_ASSERT_TRUE(vehicleBus->getStatistics().successfulCommands > before + 10);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_ble_initialized_once);
+  RUN_TEST(test_each_client_gets_its_adapter);
+  RUN_TEST(test_claimed_device_not_shared);
+  RUN_TEST(test_lost_link_leaves_other_polling);
+  return UNITY_END();
+}
@@ -0,0 +1,167 @@
+// Multi-ECU responses: header parsing for 11-bit, 29-bit and legacy buses,
+// the responder table and ECU targeting (ATSH/ATCRA) on both CAN widths
+
+#include <unity.h>
+#include "OBDResponse.h"
+#include "OBDTestHarness.h"
+
+static SimAdapter* adapter = nullptr;
+static BLEOBDClient* client = nullptr;
+
+void setUp() {
+  adapter = new SimAdapter();
+  client = new BLEOBDClient();
+}
+
+void tearDown() {
+  client->disconnect();
+  delete client;
+  delete adapter;
+}
+
+static OBDResponse parse(const char* text) {
+  OBDResponse response;
+  parseOBDResponse(text, strlen(text), response);
+  return response;
+}
+
+// ---- Parser -------------------------------------------------------------
+
+void test_parse_11bit_two_ecus() {
+  OBDResponse r = parse("7E8 06 41 00 BE 1F A8 13\r7E9 06 41 00 98 18 00 11\r");
+  TEST_ASSERT_EQUAL_UINT8(2, r.messageCount);
+  const OBDMessage* engine = r.fromECU(0x7E8);
+  const OBDMessage* gearbox = r.fromECU(0x7E9);
+  TEST_ASSERT_NOT_NULL(engine);
+  TEST_ASSERT_NOT_NULL(gearbox);
+  TEST_ASSERT_EQUAL_UINT8(6, engine->length);
+  TEST_ASSERT_EQUAL_HEX8(0x41, engine->data[0]);
+  TEST_ASSERT_EQUAL_HEX8(0xBE, engine->data[2]);
+  TEST_ASSERT_EQUAL_HEX8(0x98, gearbox->data[2]);
+  TEST_ASSERT_EQUAL_PTR(engine, r.primary(0x41, 0x00));
+}
+
+void test_parse_11bit_no_spaces() {
+  OBDResponse r = parse("7E803410D3C\r");
+  TEST_ASSERT_EQUAL_UINT8(1, r.messageCount);
+  TEST_ASSERT_EQUAL_HEX32(0x7E8, r.messages[0].ecuId);
+  TEST_ASSERT_EQUAL_UINT8(3, r.messages[0].length);
+  TEST_ASSERT_EQUAL_HEX8(0x3C, r.messages[0].data[2]);
+}
+
+void test_parse_29bit() {
+  OBDResponse r = parse("18 DA F1 10 04 41 0C 1A F8\r18 DA F1 18 03 41 0D 3C\r");
+  TEST_ASSERT_EQUAL_UINT8(2, r.messageCount);
+  const OBDMessage* engine = r.fromECU(0x18DAF110);
+  TEST_ASSERT_NOT_NULL(engine);
+  TEST_ASSERT_EQUAL_UINT8(4, engine->length);
+  TEST_ASSERT_EQUAL_HEX8(0xF8, engine->data[3]);
+  TEST_ASSERT_NOT_NULL(r.fromECU(0x18DAF118));
+  TEST_ASSERT_NULL(r.fromECU(0x7E8));
+}
+
+void test_parse_29bit_multi_frame() {
+  OBDResponse r = parse("18DAF1101014490201314847\r"
+                        "18DAF11021434D3832363333\r"
+                        "18DAF110224130303433353200\r");
+  TEST_ASSERT_EQUAL_UINT8(1, r.messageCount);
+  TEST_ASSERT_EQUAL_HEX32(0x18DAF110, r.messages[0].ecuId);
+  TEST_ASSERT_EQUAL_UINT8(20, r.messages[0].length);
+  TEST_ASSERT_EQUAL_HEX8(0x49, r.messages[0].data[0]);
+  TEST_ASSERT_EQUAL_HEX8('2', r.messages[0].data[19]);
+}
+
+void test_parse_legacy_header() {
+  // J1850/KWP: priority, target, source, payload, checksum
+  OBDResponse r = parse("48 6B 10 41 0C 1A F8 D4\r48 6B 18 41 0C 00 00 12\r");
+  TEST_ASSERT_EQUAL_UINT8(2, r.messageCount);
+  const OBDMessage* engine = r.fromECU(0x10);
+  TEST_ASSERT_NOT_NULL(engine);
+  TEST_ASSERT_EQUAL_UINT8(4, engine->length);
+  TEST_ASSERT_EQUAL_HEX8(0x0C, engine->data[1]);
+  TEST_ASSERT_EQUAL_HEX8(0xF8, engine->data[3]);
+  TEST_ASSERT_NOT_NULL(r.fromECU(0x18));
+}
+
+void test_parse_headerless() {
+  OBDResponse r = parse("41 0C 1A F8\r");
+  TEST_ASSERT_EQUAL_UINT8(1, r.messageCount);
+  TEST_ASSERT_EQUAL_HEX32(0, r.messages[0].ecuId);
+  TEST_ASSERT_EQUAL_UINT8(4, r.messages[0].length);
+}
+
+void test_parse_rejects_text_only() {
+  OBDResponse response;
+  TEST_ASSERT_FALSE(parseOBDResponse("SEARCHING...\r", 13, response));
+  TEST_ASSERT_FALSE(parseOBDResponse("", 0, response));
+}
+
+// ---- Client ---------------------------------------------------------------
+
+static void addGearbox() {
+  SimECU& gearbox = adapter->addECU(0x7E9, 0x18DAF118, 0x18);
+  gearbox.responses["0100"] = "410098180011";
+  gearbox.responses["010D"] = "410D3B";       // Answers the speed poll too
+}
+
+void test_learns_responders_11bit() {
+  addGearbox();
+  TEST_ASSERT_TRUE(connectClient(*client, *adapter));
+  runFor(*client, 2000);
+  TEST_ASSERT_EQUAL_UINT8(2, client->getECUCount());
+  TEST_ASSERT_EQUAL_HEX32(0x7E8, client->getECUInfo(0).id);
+  TEST_ASSERT_EQUAL_HEX32(0x7E9, client->getECUInfo(1).id);
+  TEST_ASSERT_FLOAT_WITHIN(0.1f, 60.0f, client->getCurrentData().speed);   // Lowest id wins
+}
+
+void test_target_and_clear_11bit() {
+  addGearbox();
+  TEST_ASSERT_TRUE(connectClient(*client, *adapter));
+  runFor(*client, 2000);
+
+  client->setTargetECU(0x7E0, 0x7E8);
+  runFor(*client, 1000);
+  TEST_ASSERT_EQUAL_HEX32(0x7E0, adapter->lastHeader());
+  TEST_ASSERT_EQUAL(1, (int)adapter->countWrites("ATCRA7E8"));
+
+  client->clearTargetECU();
+  runFor(*client, 1000);
+  TEST_ASSERT_EQUAL_HEX32(0x7DF, adapter->lastHeader());
+  TEST_ASSERT_FLOAT_WITHIN(0.5f, 1726.0f, client->getCurrentData().rpm);
+}
+
+void test_target_and_clear_29bit() {
+  adapter->setProtocol(SIM_CAN_29BIT);
+  addGearbox();
+  TEST_ASSERT_TRUE(connectClient(*client, *adapter));
+  runFor(*client, 2000);
+  TEST_ASSERT_EQUAL_HEX32(0x18DAF110, client->getECUInfo(0).id);
+
+  client->setTargetECU(0x18DA10F1, 0x18DAF110);
+  runFor(*client, 1000);
+  TEST_ASSERT_EQUAL_HEX32(0x18DA10F1, adapter->lastHeader());
+
+  // Back to the 29-bit functional header, not ATSH7DF
+  adapter->clearWrites();
+  client->clearTargetECU();
+  runFor(*client, 1000);
+  TEST_ASSERT_EQUAL(0, (int)adapter->countWrites("ATSH7DF"));
+  TEST_ASSERT_EQUAL_HEX32(0x18DB33F1, adapter->lastHeader());
+  float rpm = client->getCurrentData().rpm;
+  TEST_ASSERT_FLOAT_WITHIN(0.5f, 1726.0f, rpm);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_parse_11bit_two_ecus);
+  RUN_TEST(test_parse_11bit_no_spaces);
+  RUN_TEST(test_parse_29bit);
+  RUN_TEST(test_parse_29bit_multi_frame);
+  RUN_TEST(test_parse_legacy_header);
+  RUN_TEST(test_parse_headerless);
+  RUN_TEST(test_parse_rejects_text_only);
+  RUN_TEST(test_learns_responders_11bit);
+  RUN_TEST(test_target_and_clear_11bit);
+  RUN_TEST(test_target_and_clear_29bit);
+  return UNITY_END();
+}
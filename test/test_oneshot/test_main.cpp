@@ -0,0 +1,278 @@
+// One-shot requests: callbacks and their status, scheduling with and
+// without periodic polls, the oneShotMaxDelay timeout cap, freeze frames
+// and Mode 09 text (VIN, calibration IDs) in CAN and legacy framing
+
+#include <unity.h>
+#include "OBDTestHarness.h"
+#include "BLEOBDClientProbe.h"
+
+static SimAdapter* adapter = nullptr;
+static BLEOBDClient* client = nullptr;
+static OneShotResult lastResult;
+static char lastText[64];
+static char lastCommand[24];
+static int results = 0;
+
+static void onResult(const OneShotResult& result, void* context) {
+  lastResult = result;
+  strncpy(lastText, result.text, sizeof(lastText) - 1);
+  strncpy(lastCommand, result.command, sizeof(lastCommand) - 1);
+  lastResult.text = lastText;
+  lastResult.command = lastCommand;
+  lastResult.response = nullptr;   // Valid during the callback only
+  lastResult.message = nullptr;
+  results++;
+  if (context) (*static_cast<int*>(context))++;
+}
+
+static char vehicleText[64];
+static float freezeRPM = 0.0f;
+
+static void onVehicleInfo(const OneShotResult& result, void* context) {
+  vehicleText[0] = '\0';
+  if (result.status == ONESHOT_OK) {
+    BLEOBDClient::decodeVehicleInfoText(result.message, vehicleText, sizeof(vehicleText));
+  }
+  onResult(result, context);
+}
+
+static void onFreezeFrame(const OneShotResult& result, void* context) {
+  // 42 <pid> <frame> <A> <B>
+  const OBDMessage* msg = result.message;
+  if (result.status == ONESHOT_OK && msg->length >= 5) {
+    freezeRPM = ((msg->data[3] << 8) | msg->data[4]) / 4.0f;
+  }
+  onResult(result, context);
+}
+
+void setUp() {
+  adapter = new SimAdapter();
+  client = new BLEOBDClient();
+  results = 0;
+  vehicleText[0] = '\0';
+  freezeRPM = 0.0f;
+  memset(lastText, 0, sizeof(lastText));
+  memset(lastCommand, 0, sizeof(lastCommand));
+}
+
+void tearDown() {
+  client->disconnect();
+  delete client;
+  delete adapter;
+}
+
+static void connectAndPoll() {
+  TEST_ASSERT_TRUE(connectClient(*client, *adapter));
+  runFor(*client, 2000);
+  adapter->clearWrites();
+}
+
+// No periodic command comes due again; returns once the last poll is answered
+static void holdPolls(BLEOBDClientProbe& probe) {
+  for (uint8_t i = 0; i < probe.commandCount(); i++) {
+    probe.command(i).interval = 600000;
+    probe.command(i).lastPolled = millis();
+  }
+  TEST_ASSERT_TRUE(runUntil(*client, [&]() { return !probe.isWaiting(); }, 1000));
+  adapter->clearWrites();
+}
+
+static size_t vehicleInfo(const char* text, char* out, size_t outSize) {
+  OBDResponse response;
+  parseOBDResponse(text, strlen(text), response);
+  return BLEOBDClient::decodeVehicleInfoText(response.primary(0x49), out, outSize);
+}
+
+// ---- Callbacks ------------------------------------------------------------
+
+void test_callback_gets_reply_and_context() {
+  connectAndPoll();
+  int calls = 0;
+  TEST_ASSERT_TRUE(client->submitRequest("0105", onResult, &calls));
+  TEST_ASSERT_EQUAL_UINT8(1, client->getPendingOneShots());
+  TEST_ASSERT_TRUE(runUntil(*client, [&]() { return results == 1; }, 1000));
+
+  TEST_ASSERT_EQUAL(1, calls);
+  TEST_ASSERT_EQUAL(ONESHOT_OK, lastResult.status);
+  TEST_ASSERT_EQUAL_STRING("0105", lastResult.command);
+  TEST_ASSERT_EQUAL_STRING("7E80341055A", lastResult.text);
+  TEST_ASSERT_EQUAL(STATUS_DATA, lastResult.adapterStatus);
+  TEST_ASSERT_TRUE(lastResult.latency < 500);
+  TEST_ASSERT_EQUAL_UINT8(0, client->getPendingOneShots());
+}
+
+void test_no_data_negative_and_adapter_commands() {
+  connectAndPoll();
+  adapter->setResponse(0, "0906", "7F0912");
+  TEST_ASSERT_TRUE(client->submitRequest("01A6", onResult));
+  TEST_ASSERT_TRUE(runUntil(*client, [&]() { return results == 1; }, 1000));
+  TEST_ASSERT_EQUAL(ONESHOT_NO_DATA, lastResult.status);
+  TEST_ASSERT_EQUAL(STATUS_NO_DATA, lastResult.adapterStatus);
+
+  TEST_ASSERT_TRUE(client->submitRequest("0906", onResult));
+  TEST_ASSERT_TRUE(runUntil(*client, [&]() { return results == 2; }, 1000));
+  TEST_ASSERT_EQUAL(ONESHOT_NEGATIVE, lastResult.status);
+
+  TEST_ASSERT_TRUE(client->submitRequest("ATRV", onResult));
+  TEST_ASSERT_TRUE(runUntil(*client, [&]() { return results == 3; }, 1000));
+  TEST_ASSERT_EQUAL(ONESHOT_OK, lastResult.status);
+  TEST_ASSERT_EQUAL_STRING("12.6V", lastResult.text);
+}
+
+void test_queue_limits() {
+  connectAndPoll();
+  TEST_ASSERT_FALSE(client->submitRequest("0123456789ABCDEF0123456789", onResult));
+  int pending = client->getPendingOneShots();
+  int queued = 0;
+  while (client->submitRequest("0105", onResult)) queued++;
+  TEST_ASSERT_EQUAL(OBD_MAX_ONESHOTS - pending, queued);
+  TEST_ASSERT_EQUAL_UINT8(OBD_MAX_ONESHOTS, client->getPendingOneShots());
+  TEST_ASSERT_TRUE(runUntil(*client, [&]() { return results == queued; }, 10000));
+}
+
+// ---- Scheduling -----------------------------------------------------------
+
+void test_interleaved_with_due_polls() {
+  connectAndPoll();
+  for (int i = 0; i < 3; i++) TEST_ASSERT_TRUE(client->submitRequest("0105", onResult));
+  TEST_ASSERT_TRUE(runUntil(*client, [&]() { return results == 3; }, 3000));
+
+  // Polls are always due: a periodic request between every two one-shots
+  size_t firstOneShot = 0, lastOneShot = 0;
+  for (size_t i = 0; i < adapter->writes.size(); i++) {
+    if (adapter->writes[i] != "0105") continue;
+    if (!firstOneShot) firstOneShot = i + 1;
+    if (lastOneShot) TEST_ASSERT_TRUE(i + 1 > lastOneShot + 1);
+    lastOneShot = i + 1;
+  }
+  TEST_ASSERT_TRUE(firstOneShot > 0);
+}
+
+void test_back_to_back_when_no_poll_due() {
+  connectAndPoll();
+  BLEOBDClientProbe probe(*client);
+  holdPolls(probe);
+
+  for (int i = 0; i < 4; i++) TEST_ASSERT_TRUE(client->submitRequest("0105", onResult));
+  TEST_ASSERT_TRUE(runUntil(*client, [&]() { return results == 4; }, 1000));
+  TEST_ASSERT_EQUAL(4, (int)adapter->countWrites("0105"));
+  TEST_ASSERT_EQUAL(4, (int)adapter->writes.size());
+}
+
+void test_sent_without_periodic_commands() {
+  connectAndPoll();
+  BLEOBDClientProbe probe(*client);
+  holdPolls(probe);
+  probe.clearCommands();
+
+  TEST_ASSERT_TRUE(client->requestVIN(onVehicleInfo));
+  TEST_ASSERT_TRUE(client->submitRequest("0105", onResult));
+  TEST_ASSERT_TRUE(runUntil(*client, [&]() { return results == 2; }, 1000));
+  TEST_ASSERT_EQUAL_STRING("1HGCM82633A004352", vehicleText);
+  TEST_ASSERT_EQUAL(ONESHOT_OK, lastResult.status);
+}
+
+void test_timeout_capped_by_max_delay() {
+  connectAndPoll();
+  client->setOneShotMaxDelay(300);
+  adapter->replying = false;
+  unsigned long start = millis();
+  TEST_ASSERT_TRUE(client->submitRequest("0105", onResult, nullptr, 5000));
+  TEST_ASSERT_TRUE(runUntil(*client, [&]() { return results == 1; }, 5000));
+  adapter->replying = true;
+
+  TEST_ASSERT_EQUAL(ONESHOT_TIMEOUT, lastResult.status);
+  TEST_ASSERT_EQUAL_STRING("TIMEOUT", lastResult.text);
+  TEST_ASSERT_TRUE(millis() - start < 3000);     // A periodic timeout (2 s) may come first
+  TEST_ASSERT_TRUE(lastResult.latency >= 300);
+
+  // Polling carries on afterwards
+  runFor(*client, 2000);
+  TEST_ASSERT_FLOAT_WITHIN(0.5f, 1726.0f, client->getCurrentData().rpm);
+}
+
+// ---- Freeze frames --------------------------------------------------------
+
+void test_freeze_frame() {
+  adapter->setResponse(0, "020C00", "420C0012C0");   // 1200 rpm when the DTC set
+  connectAndPoll();
+  TEST_ASSERT_TRUE(client->requestFreezeFrame(0x0C, onFreezeFrame));
+  TEST_ASSERT_TRUE(runUntil(*client, [&]() { return results == 1; }, 1000));
+  TEST_ASSERT_EQUAL(ONESHOT_OK, lastResult.status);
+  TEST_ASSERT_EQUAL_STRING("020C00", lastResult.command);
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 1200.0f, freezeRPM);
+
+  // Another frame the ECU does not store
+  TEST_ASSERT_TRUE(client->requestFreezeFrame(0x0C, onFreezeFrame, nullptr, 1));
+  TEST_ASSERT_TRUE(runUntil(*client, [&]() { return results == 2; }, 1000));
+  TEST_ASSERT_EQUAL_STRING("020C01", lastResult.command);
+  TEST_ASSERT_EQUAL(ONESHOT_NO_DATA, lastResult.status);
+}
+
+// ---- Vehicle information --------------------------------------------------
+
+void test_vin_over_can() {
+  connectAndPoll();
+  TEST_ASSERT_TRUE(client->requestVIN(onVehicleInfo));
+  TEST_ASSERT_TRUE(runUntil(*client, [&]() { return results == 1; }, 1000));
+  TEST_ASSERT_EQUAL(ONESHOT_OK, lastResult.status);
+  TEST_ASSERT_EQUAL_STRING("1HGCM82633A004352", vehicleText);
+}
+
+void test_calibration_ids_over_can() {
+  // 35 bytes with 'I' (0x49) at byte 8: not legacy lines despite the layout
+  const char* text =
+    "7E8 10 23 49 04 02 41 42 43\r7E8 21 44 49 46 47 48 30 31\r"
+    "7E8 22 32 33 34 35 36 37 43\r7E8 23 41 4C 32 30 30 30 30\r"
+    "7E8 24 30 30 30 30 30 30 30\r7E8 25 30\r";
+  char out[64];
+  TEST_ASSERT_EQUAL_UINT32(32, vehicleInfo(text, out, sizeof(out)));
+  TEST_ASSERT_EQUAL_STRING("ABCDIFGH01234567CAL2000000000000", out);
+
+  // Same with headers off
+  text = "023\r0: 49 04 02 41 42 43\r1: 44 49 46 47 48 30 31\r2: 32 33 34 35 36 37 43\r"
+         "3: 41 4C 32 30 30 30 30\r4: 30 30 30 30 30 30 30\r5: 30\r";
+  TEST_ASSERT_EQUAL_UINT32(32, vehicleInfo(text, out, sizeof(out)));
+  TEST_ASSERT_EQUAL_STRING("ABCDIFGH01234567CAL2000000000000", out);
+}
+
+void test_vin_legacy_lines() {
+  char out[32];
+  const char* text =
+    "48 6B 10 49 02 01 00 00 00 31 40\r48 6B 10 49 02 02 48 47 43 4D 2F\r"
+    "48 6B 10 49 02 03 38 32 36 33 E4\r48 6B 10 49 02 04 33 41 30 30 E6\r"
+    "48 6B 10 49 02 05 34 33 35 32 E1\r";
+  TEST_ASSERT_EQUAL_UINT32(17, vehicleInfo(text, out, sizeof(out)));
+  TEST_ASSERT_EQUAL_STRING("1HGCM82633A004352", out);
+
+  // Headers off: the sequence numbers tell the lines apart
+  text = "49 02 01 00 00 00 31\r49 02 02 48 47 43 4D\r49 02 03 38 32 36 33\r"
+         "49 02 04 33 41 30 30\r49 02 05 34 33 35 32\r";
+  TEST_ASSERT_EQUAL_UINT32(17, vehicleInfo(text, out, sizeof(out)));
+  TEST_ASSERT_EQUAL_STRING("1HGCM82633A004352", out);
+}
+
+void test_vehicle_text_bounded() {
+  char out[8];
+  TEST_ASSERT_EQUAL_UINT32(0, BLEOBDClient::decodeVehicleInfoText(nullptr, out, sizeof(out)));
+  const char* text = "49 02 01 00 00 00 31\r49 02 02 48 47 43 4D\r49 02 03 38 32 36 33\r";
+  TEST_ASSERT_EQUAL_UINT32(7, vehicleInfo(text, out, sizeof(out)));
+  TEST_ASSERT_EQUAL_STRING("1HGCM82", out);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_callback_gets_reply_and_context);
+  RUN_TEST(test_no_data_negative_and_adapter_commands);
+  RUN_TEST(test_queue_limits);
+  RUN_TEST(test_interleaved_with_due_polls);
+  RUN_TEST(test_back_to_back_when_no_poll_due);
+  RUN_TEST(test_sent_without_periodic_commands);
+  RUN_TEST(test_timeout_capped_by_max_delay);
+  RUN_TEST(test_freeze_frame);
+  RUN_TEST(test_vin_over_can);
+  RUN_TEST(test_calibration_ids_over_can);
+  RUN_TEST(test_vin_legacy_lines);
+  RUN_TEST(test_vehicle_text_bounded);
+  return UNITY_END();
+}
@@ -0,0 +1,234 @@
+// PID descriptors: bit-field extraction, signed values, bounds checks,
+// the XPID config blob and Mode 22 polling through the client
+
+#include <unity.h>
+#include <vector>
+#include "OBDPidDecoder.h"
+#include "OBDTestHarness.h"
+
+static SimAdapter* adapter = nullptr;
+static BLEOBDClient* client = nullptr;
+
+void setUp() {
+  adapter = new SimAdapter();
+  client = new BLEOBDClient();
+}
+
+void tearDown() {
+  client->disconnect();
+  delete client;
+  delete adapter;
+}
+
+static OBDMessage message(std::initializer_list<uint8_t> bytes) {
+  OBDMessage msg = OBDMessage();
+  for (uint8_t b : bytes) msg.data[msg.length++] = b;
+  return msg;
+}
+
+static void putLE(std::vector<uint8_t>& out, uint32_t value, int bytes) {
+  for (int i = 0; i < bytes; i++) out.push_back((uint8_t)(value >> (8 * i)));
+}
+
+static void putFloat(std::vector<uint8_t>& out, float value) {
+  uint32_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  putLE(out, bits, 4);
+}
+
+// One 23-byte XPID record
+static void putRecord(std::vector<uint8_t>& out, const PIDDescriptor& d) {
+  out.push_back(d.mode);
+  putLE(out, d.pid, 2);
+  putLE(out, d.header, 4);
+  putLE(out, d.ecuId, 4);
+  out.push_back(d.byteOffset);
+  out.push_back(d.bitOffset);
+  out.push_back(d.bitLength);
+  out.push_back(d.flags);
+  putFloat(out, d.scale);
+  putFloat(out, d.offset);
+}
+
+static std::vector<uint8_t> blob(std::initializer_list<PIDDescriptor> records) {
+  std::vector<uint8_t> out = {'X', 'P', 'I', 'D', 1, (uint8_t)records.size()};
+  for (const PIDDescriptor& d : records) putRecord(out, d);
+  return out;
+}
+
+// ---- Decoding -----------------------------------------------------------
+
+void test_standard_pids() {
+  float value = 0;
+  OBDMessage rpm = message({0x41, 0x0C, 0x1A, 0xF8});
+  TEST_ASSERT_TRUE(decodePIDValue(standardPID(0x0C, 2, 0.25f), rpm, &value));
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 1726.0f, value);
+
+  OBDMessage coolant = message({0x41, 0x05, 0x5A});
+  TEST_ASSERT_TRUE(decodePIDValue(standardPID(0x05, 1, 1.0f, -40.0f), coolant, &value));
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 50.0f, value);
+}
+
+void test_echo_mismatch() {
+  float value = 0;
+  OBDMessage speed = message({0x41, 0x0D, 0x3C});
+  TEST_ASSERT_FALSE(decodePIDValue(standardPID(0x0C, 1, 1.0f), speed, &value));
+  OBDMessage negative = message({0x7F, 0x01, 0x12});
+  TEST_ASSERT_FALSE(decodePIDValue(standardPID(0x01, 1, 1.0f), negative, &value));
+}
+
+void test_short_message() {
+  float value = 0;
+  OBDMessage rpm = message({0x41, 0x0C, 0x1A});
+  TEST_ASSERT_FALSE(decodePIDValue(standardPID(0x0C, 2, 0.25f), rpm, &value));
+}
+
+void test_bit_field() {
+  // 4 bits starting 2 bits into the second data byte: 0b1011_0110 -> 1101
+  PIDDescriptor d = extendedPID(0xF40D, 0, 0, 1, 4, 1.0f);
+  d.bitOffset = 2;
+  OBDMessage msg = message({0x62, 0xF4, 0x0D, 0x00, 0xB6});
+  float value = 0;
+  TEST_ASSERT_TRUE(decodePIDValue(d, msg, &value));
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 13.0f, value);
+}
+
+void test_field_across_bytes() {
+  PIDDescriptor d = extendedPID(0x1234, 0, 0, 0, 12, 1.0f);
+  d.bitOffset = 4;
+  OBDMessage msg = message({0x62, 0x12, 0x34, 0xAB, 0xCD});
+  float value = 0;
+  TEST_ASSERT_TRUE(decodePIDValue(d, msg, &value));
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, (float)0xBCD, value);
+}
+
+void test_signed_and_32bit() {
+  float value = 0;
+  PIDDescriptor temp = extendedPID(0x2001, 0, 0, 0, 16, 0.1f, 0.0f, PID_FLAG_SIGNED);
+  OBDMessage cold = message({0x62, 0x20, 0x01, 0xFF, 0x38});   // -200
+  TEST_ASSERT_TRUE(decodePIDValue(temp, cold, &value));
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, -20.0f, value);
+
+  PIDDescriptor odometer = extendedPID(0x2002, 0, 0, 0, 32, 1.0f);
+  OBDMessage km = message({0x62, 0x20, 0x02, 0x00, 0x01, 0xE2, 0x40});
+  TEST_ASSERT_TRUE(decodePIDValue(odometer, km, &value));
+  TEST_ASSERT_FLOAT_WITHIN(0.5f, 123456.0f, value);
+}
+
+void test_offsets_past_frame_rejected() {
+  OBDMessage msg = message({0x62, 0xF4, 0x0D, 0x11, 0x22, 0x33});
+  float value = 0;
+
+  // 1 + 2 + 254 used to wrap to 1 in a uint8_t and read the echo back
+  PIDDescriptor farByte = extendedPID(0xF40D, 0, 0, 254, 8, 1.0f);
+  TEST_ASSERT_FALSE(pidDescriptorValid(farByte));
+  TEST_ASSERT_FALSE(decodePIDValue(farByte, msg, &value));
+
+  // 250 + 8 used to wrap to 2 bits
+  PIDDescriptor farBit = extendedPID(0xF40D, 0, 0, 0, 8, 1.0f);
+  farBit.bitOffset = 250;
+  TEST_ASSERT_FALSE(pidDescriptorValid(farBit));
+  TEST_ASSERT_FALSE(decodePIDValue(farBit, msg, &value));
+
+  PIDDescriptor zeroLength = extendedPID(0xF40D, 0, 0, 0, 0, 1.0f);
+  TEST_ASSERT_FALSE(pidDescriptorValid(zeroLength));
+  PIDDescriptor tooLong = extendedPID(0xF40D, 0, 0, 0, 33, 1.0f);
+  TEST_ASSERT_FALSE(pidDescriptorValid(tooLong));
+
+  // Last byte of the largest payload is still reachable
+  PIDDescriptor lastByte = extendedPID(0xF40D, 0, 0, OBD_MAX_PAYLOAD - 4, 8, 1.0f);
+  TEST_ASSERT_TRUE(pidDescriptorValid(lastByte));
+  TEST_ASSERT_FALSE(pidDescriptorValid(extendedPID(0xF40D, 0, 0, OBD_MAX_PAYLOAD - 3, 8, 1.0f)));
+}
+
+void test_request_text() {
+  char text[8];
+  formatPIDRequest(standardPID(0x0C, 2, 0.25f), text);
+  TEST_ASSERT_EQUAL_STRING("010C", text);
+  formatPIDRequest(extendedPID(0xF40D, 0x7E0, 0x7E8, 0, 8, 1.0f), text);
+  TEST_ASSERT_EQUAL_STRING("22F40D", text);
+}
+
+// ---- Blob ---------------------------------------------------------------
+
+void test_blob_round_trip() {
+  std::vector<uint8_t> data = blob({extendedPID(0xF40D, 0x7E0, 0x7E8, 1, 8, 0.5f, -10.0f),
+                                    extendedPID(0x2001, 0x18DA10F1, 0x18DAF110, 0, 16, 0.1f, 0.0f,
+                                                PID_FLAG_SIGNED)});
+  PIDDescriptor out[4];
+  TEST_ASSERT_EQUAL(2, parsePIDBlob(data.data(), data.size(), out, 4));
+  TEST_ASSERT_EQUAL_HEX16(0xF40D, out[0].pid);
+  TEST_ASSERT_EQUAL_HEX32(0x7E0, out[0].header);
+  TEST_ASSERT_EQUAL_UINT8(1, out[0].byteOffset);
+  TEST_ASSERT_FLOAT_WITHIN(0.001f, -10.0f, out[0].offset);
+  TEST_ASSERT_EQUAL_HEX32(0x18DAF110, out[1].ecuId);
+  TEST_ASSERT_EQUAL_HEX8(PID_FLAG_SIGNED, out[1].flags);
+
+  TEST_ASSERT_EQUAL(1, parsePIDBlob(data.data(), data.size(), out, 1));
+}
+
+void test_blob_malformed() {
+  PIDDescriptor out[4];
+  std::vector<uint8_t> data = blob({extendedPID(0xF40D, 0x7E0, 0x7E8, 1, 8, 1.0f)});
+
+  std::vector<uint8_t> truncated(data.begin(), data.end() - 1);
+  TEST_ASSERT_EQUAL(-1, parsePIDBlob(truncated.data(), truncated.size(), out, 4));
+
+  std::vector<uint8_t> magic = data;
+  magic[0] = 'Y';
+  TEST_ASSERT_EQUAL(-1, parsePIDBlob(magic.data(), magic.size(), out, 4));
+
+  std::vector<uint8_t> version = data;
+  version[4] = 2;
+  TEST_ASSERT_EQUAL(-1, parsePIDBlob(version.data(), version.size(), out, 4));
+
+  TEST_ASSERT_EQUAL(-1, parsePIDBlob(data.data(), 5, out, 4));
+}
+
+void test_blob_rejects_out_of_frame_record() {
+  PIDDescriptor farBit = extendedPID(0x2001, 0x7E0, 0x7E8, 0, 8, 1.0f);
+  farBit.bitOffset = 9;
+  std::vector<uint8_t> data = blob({extendedPID(0xF40D, 0x7E0, 0x7E8, 0, 8, 1.0f), farBit});
+  PIDDescriptor out[4];
+  TEST_ASSERT_EQUAL(-1, parsePIDBlob(data.data(), data.size(), out, 4));
+
+  std::vector<uint8_t> farByte = blob({extendedPID(0xF40D, 0x7E0, 0x7E8, 200, 8, 1.0f)});
+  TEST_ASSERT_EQUAL(-1, parsePIDBlob(farByte.data(), farByte.size(), out, 4));
+}
+
+// ---- Client ---------------------------------------------------------------
+
+void test_extended_pid_polled() {
+  adapter->setResponse(0, "22F40D", "62F40D5A");
+  std::vector<uint8_t> data = blob({extendedPID(0xF40D, 0x7E0, 0x7E8, 0, 8, 1.0f, -40.0f)});
+  TEST_ASSERT_EQUAL(1, client->loadExtendedPIDs(data.data(), data.size()));
+  TEST_ASSERT_TRUE(connectClient(*client, *adapter));
+  runFor(*client, 3000);
+
+  TEST_ASSERT_TRUE(adapter->countWrites("ATSH7E0") > 0);
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 50.0f, client->getExtendedValue(0));
+  TEST_ASSERT_FLOAT_WITHIN(0.5f, 1726.0f, client->getCurrentData().rpm);
+}
+
+void test_invalid_descriptor_not_added() {
+  TEST_ASSERT_EQUAL(-1, client->addExtendedPID(extendedPID(0xF40D, 0x7E0, 0x7E8, 250, 8, 1.0f)));
+  TEST_ASSERT_EQUAL_UINT8(0, client->getExtendedPIDCount());
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_standard_pids);
+  RUN_TEST(test_echo_mismatch);
+  RUN_TEST(test_short_message);
+  RUN_TEST(test_bit_field);
+  RUN_TEST(test_field_across_bytes);
+  RUN_TEST(test_signed_and_32bit);
+  RUN_TEST(test_offsets_past_frame_rejected);
+  RUN_TEST(test_request_text);
+  RUN_TEST(test_blob_round_trip);
+  RUN_TEST(test_blob_malformed);
+  RUN_TEST(test_blob_rejects_out_of_frame_record);
+  RUN_TEST(test_extended_pid_polled);
+  RUN_TEST(test_invalid_descriptor_not_added);
+  return UNITY_END();
+}
@@ -0,0 +1,137 @@
+// Poller task and cross-task access: service() on its own thread while the
+// test thread reads, tunes and prints; link loss reported from the BLE side;
+// stopping the poller from its own callbacks
+
+#include <unity.h>
+#include <chrono>
+#include <future>
+#include <vector>
+#include "OBDTestHarness.h"
+
+static SimAdapter* adapter = nullptr;
+static BLEOBDClient* client = nullptr;
+
+void setUp() {
+  adapter = new SimAdapter();
+  client = new BLEOBDClient();
+}
+
+void tearDown() {
+  Serial.setWriteHook(nullptr);
+  client->stopPollerTask();
+  client->disconnect();
+  delete client;
+  delete adapter;
+}
+
+// Move the mocked clock from this thread while the poller services the client
+template <typename Condition>
+static bool advanceUntil(Condition done, unsigned long timeoutMs) {
+  for (unsigned long elapsed = 0; elapsed < timeoutMs; elapsed += 5) {
+    if (done()) return true;
+    mockAdvance(5);
+    std::this_thread::sleep_for(std::chrono::microseconds(200));
+  }
+  return done();
+}
+
+// ---- Poller task ----------------------------------------------------------
+
+void test_poller_polls_while_caller_reads() {
+  TEST_ASSERT_TRUE(connectClient(*client, *adapter));
+  int index = client->getSignalDB()->addSignal(0x100, 0, 8, CAN_SIGNAL_LITTLE_ENDIAN, 1.0f, 0.0f);
+  TEST_ASSERT_TRUE(client->startPollerTask());
+  TEST_ASSERT_TRUE(client->isPollerRunning());
+
+  uint32_t reads = 0;
+  bool polled = advanceUntil([&]() {
+    client->getLinkMonitor()->setThrottle(150, 500);
+    client->getFreshness()->getAge(SIGNAL_RPM, millis());
+    client->getSignalDB()->getValue(index);
+    client->displayStatus();
+    reads++;
+    return client->getStatistics().successfulCommands > 30;
+  }, 20000);
+  TEST_ASSERT_TRUE(polled);
+  TEST_ASSERT_FLOAT_WITHIN(0.5f, 1726.0f, client->getCurrentData().rpm);
+  TEST_ASSERT_TRUE(reads > 0);
+
+  client->stopPollerTask();
+  TEST_ASSERT_FALSE(client->isPollerRunning());
+}
+
+static void stopFromCallback(const OneShotResult&, void* context) {
+  static_cast<BLEOBDClient*>(context)->stopPollerTask();
+}
+
+void test_stop_from_poller_callback() {
+  TEST_ASSERT_TRUE(connectClient(*client, *adapter));
+  TEST_ASSERT_TRUE(client->startPollerTask());
+  TEST_ASSERT_TRUE(client->submitRequest("0902", stopFromCallback, client));
+  TEST_ASSERT_TRUE(advanceUntil([]() { return !client->isPollerRunning(); }, 20000));
+
+  // And it can be started again
+  uint32_t before = client->getStatistics().successfulCommands;
+  TEST_ASSERT_TRUE(client->startPollerTask());
+  TEST_ASSERT_TRUE(advanceUntil([&]() {
+    return client->getStatistics().successfulCommands > before + 5;
+  }, 20000));
+  client->stopPollerTask();
+  TEST_ASSERT_FALSE(client->isPollerRunning());
+}
+
+// ---- Display --------------------------------------------------------------
+
+// Each Serial write checks from another thread that the client lock is free
+static bool lockHeldWhilePrinting = false;
+static std::vector<std::future<void>> lockProbes;
+
+static void probeLock() {
+  if (lockProbes.size() >= 4) return;
+  std::future<void> probe = std::async(std::launch::async, []() { client->getStatistics(); });
+  if (probe.wait_for(std::chrono::milliseconds(200)) != std::future_status::ready) {
+    lockHeldWhilePrinting = true;
+  }
+  lockProbes.push_back(std::move(probe));
+}
+
+void test_display_prints_without_lock() {
+  TEST_ASSERT_TRUE(connectClient(*client, *adapter));
+  runFor(*client, 12000);
+  lockHeldWhilePrinting = false;
+  lockProbes.clear();
+  Serial.setWriteHook(probeLock);
+  client->displayStatus();
+  Serial.setWriteHook(nullptr);
+  lockProbes.clear();   // Waits for any probe that was blocked
+
+  TEST_ASSERT_FALSE(lockHeldWhilePrinting);
+  std::string out = Serial.takeOutput();
+  TEST_ASSERT_TRUE(out.find("RPM: 1726 rpm") != std::string::npos);
+  TEST_ASSERT_TRUE(out.find("STATISTICS") != std::string::npos);
+}
+
+// ---- BLE side -------------------------------------------------------------
+
+void test_link_loss_handled_in_service() {
+  client->setAutoReconnect(false);
+  TEST_ASSERT_TRUE(connectClient(*client, *adapter));
+  runFor(*client, 3000);
+
+  adapter->dropLink();
+  TEST_ASSERT_EQUAL(CONNECTED, client->getConnectionState());   // Only flagged
+  client->service();
+  TEST_ASSERT_EQUAL(DISCONNECTED, client->getConnectionState());
+  TEST_ASSERT_FALSE(client->isConnected());
+  TEST_ASSERT_TRUE(client->getStatistics().connectionUptime >= 3000);
+  TEST_ASSERT_EQUAL_UINT32(1, client->getConnectionTiming().drops);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_poller_polls_while_caller_reads);
+  RUN_TEST(test_stop_from_poller_callback);
+  RUN_TEST(test_display_prints_without_lock);
+  RUN_TEST(test_link_loss_handled_in_service);
+  return UNITY_END();
+}
@@ -0,0 +1,188 @@
+// Poll cycle profiler on a fake cycle counter: mark ordering, histogram
+// buckets and percentiles, counter wrap, and cycles recorded by the client
+
+#include <unity.h>
+#include "OBDProfiler.h"
+#include "OBDTestHarness.h"
+
+static uint32_t fakeCycles = 0;
+static uint32_t fakeCounter() { return fakeCycles; }
+
+// One microsecond per cycle, following the mocked clock
+static uint32_t mockClockCounter() { return (uint32_t)millis() * 1000; }
+
+static PollProfiler profiler;
+
+void setUp() {
+  fakeCycles = 0;
+  profiler.setCounter(fakeCounter, 1);
+  profiler.setEnabled(true);
+}
+
+void tearDown() {}
+
+// One full cycle with the given stage durations
+static void cycle(uint32_t response, uint32_t transfer, uint32_t dispatch, uint32_t parse, uint32_t publish) {
+  profiler.markSend();
+  fakeCycles += response;
+  profiler.markFirstByte(fakeCycles);
+  fakeCycles += transfer;
+  profiler.markPrompt(fakeCycles);
+  fakeCycles += dispatch;
+  profiler.markDecodeStart();
+  fakeCycles += parse;
+  profiler.markDecoded();
+  fakeCycles += publish;
+  profiler.markPublished();
+}
+
+// ---- Marks ----------------------------------------------------------------
+
+void test_stages_of_one_cycle() {
+  cycle(30000, 500, 2000, 40, 15);
+  TEST_ASSERT_EQUAL_UINT32(30000, profiler.getStage(STAGE_RESPONSE).min);
+  TEST_ASSERT_EQUAL_UINT32(500, profiler.getStage(STAGE_TRANSFER).min);
+  TEST_ASSERT_EQUAL_UINT32(2000, profiler.getStage(STAGE_DISPATCH).min);
+  TEST_ASSERT_EQUAL_UINT32(40, profiler.getStage(STAGE_PARSE).min);
+  TEST_ASSERT_EQUAL_UINT32(15, profiler.getStage(STAGE_PUBLISH).min);
+  TEST_ASSERT_EQUAL_UINT32(32555, profiler.getStage(STAGE_TOTAL).min);
+  TEST_ASSERT_EQUAL_UINT32(1, profiler.getStage(STAGE_TOTAL).count);
+}
+
+void test_next_send_before_publish() {
+  // The scheduler sends the next request in the same pass that decoded the
+  // reply; the decoded cycle is still recorded when published
+  profiler.markSend();
+  fakeCycles += 100;
+  profiler.markFirstByte(fakeCycles);
+  profiler.markPrompt(fakeCycles);
+  profiler.markDecodeStart();
+  fakeCycles += 10;
+  profiler.markDecoded();
+  profiler.cancel();      // One-shot or setup command sent next
+  profiler.markSend();    // Next periodic request
+  fakeCycles += 5;
+  profiler.markPublished();
+  TEST_ASSERT_EQUAL_UINT32(1, profiler.getStage(STAGE_TOTAL).count);
+  TEST_ASSERT_EQUAL_UINT32(115, profiler.getStage(STAGE_TOTAL).min);
+
+  profiler.markPublished();   // Nothing new decoded
+  TEST_ASSERT_EQUAL_UINT32(1, profiler.getStage(STAGE_TOTAL).count);
+}
+
+void test_out_of_order_marks_ignored() {
+  profiler.markSend();
+  profiler.markPrompt(10);        // No first byte yet
+  profiler.markDecodeStart();
+  profiler.markDecoded();
+  profiler.markPublished();
+  TEST_ASSERT_EQUAL_UINT32(0, profiler.getStage(STAGE_TOTAL).count);
+
+  profiler.markFirstByte(5);      // No send since the last cycle ended
+  TEST_ASSERT_EQUAL_UINT32(0, profiler.getStage(STAGE_TOTAL).count);
+}
+
+void test_cancel_and_disabled() {
+  profiler.markSend();
+  profiler.markFirstByte(1);
+  profiler.markPrompt(2);
+  profiler.cancel();              // Timeout
+  profiler.markDecodeStart();
+  profiler.markDecoded();
+  profiler.markPublished();
+  TEST_ASSERT_EQUAL_UINT32(0, profiler.getStage(STAGE_TOTAL).count);
+
+  profiler.setEnabled(false);
+  cycle(1, 1, 1, 1, 1);
+  TEST_ASSERT_EQUAL_UINT32(0, profiler.getStage(STAGE_TOTAL).count);
+}
+
+void test_counter_wrap() {
+  fakeCycles = 0xFFFFFF00;
+  cycle(0x80, 0x40, 0x40, 0x10, 0x10);
+  TEST_ASSERT_EQUAL_UINT32(0x80, profiler.getStage(STAGE_RESPONSE).max);
+  TEST_ASSERT_EQUAL_UINT32(0x120, profiler.getStage(STAGE_TOTAL).max);
+}
+
+// ---- Histogram --------------------------------------------------------------
+
+void test_histogram_percentiles() {
+  StageHistogram h = StageHistogram();
+  for (uint32_t i = 1; i <= 100; i++) h.add(i * 100);
+  TEST_ASSERT_EQUAL_UINT32(100, h.min);
+  TEST_ASSERT_EQUAL_UINT32(10000, h.max);
+  TEST_ASSERT_EQUAL_UINT32(100, h.count);
+
+  // Upper bound of the bucket holding the percentile: within 25% above it
+  uint32_t p50 = h.percentile(50);
+  uint32_t p90 = h.percentile(90);
+  TEST_ASSERT_TRUE(p50 >= 5000 && p50 <= 6250);
+  TEST_ASSERT_TRUE(p90 >= 9000 && p90 <= 11250);
+  TEST_ASSERT_EQUAL_UINT32(10000, h.percentile(100));   // Capped at the max
+  TEST_ASSERT_EQUAL_UINT32(0, StageHistogram().percentile(50));
+}
+
+void test_histogram_extremes() {
+  StageHistogram h = StageHistogram();
+  h.add(0);
+  h.add(3);
+  h.add(0xFFFFFFFF);
+  TEST_ASSERT_EQUAL_UINT32(0, h.min);
+  TEST_ASSERT_EQUAL_UINT32(0, h.percentile(1));
+  TEST_ASSERT_EQUAL_UINT32(3, h.percentile(60));
+  TEST_ASSERT_EQUAL_UINT32(0xFFFFFFFF, h.percentile(100));
+}
+
+void test_report() {
+  profiler.setCounter(fakeCounter, 10);   // 10 cycles per microsecond
+  cycle(300000, 5000, 20000, 400, 150);
+  char out[1024];
+  size_t length = profiler.report(out, sizeof(out));
+  TEST_ASSERT_EQUAL(strlen(out), length);
+  TEST_ASSERT_NOT_NULL(strstr(out, "response"));
+  TEST_ASSERT_NOT_NULL(strstr(out, "30000"));   // 300000 cycles = 30000 us
+
+  char small[40];
+  length = profiler.report(small, sizeof(small));
+  TEST_ASSERT_EQUAL(sizeof(small) - 1, length);
+  TEST_ASSERT_EQUAL(strlen(small), length);
+}
+
+// ---- Client -----------------------------------------------------------------
+
+void test_client_records_poll_cycles() {
+  SimAdapter adapter;
+  BLEOBDClient client;
+  client.getProfiler()->setCounter(mockClockCounter, 1);
+  TEST_ASSERT_TRUE(connectClient(client, adapter));
+  client.setProfiling(true);
+  runFor(client, 5000);
+
+  auto profile = client.getProfiler();
+  const StageHistogram& response = profile->getStage(STAGE_RESPONSE);
+  const StageHistogram& total = profile->getStage(STAGE_TOTAL);
+  TEST_ASSERT_TRUE(total.count > 20);
+  TEST_ASSERT_EQUAL_UINT32(total.count, response.count);
+  // Reply latency of the simulator, seen on the 5 ms service steps
+  TEST_ASSERT_TRUE(response.min >= 25000 && response.max <= 40000);
+  TEST_ASSERT_TRUE(total.min >= response.min);
+
+  // Stages add up to the total, cycle by cycle
+  uint64_t stages = 0;
+  for (int i = STAGE_RESPONSE; i < STAGE_TOTAL; i++) stages += profile->getStage((ProfileStage)i).sum;
+  TEST_ASSERT_TRUE(stages == total.sum);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_stages_of_one_cycle);
+  RUN_TEST(test_next_send_before_publish);
+  RUN_TEST(test_out_of_order_marks_ignored);
+  RUN_TEST(test_cancel_and_disabled);
+  RUN_TEST(test_counter_wrap);
+  RUN_TEST(test_histogram_percentiles);
+  RUN_TEST(test_histogram_extremes);
+  RUN_TEST(test_report);
+  RUN_TEST(test_client_records_poll_cycles);
+  return UNITY_END();
+}
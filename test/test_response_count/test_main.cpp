@@ -0,0 +1,108 @@
+// Expected response count suffix: learned per PID on CAN, appended to the
+// request so the adapter stops waiting for more ECUs
+
+#include <unity.h>
+#include "OBDTestHarness.h"
+
+static SimAdapter* adapter = nullptr;
+static BLEOBDClient* client = nullptr;
+
+void setUp() {
+  adapter = new SimAdapter();
+  adapter->searchWait = 100;     // Adapter waits this long for more ECUs without a count
+  client = new BLEOBDClient();
+}
+
+void tearDown() {
+  client->disconnect();
+  delete client;
+  delete adapter;
+}
+
+static uint32_t pollsIn(unsigned long ms) {
+  uint32_t before = client->getStatistics().successfulCommands;
+  runFor(*client, ms);
+  return client->getStatistics().successfulCommands - before;
+}
+
+void test_count_learned_after_discovery() {
+  TEST_ASSERT_TRUE(connectClient(*client, *adapter));
+  runFor(*client, 5000);
+  TEST_ASSERT_TRUE(adapter->countWrites("010C1") > 0);
+  TEST_ASSERT_TRUE(adapter->countWrites("010C") >= 3);      // Discovery polls without a count
+  TEST_ASSERT_FLOAT_WITHIN(0.5f, 1726.0f, client->getCurrentData().rpm);
+}
+
+void test_count_matches_responders() {
+  SimECU& gearbox = adapter->addECU(0x7E9, 0x18DAF118, 0x18);
+  gearbox.responses["010D"] = "410D3B";
+  TEST_ASSERT_TRUE(connectClient(*client, *adapter));
+  runFor(*client, 5000);
+  TEST_ASSERT_TRUE(adapter->countWrites("010D2") > 0);
+  TEST_ASSERT_EQUAL(0, (int)adapter->countWrites("010D1"));
+  TEST_ASSERT_TRUE(adapter->countWrites("010C1") > 0);
+}
+
+void test_count_cuts_cycle_time() {
+  TEST_ASSERT_TRUE(connectClient(*client, *adapter));
+  runFor(*client, 5000);
+  uint32_t withCount = pollsIn(5000);
+
+  client->setResponseCountEnabled(false);
+  runFor(*client, 500);
+  uint32_t withoutCount = pollsIn(5000);
+
+  // 30 ms vs 130 ms per request
+  TEST_ASSERT_TRUE(withCount > withoutCount * 2);
+}
+
+void test_disabled_sends_plain_requests() {
+  client->setResponseCountEnabled(false);
+  TEST_ASSERT_TRUE(connectClient(*client, *adapter));
+  runFor(*client, 5000);
+  TEST_ASSERT_EQUAL(0, (int)adapter->countWrites("010C1"));
+  TEST_ASSERT_TRUE(adapter->countWrites("010C") > 3);
+}
+
+void test_no_count_on_legacy_bus() {
+  adapter->setProtocol(SIM_LEGACY);
+  TEST_ASSERT_TRUE(connectClient(*client, *adapter));
+  runFor(*client, 5000);
+  TEST_ASSERT_EQUAL(0, (int)adapter->countWrites("010C1"));
+  TEST_ASSERT_FLOAT_WITHIN(0.5f, 1726.0f, client->getCurrentData().rpm);
+}
+
+void test_count_relearned_for_target_ecu() {
+  SimECU& gearbox = adapter->addECU(0x7E9, 0x18DAF118, 0x18);
+  gearbox.responses["010D"] = "410D3B";
+  TEST_ASSERT_TRUE(connectClient(*client, *adapter));
+  runFor(*client, 5000);
+  TEST_ASSERT_TRUE(adapter->countWrites("010D2") > 0);
+
+  // One responder: the broadcast count would make the adapter wait for two
+  client->setTargetECU(0x7E0, 0x7E8);
+  runFor(*client, 5000);
+  adapter->clearWrites();
+  runFor(*client, 2000);
+  TEST_ASSERT_EQUAL(0, (int)adapter->countWrites("010D2"));
+  TEST_ASSERT_TRUE(adapter->countWrites("010D1") > 0);
+
+  // Back to broadcast: both answer again
+  client->clearTargetECU();
+  runFor(*client, 5000);
+  adapter->clearWrites();
+  runFor(*client, 2000);
+  TEST_ASSERT_EQUAL(0, (int)adapter->countWrites("010D1"));
+  TEST_ASSERT_TRUE(adapter->countWrites("010D2") > 0);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_count_learned_after_discovery);
+  RUN_TEST(test_count_matches_responders);
+  RUN_TEST(test_count_cuts_cycle_time);
+  RUN_TEST(test_disabled_sends_plain_requests);
+  RUN_TEST(test_no_count_on_legacy_bus);
+  RUN_TEST(test_count_relearned_for_target_ecu);
+  return UNITY_END();
+}
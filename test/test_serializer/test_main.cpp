@@ -0,0 +1,184 @@
+// Snapshot serializer: fixed-point formatting, JSON and CSV templates,
+// buffer limits and the client's serialize()
+
+#include <unity.h>
+#include <string>
+#include "OBDSerializer.h"
+#include "OBDTestHarness.h"
+
+static float values[SIGNAL_COUNT];
+
+void setUp() {
+  for (int i = 0; i < SIGNAL_COUNT; i++) values[i] = 0.0f;
+}
+
+void tearDown() {}
+
+static std::string fixed(float value, uint8_t decimals) {
+  char out[24];
+  size_t length = formatFixed(value, decimals, out);
+  TEST_ASSERT_EQUAL(strlen(out), length);
+  return out;
+}
+
+// ---- Numbers --------------------------------------------------------------
+
+void test_format_fixed() {
+  TEST_ASSERT_EQUAL_STRING("812", fixed(812.4f, 0).c_str());
+  TEST_ASSERT_EQUAL_STRING("-12.35", fixed(-12.345f, 2).c_str());
+  TEST_ASSERT_EQUAL_STRING("0.5", fixed(0.5f, 1).c_str());
+  TEST_ASSERT_EQUAL_STRING("0.05", fixed(0.05f, 2).c_str());
+  TEST_ASSERT_EQUAL_STRING("0.0", fixed(0.0f, 1).c_str());
+  TEST_ASSERT_EQUAL_STRING("0.0", fixed(-0.01f, 1).c_str());   // No "-0.0"
+  TEST_ASSERT_EQUAL_STRING("1.0", fixed(0.96f, 1).c_str());    // Carry into the integer part
+  TEST_ASSERT_EQUAL_STRING("12.600000", fixed(12.6f, 9).c_str());   // Clamped to 6 places
+}
+
+void test_format_fixed_out_of_range() {
+  TEST_ASSERT_EQUAL_STRING("", fixed(NAN, 1).c_str());
+  TEST_ASSERT_EQUAL_STRING("", fixed(INFINITY, 1).c_str());
+  TEST_ASSERT_EQUAL_STRING("", fixed(1e13f, 6).c_str());
+  // Largest accepted magnitude still fits the 24-byte buffer
+  std::string big = fixed(-9.9e16f, 1);
+  TEST_ASSERT_TRUE(big.size() > 18 && big.size() < 24);
+}
+
+// ---- Templates ------------------------------------------------------------
+
+void test_json() {
+  SnapshotSerializer json;
+  json.addField(SIGNAL_RPM, 0);
+  json.addField(SIGNAL_SPEED, 1, "kmh");
+  json.addField(SIGNAL_VOLTAGE, 2);
+  values[SIGNAL_RPM] = 812.4f;
+  values[SIGNAL_SPEED] = 60.0f;
+  values[SIGNAL_VOLTAGE] = NAN;
+  char out[128];
+  size_t length = json.write(values, out, sizeof(out));
+  TEST_ASSERT_EQUAL_STRING("{\"rpm\":812,\"kmh\":60.0,\"voltage\":null}", out);
+  TEST_ASSERT_EQUAL(strlen(out), length);
+}
+
+void test_empty_json_and_csv() {
+  SnapshotSerializer json;
+  char out[16];
+  json.write(values, out, sizeof(out));
+  TEST_ASSERT_EQUAL_STRING("{}", out);
+
+  SnapshotSerializer csv(FORMAT_CSV);
+  csv.write(values, out, sizeof(out));
+  TEST_ASSERT_EQUAL_STRING("\n", out);
+  TEST_ASSERT_EQUAL(0, (int)csv.writeHeader(out, 1));   // No room for the newline
+}
+
+void test_csv_and_header() {
+  SnapshotSerializer csv(FORMAT_CSV);
+  csv.addField(SIGNAL_RPM, 0);
+  csv.addField(SIGNAL_COOLANT_TEMP, 1);
+  values[SIGNAL_RPM] = 1726.0f;
+  values[SIGNAL_COOLANT_TEMP] = NAN;
+  char out[64];
+  csv.writeHeader(out, sizeof(out));
+  TEST_ASSERT_EQUAL_STRING("rpm,coolant_temp\n", out);
+  csv.write(values, out, sizeof(out));
+  TEST_ASSERT_EQUAL_STRING("1726,\n", out);   // Unknown value left empty
+}
+
+void test_switch_format() {
+  SnapshotSerializer serializer(FORMAT_CSV);
+  serializer.addField(SIGNAL_RPM, 0);
+  serializer.addField(SIGNAL_SPEED, 0);
+  values[SIGNAL_RPM] = 900.0f;
+  char out[64];
+  TEST_ASSERT_TRUE(serializer.setFormat(FORMAT_JSON));
+  serializer.write(values, out, sizeof(out));
+  TEST_ASSERT_EQUAL_STRING("{\"rpm\":900,\"speed\":0}", out);
+  serializer.clear();
+  serializer.write(values, out, sizeof(out));
+  TEST_ASSERT_EQUAL_STRING("{}", out);
+}
+
+void test_buffer_too_small() {
+  SnapshotSerializer json;
+  json.addField(SIGNAL_RPM, 0);
+  values[SIGNAL_RPM] = 812.0f;
+  char out[64];
+  TEST_ASSERT_EQUAL(0, (int)json.write(values, out, 8));
+  TEST_ASSERT_EQUAL(0, (int)json.writeHeader(out, 4));
+}
+
+void test_field_limits() {
+  SnapshotSerializer json;
+  TEST_ASSERT_FALSE(json.addField(SIGNAL_COUNT));
+  for (int i = 0; i < SERIALIZER_MAX_FIELDS; i++) TEST_ASSERT_TRUE(json.addField((OBDSignal)i));
+  TEST_ASSERT_FALSE(json.addField(SIGNAL_RPM));
+  TEST_ASSERT_EQUAL_UINT8(SERIALIZER_MAX_FIELDS, json.getFieldCount());
+
+  // Every field, every value at its widest: the output is still well formed
+  for (int i = 0; i < SIGNAL_COUNT; i++) values[i] = -99999.9f;
+  char out[1024];
+  size_t length = json.write(values, out, sizeof(out));
+  TEST_ASSERT_TRUE(length > 0);
+  TEST_ASSERT_EQUAL('{', out[0]);
+  TEST_ASSERT_EQUAL('}', out[length - 1]);
+}
+
+void test_long_names() {
+  // One name nearly filling the template; the prefix length must cover it all
+  static char longName[SERIALIZER_TEMPLATE_SIZE - 8];
+  memset(longName, 'n', sizeof(longName) - 1);
+  longName[sizeof(longName) - 1] = '\0';
+
+  SnapshotSerializer json;
+  TEST_ASSERT_TRUE(json.addField(SIGNAL_RPM, 0, longName));
+  values[SIGNAL_RPM] = 7.0f;
+  char out[512];
+  size_t length = json.write(values, out, sizeof(out));
+  TEST_ASSERT_EQUAL(strlen(longName) + 6, length);   // {"name":7}
+  TEST_ASSERT_EQUAL_STRING(":7}", out + length - 3);
+
+  // A second field no longer fits and is rejected, leaving the first intact
+  TEST_ASSERT_FALSE(json.addField(SIGNAL_SPEED, 0, "speed_that_does_not_fit"));
+  TEST_ASSERT_EQUAL(length, json.write(values, out, sizeof(out)));
+
+  // JSON needs more template than CSV: switching keeps the format that fits
+  SnapshotSerializer csv(FORMAT_CSV);
+  TEST_ASSERT_TRUE(csv.addField(SIGNAL_RPM, 0, longName));
+  TEST_ASSERT_TRUE(csv.addField(SIGNAL_SPEED, 0, "speed_that_does_not_fit"));
+  TEST_ASSERT_FALSE(csv.setFormat(FORMAT_JSON));
+  csv.write(values, out, sizeof(out));
+  TEST_ASSERT_EQUAL_STRING("7,0\n", out);
+}
+
+// ---- Client ---------------------------------------------------------------
+
+void test_client_serialize() {
+  SimAdapter adapter;
+  BLEOBDClient client;
+  TEST_ASSERT_TRUE(connectClient(client, adapter));
+  runFor(client, 3000);
+
+  SnapshotSerializer json;
+  json.addField(SIGNAL_RPM, 0);
+  json.addField(SIGNAL_SPEED, 0);
+  json.addField(SIGNAL_ENGINE_RUNNING, 0);
+  char out[128];
+  TEST_ASSERT_TRUE(client.serialize(json, out, sizeof(out)) > 0);
+  TEST_ASSERT_EQUAL_STRING("{\"rpm\":1726,\"speed\":60,\"engine_running\":1}", out);
+  client.disconnect();
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_format_fixed);
+  RUN_TEST(test_format_fixed_out_of_range);
+  RUN_TEST(test_json);
+  RUN_TEST(test_empty_json_and_csv);
+  RUN_TEST(test_csv_and_header);
+  RUN_TEST(test_switch_format);
+  RUN_TEST(test_buffer_too_small);
+  RUN_TEST(test_field_limits);
+  RUN_TEST(test_long_names);
+  RUN_TEST(test_client_serialize);
+  return UNITY_END();
+}
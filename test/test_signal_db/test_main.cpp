@@ -0,0 +1,191 @@
+// DBC-style signal extraction: Intel and Motorola bit numbering, signed
+// and 64-bit signals, DLC checks, the ID hash and the CDBC blob
+
+#include <unity.h>
+#include <vector>
+#include "CANSignalDB.h"
+
+static CANSignalDB db;
+
+void setUp() { db.clear(); }
+void tearDown() {}
+
+static CANFrame frame(uint32_t id, std::initializer_list<uint8_t> bytes) {
+  CANFrame f = CANFrame();
+  f.id = id;
+  for (uint8_t b : bytes) f.data[f.dlc++] = b;
+  return f;
+}
+
+static void putLE(std::vector<uint8_t>& out, uint32_t value, int bytes) {
+  for (int i = 0; i < bytes; i++) out.push_back((uint8_t)(value >> (8 * i)));
+}
+
+static void putRecord(std::vector<uint8_t>& out, uint32_t id, uint8_t start, uint8_t length,
+                      uint8_t flags, float scale, float offset) {
+  putLE(out, id, 4);
+  out.push_back(start);
+  out.push_back(length);
+  out.push_back(flags);
+  uint32_t bits;
+  memcpy(&bits, &scale, 4);
+  putLE(out, bits, 4);
+  memcpy(&bits, &offset, 4);
+  putLE(out, bits, 4);
+}
+
+// ---- Extraction ---------------------------------------------------------
+
+void test_intel_byte_aligned() {
+  int idx = db.addSignal(0x100, 8, 16, CAN_SIGNAL_LITTLE_ENDIAN, 0.25f, 0.0f);
+  TEST_ASSERT_EQUAL_UINT8(1, db.decodeFrame(frame(0x100, {0x00, 0xF8, 0x1A, 0x00})));
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 1726.0f, db.getValue(idx));
+}
+
+void test_intel_unaligned() {
+  // 12 bits from bit 4: low nibble of byte 0 skipped
+  int idx = db.addSignal(0x100, 4, 12, CAN_SIGNAL_LITTLE_ENDIAN, 1.0f, 0.0f);
+  db.decodeFrame(frame(0x100, {0xB0, 0x7A}));
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, (float)0x7AB, db.getValue(idx));
+}
+
+void test_motorola_sawtooth() {
+  // DBC "7|16@0+": MSB is bit 7 of byte 0, so bytes 0-1 big-endian
+  int word = db.addSignal(0x200, 7, 16, 0, 1.0f, 0.0f);
+  // "11|4@0+": bits 11..8 = high nibble of byte 1
+  int nibble = db.addSignal(0x200, 15, 4, 0, 1.0f, 0.0f);
+  // "3|12@0+": low nibble of byte 0 then all of byte 1
+  int across = db.addSignal(0x200, 3, 12, 0, 1.0f, 0.0f);
+  db.decodeFrame(frame(0x200, {0x12, 0x34}));
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, (float)0x1234, db.getValue(word));
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 3.0f, db.getValue(nibble));
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, (float)0x234, db.getValue(across));
+}
+
+void test_signed_scale_offset() {
+  int idx = db.addSignal(0x300, 0, 8, CAN_SIGNAL_LITTLE_ENDIAN | CAN_SIGNAL_SIGNED, 0.5f, 10.0f);
+  db.decodeFrame(frame(0x300, {0xF6}));   // -10
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 5.0f, db.getValue(idx));
+}
+
+void test_full_64_bits() {
+  int idx = db.addSignal(0x400, 0, 64, CAN_SIGNAL_LITTLE_ENDIAN, 1.0f, 0.0f);
+  db.decodeFrame(frame(0x400, {1, 0, 0, 0, 0, 0, 0, 0}));
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 1.0f, db.getValue(idx));
+}
+
+void test_short_frame_skips_signal() {
+  int low = db.addSignal(0x500, 0, 8, CAN_SIGNAL_LITTLE_ENDIAN, 1.0f, 0.0f);
+  int high = db.addSignal(0x500, 48, 8, CAN_SIGNAL_LITTLE_ENDIAN, 1.0f, 0.0f);
+  TEST_ASSERT_EQUAL_UINT8(1, db.decodeFrame(frame(0x500, {7, 0, 0})));
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 7.0f, db.getValue(low));
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 0.0f, db.getValue(high));
+}
+
+// ---- Database -----------------------------------------------------------
+
+void test_unknown_frame_counted() {
+  db.addSignal(0x600, 0, 8, CAN_SIGNAL_LITTLE_ENDIAN, 1.0f, 0.0f);
+  TEST_ASSERT_EQUAL_UINT8(0, db.decodeFrame(frame(0x601, {1})));
+  TEST_ASSERT_EQUAL_UINT32(1, db.getUnknownFrames());
+}
+
+void test_index_stable_after_grouping() {
+  // Added out of ID order: indices still follow addSignal() order
+  float target = 0;
+  int a = db.addSignal(0x700, 0, 8, CAN_SIGNAL_LITTLE_ENDIAN, 1.0f, 0.0f);
+  int b = db.addSignal(0x100, 0, 8, CAN_SIGNAL_LITTLE_ENDIAN, 1.0f, 0.0f, &target);
+  int c = db.addSignal(0x700, 8, 8, CAN_SIGNAL_LITTLE_ENDIAN, 1.0f, 0.0f);
+  db.decodeFrame(frame(0x700, {1, 2}));
+  db.decodeFrame(frame(0x100, {3}));
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 1.0f, db.getValue(a));
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 3.0f, db.getValue(b));
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 2.0f, db.getValue(c));
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 3.0f, target);
+  TEST_ASSERT_EQUAL_UINT8(2, db.getMessageCount());
+}
+
+static uint8_t seenIndex[4];
+static float seenValue[4];
+static int seen = 0;
+
+static void onSignal(uint8_t index, float value, void*) {
+  if (seen < 4) {
+    seenIndex[seen] = index;
+    seenValue[seen] = value;
+  }
+  seen++;
+}
+
+void test_callback_per_updated_signal() {
+  db.addSignal(0x100, 0, 8, CAN_SIGNAL_LITTLE_ENDIAN, 1.0f, 0.0f);
+  int second = db.addSignal(0x200, 0, 8, CAN_SIGNAL_LITTLE_ENDIAN, 2.0f, 0.0f);
+  seen = 0;
+  db.decodeFrame(frame(0x200, {21}), onSignal, nullptr);
+  TEST_ASSERT_EQUAL(1, seen);
+  TEST_ASSERT_EQUAL_UINT8(second, seenIndex[0]);
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 42.0f, seenValue[0]);
+}
+
+void test_many_messages_hash() {
+  // Every message slot in use, ids chosen to collide in the hash
+  for (uint32_t i = 0; i < CAN_MAX_MESSAGES; i++) {
+    TEST_ASSERT_TRUE(db.addSignal(0x100 + i * CAN_HASH_SIZE, 0, 8, CAN_SIGNAL_LITTLE_ENDIAN, 1.0f, (float)i) >= 0);
+  }
+  for (uint32_t i = 0; i < CAN_MAX_MESSAGES; i++) {
+    TEST_ASSERT_EQUAL_UINT8(1, db.decodeFrame(frame(0x100 + i * CAN_HASH_SIZE, {0})));
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, (float)i, db.getValue(i));
+  }
+  TEST_ASSERT_EQUAL_UINT8(0, db.decodeFrame(frame(0x0FF, {0})));
+}
+
+void test_rejects_bad_signals() {
+  TEST_ASSERT_EQUAL(-1, db.addSignal(0x100, 0, 0, 0, 1.0f, 0.0f));
+  TEST_ASSERT_EQUAL(-1, db.addSignal(0x100, 0, 65, 0, 1.0f, 0.0f));
+  TEST_ASSERT_EQUAL(-1, db.addSignal(0x100, 64, 8, 0, 1.0f, 0.0f));
+}
+
+void test_signal_past_frame_never_decoded() {
+  // Motorola field running off the end of an 8-byte frame
+  int idx = db.addSignal(0x100, 60, 16, 0, 1.0f, 0.0f);
+  TEST_ASSERT_EQUAL_UINT8(0, db.decodeFrame(frame(0x100, {1, 2, 3, 4, 5, 6, 7, 8})));
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 0.0f, db.getValue(idx));
+}
+
+// ---- Blob ---------------------------------------------------------------
+
+void test_blob() {
+  std::vector<uint8_t> blob = {'C', 'D', 'B', 'C', 1};
+  putLE(blob, 2, 2);
+  putRecord(blob, 0x0C9, 24, 16, CAN_SIGNAL_LITTLE_ENDIAN, 0.25f, 0.0f);
+  putRecord(blob, 0x3D1, 7, 8, 0, 1.0f, -40.0f);
+  TEST_ASSERT_EQUAL(2, db.loadBlob(blob.data(), blob.size()));
+  db.decodeFrame(frame(0x0C9, {0, 0, 0, 0x80, 0x3E}));
+  db.decodeFrame(frame(0x3D1, {0x5A}));
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 4000.0f, db.getValue(0));
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 50.0f, db.getValue(1));
+
+  db.clear();
+  std::vector<uint8_t> truncated(blob.begin(), blob.end() - 1);
+  TEST_ASSERT_EQUAL(-1, db.loadBlob(truncated.data(), truncated.size()));
+  blob[4] = 9;
+  TEST_ASSERT_EQUAL(-1, db.loadBlob(blob.data(), blob.size()));
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_intel_byte_aligned);
+  RUN_TEST(test_intel_unaligned);
+  RUN_TEST(test_motorola_sawtooth);
+  RUN_TEST(test_signed_scale_offset);
+  RUN_TEST(test_full_64_bits);
+  RUN_TEST(test_short_frame_skips_signal);
+  RUN_TEST(test_unknown_frame_counted);
+  RUN_TEST(test_index_stable_after_grouping);
+  RUN_TEST(test_callback_per_updated_signal);
+  RUN_TEST(test_many_messages_hash);
+  RUN_TEST(test_rejects_bad_signals);
+  RUN_TEST(test_signal_past_frame_never_decoded);
+  RUN_TEST(test_blob);
+  return UNITY_END();
+}
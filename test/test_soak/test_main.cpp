@@ -0,0 +1,97 @@
+// Reconnect soak: OBD_SOAK_CYCLES (default 10000) drop/rescan/reconnect/poll
+// cycles against one adapter, dropping at a different point of the request
+// each time. The BLE client is created once, every cycle polls again, and
+// live heap stays flat once the first cycles have warmed up.
+
+#include <unity.h>
+#include <malloc.h>
+#include <stdlib.h>
+#include "OBDTestHarness.h"
+
+static SimAdapter* adapter = nullptr;
+static BLEOBDClient* client = nullptr;
+
+void setUp() {
+  adapter = new SimAdapter();
+  client = new BLEOBDClient();
+}
+
+void tearDown() {
+  client->disconnect();
+  delete client;
+  delete adapter;
+}
+
+static unsigned long envNumber(const char* name, unsigned long fallback) {
+  const char* value = getenv(name);
+  return value ? strtoul(value, nullptr, 0) : fallback;
+}
+
+static size_t liveHeapBytes() {
+  return mallinfo2().uordblks;
+}
+
+// Link lost, rescan, reconnect; false if the client does not get back
+static bool reconnect() {
+  adapter->dropLink();
+  if (!runUntil(*client, [&]() { return client->getConnectionState() == SCANNING; }, 1000)) return false;
+  adapter->advertise();
+  return runUntil(*client, [&]() { return client->getConnectionState() == CONNECTED; }, 5000);
+}
+
+// ---- Soak -----------------------------------------------------------------
+
+void test_reconnect_poll_soak() {
+  const unsigned long cycles = envNumber("OBD_SOAK_CYCLES", 10000);
+  const unsigned long warmUp = 10;
+  TEST_ASSERT_TRUE(cycles > warmUp);
+  TEST_ASSERT_TRUE(connectClient(*client, *adapter));
+  runFor(*client, 500);
+
+  size_t heapAfterWarmUp = 0;
+  unsigned long stalled = 0, lost = 0;
+  for (unsigned long cycle = 0; cycle < cycles; cycle++) {
+    // Vary the drop point across send, reply and decode
+    runFor(*client, 200 + (cycle % 13) * 7);
+    unsigned long polled = client->getStatistics().successfulCommands;
+    if (!reconnect()) {
+      lost++;
+      break;
+    }
+    runFor(*client, 300);
+    if (client->getStatistics().successfulCommands == polled) stalled++;
+
+    // Observations the harness keeps would otherwise grow with the run
+    adapter->clearWrites();
+    Serial.takeOutput();
+    if (cycle + 1 == warmUp) heapAfterWarmUp = liveHeapBytes();
+  }
+  long heapGrowth = (long)liveHeapBytes() - (long)heapAfterWarmUp;
+  printf("soak: %lu cycles, live heap %+ld bytes after warm-up\n", cycles, heapGrowth);
+
+  TEST_ASSERT_EQUAL_UINT32(0, lost);
+  TEST_ASSERT_EQUAL_UINT32(0, stalled);
+  TEST_ASSERT_EQUAL(CONNECTED, client->getConnectionState());
+  TEST_ASSERT_FLOAT_WITHIN(0.5f, 1726.0f, client->getCurrentData().rpm);
+
+  ConnectionTiming timing = client->getConnectionTiming();
+  TEST_ASSERT_EQUAL_UINT32(cycles + 1, timing.connects);
+  TEST_ASSERT_EQUAL_UINT32(cycles, timing.drops);
+  TEST_ASSERT_EQUAL_UINT32(cycles, timing.reconnects);
+  TEST_ASSERT_EQUAL_UINT32(0, timing.failures);
+  TEST_ASSERT_EQUAL_UINT32(1, BLEDevice::getClientsCreated());
+  TEST_ASSERT_EQUAL_UINT32(cycles + 1, adapter->connects);
+
+  Statistics stats = client->getStatistics();
+  TEST_ASSERT_TRUE(stats.connectionUptime >= cycles * 200);
+  TEST_ASSERT_TRUE(stats.successfulCommands > cycles);
+
+  // A leak of one small block per cycle would show as kilobytes here
+  TEST_ASSERT_TRUE(heapGrowth < 1024);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_reconnect_poll_soak);
+  return UNITY_END();
+}
@@ -0,0 +1,169 @@
+// Adapter reply classification (status lines, precedence, the version
+// banner) and the client's recovery: retries, back-off and the adapter
+// re-initialisation with the right request header
+
+#include <unity.h>
+#include "OBDStatus.h"
+#include "OBDTestHarness.h"
+
+static SimAdapter* adapter = nullptr;
+static BLEOBDClient* client = nullptr;
+
+void setUp() {
+  adapter = new SimAdapter();
+  client = new BLEOBDClient();
+}
+
+void tearDown() {
+  client->disconnect();
+  delete client;
+  delete adapter;
+}
+
+static ResponseClass classify(const char* text, bool obdRequest = true) {
+  return classifyResponse(text, strlen(text), obdRequest);
+}
+
+// ---- Classification -------------------------------------------------------
+
+void test_status_lines() {
+  TEST_ASSERT_EQUAL(STATUS_NO_DATA, classify("NO DATA\r").status);
+  TEST_ASSERT_EQUAL(STATUS_OK, classify("OK").status);
+  TEST_ASSERT_EQUAL(STATUS_UNKNOWN_COMMAND, classify("?\r").status);
+  TEST_ASSERT_EQUAL(STATUS_BUFFER_FULL, classify("BUFFER FULL").status);
+  TEST_ASSERT_EQUAL(STATUS_CAN_ERROR, classify("CAN ERROR\r").status);
+  TEST_ASSERT_EQUAL(STATUS_BUS_INIT_ERROR, classify("BUS INIT: ...ERROR").status);
+  TEST_ASSERT_EQUAL(STATUS_UNABLE_TO_CONNECT, classify("UNABLE TO CONNECT").status);
+  TEST_ASSERT_EQUAL(STATUS_ADAPTER_RESET, classify("LV RESET").status);
+  TEST_ASSERT_EQUAL(STATUS_INTERNAL_ERROR, classify("ERR94").status);
+  TEST_ASSERT_EQUAL(STATUS_ACT_ALERT, classify("ACT ALERT").status);
+  TEST_ASSERT_EQUAL(STATUS_DATA_ERROR, classify("41 0D 00 <DATA ERROR").status);
+  TEST_ASSERT_EQUAL(STATUS_TEXT, classify("12.6V").status);
+  TEST_ASSERT_EQUAL(STATUS_EMPTY, classify("\r\r").status);
+}
+
+void test_data_lines() {
+  ResponseClass reply = classify("7E8 10 14 49 02 01 31 47 31\r7E8 21 4A 43 35 34 34 34 52\r");
+  TEST_ASSERT_EQUAL(STATUS_DATA, reply.status);
+  TEST_ASSERT_EQUAL_UINT8(2, reply.dataLines);
+
+  reply = classify("014\r0: 49 02 01 31 47 31\r1: 4A 43 35 34 34 34 52\r");
+  TEST_ASSERT_EQUAL(STATUS_DATA, reply.status);
+  TEST_ASSERT_EQUAL_UINT8(3, reply.dataLines);
+}
+
+void test_precedence() {
+  // Error outranks partial data, data outranks NO DATA
+  ResponseClass reply = classify("7E8 03 41 0C 1A\rBUFFER FULL\r");
+  TEST_ASSERT_EQUAL(STATUS_BUFFER_FULL, reply.status);
+  TEST_ASSERT_EQUAL_UINT8(1, reply.dataLines);
+  TEST_ASSERT_EQUAL(STATUS_DATA, classify("NO DATA\r7E8 03 41 0D 3C\r").status);
+
+  reply = classify("SEARCHING...\r7E8 03 41 0D 3C\r");
+  TEST_ASSERT_EQUAL(STATUS_DATA, reply.status);
+  TEST_ASSERT_TRUE(reply.searching);
+  reply = classify("BUS INIT: ...OK\rNO DATA\r");
+  TEST_ASSERT_EQUAL(STATUS_NO_DATA, reply.status);
+  TEST_ASSERT_TRUE(reply.searching);
+}
+
+void test_banner_is_reset_only_for_obd_requests() {
+  ResponseClass reply = classify("\r\rELM327 v1.5\r", true);
+  TEST_ASSERT_EQUAL(STATUS_ADAPTER_RESET, reply.status);
+  TEST_ASSERT_EQUAL_HEX8(RECOVER_REINIT, reply.recovery);
+
+  // ATI / ATZ answer with the banner on purpose
+  reply = classify("ELM327 v1.5\r", false);
+  TEST_ASSERT_EQUAL(STATUS_TEXT, reply.status);
+  TEST_ASSERT_EQUAL_HEX8(RECOVER_NONE, reply.recovery);
+  TEST_ASSERT_EQUAL(STATUS_ADAPTER_RESET, classify("LV RESET", false).status);
+}
+
+void test_recovery_flags() {
+  TEST_ASSERT_EQUAL_HEX8(RECOVER_RETRY, recoveryFor(STATUS_UNKNOWN_COMMAND));
+  TEST_ASSERT_EQUAL_HEX8(RECOVER_RETRY | RECOVER_SLOW_DOWN, recoveryFor(STATUS_BUS_BUSY));
+  TEST_ASSERT_EQUAL_HEX8(RECOVER_REINIT, recoveryFor(STATUS_CAN_ERROR));
+  TEST_ASSERT_EQUAL_HEX8(RECOVER_NONE, recoveryFor(STATUS_NO_DATA));
+  TEST_ASSERT_EQUAL_HEX8(RECOVER_NONE, recoveryFor(STATUS_ACT_ALERT));
+  for (int s = 0; s < STATUS_COUNT; s++) {
+    TEST_ASSERT_TRUE(strcmp(adapterStatusName((AdapterStatus)s), "UNKNOWN") != 0);
+  }
+}
+
+// ---- Client ---------------------------------------------------------------
+
+static void connectAndPoll() {
+  TEST_ASSERT_TRUE(connectClient(*client, *adapter));
+  runFor(*client, 2000);
+  adapter->clearWrites();
+}
+
+void test_identify_banner_not_a_reset() {
+  connectAndPoll();
+  TEST_ASSERT_EQUAL_STRING("ELM327 v1.5", client->getAdapterVersion());
+  TEST_ASSERT_EQUAL_UINT32(0, client->getStatusCount(STATUS_ADAPTER_RESET));
+  TEST_ASSERT_EQUAL_UINT32(0, client->getStatistics().adapterReinits);
+  TEST_ASSERT_EQUAL_UINT32(0, client->getStatistics().adapterErrors);
+}
+
+void test_banner_in_poll_reinitialises() {
+  connectAndPoll();
+  adapter->scripted.push_back("\r\rELM327 v1.5\r\r>");
+  runFor(*client, 2000);
+  TEST_ASSERT_EQUAL_UINT32(1, client->getStatusCount(STATUS_ADAPTER_RESET));
+  TEST_ASSERT_EQUAL_UINT32(1, client->getStatistics().adapterReinits);
+  TEST_ASSERT_EQUAL(1, (int)adapter->countWrites("ATSP0"));
+  TEST_ASSERT_EQUAL(1, (int)adapter->countWrites("ATSH7DF"));
+  TEST_ASSERT_FLOAT_WITHIN(0.5f, 1726.0f, client->getCurrentData().rpm);
+}
+
+void test_reinit_keeps_29bit_header() {
+  adapter->setProtocol(SIM_CAN_29BIT);
+  connectAndPoll();
+  adapter->scripted.push_back("CAN ERROR\r\r>");
+  runFor(*client, 2000);
+  TEST_ASSERT_EQUAL_UINT32(1, client->getStatistics().adapterReinits);
+  TEST_ASSERT_EQUAL(0, (int)adapter->countWrites("ATSH7DF"));
+  TEST_ASSERT_EQUAL(1, (int)adapter->countWrites("ATSHDB33F1"));
+  TEST_ASSERT_EQUAL_HEX32(0x18DB33F1, adapter->lastHeader());
+  TEST_ASSERT_FLOAT_WITHIN(0.5f, 1726.0f, client->getCurrentData().rpm);
+}
+
+void test_reinit_keeps_target_ecu() {
+  connectAndPoll();
+  client->setTargetECU(0x7E0, 0x7E8);
+  runFor(*client, 1000);
+  adapter->clearWrites();
+  adapter->scripted.push_back("CAN ERROR\r\r>");
+  runFor(*client, 2000);
+  TEST_ASSERT_EQUAL_UINT32(1, client->getStatistics().adapterReinits);
+  TEST_ASSERT_EQUAL(0, (int)adapter->countWrites("ATSH7DF"));
+  TEST_ASSERT_EQUAL(1, (int)adapter->countWrites("ATCRA7E8"));
+  TEST_ASSERT_EQUAL_HEX32(0x7E0, adapter->lastHeader());
+}
+
+void test_overrun_backs_off_then_decays() {
+  connectAndPoll();
+  adapter->scripted.push_back("BUFFER FULL\r\r>");
+  runFor(*client, 200);
+  TEST_ASSERT_TRUE(client->getPollBackoff() > 0);
+  TEST_ASSERT_EQUAL_UINT32(1, client->getStatistics().adapterErrors);
+  runFor(*client, 20000);
+  TEST_ASSERT_EQUAL_UINT32(0, client->getPollBackoff());
+  TEST_ASSERT_EQUAL_UINT32(0, client->getStatistics().adapterReinits);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_status_lines);
+  RUN_TEST(test_data_lines);
+  RUN_TEST(test_precedence);
+  RUN_TEST(test_banner_is_reset_only_for_obd_requests);
+  RUN_TEST(test_recovery_flags);
+  RUN_TEST(test_identify_banner_not_a_reset);
+  RUN_TEST(test_banner_in_poll_reinitialises);
+  RUN_TEST(test_reinit_keeps_29bit_header);
+  RUN_TEST(test_reinit_keeps_target_ecu);
+  RUN_TEST(test_overrun_backs_off_then_decays);
+  return UNITY_END();
+}
@@ -0,0 +1,122 @@
+// STN adapters: STI detection, STPX requests carrying their own header, and
+// the default header restored when extensions take over from ATSH switching
+
+#include <unity.h>
+#include "BLEOBDClientProbe.h"
+#include "OBDTestHarness.h"
+
+static SimAdapter* adapter = nullptr;
+static BLEOBDClient* client = nullptr;
+
+void setUp() {
+  adapter = new SimAdapter();
+  client = new BLEOBDClient();
+}
+
+void tearDown() {
+  client->disconnect();
+  delete client;
+  delete adapter;
+}
+
+static size_t countPrefix(const char* prefix) {
+  size_t count = 0;
+  for (const std::string& write : adapter->writes) {
+    if (write.compare(0, strlen(prefix), prefix) == 0) count++;
+  }
+  return count;
+}
+
+// ---- Detection ------------------------------------------------------------
+
+void test_stn_detected() {
+  adapter->stn = true;
+  TEST_ASSERT_TRUE(connectClient(*client, *adapter));
+  runFor(*client, 3000);
+  TEST_ASSERT_EQUAL(ADAPTER_STN, client->getAdapterType());
+  TEST_ASSERT_EQUAL_STRING("STN1110 v4.2.0", client->getAdapterVersion());
+  TEST_ASSERT_EQUAL(1, (int)adapter->countWrites("STCSEGT1"));
+  TEST_ASSERT_TRUE(countPrefix("STPX D:010C") > 0);
+  TEST_ASSERT_FLOAT_WITHIN(0.5f, 1726.0f, client->getCurrentData().rpm);
+}
+
+void test_elm_clone_stays_elm() {
+  TEST_ASSERT_TRUE(connectClient(*client, *adapter));
+  runFor(*client, 3000);
+  TEST_ASSERT_EQUAL(ADAPTER_ELM327, client->getAdapterType());
+  TEST_ASSERT_EQUAL_STRING("ELM327 v1.5", client->getAdapterVersion());
+  TEST_ASSERT_EQUAL(1, (int)adapter->countWrites("STI"));
+  TEST_ASSERT_EQUAL(0, (int)countPrefix("STPX"));
+  TEST_ASSERT_FLOAT_WITHIN(0.5f, 1726.0f, client->getCurrentData().rpm);
+}
+
+void test_extensions_disabled() {
+  adapter->stn = true;
+  client->setSTNExtensions(false);
+  TEST_ASSERT_TRUE(connectClient(*client, *adapter));
+  runFor(*client, 3000);
+  TEST_ASSERT_EQUAL(ADAPTER_STN, client->getAdapterType());
+  TEST_ASSERT_EQUAL(0, (int)countPrefix("STPX"));
+  TEST_ASSERT_EQUAL(0, (int)adapter->countWrites("STCSEGT1"));
+}
+
+// ---- Headers --------------------------------------------------------------
+
+void test_extended_pid_header_in_request() {
+  adapter->stn = true;
+  adapter->setProtocol(SIM_CAN_29BIT);
+  adapter->setResponse(0, "22F40D", "62F40D5A");
+  TEST_ASSERT_EQUAL(0, client->addExtendedPID(extendedPID(0xF40D, 0x18DA10F1, 0x18DAF110, 0, 8, 1.0f, -40.0f)));
+  TEST_ASSERT_TRUE(connectClient(*client, *adapter));
+  runFor(*client, 4000);
+
+  TEST_ASSERT_TRUE(countPrefix("STPX H:18DA10F1, D:22F40D") > 0);
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 50.0f, client->getExtendedValue(0));
+  TEST_ASSERT_EQUAL_HEX32(0x18DB33F1, adapter->lastHeader());   // Never switched away
+}
+
+static void identifyWithHeaderActive(uint32_t header) {
+  BLEOBDClientProbe probe(*client);
+  TEST_ASSERT_TRUE(connectClient(*client, *adapter));
+  runFor(*client, 3000);                      // Responders learned, ELM327 so far
+  TEST_ASSERT_EQUAL(ADAPTER_ELM327, client->getAdapterType());
+
+  adapter->stn = true;
+  adapter->clearWrites();
+  probe.setActiveHeader(header);
+  probe.identify("STI", "STN1110 v4.2.0");
+  TEST_ASSERT_EQUAL_UINT32(0, probe.activeHeader());
+  runFor(*client, 1000);
+}
+
+void test_stn_restores_29bit_functional_header() {
+  adapter->setProtocol(SIM_CAN_29BIT);
+  identifyWithHeaderActive(0x18DA10F1);
+
+  TEST_ASSERT_EQUAL(0, (int)adapter->countWrites("ATSH7DF"));
+  TEST_ASSERT_EQUAL(1, (int)adapter->countWrites("ATSHDB33F1"));
+  TEST_ASSERT_EQUAL_HEX32(0x18DB33F1, adapter->lastHeader());
+
+  // Polls after the switch are still answered
+  uint32_t before = client->getStatistics().successfulCommands;
+  runFor(*client, 1000);
+  TEST_ASSERT_TRUE(client->getStatistics().successfulCommands > before);
+  TEST_ASSERT_EQUAL_UINT32(0, client->getStatusCount(STATUS_NO_DATA));
+}
+
+void test_stn_restores_11bit_functional_header() {
+  identifyWithHeaderActive(0x7E0);
+  TEST_ASSERT_EQUAL(1, (int)adapter->countWrites("ATSH7DF"));
+  TEST_ASSERT_EQUAL_HEX32(0x7DF, adapter->lastHeader());
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_stn_detected);
+  RUN_TEST(test_elm_clone_stays_elm);
+  RUN_TEST(test_extensions_disabled);
+  RUN_TEST(test_extended_pid_header_in_request);
+  RUN_TEST(test_stn_restores_29bit_functional_header);
+  RUN_TEST(test_stn_restores_11bit_functional_header);
+  return UNITY_END();
+}
@@ -0,0 +1,216 @@
+// Change subscriptions: deadband, minimum interval with held-back changes,
+// slot reuse, callbacks that unsubscribe, and delivery through the client
+
+#include <unity.h>
+#include "OBDSubscription.h"
+#include "OBDTestHarness.h"
+
+static SubscriptionTable table;
+static int events = 0;
+static float lastValue = 0;
+static OBDSignal lastSignal = SIGNAL_COUNT;
+
+static void onChange(OBDSignal signal, float value, void*) {
+  events++;
+  lastValue = value;
+  lastSignal = signal;
+}
+
+void setUp() {
+  table = SubscriptionTable();
+  events = 0;
+  lastValue = 0;
+  lastSignal = SIGNAL_COUNT;
+}
+
+void tearDown() {}
+
+// ---- Table ----------------------------------------------------------------
+
+void test_first_value_always_delivered() {
+  table.subscribe(SIGNAL_RPM, onChange, nullptr, 100.0f, 0);
+  table.publish(SIGNAL_RPM, 800.0f, 0);
+  TEST_ASSERT_EQUAL(1, events);
+  TEST_ASSERT_EQUAL(SIGNAL_RPM, lastSignal);
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 800.0f, lastValue);
+}
+
+void test_deadband_against_last_delivered() {
+  table.subscribe(SIGNAL_RPM, onChange, nullptr, 50.0f, 0);
+  table.publish(SIGNAL_RPM, 800.0f, 0);
+  table.publish(SIGNAL_RPM, 830.0f, 10);
+  table.publish(SIGNAL_RPM, 849.0f, 20);   // Creeping: still within 50 of 800
+  TEST_ASSERT_EQUAL(1, events);
+  table.publish(SIGNAL_RPM, 851.0f, 30);
+  TEST_ASSERT_EQUAL(2, events);
+  TEST_ASSERT_EQUAL_UINT32(2, table.getSuppressed());
+  TEST_ASSERT_EQUAL_UINT32(2, table.getDelivered());
+}
+
+void test_zero_deadband_suppresses_repeats() {
+  table.subscribe(SIGNAL_SPEED, onChange, nullptr, 0.0f, 0);
+  table.publish(SIGNAL_SPEED, 60.0f, 0);
+  table.publish(SIGNAL_SPEED, 60.0f, 10);
+  table.publish(SIGNAL_SPEED, 61.0f, 20);
+  TEST_ASSERT_EQUAL(2, events);
+}
+
+void test_interval_holds_back_latest_change() {
+  table.subscribe(SIGNAL_RPM, onChange, nullptr, 0.0f, 1000);
+  table.publish(SIGNAL_RPM, 800.0f, 0);
+  table.publish(SIGNAL_RPM, 900.0f, 100);
+  table.publish(SIGNAL_RPM, 950.0f, 200);
+  TEST_ASSERT_EQUAL(1, events);
+
+  table.poll(999);
+  TEST_ASSERT_EQUAL(1, events);
+  table.poll(1000);
+  TEST_ASSERT_EQUAL(2, events);
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 950.0f, lastValue);   // Latest, not the first held
+  table.poll(5000);
+  TEST_ASSERT_EQUAL(2, events);
+}
+
+void test_held_change_undone() {
+  table.subscribe(SIGNAL_RPM, onChange, nullptr, 10.0f, 1000);
+  table.publish(SIGNAL_RPM, 800.0f, 0);
+  table.publish(SIGNAL_RPM, 900.0f, 100);   // Held back
+  table.publish(SIGNAL_RPM, 805.0f, 200);   // Back inside the deadband
+  table.poll(2000);
+  TEST_ASSERT_EQUAL(1, events);
+}
+
+void test_signals_are_independent() {
+  table.subscribe(SIGNAL_RPM, onChange, nullptr, 0.0f, 0);
+  table.publish(SIGNAL_SPEED, 50.0f, 0);
+  TEST_ASSERT_EQUAL(0, events);
+  TEST_ASSERT_TRUE(table.hasSubscribers(SIGNAL_RPM));
+  TEST_ASSERT_FALSE(table.hasSubscribers(SIGNAL_SPEED));
+}
+
+void test_table_full_and_slot_reuse() {
+  int handles[OBD_MAX_SUBSCRIPTIONS];
+  for (int i = 0; i < OBD_MAX_SUBSCRIPTIONS; i++) {
+    handles[i] = table.subscribe(SIGNAL_RPM, onChange, nullptr, 0.0f, 0);
+    TEST_ASSERT_TRUE(handles[i] >= 0);
+  }
+  TEST_ASSERT_EQUAL(-1, table.subscribe(SIGNAL_RPM, onChange, nullptr, 0.0f, 0));
+
+  table.unsubscribe(handles[3]);
+  int reused = table.subscribe(SIGNAL_SPEED, onChange, nullptr, 0.0f, 0);
+  TEST_ASSERT_EQUAL(handles[3], reused);
+  table.publish(SIGNAL_RPM, 1.0f, 0);
+  TEST_ASSERT_EQUAL(OBD_MAX_SUBSCRIPTIONS - 1, events);
+}
+
+void test_invalid_arguments() {
+  TEST_ASSERT_EQUAL(-1, table.subscribe(SIGNAL_COUNT, onChange, nullptr, 0.0f, 0));
+  TEST_ASSERT_EQUAL(-1, table.subscribe(SIGNAL_RPM, nullptr, nullptr, 0.0f, 0));
+  table.unsubscribe(-1);
+  table.unsubscribe(OBD_MAX_SUBSCRIPTIONS);
+  table.unsubscribe(5);   // Never used
+  table.publish(SIGNAL_COUNT, 1.0f, 0);
+  TEST_ASSERT_EQUAL(0, events);
+}
+
+// A callback that drops the other subscription of the same signal
+static int victim = -1;
+static int victimEvents = 0;
+
+static void unsubscribeVictim(OBDSignal, float, void*) {
+  events++;
+  table.unsubscribe(victim);
+}
+
+static void onVictim(OBDSignal, float, void*) { victimEvents++; }
+
+void test_unsubscribed_in_callback_not_called() {
+  table.subscribe(SIGNAL_RPM, unsubscribeVictim, nullptr, 0.0f, 0);
+  victim = table.subscribe(SIGNAL_RPM, onVictim, nullptr, 0.0f, 0);
+  victimEvents = 0;
+  table.publish(SIGNAL_RPM, 800.0f, 0);
+  TEST_ASSERT_EQUAL(1, events);
+  TEST_ASSERT_EQUAL(0, victimEvents);
+}
+
+void test_unsubscribed_in_callback_not_polled() {
+  table.subscribe(SIGNAL_RPM, unsubscribeVictim, nullptr, 0.0f, 100);
+  victim = table.subscribe(SIGNAL_RPM, onVictim, nullptr, 0.0f, 100);
+  victimEvents = 0;
+  table.publish(SIGNAL_RPM, 800.0f, 0);    // First subscriber drops the victim
+  victim = table.subscribe(SIGNAL_RPM, onVictim, nullptr, 0.0f, 100);
+  table.publish(SIGNAL_RPM, 800.0f, 1);    // Victim delivered, first one within its interval
+  table.publish(SIGNAL_RPM, 900.0f, 50);   // Both held back
+  int before = victimEvents;
+  table.poll(200);                         // First one drops the victim again
+  TEST_ASSERT_EQUAL(before, victimEvents);
+}
+
+// ---- Client ---------------------------------------------------------------
+
+static SimAdapter* adapter = nullptr;
+static BLEOBDClient* client = nullptr;
+
+static void startClient() {
+  adapter = new SimAdapter();
+  client = new BLEOBDClient();
+  TEST_ASSERT_TRUE(connectClient(*client, *adapter));
+}
+
+static void stopClient() {
+  client->disconnect();
+  delete client;
+  delete adapter;
+}
+
+void test_client_delivers_changes() {
+  startClient();
+  int handle = client->subscribe(SIGNAL_RPM, onChange, nullptr, 100.0f);
+  TEST_ASSERT_TRUE(handle >= 0);
+  runFor(*client, 3000);
+  TEST_ASSERT_EQUAL(1, events);   // Constant 1726 rpm
+  TEST_ASSERT_FLOAT_WITHIN(0.5f, 1726.0f, lastValue);
+
+  adapter->setResponse(0, "010C", "410C1F40");   // 2000 rpm
+  runFor(*client, 3000);
+  TEST_ASSERT_EQUAL(2, events);
+  TEST_ASSERT_FLOAT_WITHIN(0.5f, 2000.0f, lastValue);
+  TEST_ASSERT_TRUE(client->getSuppressedEvents() > 0);
+
+  client->unsubscribe(handle);
+  adapter->setResponse(0, "010C", "410C0FA0");
+  runFor(*client, 3000);
+  TEST_ASSERT_EQUAL(2, events);
+  stopClient();
+}
+
+void test_client_delivers_held_change_without_new_reply() {
+  startClient();
+  client->subscribe(SIGNAL_RPM, onChange, nullptr, 0.0f, 5000);
+  runFor(*client, 1000);
+  TEST_ASSERT_EQUAL(1, events);
+  adapter->setResponse(0, "010C", "410C1F40");
+  runFor(*client, 1000);
+  adapter->replying = false;                     // No more publishes
+  runFor(*client, 5000);
+  TEST_ASSERT_EQUAL(2, events);                  // Delivered by poll() in service()
+  TEST_ASSERT_FLOAT_WITHIN(0.5f, 2000.0f, lastValue);
+  stopClient();
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_first_value_always_delivered);
+  RUN_TEST(test_deadband_against_last_delivered);
+  RUN_TEST(test_zero_deadband_suppresses_repeats);
+  RUN_TEST(test_interval_holds_back_latest_change);
+  RUN_TEST(test_held_change_undone);
+  RUN_TEST(test_signals_are_independent);
+  RUN_TEST(test_table_full_and_slot_reuse);
+  RUN_TEST(test_invalid_arguments);
+  RUN_TEST(test_unsubscribed_in_callback_not_called);
+  RUN_TEST(test_unsubscribed_in_callback_not_polled);
+  RUN_TEST(test_client_delivers_changes);
+  RUN_TEST(test_client_delivers_held_change_without_new_reply);
+  return UNITY_END();
+}
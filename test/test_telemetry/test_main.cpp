@@ -0,0 +1,320 @@
+// Binary telemetry: CRC16 and COBS vectors, key/delta frames decoded back
+// the way tools/telemetry_decode.py does, and the stream from the client
+
+#include <unity.h>
+#include <vector>
+#include "OBDTelemetry.h"
+#include "OBDTestHarness.h"
+
+static TelemetryEncoder encoder;
+
+void setUp() { encoder = TelemetryEncoder(); }
+void tearDown() {}
+
+// ---- Reference decoder ----------------------------------------------------
+
+struct DecodedFrame {
+  uint8_t type = 0;
+  uint8_t sequence = 0;
+  uint32_t time = 0;
+  uint32_t mask = 0;
+  int32_t values[SIGNAL_COUNT] = {};
+  bool valid = false;
+};
+
+// Empty when the block structure is broken (e.g. text between frames)
+static std::vector<uint8_t> cobsDecode(const uint8_t* in, size_t length) {
+  std::vector<uint8_t> out;
+  size_t i = 0;
+  while (i < length) {
+    uint8_t code = in[i];
+    if (code == 0 || i + code > length) return std::vector<uint8_t>();
+    out.insert(out.end(), in + i + 1, in + i + code);
+    i += code;
+    if (code < 0xFF && i < length) out.push_back(0);
+  }
+  return out;
+}
+
+static uint32_t getVarint(const std::vector<uint8_t>& data, size_t& pos) {
+  uint32_t value = 0;
+  for (int shift = 0; pos < data.size(); shift += 7) {
+    uint8_t byte = data[pos++];
+    value |= (uint32_t)(byte & 0x7F) << shift;
+    if (!(byte & 0x80)) break;
+  }
+  return value;
+}
+
+// One frame without its delimiter; valid only when the CRC and length check out
+static DecodedFrame decodeFrame(const uint8_t* data, size_t length) {
+  DecodedFrame frame;
+  std::vector<uint8_t> packet = cobsDecode(data, length);
+  size_t n = packet.size();
+  if (n < 4 || crc16CCITT(packet.data(), n - 2) != (packet[n - 2] | packet[n - 1] << 8)) return frame;
+
+  packet.resize(n - 2);
+  size_t pos = 0;
+  frame.type = packet[pos++];
+  frame.sequence = packet[pos++];
+  frame.time = getVarint(packet, pos);
+  frame.mask = getVarint(packet, pos);
+  for (uint32_t bits = frame.mask; bits; bits &= bits - 1) {
+    uint32_t raw = getVarint(packet, pos);
+    frame.values[__builtin_ctz(bits)] = (int32_t)(raw >> 1) ^ -(int32_t)(raw & 1);
+  }
+  frame.valid = pos == packet.size();
+  return frame;
+}
+
+// Split a captured stream on delimiters and decode every non-empty frame
+static std::vector<DecodedFrame> decodeStream(const uint8_t* data, size_t length) {
+  std::vector<DecodedFrame> frames;
+  size_t start = 0;
+  for (size_t i = 0; i < length; i++) {
+    if (data[i] != 0) continue;
+    if (i > start) frames.push_back(decodeFrame(data + start, i - start));
+    start = i + 1;
+  }
+  return frames;
+}
+
+static DecodedFrame encodeOne(uint32_t now) {
+  uint8_t out[TELEMETRY_MAX_FRAME];
+  size_t length = encoder.encode(now, out, sizeof(out));
+  TEST_ASSERT_TRUE(length > 0);
+  TEST_ASSERT_EQUAL_HEX8(0, out[length - 1]);
+  std::vector<DecodedFrame> frames = decodeStream(out, length);
+  TEST_ASSERT_EQUAL(1, (int)frames.size());
+  TEST_ASSERT_TRUE(frames[0].valid);
+  return frames[0];
+}
+
+// ---- Primitives -----------------------------------------------------------
+
+void test_crc16_check_value() {
+  const char* text = "123456789";
+  TEST_ASSERT_EQUAL_HEX16(0x29B1, crc16CCITT((const uint8_t*)text, 9));
+  // Chained over two halves
+  uint16_t crc = crc16CCITT((const uint8_t*)text, 4);
+  TEST_ASSERT_EQUAL_HEX16(0x29B1, crc16CCITT((const uint8_t*)text + 4, 5, crc));
+}
+
+void test_cobs_vectors() {
+  uint8_t out[300];
+  const uint8_t zero[] = {0x00};
+  TEST_ASSERT_EQUAL(2, (int)cobsEncode(zero, 1, out));
+  TEST_ASSERT_EQUAL_HEX8(0x01, out[0]);
+  TEST_ASSERT_EQUAL_HEX8(0x01, out[1]);
+
+  const uint8_t mixed[] = {0x11, 0x22, 0x00, 0x33};
+  const uint8_t expected[] = {0x03, 0x11, 0x22, 0x02, 0x33};
+  TEST_ASSERT_EQUAL(5, (int)cobsEncode(mixed, 4, out));
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, out, 5);
+}
+
+void test_cobs_long_runs() {
+  uint8_t in[255];
+  uint8_t out[300];
+  for (int i = 0; i < 255; i++) in[i] = (uint8_t)(i % 255 + 1);
+
+  // 254 non-zero bytes fill one block exactly
+  TEST_ASSERT_EQUAL(255, (int)cobsEncode(in, 254, out));
+  TEST_ASSERT_EQUAL_HEX8(0xFF, out[0]);
+  std::vector<uint8_t> back = cobsDecode(out, 255);
+  TEST_ASSERT_EQUAL(254, (int)back.size());
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(in, back.data(), 254);
+
+  // One more starts a second block
+  size_t length = cobsEncode(in, 255, out);
+  TEST_ASSERT_EQUAL(257, (int)length);
+  back = cobsDecode(out, length);
+  TEST_ASSERT_EQUAL(255, (int)back.size());
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(in, back.data(), 255);
+  for (size_t i = 0; i < length; i++) TEST_ASSERT_NOT_EQUAL(0, out[i]);
+}
+
+// ---- Encoder --------------------------------------------------------------
+
+void test_keyframe_then_deltas() {
+  encoder.record(SIGNAL_RPM, 1726.0f);
+  encoder.record(SIGNAL_SPEED, 60.0f);
+  uint8_t out[TELEMETRY_MAX_FRAME];
+  size_t length = encoder.encode(1000, out, sizeof(out));
+  TEST_ASSERT_EQUAL_HEX8(0, out[0]);   // Keyframes start with a delimiter too
+
+  std::vector<DecodedFrame> frames = decodeStream(out, length);
+  TEST_ASSERT_EQUAL(1, (int)frames.size());
+  DecodedFrame key = frames[0];
+  TEST_ASSERT_TRUE(key.valid);
+  TEST_ASSERT_EQUAL_UINT8(TELEMETRY_FRAME_KEY, key.type);
+  TEST_ASSERT_EQUAL_UINT32(1000, key.time);
+  TEST_ASSERT_EQUAL_HEX32(SIGNAL_BIT(SIGNAL_RPM) | SIGNAL_BIT(SIGNAL_SPEED), key.mask);
+  TEST_ASSERT_EQUAL(172600, key.values[SIGNAL_RPM]);
+  TEST_ASSERT_EQUAL(6000, key.values[SIGNAL_SPEED]);
+
+  encoder.record(SIGNAL_RPM, 1700.5f);
+  DecodedFrame delta = encodeOne(1250);
+  TEST_ASSERT_EQUAL_UINT8(TELEMETRY_FRAME_DELTA, delta.type);
+  TEST_ASSERT_EQUAL_UINT8(1, delta.sequence);
+  TEST_ASSERT_EQUAL_UINT32(250, delta.time);
+  TEST_ASSERT_EQUAL_HEX32(SIGNAL_BIT(SIGNAL_RPM), delta.mask);
+  TEST_ASSERT_EQUAL(-2550, delta.values[SIGNAL_RPM]);
+
+  TEST_ASSERT_EQUAL_UINT32(2, encoder.getFrames());
+  TEST_ASSERT_EQUAL_UINT32(3, encoder.getSamples());
+}
+
+void test_nothing_recorded() {
+  uint8_t out[TELEMETRY_MAX_FRAME];
+  TEST_ASSERT_EQUAL(0, (int)encoder.encode(0, out, sizeof(out)));
+  encoder.record(SIGNAL_COUNT, 1.0f);
+  TEST_ASSERT_EQUAL(0, (int)encoder.encode(0, out, sizeof(out)));
+}
+
+void test_small_buffer_keeps_state() {
+  encoder.record(SIGNAL_RPM, 800.0f);
+  uint8_t out[TELEMETRY_MAX_FRAME];
+  TEST_ASSERT_EQUAL(0, (int)encoder.encode(0, out, TELEMETRY_MAX_FRAME - 1));
+  DecodedFrame key = encodeOne(10);
+  TEST_ASSERT_EQUAL_UINT8(TELEMETRY_FRAME_KEY, key.type);
+  TEST_ASSERT_EQUAL_UINT8(0, key.sequence);
+  TEST_ASSERT_EQUAL(80000, key.values[SIGNAL_RPM]);
+}
+
+void test_periodic_keyframe_and_reset() {
+  encoder.record(SIGNAL_RPM, 800.0f);
+  encodeOne(0);
+  for (int i = 1; i <= TELEMETRY_KEYFRAME_EVERY; i++) {
+    encoder.record(SIGNAL_SPEED, (float)i);
+    TEST_ASSERT_EQUAL_UINT8(TELEMETRY_FRAME_DELTA, encodeOne(i * 100).type);
+  }
+  encoder.record(SIGNAL_SPEED, 99.0f);
+  DecodedFrame key = encodeOne(10000);
+  TEST_ASSERT_EQUAL_UINT8(TELEMETRY_FRAME_KEY, key.type);
+  // Every known signal, absolute, not just the one updated
+  TEST_ASSERT_EQUAL(80000, key.values[SIGNAL_RPM]);
+  TEST_ASSERT_EQUAL(9900, key.values[SIGNAL_SPEED]);
+
+  encoder.record(SIGNAL_SPEED, 98.0f);
+  encoder.reset();
+  TEST_ASSERT_EQUAL_UINT8(TELEMETRY_FRAME_KEY, encodeOne(10100).type);
+}
+
+void test_worst_case_frame_fits() {
+  for (int i = 0; i < SIGNAL_COUNT; i++) encoder.record((OBDSignal)i, -2.0e7f);
+  uint8_t out[TELEMETRY_MAX_FRAME];
+  size_t length = encoder.encode(0xFFFFFFFF, out, sizeof(out));
+  TEST_ASSERT_TRUE(length > 0 && length <= TELEMETRY_MAX_FRAME);
+  std::vector<DecodedFrame> frames = decodeStream(out, length);
+  TEST_ASSERT_TRUE(frames[0].valid);
+  TEST_ASSERT_EQUAL(-2000000000, frames[0].values[SIGNAL_ENGINE_RUNNING]);
+}
+
+// ---- Client ---------------------------------------------------------------
+
+class CapturePrint : public Print {
+public:
+  size_t write(uint8_t b) override { bytes.push_back(b); return 1; }
+  size_t write(const uint8_t* data, size_t size) override {
+    bytes.insert(bytes.end(), data, data + size);
+    return size;
+  }
+  std::vector<uint8_t> bytes;
+};
+
+void test_client_stream() {
+  SimAdapter adapter;
+  BLEOBDClient client;
+  CapturePrint out;
+  TEST_ASSERT_TRUE(connectClient(client, adapter));
+  out.write((const uint8_t*)"boot text", 9);   // Noise before the first frame
+  client.startTelemetry(out);
+  runFor(client, 3000);
+  client.stopTelemetry();
+  size_t captured = out.bytes.size();
+  runFor(client, 1000);
+  TEST_ASSERT_EQUAL(captured, out.bytes.size());
+  TEST_ASSERT_EQUAL_UINT32(captured - 9, client.getTelemetryBytes());
+
+  std::vector<DecodedFrame> frames = decodeStream(out.bytes.data(), out.bytes.size());
+  TEST_ASSERT_TRUE(frames.size() > 3);
+  TEST_ASSERT_FALSE(frames[0].valid);   // The noise
+  int32_t values[SIGNAL_COUNT] = {};
+  uint32_t updated = 0;
+  for (size_t i = 1; i < frames.size(); i++) {
+    TEST_ASSERT_TRUE(frames[i].valid);
+    TEST_ASSERT_EQUAL_UINT8((uint8_t)(i - 1), frames[i].sequence);
+    bool key = frames[i].type == TELEMETRY_FRAME_KEY;
+    for (uint32_t bits = frames[i].mask; bits; bits &= bits - 1) {
+      int s = __builtin_ctz(bits);
+      values[s] = key ? frames[i].values[s] : values[s] + frames[i].values[s];
+    }
+    updated |= frames[i].mask;
+  }
+  TEST_ASSERT_TRUE(updated & SIGNAL_BIT(SIGNAL_RPM));
+  TEST_ASSERT_EQUAL(172600, values[SIGNAL_RPM]);
+  TEST_ASSERT_EQUAL(6000, values[SIGNAL_SPEED]);
+  client.disconnect();
+}
+
+// ---- Size versus the text display ----------------------------------------
+
+// The signals displayOBDData() prints, one sample each per block
+static const OBDSignal displayedSignals[] = {
+  SIGNAL_RPM, SIGNAL_SPEED, SIGNAL_COOLANT_TEMP, SIGNAL_OIL_TEMP, SIGNAL_FUEL_LEVEL,
+  SIGNAL_THROTTLE, SIGNAL_ENGINE_LOAD, SIGNAL_AIRFLOW, SIGNAL_BOOST,
+  SIGNAL_FUEL_ECONOMY, SIGNAL_AVG_FUEL_ECONOMY, SIGNAL_TRIP_DISTANCE
+};
+static const int displayedCount = sizeof(displayedSignals) / sizeof(displayedSignals[0]);
+
+// One snapshot of the client through both outputs: the text block and a frame
+static void encodeSnapshot(BLEOBDClient& client, uint32_t now, size_t* textBytes, size_t* binaryBytes) {
+  Serial.takeOutput();
+  client.displayOBDData();
+  *textBytes = Serial.takeOutput().size();
+
+  float values[SIGNAL_COUNT];
+  client.getSignalValues(values);
+  for (int i = 0; i < displayedCount; i++) encoder.record(displayedSignals[i], values[displayedSignals[i]]);
+  uint8_t out[TELEMETRY_MAX_FRAME];
+  *binaryBytes = encoder.encode(now, out, sizeof(out));
+}
+
+void test_bytes_per_sample_vs_text() {
+  SimAdapter adapter;
+  BLEOBDClient client;
+  TEST_ASSERT_TRUE(connectClient(client, adapter));
+  runFor(client, 3000);
+
+  // A keyframe, then a delta after one display period of polling
+  size_t textKey, binaryKey, textDelta, binaryDelta;
+  encodeSnapshot(client, millis(), &textKey, &binaryKey);
+  runFor(client, 2000);
+  encodeSnapshot(client, millis(), &textDelta, &binaryDelta);
+  client.disconnect();
+
+  printf("bytes/sample over %d signals: text %.1f, binary keyframe %.1f, delta %.1f\n",
+         displayedCount, (double)textKey / displayedCount,
+         (double)binaryKey / displayedCount, (double)binaryDelta / displayedCount);
+  TEST_ASSERT_TRUE(textKey > 0 && textDelta > 0);
+  TEST_ASSERT_TRUE(binaryKey > 0 && binaryDelta > 0);
+  TEST_ASSERT_TRUE(binaryKey * 8 < textKey);
+  TEST_ASSERT_TRUE(binaryDelta * 8 < textDelta);
+  TEST_ASSERT_TRUE(binaryDelta <= binaryKey);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_crc16_check_value);
+  RUN_TEST(test_cobs_vectors);
+  RUN_TEST(test_cobs_long_runs);
+  RUN_TEST(test_keyframe_then_deltas);
+  RUN_TEST(test_nothing_recorded);
+  RUN_TEST(test_small_buffer_keeps_state);
+  RUN_TEST(test_periodic_keyframe_and_reset);
+  RUN_TEST(test_worst_case_frame_fits);
+  RUN_TEST(test_client_stream);
+  RUN_TEST(test_bytes_per_sample_vs_text);
+  return UNITY_END();
+}
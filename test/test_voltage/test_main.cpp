@@ -0,0 +1,142 @@
+// Supply voltage: source chosen from PID 0140, ATRV fallback when 0142 stops
+// answering, smoothing and the low-voltage callback's hysteresis
+
+#include <unity.h>
+#include "OBDTestHarness.h"
+
+static SimAdapter* adapter = nullptr;
+static BLEOBDClient* client = nullptr;
+static int lowEvents = 0;
+static int recoveredEvents = 0;
+
+static void onVoltage(float, bool low, void*) {
+  if (low) lowEvents++;
+  else recoveredEvents++;
+}
+
+void setUp() {
+  adapter = new SimAdapter();
+  client = new BLEOBDClient();
+  lowEvents = 0;
+  recoveredEvents = 0;
+}
+
+void tearDown() {
+  client->disconnect();
+  delete client;
+  delete adapter;
+}
+
+// Run until one more read of the given request has been answered
+static void nextRead(const char* request) {
+  size_t before = adapter->countWrites(request);
+  TEST_ASSERT_TRUE(runUntil(*client, [&]() { return adapter->countWrites(request) > before; }, 5000));
+  runFor(*client, 200);
+}
+
+void test_pid_source_when_supported() {
+  TEST_ASSERT_TRUE(connectClient(*client, *adapter));
+  nextRead("0142");
+  TEST_ASSERT_EQUAL(VOLTAGE_PID, client->getVoltageSource());
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 12.6f, client->getCurrentData().voltage);
+  TEST_ASSERT_EQUAL(0, (int)adapter->countWrites("ATRV"));
+}
+
+void test_adapter_source_when_not_supported() {
+  adapter->setResponse(0, "0140", "414000000000");
+  adapter->voltage = 13.1f;
+  TEST_ASSERT_TRUE(connectClient(*client, *adapter));
+  nextRead("ATRV");
+  TEST_ASSERT_EQUAL(VOLTAGE_ADAPTER, client->getVoltageSource());
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 13.1f, client->getCurrentData().voltage);
+  TEST_ASSERT_EQUAL(0, (int)adapter->countWrites("0142"));
+}
+
+void test_falls_back_to_adapter() {
+  client->setVoltageInterval(500);
+  TEST_ASSERT_TRUE(connectClient(*client, *adapter));
+  nextRead("0142");
+  adapter->removeResponse(0, "0142");   // Ignition off: NO DATA
+  adapter->voltage = 12.0f;
+  TEST_ASSERT_TRUE(runUntil(*client, [&]() { return client->getVoltageSource() == VOLTAGE_ADAPTER; }, 10000));
+  TEST_ASSERT_EQUAL(4, (int)adapter->countWrites("0142"));   // One answered, three failures
+  nextRead("ATRV");
+  TEST_ASSERT_TRUE(client->getCurrentData().voltage < 12.6f);
+}
+
+void test_smoothing() {
+  adapter->setResponse(0, "0140", "414000000000");
+  client->setVoltageInterval(1000);
+  TEST_ASSERT_TRUE(connectClient(*client, *adapter));
+  nextRead("ATRV");
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 12.6f, client->getCurrentData().voltage);   // First read taken as is
+  adapter->voltage = 13.6f;
+  nextRead("ATRV");
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 12.9f, client->getCurrentData().voltage);   // 30% of the step
+}
+
+void test_low_voltage_hysteresis() {
+  adapter->setResponse(0, "0140", "414000000000");
+  client->setVoltageInterval(200);
+  client->setLowVoltageThreshold(11.8f);
+  client->setVoltageCallback(onVoltage);
+  TEST_ASSERT_TRUE(connectClient(*client, *adapter));
+  nextRead("ATRV");
+
+  adapter->voltage = 11.0f;
+  TEST_ASSERT_TRUE(runUntil(*client, [&]() { return client->isVoltageLow(); }, 10000));
+  TEST_ASSERT_EQUAL(1, lowEvents);
+
+  // Above the threshold but inside the hysteresis band: still low
+  adapter->voltage = 11.95f;
+  runFor(*client, 10000);
+  TEST_ASSERT_TRUE(client->isVoltageLow());
+  TEST_ASSERT_EQUAL(0, recoveredEvents);
+
+  adapter->voltage = 12.6f;
+  TEST_ASSERT_TRUE(runUntil(*client, [&]() { return !client->isVoltageLow(); }, 10000));
+  TEST_ASSERT_EQUAL(1, recoveredEvents);
+  TEST_ASSERT_EQUAL(1, lowEvents);
+}
+
+void test_disabled() {
+  client->setVoltageInterval(0);
+  TEST_ASSERT_TRUE(connectClient(*client, *adapter));
+  runFor(*client, 5000);
+  TEST_ASSERT_EQUAL(0, (int)adapter->countWrites("0142"));
+  TEST_ASSERT_EQUAL(0, (int)adapter->countWrites("ATRV"));
+}
+
+void test_reconnect_reads_once() {
+  adapter->setResponse(0, "0140", "414000000000");
+  client->setVoltageInterval(1000);
+  TEST_ASSERT_TRUE(connectClient(*client, *adapter));
+  nextRead("ATRV");
+
+  // The next read is still queued when the link drops
+  adapter->replying = false;
+  TEST_ASSERT_TRUE(runUntil(*client, [&]() { return client->getPendingOneShots() > 0; }, 5000));
+  adapter->dropLink();
+  TEST_ASSERT_TRUE(runUntil(*client, [&]() { return client->getConnectionState() == SCANNING; }, 1000));
+  adapter->replying = true;
+  adapter->clearWrites();
+  adapter->advertise();
+  TEST_ASSERT_TRUE(runUntil(*client, [&]() { return client->getConnectionState() == CONNECTED; }, 5000));
+
+  // initializeOBD() picks the source again and reads once, not twice
+  runFor(*client, 500);
+  TEST_ASSERT_EQUAL(1, (int)adapter->countWrites("ATRV"));
+  TEST_ASSERT_EQUAL(1, (int)adapter->countWrites("0140"));
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_pid_source_when_supported);
+  RUN_TEST(test_adapter_source_when_not_supported);
+  RUN_TEST(test_falls_back_to_adapter);
+  RUN_TEST(test_smoothing);
+  RUN_TEST(test_low_voltage_hysteresis);
+  RUN_TEST(test_disabled);
+  RUN_TEST(test_reconnect_reads_once);
+  return UNITY_END();
+}
@@ -0,0 +1,63 @@
+#!/usr/bin/env python3
+"""Compare two host benchmark runs (test/test_benchmarks JSON output).
+
+Prints the time per iteration of every benchmark in both files and the
+change, and exits non-zero when any benchmark got slower than the
+threshold, so it can gate a change in CI.
+
+    OBD_BENCH_JSON=before.json pio test -e native -f test_benchmarks
+    (apply the change)
+    OBD_BENCH_JSON=after.json pio test -e native -f test_benchmarks
+    python3 tools/bench_compare.py before.json after.json --threshold 10
+"""
+import argparse
+import json
+import sys
+
+
+def load(path):
+    with open(path) as f:
+        data = json.load(f)
+    return {b["name"]: b for b in data.get("benchmarks", [])
+            if b.get("run_type", "iteration") == "iteration"}
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("before", help="baseline JSON")
+    parser.add_argument("after", help="JSON of the change")
+    parser.add_argument("--threshold", type=float, default=10.0,
+                        help="percent slowdown that counts as a regression (default 10)")
+    args = parser.parse_args()
+
+    before = load(args.before)
+    after = load(args.after)
+    names = [n for n in after if n in before]
+    if not names:
+        print("No benchmarks in common", file=sys.stderr)
+        return 2
+
+    width = max(len(n) for n in names)
+    print(f"{'benchmark':<{width}}  {'before ns':>12}  {'after ns':>12}  {'change':>8}")
+    regressions = []
+    for name in names:
+        old = before[name]["real_time"]
+        new = after[name]["real_time"]
+        change = (new - old) / old * 100.0 if old else 0.0
+        flag = ""
+        if change > args.threshold:
+            flag = "  SLOWER"
+            regressions.append(name)
+        print(f"{name:<{width}}  {old:12.1f}  {new:12.1f}  {change:+7.1f}%{flag}")
+
+    for name in sorted(set(before) ^ set(after)):
+        print(f"{name}: only in {'before' if name in before else 'after'}")
+
+    if regressions:
+        print(f"\n{len(regressions)} benchmark(s) slower than {args.threshold:g}%", file=sys.stderr)
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,72 @@
+#!/usr/bin/env python3
+"""Convert signals from a .dbc file into the compact blob read by
+CANSignalDB::loadBlob().
+
+    python3 tools/dbc2blob.py car.dbc [SIGNAL ...] > src/car_signals.h
+
+Only the named signals are exported (all signals when none are given), in
+the order given. The signal index used by CANSignalDB::getValue() is the
+position in that order and is listed in the generated header.
+Multiplexed signals are skipped.
+"""
+import re
+import struct
+import sys
+
+BLOB_VERSION = 1
+FLAG_LITTLE_ENDIAN = 0x01
+FLAG_SIGNED = 0x02
+
+MESSAGE_RE = re.compile(r"^BO_\s+(\d+)\s+(\w+)\s*:")
+SIGNAL_RE = re.compile(
+    r"^SG_\s+(\w+)\s*(\S*)\s*:\s*(\d+)\|(\d+)@([01])([+-])\s*"
+    r"\(\s*([-+0-9.eE]+)\s*,\s*([-+0-9.eE]+)\s*\)")
+
+
+def parse_dbc(path):
+    signals = []
+    can_id = None
+    for raw in open(path, encoding="latin-1"):
+        line = raw.strip()
+        m = MESSAGE_RE.match(line)
+        if m:
+            can_id = int(m.group(1)) & 0x1FFFFFFF  # Bit 31 flags extended ids
+            continue
+        m = SIGNAL_RE.match(line)
+        if m and can_id is not None:
+            name, mux, start, length, order, sign, scale, offset = m.groups()
+            if mux:
+                continue
+            flags = (FLAG_LITTLE_ENDIAN if order == "1" else 0) | (FLAG_SIGNED if sign == "-" else 0)
+            signals.append((name, can_id, int(start), int(length), flags, float(scale), float(offset)))
+    return signals
+
+
+def main():
+    if len(sys.argv) < 2:
+        sys.exit(__doc__)
+
+    signals = parse_dbc(sys.argv[1])
+    wanted = sys.argv[2:]
+    if wanted:
+        by_name = {s[0]: s for s in signals}
+        missing = [n for n in wanted if n not in by_name]
+        if missing:
+            sys.exit("unknown signals: " + ", ".join(missing))
+        signals = [by_name[n] for n in wanted]
+
+    blob = bytearray(b"CDBC") + struct.pack("<BH", BLOB_VERSION, len(signals))
+    for _, can_id, start, length, flags, scale, offset in signals:
+        blob += struct.pack("<IBBBff", can_id, start, length, flags, scale, offset)
+
+    print("// Generated by tools/dbc2blob.py from " + sys.argv[1])
+    for index, (name, can_id, *_rest) in enumerate(signals):
+        print("#define CAN_SIGNAL_%s %d  // 0x%X" % (name.upper(), index, can_id))
+    print("static const uint8_t CAN_SIGNAL_BLOB[%d] = {" % len(blob))
+    for i in range(0, len(blob), 12):
+        print("  " + ", ".join("0x%02X" % b for b in blob[i:i + 12]) + ",")
+    print("};")
+
+
+if __name__ == "__main__":
+    main()
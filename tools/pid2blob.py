@@ -0,0 +1,57 @@
+#!/usr/bin/env python3
+"""Convert an extended PID list (CSV) into the compact blob read by
+BLEOBDClient::loadExtendedPIDs().
+
+CSV columns (header row required):
+    name,mode,pid,header,ecu,byte,bit,length,signed,scale,offset
+
+Numbers accept hex (0x...). Output is a C array ready to #include.
+
+    python3 tools/pid2blob.py vag_pids.csv > src/vag_pids.h
+"""
+import csv
+import struct
+import sys
+
+BLOB_VERSION = 1
+MAX_PAYLOAD = 64  # OBD_MAX_PAYLOAD in OBDResponse.h
+
+
+def num(text):
+    return int(text, 0)
+
+
+def main():
+    if len(sys.argv) != 2:
+        sys.exit(__doc__)
+
+    rows = list(csv.DictReader(open(sys.argv[1], newline="")))
+    if len(rows) > 255:
+        sys.exit("too many PIDs (max 255)")
+
+    blob = bytearray(b"XPID") + bytes([BLOB_VERSION, len(rows)])
+    for row in rows:
+        mode, byte, bit, length = num(row["mode"]), num(row["byte"]), num(row["bit"]), num(row["length"])
+        echo = 2 if mode == 0x22 else 1
+        if not 1 <= length <= 32 or not 0 <= bit <= 7 or \
+                1 + echo + byte + (bit + length + 7) // 8 > MAX_PAYLOAD:
+            sys.exit("%s: field outside the response frame" % row["name"])
+        flags = 0x01 if row["signed"].strip().lower() in ("1", "true", "yes") else 0
+        blob += struct.pack(
+            "<BHIIBBBBff",
+            num(row["mode"]), num(row["pid"]), num(row["header"]), num(row["ecu"]),
+            num(row["byte"]), num(row["bit"]), num(row["length"]), flags,
+            float(row["scale"]), float(row["offset"]),
+        )
+
+    print("// Generated by tools/pid2blob.py from " + sys.argv[1])
+    for row in rows:
+        print("//   %s: mode %s PID %s" % (row["name"], row["mode"], row["pid"]))
+    print("static const uint8_t EXTENDED_PID_BLOB[%d] = {" % len(blob))
+    for i in range(0, len(blob), 12):
+        print("  " + ", ".join("0x%02X" % b for b in blob[i:i + 12]) + ",")
+    print("};")
+
+
+if __name__ == "__main__":
+    main()
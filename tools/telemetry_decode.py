@@ -0,0 +1,170 @@
+#!/usr/bin/env python3
+"""Decode the binary telemetry stream written by BLEOBDClient::startTelemetry().
+
+Reads a serial port (needs pyserial) or a captured file, checks each
+COBS/CRC16 frame, rebuilds the signal values and prints one CSV row per
+frame. Bytes between frames that don't decode (boot or debug text) are
+skipped.
+
+    python3 tools/telemetry_decode.py /dev/ttyACM0 > drive.csv
+    python3 tools/telemetry_decode.py capture.bin --stats
+"""
+import argparse
+import sys
+
+# Must match enum OBDSignal in OBDSubscription.h
+SIGNALS = [
+    "rpm", "speed", "coolant_temp", "oil_temp", "fuel_level", "throttle",
+    "engine_load", "airflow", "boost", "voltage", "manifold_pressure",
+    "baro_pressure", "fuel_rate", "fuel_economy", "avg_fuel_economy",
+    "trip_distance", "engine_running",
+]
+
+FRAME_DELTA = 1
+FRAME_KEY = 2
+SCALE = 100.0
+
+
+def crc16(data, crc=0xFFFF):
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else crc << 1
+            crc &= 0xFFFF
+    return crc
+
+
+def cobs_decode(data):
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        code = data[i]
+        if code == 0 or i + code > len(data):
+            raise ValueError("bad COBS block")
+        out += data[i + 1:i + code]
+        i += code
+        if code < 0xFF and i < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+def varint(data, pos):
+    value = shift = 0
+    while True:
+        if pos >= len(data):
+            raise ValueError("truncated varint")
+        byte = data[pos]
+        pos += 1
+        value |= (byte & 0x7F) << shift
+        shift += 7
+        if not byte & 0x80:
+            return value, pos
+
+
+def unzigzag(value):
+    return (value >> 1) ^ -(value & 1)
+
+
+class Decoder:
+    def __init__(self):
+        self.values = {}
+        self.time = None
+        self.sequence = None
+        self.synced = False
+        self.frames = self.samples = self.bytes = 0
+        self.bad = self.lost = 0
+
+    def feed(self, frame):
+        """Decode one frame (without delimiter); returns (time, updated) or None."""
+        self.bytes += len(frame) + 1
+        try:
+            packet = cobs_decode(frame)
+            if len(packet) < 6 or crc16(packet[:-2]) != packet[-2] | packet[-1] << 8:
+                raise ValueError("CRC mismatch")
+            kind, seq = packet[0], packet[1]
+            time, pos = varint(packet, 2)
+            mask, pos = varint(packet, pos)
+            fields = []
+            for index in range(len(SIGNALS)):
+                if mask & (1 << index):
+                    raw, pos = varint(packet, pos)
+                    fields.append((index, unzigzag(raw)))
+        except (ValueError, IndexError):
+            self.bad += 1
+            return None
+
+        if self.sequence is not None and seq != (self.sequence + 1) & 0xFF:
+            self.lost += 1
+            self.synced = False
+        self.sequence = seq
+        self.frames += 1
+        self.samples += len(fields)
+
+        if kind == FRAME_KEY:
+            self.time = time
+            self.values = {index: value for index, value in fields}
+            self.synced = True
+        elif kind == FRAME_DELTA and self.synced:
+            self.time += time
+            for index, delta in fields:
+                self.values[index] = self.values.get(index, 0) + delta
+        else:
+            return None  # Wait for the next keyframe
+        return self.time, [index for index, _ in fields]
+
+
+def frames(stream):
+    buffer = bytearray()
+    while True:
+        chunk = stream.read(256)
+        if not chunk:
+            return
+        for byte in chunk:
+            if byte == 0:
+                if buffer:
+                    yield bytes(buffer)
+                buffer.clear()
+            else:
+                buffer.append(byte)
+
+
+def open_source(path, baud):
+    try:
+        return open(path, "rb")
+    except OSError:
+        pass
+    import serial  # Only needed for live ports
+    return serial.Serial(path, baud, timeout=1)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("source", help="serial port or captured file")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--stats", action="store_true", help="print totals instead of rows")
+    args = parser.parse_args()
+
+    decoder = Decoder()
+    if not args.stats:
+        print("time_ms," + ",".join(SIGNALS))
+
+    with open_source(args.source, args.baud) as stream:
+        for frame in frames(stream):
+            result = decoder.feed(frame)
+            if result and not args.stats:
+                time, _ = result
+                row = [str(time)]
+                for index in range(len(SIGNALS)):
+                    value = decoder.values.get(index)
+                    row.append("" if value is None else "%g" % (value / SCALE))
+                print(",".join(row))
+
+    if args.stats:
+        per_sample = decoder.bytes / decoder.samples if decoder.samples else 0
+        print("frames %d, samples %d, bytes %d (%.2f bytes/sample), bad %d, gaps %d"
+              % (decoder.frames, decoder.samples, decoder.bytes, per_sample,
+                 decoder.bad, decoder.lost))
+
+
+if __name__ == "__main__":
+    main()